@@ -335,6 +335,12 @@ installers.  The most commonly-used variables are:
 
   Other compression methods ignore this value and use only one thread.
 
+  .. versionadded:: 4.2
+
+    With more than one thread, the Archive and Debian generators also
+    read the files to be packaged on multiple threads ahead of adding
+    them to the package.
+
 Variables for Source Package Generators
 ^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^^
 
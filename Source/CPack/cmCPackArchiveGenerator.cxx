@@ -271,6 +271,14 @@ int cmCPackArchiveGenerator::addOneComponentToArchive(
     filePrefix += installPrefix->substr(1);
     filePrefix += "/";
   }
+  if (!deduplicator) {
+    std::vector<std::string> paths;
+    paths.reserve(component->Files.size());
+    for (std::string const& file : component->Files) {
+      paths.push_back(filePrefix + file);
+    }
+    archive.PrefetchFiles(paths);
+  }
   for (std::string const& file : component->Files) {
     std::string rp = filePrefix + file;
 
@@ -461,10 +469,16 @@ int cmCPackArchiveGenerator::PackageFiles()
     cmCPackLogger(cmCPackLog::LOG_ERROR, workdir.GetError() << std::endl);
     return 0;
   }
+  std::vector<std::string> paths;
+  paths.reserve(this->files.size());
   for (std::string const& file : this->files) {
     // Get the relative path to the file
-    std::string rp = cmSystemTools::RelativePath(this->toplevel, file);
-    archive.Add(rp, 0, nullptr, false);
+    paths.push_back(cmSystemTools::RelativePath(this->toplevel, file));
+  }
+  archive.PrefetchFiles(paths);
+  auto rp = paths.begin();
+  for (std::string const& file : this->files) {
+    archive.Add(*rp++, 0, nullptr, false);
     if (!archive) {
       cmCPackLogger(cmCPackLog::LOG_ERROR,
                     "Problem while adding file <"
@@ -9,6 +9,7 @@
 #include <set>
 #include <stdexcept>
 #include <utility>
+#include <vector>
 
 #include "cmsys/Glob.hxx"
 
@@ -229,6 +230,8 @@ bool DebGenerator::generateDataTar() const
     }
   }
 
+  data_tar.PrefetchFiles(
+    std::vector<std::string>(orderedFiles.begin(), orderedFiles.end()));
   for (std::string const& file : orderedFiles) {
     cmCPackLogger(cmCPackLog::LOG_DEBUG,
                   "FILEIT: \"" << file << "\"" << std::endl);
@@ -11,11 +11,16 @@
 #include <memory>
 #include <ratio>
 #include <sstream>
+#include <thread>
 #include <type_traits>
 #include <utility>
 
+#include <cm/memory>
+#include <cm/optional>
 #include <cmext/algorithm>
 
+#include <cm3p/uv.h>
+
 #include "cmsys/FStream.hxx"
 #include "cmsys/Glob.hxx"
 #include "cmsys/RegularExpression.hxx"
@@ -30,9 +35,12 @@
 #include "cmParseGTMCoverage.h"
 #include "cmParseJacocoCoverage.h"
 #include "cmParsePHPCoverage.h"
+#include "cmProcessOutput.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
+#include "cmUVHandlePtr.h"
 #include "cmUVProcessChain.h"
+#include "cmUVStream.h"
 #include "cmWorkingDirectory.h"
 #include "cmXMLWriter.h"
 
@@ -807,6 +815,84 @@ static std::string joinCommandLine(std::vector<std::string> const& args)
   return ret;
 }
 
+namespace {
+// Maximum number of *.gcda files given to one gcov invocation.
+size_t const GCovFilesPerJob = 64;
+
+// One gcov invocation running on a shared event loop.
+struct GCovJob
+{
+  std::vector<std::string> Files;
+  std::string FileDir;
+  std::vector<std::string> Command;
+  std::string WorkingDirectory;
+
+  void Start(uv_loop_t& loop)
+  {
+    cmUVProcessChainBuilder builder;
+    builder.AddCommand(this->Command)
+      .SetExternalLoop(loop)
+      .SetBuiltinStream(cmUVProcessChainBuilder::Stream_OUTPUT)
+      .SetBuiltinStream(cmUVProcessChainBuilder::Stream_ERROR)
+      .SetWorkingDirectory(this->WorkingDirectory);
+    this->Chain = cm::make_unique<cmUVProcessChain>(builder.Start());
+    this->OutputHandle =
+      this->StartRead(this->OutputPipe, this->Chain->OutputStream(),
+                      this->OutputData, this->OutputFinished);
+    this->ErrorHandle =
+      this->StartRead(this->ErrorPipe, this->Chain->ErrorStream(),
+                      this->ErrorData, this->ErrorFinished);
+  }
+
+  bool Finished() const
+  {
+    return this->OutputFinished && this->ErrorFinished &&
+      this->Chain->Finished();
+  }
+
+  // Same conventions as cmCTest::RunCommand.
+  bool GetResult(std::string& output, std::string& errors, int& retVal)
+  {
+    cmProcessOutput processOutput(cmProcessOutput::Auto);
+    processOutput.DecodeText(this->OutputData, this->OutputData);
+    output.assign(this->OutputData.data(), this->OutputData.size());
+    processOutput.DecodeText(this->ErrorData, this->ErrorData);
+    errors.assign(this->ErrorData.data(), this->ErrorData.size());
+
+    auto exception = this->Chain->GetStatus(0).GetException();
+    if (exception.first != cmUVProcessChain::ExceptionCode::None) {
+      errors += exception.second;
+      return false;
+    }
+    retVal = static_cast<int>(this->Chain->GetStatus(0).ExitStatus);
+    return true;
+  }
+
+private:
+  std::unique_ptr<cmUVProcessChain> Chain;
+  cm::uv_pipe_ptr OutputPipe;
+  cm::uv_pipe_ptr ErrorPipe;
+  std::unique_ptr<cmUVStreamReadHandle> OutputHandle;
+  std::unique_ptr<cmUVStreamReadHandle> ErrorHandle;
+  std::vector<char> OutputData;
+  std::vector<char> ErrorData;
+  bool OutputFinished = false;
+  bool ErrorFinished = false;
+
+  std::unique_ptr<cmUVStreamReadHandle> StartRead(cm::uv_pipe_ptr& pipe,
+                                                  int stream,
+                                                  std::vector<char>& data,
+                                                  bool& finished)
+  {
+    pipe.init(this->Chain->GetLoop(), 0);
+    uv_pipe_open(pipe, stream);
+    return cmUVStreamRead(
+      pipe, [&data](std::vector<char> chunk) { cm::append(data, chunk); },
+      [&finished]() { finished = true; });
+  }
+};
+}
+
 int cmCTestCoverageHandler::HandleBlanketJSCoverage(
   cmCTestCoverageHandlerContainer* cont)
 {
@@ -915,7 +1001,6 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
 
   std::set<std::string> missingFiles;
 
-  std::string actualSourceFile;
   cmCTestOptionalLog(
     this->CTest, HANDLER_OUTPUT,
     "   Processing coverage (each . represents one file):" << std::endl,
@@ -936,44 +1021,87 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
   // These are binary files that you give as input to gcov so that it will
   // give us text output we can analyze to summarize coverage.
   //
-  for (std::string const& f : files) {
-    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "." << std::flush,
-                       this->Quiet);
-
-    // Call gcov to get coverage data for this *.gcda file:
-    //
-    std::string fileDir = cmSystemTools::GetFilenamePath(f);
-    std::vector<std::string> covargs = basecovargs;
-    covargs.push_back(fileDir);
-    covargs.push_back(f);
-    std::string const command = joinCommandLine(covargs);
+  // gcov names the files it creates after the sources only, unless long
+  // file names are requested.  Only then can one invocation process
+  // several files without overwriting its own outputs before they are
+  // read.
+  bool const longFileNames =
+    std::any_of(basecovargs.begin(), basecovargs.end(),
+                [](std::string const& arg) {
+                  return arg == "-l" || arg == "--long-file-names";
+                });
+  cm::uv_loop_ptr loop;
+  loop.init();
+  std::vector<GCovJob> jobs;
+  {
+    std::map<std::string, size_t> openJobs;
+    for (std::string const& f : files) {
+      std::string fileDir = cmSystemTools::GetFilenamePath(f);
+      if (longFileNames) {
+        auto it = openJobs.find(fileDir);
+        if (it != openJobs.end() &&
+            jobs[it->second].Files.size() < GCovFilesPerJob) {
+          jobs[it->second].Files.push_back(f);
+          continue;
+        }
+        openJobs[fileDir] = jobs.size();
+      }
+      jobs.emplace_back();
+      jobs.back().Files.push_back(f);
+      jobs.back().FileDir = std::move(fileDir);
+    }
+  }
 
-    cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
-                       command << std::endl, this->Quiet);
+  // Run as many gcov processes at once as tests.  Each concurrent
+  // process gets its own directory for the files it creates.
+  cm::optional<size_t> parallelLevel = this->CTest->GetParallelLevel();
+  size_t slots = parallelLevel
+    ? *parallelLevel
+    : std::max(std::thread::hardware_concurrency(), 1u);
+  if (slots == 0 || slots > jobs.size()) {
+    slots = jobs.size();
+  }
+  std::vector<std::string> freeSlots;
+  for (size_t slot = slots; slot > 1; --slot) {
+    std::string slotDir = cmStrCat(tempDir, "/gcov", slot - 1);
+    if (!cmSystemTools::MakeDirectory(slotDir)) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Unable to make directory: " << slotDir << std::endl);
+      cont->Error++;
+      return 0;
+    }
+    freeSlots.push_back(std::move(slotDir));
+  }
+  freeSlots.push_back(tempDir);
 
+  // The output of each process is analyzed when it finishes, in the order
+  // processes finish.
+  auto finishJob = [&](GCovJob& job) -> bool {
+    std::string const command = joinCommandLine(job.Command);
     std::string output;
     std::string errors;
     int retVal = 0;
-    *cont->OFS << "* Run coverage for: " << fileDir << std::endl;
-    *cont->OFS << "  Command: " << command << std::endl;
-    int res = this->CTest->RunCommand(covargs, &output, &errors, &retVal,
-                                      tempDir.c_str(),
-                                      cmDuration::zero() /*this->TimeOut*/);
+    bool res = job.GetResult(output, errors, retVal);
 
+    *cont->OFS << "* Run coverage for: " << job.FileDir << std::endl;
+    *cont->OFS << "  Command: " << command << std::endl;
     *cont->OFS << "  Output: " << output << std::endl;
     *cont->OFS << "  Errors: " << errors << std::endl;
     if (!res) {
-      cmCTestLog(this->CTest, ERROR_MESSAGE,
-                 "Problem running coverage on file: " << f << std::endl);
+      for (std::string const& f : job.Files) {
+        cmCTestLog(this->CTest, ERROR_MESSAGE,
+                   "Problem running coverage on file: " << f << std::endl);
+      }
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Command produced error: " << errors << std::endl);
       cont->Error++;
-      continue;
+      return false;
     }
     if (retVal != 0) {
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Coverage command returned: "
-                   << retVal << " while processing: " << f << std::endl);
+                   << retVal << " while processing: " << cmJoin(job.Files, " ")
+                   << std::endl);
       cmCTestLog(this->CTest, ERROR_MESSAGE,
                  "Command produced error: " << cont->Error << std::endl);
     }
@@ -989,6 +1117,7 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
     std::vector<std::string> lines;
     cmsys::SystemTools::Split(output, lines);
 
+    std::string actualSourceFile;
     for (std::string const& line : lines) {
       std::string sourceFile;
       std::string gcovFile;
@@ -1129,7 +1258,9 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
                            "   in gcovFile: " << gcovFile << std::endl,
                            this->Quiet);
 
-        cmsys::ifstream ifile(gcovFile.c_str());
+        std::string const gcovPath =
+          cmSystemTools::CollapseFullPath(gcovFile, job.WorkingDirectory);
+        cmsys::ifstream ifile(gcovPath.c_str());
         if (!ifile) {
           cmCTestLog(this->CTest, ERROR_MESSAGE,
                      "Cannot open file: " << gcovFile << std::endl);
@@ -1232,15 +1363,58 @@ int cmCTestCoverageHandler::HandleGCovCoverage(
         }
       }
     }
+    return true;
+  };
 
-    file_count++;
+  std::vector<size_t> running;
+  size_t next = 0;
+  while (next < jobs.size() || !running.empty()) {
+    for (; next < jobs.size() && !freeSlots.empty(); ++next) {
+      // Call gcov to get coverage data for these *.gcda files:
+      //
+      GCovJob& job = jobs[next];
+      job.Command = basecovargs;
+      job.Command.push_back(job.FileDir);
+      cm::append(job.Command, job.Files);
+      job.WorkingDirectory = std::move(freeSlots.back());
+      freeSlots.pop_back();
+
+      cmCTestOptionalLog(this->CTest, HANDLER_VERBOSE_OUTPUT,
+                         joinCommandLine(job.Command) << std::endl,
+                         this->Quiet);
+      job.Start(*loop);
+      running.push_back(next);
+    }
+
+    uv_run(loop, UV_RUN_ONCE);
+
+    for (auto it = running.begin(); it != running.end();) {
+      GCovJob& job = jobs[*it];
+      if (!job.Finished()) {
+        ++it;
+        continue;
+      }
+      freeSlots.push_back(job.WorkingDirectory);
+      it = running.erase(it);
 
-    if (file_count % 50 == 0) {
       cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
-                         " processed: " << file_count << " out of "
-                                        << files.size() << std::endl,
+                         std::string(job.Files.size(), '.') << std::flush,
                          this->Quiet);
-      cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "    ", this->Quiet);
+      if (!finishJob(job)) {
+        continue;
+      }
+      for (size_t i = 0; i < job.Files.size(); ++i) {
+        file_count++;
+
+        if (file_count % 50 == 0) {
+          cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                             " processed: " << file_count << " out of "
+                                            << files.size() << std::endl,
+                             this->Quiet);
+          cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT, "    ",
+                             this->Quiet);
+        }
+      }
     }
   }
 
@@ -8,9 +8,11 @@
 #include <cmath>
 #include <cstddef> // IWYU pragma: keep
 #include <cstdlib>
+#include <functional>
 #include <iomanip>
 #include <iostream>
 #include <list>
+#include <queue>
 #include <sstream>
 #include <stack>
 #include <unordered_map>
@@ -34,6 +36,7 @@
 #include "cmCTestBinPacker.h"
 #include "cmCTestRunTest.h"
 #include "cmCTestTestHandler.h"
+#include "cmCTestWorkerPool.h"
 #include "cmDuration.h"
 #include "cmJSONState.h"
 #include "cmListFileCache.h"
@@ -182,7 +185,8 @@ void cmCTestMultiProcessHandler::SetParallelLevel(cm::optional<size_t> level)
 size_t cmCTestMultiProcessHandler::GetParallelLevel() const
 {
   if ((this->ParallelLevel && *this->ParallelLevel == 0) ||
-      (!this->ParallelLevel && this->JobServerClient)) {
+      (!this->ParallelLevel &&
+       (this->JobServerClient || !this->WorkerCommands.empty()))) {
     return kParallelLevelUnbounded;
   }
   if (this->ParallelLevel) {
@@ -223,10 +227,17 @@ void cmCTestMultiProcessHandler::InitializeLoop()
     cmCTestLog(this->CTest, OUTPUT,
                "Connected to MAKE jobserver" << std::endl);
   }
+
+  if (!this->WorkerCommands.empty()) {
+    this->WorkerPool = cm::make_unique<cmCTestWorkerPool>(
+      this->CTest, *this->Loop, [this]() { this->StartNextTestsOnIdle(); });
+    this->WorkerPool->Start(this->WorkerCommands);
+  }
 }
 
 void cmCTestMultiProcessHandler::FinalizeLoop()
 {
+  this->WorkerPool.reset();
   this->JobServerClient.reset();
   this->StartNextTestsOnTimer_.reset();
   this->StartNextTestsOnIdle_.reset();
@@ -241,11 +252,23 @@ void cmCTestMultiProcessHandler::RunTests()
   }
   this->TestHandler->SetMaxIndex(this->FindMaxIndex());
 
+  auto const start = std::chrono::steady_clock::now();
   this->InitializeLoop();
   this->StartNextTestsOnIdle();
   uv_run(this->Loop, UV_RUN_DEFAULT);
   this->FinalizeLoop();
 
+  if (this->PredictedMakespan) {
+    std::chrono::duration<double> const achieved =
+      std::chrono::steady_clock::now() - start;
+    cmCTestOptionalLog(this->CTest, HANDLER_OUTPUT,
+                       "\nCritical path schedule: predicted "
+                         << std::fixed << std::setprecision(2)
+                         << *this->PredictedMakespan << " sec, achieved "
+                         << achieved.count() << " sec" << std::endl,
+                       this->Quiet);
+  }
+
   if (!this->StopTimePassed && !this->CheckStopOnFailure()) {
     assert(this->Complete());
     assert(this->PendingTests.empty());
@@ -563,7 +586,12 @@ std::string cmCTestMultiProcessHandler::GetName(int test)
 
 void cmCTestMultiProcessHandler::StartTest(int test)
 {
-  if (this->JobServerClient) {
+  if (this->WorkerPool) {
+    // There are workers.  Queue the test to run when one of them has
+    // enough free slots.
+    this->WorkerQueuedTests.emplace_back(test);
+    this->StartWorkerTests();
+  } else if (this->JobServerClient) {
     // There is a job server.  Request a token and queue the test to run
     // when a token is received.  Note that if we do not get a token right
     // away it's possible that the system load will be higher when the
@@ -586,6 +614,34 @@ void cmCTestMultiProcessHandler::JobServerReceivedToken()
   this->StartTestProcess(test);
 }
 
+void cmCTestMultiProcessHandler::StartWorkerTests()
+{
+  for (auto ti = this->WorkerQueuedTests.begin();
+       ti != this->WorkerQueuedTests.end();) {
+    int test = *ti;
+    size_t slots = this->GetProcessorsUsed(test);
+    cm::optional<size_t> worker = this->WorkerPool->AcquireSlots(slots);
+    if (!worker && this->WorkerPool->HasWorkers()) {
+      // Try smaller tests until a worker frees some slots.
+      ++ti;
+      continue;
+    }
+    if (worker) {
+      this->TestWorkers[test] = WorkerSlots{ *worker, slots };
+    } else {
+      // No worker is left.  Run the test locally.  If the workers alone
+      // limited the tests run at the same time, apply the default limit.
+      if (this->GetParallelLevel() == kParallelLevelUnbounded &&
+          this->WorkerLocalCount >= this->ParallelLevelDefault) {
+        break;
+      }
+      ++this->WorkerLocalCount;
+    }
+    ti = this->WorkerQueuedTests.erase(ti);
+    this->StartTestProcess(test);
+  }
+}
+
 void cmCTestMultiProcessHandler::StartNextTests()
 {
   // One or more events may be scheduled to call this method again.
@@ -593,8 +649,16 @@ void cmCTestMultiProcessHandler::StartNextTests()
   this->StartNextTestsOnIdle_.stop();
   this->StartNextTestsOnTimer_.stop();
 
+  if (this->WorkerPool) {
+    this->StartWorkerTests();
+  }
+
   if (this->PendingTests.empty() || this->CheckStopTimePassed() ||
       (this->CheckStopOnFailure() && !this->Failed->empty())) {
+    if (this->WorkerPool && this->RunningCount == 0) {
+      // Nothing is left to run.  Let the workers exit.
+      this->WorkerPool->Shutdown();
+    }
     return;
   }
 
@@ -811,6 +875,15 @@ void cmCTestMultiProcessHandler::FinishTestProcess(
   this->DeallocateResources(test);
   this->UnlockResources(test);
 
+  auto worker = this->TestWorkers.find(test);
+  if (worker != this->TestWorkers.end()) {
+    this->WorkerPool->ReleaseSlots(worker->second.Worker,
+                                   worker->second.Slots);
+    this->TestWorkers.erase(worker);
+  } else if (this->WorkerPool) {
+    --this->WorkerLocalCount;
+  }
+
   runner.reset();
 
   if (this->JobServerClient) {
@@ -933,7 +1006,11 @@ int cmCTestMultiProcessHandler::SearchByName(cm::string_view name)
 void cmCTestMultiProcessHandler::CreateTestCostList()
 {
   if (this->GetParallelLevel() > 1) {
-    this->CreateParallelTestCostList();
+    if (this->CTest->GetScheduleType() == "CriticalPath") {
+      this->CreateCriticalPathTestCostList();
+    } else {
+      this->CreateParallelTestCostList();
+    }
   } else {
     this->CreateSerialTestCostList();
   }
@@ -997,6 +1074,134 @@ void cmCTestMultiProcessHandler::CreateParallelTestCostList()
   }
 }
 
+void cmCTestMultiProcessHandler::CreateCriticalPathTestCostList()
+{
+  // Tests without cost data are assumed to take the average time
+  // of the tests with cost data.
+  double knownCost = 0;
+  size_t knownCount = 0;
+  for (auto const& t : this->PendingTests) {
+    float const cost = this->Properties[t.first]->Cost;
+    if (cost > 0) {
+      knownCost += cost;
+      ++knownCount;
+    }
+  }
+  double const defaultCost =
+    knownCount > 0 ? knownCost / static_cast<double>(knownCount) : 1.0;
+
+  std::map<int, double> durations;
+  std::map<int, TestList> dependents;
+  std::map<int, size_t> unfinishedDependents;
+  for (auto const& t : this->PendingTests) {
+    float const cost = this->Properties[t.first]->Cost;
+    durations[t.first] = cost > 0 ? cost : defaultCost;
+    unfinishedDependents[t.first];
+    for (int dep : t.second.Depends) {
+      dependents[dep].push_back(t.first);
+      ++unfinishedDependents[dep];
+    }
+  }
+
+  // The critical path length of a test is its duration plus the longest
+  // critical path length of the tests that depend on it.  Visit tests
+  // after all their dependents, starting from those with none.  The
+  // dependency graph has no cycles at this point.
+  std::map<int, double> pathLengths;
+  std::vector<int> ready;
+  for (auto const& t : unfinishedDependents) {
+    if (t.second == 0) {
+      ready.push_back(t.first);
+    }
+  }
+  while (!ready.empty()) {
+    int const test = ready.back();
+    ready.pop_back();
+    double longest = 0;
+    for (int dependent : dependents[test]) {
+      longest = std::max(longest, pathLengths[dependent]);
+    }
+    pathLengths[test] = durations[test] + longest;
+    for (int dep : this->PendingTests[test].Depends) {
+      if (--unfinishedDependents[dep] == 0) {
+        ready.push_back(dep);
+      }
+    }
+  }
+
+  // As in other parallel runs, start tests that failed last time first.
+  TestList sortedTests;
+  for (auto const& t : this->PendingTests) {
+    if (cm::contains(this->LastTestsFailed, this->Properties[t.first]->Name)) {
+      this->OrderedTests.push_back(t.first);
+    } else {
+      sortedTests.push_back(t.first);
+    }
+  }
+  std::stable_sort(sortedTests.begin(), sortedTests.end(),
+                   TestComparator(this));
+  std::stable_sort(sortedTests.begin(), sortedTests.end(),
+                   [&pathLengths](int a, int b) {
+                     return pathLengths[a] > pathLengths[b];
+                   });
+  cm::append(this->OrderedTests, sortedTests);
+
+  this->PredictedMakespan = this->PredictMakespan(durations);
+}
+
+double cmCTestMultiProcessHandler::PredictMakespan(
+  std::map<int, double> const& durations)
+{
+  // Replay the scheduling done by StartNextTests with the estimated
+  // durations.  Resources and the test load are not considered.
+  using Finish = std::pair<double, int>;
+  std::priority_queue<Finish, std::vector<Finish>, std::greater<Finish>>
+    running;
+  std::map<int, size_t> unfinishedDepends;
+  std::map<int, TestList> dependents;
+  for (auto const& t : this->PendingTests) {
+    unfinishedDepends[t.first] = t.second.Depends.size();
+    for (int dep : t.second.Depends) {
+      dependents[dep].push_back(t.first);
+    }
+  }
+
+  std::list<int> pending = this->OrderedTests;
+  size_t const parallelLevel = this->GetParallelLevel();
+  size_t processorsUsed = 0;
+  bool serialRunning = false;
+  double now = 0;
+  for (;;) {
+    for (auto ti = pending.begin(); !serialRunning && ti != pending.end();) {
+      int const test = *ti;
+      size_t const processors = this->GetProcessorsUsed(test);
+      bool const runSerial = this->Properties[test]->RunSerial;
+      if (unfinishedDepends[test] > 0 ||
+          processors > parallelLevel - processorsUsed ||
+          (runSerial && !running.empty())) {
+        ++ti;
+        continue;
+      }
+      running.emplace(now + durations.at(test), test);
+      processorsUsed += processors;
+      serialRunning = runSerial;
+      ti = pending.erase(ti);
+    }
+    if (running.empty()) {
+      break;
+    }
+    Finish const finished = running.top();
+    running.pop();
+    now = finished.first;
+    processorsUsed -= this->GetProcessorsUsed(finished.second);
+    serialRunning = false;
+    for (int dependent : dependents[finished.second]) {
+      --unfinishedDepends[dependent];
+    }
+  }
+  return now;
+}
+
 void cmCTestMultiProcessHandler::GetAllTestDependencies(int test,
                                                         TestList& dependencies)
 {
@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <cm/optional>
@@ -24,6 +25,7 @@
 
 struct cmCTestBinPackerAllocation;
 class cmCTestRunTest;
+class cmCTestWorkerPool;
 
 /** \class cmCTestMultiProcessHandler
  * \brief run parallel ctest
@@ -97,6 +99,12 @@ public:
 
   void SetQuiet(bool b) { this->Quiet = b; }
 
+  // Run tests through worker processes started by the given commands.
+  void SetWorkers(std::vector<std::string> commands)
+  {
+    this->WorkerCommands = std::move(commands);
+  }
+
   void CheckResourceAvailability();
 
 protected:
@@ -120,6 +128,12 @@ protected:
 
   void CreateParallelTestCostList();
 
+  // Order tests by the length of the longest chain of dependent tests
+  // that cannot start before they finish.
+  void CreateCriticalPathTestCostList();
+  // Simulate running the ordered tests to estimate the total time.
+  double PredictMakespan(std::map<int, double> const& durations);
+
   // Removes the checkpoint file
   void MarkFinished();
   void FinishTestProcess(std::unique_ptr<cmCTestRunTest> runner, bool started);
@@ -181,6 +195,8 @@ private:
   TestMap PendingTests;
   // List of pending test indexes, ordered by cost.
   std::list<int> OrderedTests;
+  // Estimated time to run all tests in critical path order, if used.
+  cm::optional<double> PredictedMakespan;
   // Total number of tests we'll be running
   size_t Total = 0;
   // Number of tests that are complete
@@ -221,6 +237,23 @@ private:
   // Callback invoked when a token is received.
   void JobServerReceivedToken();
 
+  // Worker processes that run tests on behalf of this process.
+  // If there are any, each test must get free slots on a worker.
+  std::vector<std::string> WorkerCommands;
+  std::unique_ptr<cmCTestWorkerPool> WorkerPool;
+  // List of tests that are queued to run when a worker has free slots.
+  std::list<int> WorkerQueuedTests;
+  struct WorkerSlots
+  {
+    size_t Worker;
+    size_t Slots;
+  };
+  std::map<int, WorkerSlots> TestWorkers;
+  // Number of tests running locally because no worker was left.
+  size_t WorkerLocalCount = 0;
+  // Start queued tests on workers with free slots.
+  void StartWorkerTests();
+
   unsigned long TestLoad = 0;
   unsigned long FakeLoadForTesting = 0;
   cm::uv_loop_ptr Loop;
@@ -20,6 +20,7 @@
 #include "cmCTest.h"
 #include "cmCTestMemCheckHandler.h"
 #include "cmCTestMultiProcessHandler.h"
+#include "cmCTestWorkerPool.h"
 #include "cmDuration.h"
 #include "cmInstrumentation.h"
 #include "cmProcess.h"
@@ -888,6 +889,15 @@ bool cmCTestRunTest::ForkProcess()
   this->TestResult.Environment.erase(this->TestResult.Environment.length() -
                                      1);
 
+  // A test is given no worker once none is left.  It runs locally.
+  auto const w = this->MultiTestHandler.TestWorkers.find(this->Index);
+  if (w != this->MultiTestHandler.TestWorkers.end()) {
+    return this->TestProcess->StartRemoteProcess(
+      *this->MultiTestHandler.Loop, *this->MultiTestHandler.WorkerPool,
+      w->second.Worker,
+      cmTokenize(this->TestResult.Environment, '\n', cmTokenizerMode::New));
+  }
+
   return this->TestProcess->StartProcess(*this->MultiTestHandler.Loop,
                                          &this->TestProperties->Affinity);
 }
@@ -469,6 +469,8 @@ bool cmCTestTestHandler::ProcessOptions()
   this->SetTestsToRunInformation(this->TestOptions.TestsToRunInformation);
   if (this->TestOptions.ScheduleRandom) {
     this->CTest->SetScheduleType("Random");
+  } else if (this->TestOptions.ScheduleCriticalPath) {
+    this->CTest->SetScheduleType("CriticalPath");
   }
   if (auto repeat = this->Repeat) {
     cmsys::RegularExpression repeatRegex(
@@ -1301,6 +1303,7 @@ bool cmCTestTestHandler::ProcessDirectory(std::vector<std::string>& passed,
   auto parallel =
     cm::make_unique<cmCTestMultiProcessHandler>(this->CTest, this);
   parallel->SetParallelLevel(this->CTest->GetParallelLevel());
+  parallel->SetWorkers(this->TestOptions.Workers);
   if (this->RepeatMode != cmCTest::Repeat::Never) {
     parallel->SetRepeatMode(this->RepeatMode, this->RepeatCount);
   } else {
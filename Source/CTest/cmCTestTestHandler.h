@@ -32,6 +32,7 @@ struct cmCTestTestOptions
 {
   bool RerunFailed = false;
   bool ScheduleRandom = false;
+  bool ScheduleCriticalPath = false;
   bool StopOnFailure = false;
   bool UseUnion = false;
   cm::optional<unsigned int> ScheduleRandomSeed;
@@ -56,6 +57,8 @@ struct cmCTestTestOptions
   std::string ExcludeTestListFile;
   std::string ResourceSpecFile;
   std::string JUnitXMLFileName;
+
+  std::vector<std::string> Workers;
 };
 
 /** \class cmCTestTestHandler
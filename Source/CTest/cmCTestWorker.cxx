@@ -0,0 +1,452 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmCTestWorker.h"
+
+#include <iostream>
+#include <utility>
+
+#include <cm/memory>
+
+#include "cmsys/Process.h"
+#include "cmsys/SystemInformation.hxx"
+
+#include "cmGetPipes.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+#define CM_WORKER_BUF_SIZE 65536
+
+cmCTestWorkerConnection::cmCTestWorkerConnection(cm::uv_pipe_ptr reader,
+                                                 cm::uv_pipe_ptr writer,
+                                                 MessageCallback onMessage,
+                                                 CloseCallback onClose)
+  : Reader(std::move(reader))
+  , Writer(std::move(writer))
+  , OnMessage(std::move(onMessage))
+  , OnClose(std::move(onClose))
+{
+  this->OnWrite = std::make_shared<std::function<void(int)>>([this](int) {
+    // Writes to a stream complete in the order they were queued.
+    this->Output.pop_front();
+  });
+}
+
+cmCTestWorkerConnection::~cmCTestWorkerConnection() = default;
+
+int cmCTestWorkerConnection::Start()
+{
+  this->Reader->data = this;
+  return uv_read_start(this->Reader, &cmCTestWorkerConnection::OnAllocateCB,
+                       &cmCTestWorkerConnection::OnReadCB);
+}
+
+void cmCTestWorkerConnection::Send(std::vector<std::string> const& words,
+                                   cm::string_view payload)
+{
+  if (!this->Writer) {
+    return;
+  }
+  std::string msg;
+  for (std::string const& word : words) {
+    msg = cmStrCat(std::move(msg), word, ' ');
+  }
+  msg = cmStrCat(std::move(msg), payload.size(), '\n', payload);
+  this->Output.emplace_back(std::move(msg));
+
+  std::string const& data = this->Output.back();
+  uv_buf_t const buf = uv_buf_init(const_cast<char*>(data.data()),
+                                   static_cast<unsigned int>(data.size()));
+  int status = cm::uv_write(this->Writer, &buf, 1, this->OnWrite);
+  if (status != 0) {
+    // Drop further messages.  The reader notices when the other end
+    // goes away.
+    this->Output.pop_back();
+    this->Writer.reset();
+  }
+}
+
+void cmCTestWorkerConnection::StopReading()
+{
+  this->Reader.reset();
+}
+
+std::string cmCTestWorkerConnection::EncodeList(
+  std::vector<std::string> const& list)
+{
+  std::string payload;
+  for (std::string const& item : list) {
+    payload = cmStrCat(std::move(payload), item.size(), ':', item);
+  }
+  return payload;
+}
+
+bool cmCTestWorkerConnection::DecodeList(std::string const& payload,
+                                         std::vector<std::string>& list)
+{
+  std::string::size_type pos = 0;
+  while (pos < payload.size()) {
+    std::string::size_type colon = payload.find(':', pos);
+    unsigned long size;
+    if (colon == std::string::npos ||
+        !cmStrToULong(payload.substr(pos, colon - pos), &size) ||
+        size > payload.size() - colon - 1) {
+      return false;
+    }
+    list.emplace_back(payload, colon + 1, size);
+    pos = colon + 1 + size;
+  }
+  return true;
+}
+
+void cmCTestWorkerConnection::OnAllocateCB(uv_handle_t* handle,
+                                           size_t /*suggested_size*/,
+                                           uv_buf_t* buf)
+{
+  auto* self = static_cast<cmCTestWorkerConnection*>(handle->data);
+  if (self->Buf.size() != CM_WORKER_BUF_SIZE) {
+    self->Buf.resize(CM_WORKER_BUF_SIZE);
+  }
+  *buf =
+    uv_buf_init(self->Buf.data(), static_cast<unsigned int>(self->Buf.size()));
+}
+
+void cmCTestWorkerConnection::OnReadCB(uv_stream_t* stream, ssize_t nread,
+                                       uv_buf_t const* buf)
+{
+  auto* self = static_cast<cmCTestWorkerConnection*>(stream->data);
+  self->OnRead(nread, buf);
+}
+
+void cmCTestWorkerConnection::OnRead(ssize_t nread, uv_buf_t const* buf)
+{
+  if (nread > 0) {
+    this->Input.append(buf->base, static_cast<size_t>(nread));
+    if (!this->ParseMessages()) {
+      std::cerr << "Invalid message from ctest worker connection\n";
+      this->Close();
+    }
+    return;
+  }
+  if (nread < 0) {
+    // The other end closed the connection or went away.
+    this->Close();
+  }
+}
+
+bool cmCTestWorkerConnection::ParseMessages()
+{
+  std::string::size_type pos = 0;
+  for (;;) {
+    std::string::size_type nl = this->Input.find('\n', pos);
+    if (nl == std::string::npos) {
+      break;
+    }
+    Message msg;
+    msg.Words = cmTokenize(cm::string_view(this->Input).substr(pos, nl - pos),
+                           ' ', cmTokenizerMode::New);
+    unsigned long size;
+    if (msg.Words.size() < 2 || !cmStrToULong(msg.Words.back(), &size)) {
+      return false;
+    }
+    if (this->Input.size() - nl - 1 < size) {
+      // Wait for the rest of the payload.
+      break;
+    }
+    msg.Words.pop_back();
+    msg.Payload.assign(this->Input, nl + 1, size);
+    pos = nl + 1 + size;
+    this->OnMessage(msg);
+    if (!this->Reader) {
+      // The callback stopped reading.
+      return true;
+    }
+  }
+  this->Input.erase(0, pos);
+  return true;
+}
+
+void cmCTestWorkerConnection::Close()
+{
+  if (!this->Reader && !this->Writer) {
+    return;
+  }
+  this->Reader.reset();
+  this->Writer.reset();
+  this->OnClose();
+}
+
+struct cmCTestWorker::Test
+{
+  cmCTestWorker* Worker = nullptr;
+  int Id = 0;
+  cm::uv_process_ptr Process;
+  cm::uv_pipe_ptr Reader;
+  std::vector<char> Buf;
+  bool Exited = false;
+  bool ReadClosed = false;
+  int64_t ExitStatus = 0;
+  int TermSignal = 0;
+};
+
+int cmCTestWorker::Main(int argc, char const* const argv[])
+{
+  // Skip "ctest --test-worker".
+  cmsys::SystemInformation info;
+  info.RunCPUCheck();
+  unsigned long slots = info.GetNumberOfLogicalCPU();
+  for (int i = 2; i < argc; ++i) {
+    std::string arg = argv[i];
+    if ((arg == "-j" || arg == "--parallel") && i + 1 < argc) {
+      arg = argv[++i];
+    } else if (cmHasLiteralPrefix(arg, "-j")) {
+      arg = arg.substr(2);
+    } else {
+      std::cerr << "ctest --test-worker: unknown argument: " << arg << '\n';
+      return 1;
+    }
+    if (!cmStrToULong(arg, &slots) || slots == 0) {
+      std::cerr << "ctest --test-worker: invalid number of slots: " << arg
+                << '\n';
+      return 1;
+    }
+  }
+  if (slots == 0) {
+    slots = 1;
+  }
+
+  cmCTestWorker self(static_cast<size_t>(slots));
+  return self.Run();
+}
+
+cmCTestWorker::cmCTestWorker(size_t slots)
+  : Slots(slots)
+{
+}
+
+cmCTestWorker::~cmCTestWorker() = default;
+
+int cmCTestWorker::Run()
+{
+  this->Loop.init();
+
+  cm::uv_pipe_ptr reader;
+  cm::uv_pipe_ptr writer;
+  reader.init(*this->Loop, 0);
+  writer.init(*this->Loop, 0);
+  int status = uv_pipe_open(reader, 0);
+  if (status == 0) {
+    status = uv_pipe_open(writer, 1);
+  }
+  if (status != 0) {
+    std::cerr << "ctest --test-worker: error opening stdin and stdout: "
+              << uv_strerror(status) << '\n';
+    return 1;
+  }
+
+  this->Connection = cm::make_unique<cmCTestWorkerConnection>(
+    std::move(reader), std::move(writer),
+    [this](cmCTestWorkerConnection::Message const& msg) {
+      this->OnMessage(msg);
+    },
+    [this]() {
+      // The coordinator went away.  Nobody is left to report to.
+      this->Quit = true;
+      for (auto const& t : this->Tests) {
+        this->KillTest(t.first, 0);
+      }
+    });
+  this->Connection->Send({ "hello", std::to_string(this->Slots) });
+  status = this->Connection->Start();
+  if (status != 0) {
+    std::cerr << "ctest --test-worker: error reading stdin: "
+              << uv_strerror(status) << '\n';
+    return 1;
+  }
+
+  uv_run(this->Loop, UV_RUN_DEFAULT);
+
+  this->Tests.clear();
+  this->Connection.reset();
+  this->Loop.reset();
+  return 0;
+}
+
+void cmCTestWorker::OnMessage(cmCTestWorkerConnection::Message const& msg)
+{
+  std::vector<std::string> const& words = msg.Words;
+  long id;
+  long signal;
+  if (words[0] == "run" && words.size() == 2 && cmStrToLong(words[1], &id)) {
+    this->StartTest(static_cast<int>(id), msg.Payload);
+  } else if (words[0] == "kill" && words.size() == 3 &&
+             cmStrToLong(words[1], &id) && cmStrToLong(words[2], &signal)) {
+    this->KillTest(static_cast<int>(id), static_cast<int>(signal));
+  } else if (words[0] == "quit") {
+    this->Quit = true;
+    this->CheckQuit();
+  }
+}
+
+void cmCTestWorker::StartTest(int id, std::string const& payload)
+{
+  // The payload holds the working directory, the number of environment
+  // entries, the environment entries, and the command line.
+  std::vector<std::string> fields;
+  unsigned long envCount = 0;
+  if (!cmCTestWorkerConnection::DecodeList(payload, fields) ||
+      fields.size() < 2 || !cmStrToULong(fields[1], &envCount) ||
+      fields.size() < 3 + envCount) {
+    this->Connection->Send({ "error", std::to_string(id) },
+                           "Invalid request to run test");
+    return;
+  }
+  std::string const& directory = fields[0];
+  auto envBegin = fields.begin() + 2;
+  auto argBegin = envBegin + static_cast<std::ptrdiff_t>(envCount);
+
+  std::vector<char const*> args;
+  for (auto a = argBegin; a != fields.end(); ++a) {
+    args.push_back(a->c_str());
+  }
+  args.push_back(nullptr);
+
+  auto test = cm::make_unique<Test>();
+  test->Worker = this;
+  test->Id = id;
+
+  cm::uv_pipe_ptr pipe_writer;
+  pipe_writer.init(*this->Loop, 0);
+  test->Reader.init(*this->Loop, 0, test.get());
+
+  int fds[2] = { -1, -1 };
+  int status = cmGetPipes(fds);
+  if (status != 0) {
+    this->Connection->Send(
+      { "error", std::to_string(id) },
+      cmStrCat("Error initializing pipe: ", uv_strerror(status)));
+    return;
+  }
+  uv_pipe_open(test->Reader, fds[0]);
+  uv_pipe_open(pipe_writer, fds[1]);
+
+  // The worker's stdin carries requests from the coordinator.
+  uv_stdio_container_t stdio[3];
+  stdio[0].flags = UV_IGNORE;
+  stdio[1].flags = UV_INHERIT_STREAM;
+  stdio[1].data.stream = pipe_writer;
+  stdio[2] = stdio[1];
+
+  uv_process_options_t options = uv_process_options_t();
+  options.file = args[0];
+  options.args = const_cast<char**>(args.data());
+  options.cwd = directory.empty() ? nullptr : directory.c_str();
+  options.stdio_count = 3;
+  options.exit_cb = &cmCTestWorker::OnExitCB;
+  options.stdio = stdio;
+#if UV_VERSION_MAJOR > 1 || !defined(CMAKE_USE_SYSTEM_LIBUV)
+  options.flags = UV_PROCESS_WINDOWS_USE_PARENT_ERROR_MODE;
+#endif
+
+  status = uv_read_start(test->Reader, &cmCTestWorker::OnAllocateCB,
+                         &cmCTestWorker::OnReadCB);
+  if (status == 0) {
+    // Apply the changes the coordinator measured for this test on top of
+    // the environment of the worker.
+    cmSystemTools::SaveRestoreEnvironment sre;
+    cmSystemTools::EnvDiff diff;
+    for (auto e = envBegin; e != argBegin; ++e) {
+      if (cmHasLiteralPrefix(*e, "#")) {
+        diff.UnPutEnv(e->substr(1, e->find('=') - 1));
+      } else {
+        diff.PutEnv(*e);
+      }
+    }
+    diff.ApplyToCurrentEnv();
+    status = test->Process.spawn(*this->Loop, options, test.get());
+  }
+  if (status != 0) {
+    this->Connection->Send({ "error", std::to_string(id) },
+                           cmStrCat("Process not started\n ", args[0], "\n[",
+                                    uv_strerror(status), "]"));
+    return;
+  }
+
+  this->Tests[id] = std::move(test);
+}
+
+void cmCTestWorker::KillTest(int id, int signal)
+{
+  auto it = this->Tests.find(id);
+  if (it == this->Tests.end() || it->second->Exited) {
+    return;
+  }
+  Test* test = it->second.get();
+  if (signal != 0) {
+    uv_process_kill(test->Process, signal);
+  } else {
+    cmsysProcess_KillPID(static_cast<unsigned long>(test->Process->pid));
+  }
+}
+
+void cmCTestWorker::FinishTest(Test* test)
+{
+  int const id = test->Id;
+  this->Connection->Send({ "exit", std::to_string(id),
+                           std::to_string(test->ExitStatus),
+                           std::to_string(test->TermSignal) });
+  this->Tests.erase(id);
+  this->CheckQuit();
+}
+
+void cmCTestWorker::CheckQuit()
+{
+  if (this->Quit && this->Tests.empty()) {
+    // The loop ends once the remaining messages have been written.
+    this->Connection->StopReading();
+  }
+}
+
+void cmCTestWorker::OnExitCB(uv_process_t* process, int64_t exit_status,
+                             int term_signal)
+{
+  auto* test = static_cast<Test*>(process->data);
+  test->Exited = true;
+  test->ExitStatus = exit_status;
+  test->TermSignal = term_signal;
+  if (test->ReadClosed) {
+    test->Worker->FinishTest(test);
+  }
+}
+
+void cmCTestWorker::OnAllocateCB(uv_handle_t* handle,
+                                 size_t /*suggested_size*/, uv_buf_t* buf)
+{
+  auto* test = static_cast<Test*>(handle->data);
+  if (test->Buf.size() != CM_WORKER_BUF_SIZE) {
+    test->Buf.resize(CM_WORKER_BUF_SIZE);
+  }
+  *buf =
+    uv_buf_init(test->Buf.data(), static_cast<unsigned int>(test->Buf.size()));
+}
+
+void cmCTestWorker::OnReadCB(uv_stream_t* stream, ssize_t nread,
+                             uv_buf_t const* buf)
+{
+  auto* test = static_cast<Test*>(stream->data);
+  if (nread > 0) {
+    test->Worker->Connection->Send(
+      { "output", std::to_string(test->Id) },
+      cm::string_view(buf->base, static_cast<size_t>(nread)));
+    return;
+  }
+  if (nread == 0) {
+    return;
+  }
+
+  // The process will provide no more data.
+  test->ReadClosed = true;
+  test->Reader.reset();
+  if (test->Exited) {
+    test->Worker->FinishTest(test);
+  }
+}
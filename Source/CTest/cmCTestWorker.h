@@ -0,0 +1,136 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cm/string_view>
+
+#include <cm3p/uv.h>
+
+#include "cmUVHandlePtr.h"
+
+/** \class cmCTestWorkerConnection
+ * \brief Exchange messages with the other end of a ctest worker.
+ *
+ * A coordinator 'ctest' talks to each 'ctest --test-worker' process
+ * through a pair of pipes.  Every message is a line of words separated
+ * by spaces, the last of which is the size of a payload of raw bytes
+ * following the line.  The coordinator sends:
+ *
+ *   run <id> <size>      payload: directory, environment and command
+ *   kill <id> <signal> 0  signal 0 kills the process forcefully
+ *   quit 0               exit once all tests have finished
+ *
+ * and the worker replies:
+ *
+ *   hello <slots> 0      sent once, the number of tests it may run
+ *   output <id> <size>   payload: a chunk of test output
+ *   exit <id> <status> <signal> 0
+ *   error <id> <size>    payload: why the test could not be started
+ */
+class cmCTestWorkerConnection
+{
+public:
+  struct Message
+  {
+    std::vector<std::string> Words;
+    std::string Payload;
+  };
+
+  using MessageCallback = std::function<void(Message const&)>;
+  using CloseCallback = std::function<void()>;
+
+  cmCTestWorkerConnection(cm::uv_pipe_ptr reader, cm::uv_pipe_ptr writer,
+                          MessageCallback onMessage, CloseCallback onClose);
+  ~cmCTestWorkerConnection();
+
+  cmCTestWorkerConnection(cmCTestWorkerConnection const&) = delete;
+  cmCTestWorkerConnection& operator=(cmCTestWorkerConnection const&) = delete;
+
+  /** Start reading messages.  Returns a libuv status.  */
+  int Start();
+
+  /** Queue a message for the other end.  */
+  void Send(std::vector<std::string> const& words,
+            cm::string_view payload = cm::string_view());
+
+  /** Stop reading messages.  Pending writes still complete.  */
+  void StopReading();
+
+  /** Encode a list of strings as a message payload.  */
+  static std::string EncodeList(std::vector<std::string> const& list);
+  /** Decode a message payload encoded by EncodeList.  */
+  static bool DecodeList(std::string const& payload,
+                         std::vector<std::string>& list);
+
+private:
+  static void OnAllocateCB(uv_handle_t* handle, size_t suggested_size,
+                           uv_buf_t* buf);
+  static void OnReadCB(uv_stream_t* stream, ssize_t nread,
+                       uv_buf_t const* buf);
+  void OnRead(ssize_t nread, uv_buf_t const* buf);
+  bool ParseMessages();
+  void Close();
+
+  cm::uv_pipe_ptr Reader;
+  cm::uv_pipe_ptr Writer;
+  MessageCallback OnMessage;
+  CloseCallback OnClose;
+  std::vector<char> Buf;
+  std::string Input;
+  std::deque<std::string> Output;
+  std::shared_ptr<std::function<void(int)>> OnWrite;
+};
+
+/** \class cmCTestWorker
+ * \brief Run tests on behalf of a coordinator 'ctest' process.
+ *
+ * This implements the 'ctest --test-worker' tool.  It reads requests to
+ * run test commands from stdin and streams their output and exit status
+ * to stdout using the cmCTestWorkerConnection protocol.
+ */
+class cmCTestWorker
+{
+public:
+  /** Entry point from ctest executable main().  */
+  static int Main(int argc, char const* const argv[]);
+
+  cmCTestWorker(cmCTestWorker const&) = delete;
+  cmCTestWorker& operator=(cmCTestWorker const&) = delete;
+
+private:
+  struct Test;
+
+  cmCTestWorker(size_t slots);
+  ~cmCTestWorker();
+
+  int Run();
+  void OnMessage(cmCTestWorkerConnection::Message const& msg);
+  void StartTest(int id, std::string const& payload);
+  void KillTest(int id, int signal);
+  void FinishTest(Test* test);
+  void CheckQuit();
+
+  static void OnExitCB(uv_process_t* process, int64_t exit_status,
+                       int term_signal);
+  static void OnAllocateCB(uv_handle_t* handle, size_t suggested_size,
+                           uv_buf_t* buf);
+  static void OnReadCB(uv_stream_t* stream, ssize_t nread,
+                       uv_buf_t const* buf);
+
+  size_t Slots;
+  bool Quit = false;
+  cm::uv_loop_ptr Loop;
+  std::unique_ptr<cmCTestWorkerConnection> Connection;
+  std::map<int, std::unique_ptr<Test>> Tests;
+};
@@ -0,0 +1,300 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmCTestWorkerPool.h"
+
+#include <algorithm>
+#include <csignal>
+#include <cstdint>
+#include <utility>
+
+#include <cm/memory>
+#include <cmext/algorithm>
+
+#include "cmCTest.h"
+#include "cmCTestRunTest.h" // IWYU pragma: keep
+#include "cmCTestWorker.h"
+#include "cmProcess.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+// Time a worker has to announce its slots after it started.
+uint64_t const kHelloTimeoutSeconds = 30;
+}
+
+struct cmCTestWorkerPool::Worker
+{
+  cmCTestWorkerPool* Pool = nullptr;
+  size_t Index = 0;
+  std::string Command;
+  cm::uv_process_ptr Process;
+  cm::uv_timer_ptr HelloTimer;
+  std::unique_ptr<cmCTestWorkerConnection> Connection;
+  size_t Slots = 0;
+  size_t Free = 0;
+  bool Alive = false;
+  bool Exited = false;
+};
+
+cmCTestWorkerPool::cmCTestWorkerPool(cmCTest* ctest, uv_loop_t& loop,
+                                     std::function<void()> onSlots)
+  : CTest(ctest)
+  , Loop(loop)
+  , OnSlots(std::move(onSlots))
+{
+}
+
+cmCTestWorkerPool::~cmCTestWorkerPool() = default;
+
+void cmCTestWorkerPool::Start(std::vector<std::string> const& commands)
+{
+  for (std::string const& command : commands) {
+    size_t const index = this->Workers.size();
+    this->Workers.emplace_back(cm::make_unique<Worker>());
+    Worker& worker = *this->Workers.back();
+    worker.Pool = this;
+    worker.Index = index;
+    worker.Command = command;
+
+    std::vector<std::string> args = cmSystemTools::ParseArguments(command);
+    if (args.empty()) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Empty worker command" << std::endl);
+      continue;
+    }
+    std::vector<char const*> argv;
+    for (std::string const& arg : args) {
+      argv.push_back(arg.c_str());
+    }
+    argv.push_back(nullptr);
+
+    cm::uv_pipe_ptr reader;
+    cm::uv_pipe_ptr writer;
+    reader.init(this->Loop, 0);
+    writer.init(this->Loop, 0);
+
+    uv_stdio_container_t stdio[3];
+    stdio[0].flags =
+      static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_READABLE_PIPE);
+    stdio[0].data.stream = writer;
+    stdio[1].flags =
+      static_cast<uv_stdio_flags>(UV_CREATE_PIPE | UV_WRITABLE_PIPE);
+    stdio[1].data.stream = reader;
+    stdio[2].flags = UV_INHERIT_FD;
+    stdio[2].data.fd = 2;
+
+    uv_process_options_t options = uv_process_options_t();
+    options.file = argv[0];
+    options.args = const_cast<char**>(argv.data());
+    options.stdio_count = 3;
+    options.stdio = stdio;
+    options.exit_cb = &cmCTestWorkerPool::OnExitCB;
+
+    int status = worker.Process.spawn(this->Loop, options, &worker);
+    if (status != 0) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Worker not started\n " << command << "\n["
+                                         << uv_strerror(status) << "]\n");
+      continue;
+    }
+
+    worker.Connection = cm::make_unique<cmCTestWorkerConnection>(
+      std::move(reader), std::move(writer),
+      [this, index](cmCTestWorkerConnection::Message const& msg) {
+        this->OnMessage(index, msg.Words, msg.Payload);
+      },
+      [this, index]() { this->OnClose(index); });
+    status = worker.Connection->Start();
+    if (status != 0) {
+      cmCTestLog(this->CTest, ERROR_MESSAGE,
+                 "Error reading from worker\n " << command << "\n["
+                                                << uv_strerror(status)
+                                                << "]\n");
+      worker.Connection.reset();
+      continue;
+    }
+    worker.Alive = true;
+
+    worker.HelloTimer.init(this->Loop, &worker);
+    worker.HelloTimer.start(&cmCTestWorkerPool::OnHelloTimeoutCB,
+                            kHelloTimeoutSeconds * 1000, 0);
+  }
+}
+
+bool cmCTestWorkerPool::HasWorkers() const
+{
+  return std::any_of(this->Workers.begin(), this->Workers.end(),
+                     [](std::unique_ptr<Worker> const& w) -> bool {
+                       return w->Alive;
+                     });
+}
+
+cm::optional<size_t> cmCTestWorkerPool::AcquireSlots(size_t& slots)
+{
+  cm::optional<size_t> best;
+  for (size_t i = 0; i < this->Workers.size(); ++i) {
+    Worker const& w = *this->Workers[i];
+    if (!w.Alive || w.Slots == 0 || w.Free < std::min(slots, w.Slots)) {
+      continue;
+    }
+    if (!best || this->Workers[*best]->Free < w.Free) {
+      best = i;
+    }
+  }
+  if (best) {
+    Worker& w = *this->Workers[*best];
+    slots = std::min(slots, w.Slots);
+    w.Free -= slots;
+  }
+  return best;
+}
+
+void cmCTestWorkerPool::ReleaseSlots(size_t worker, size_t slots)
+{
+  Worker& w = *this->Workers[worker];
+  if (w.Alive) {
+    w.Free += slots;
+  }
+}
+
+bool cmCTestWorkerPool::Run(size_t worker, cmProcess* process, int id,
+                            std::vector<std::string> const& command,
+                            std::string const& directory,
+                            std::vector<std::string> const& environment)
+{
+  Worker& w = *this->Workers[worker];
+  if (!w.Alive) {
+    return false;
+  }
+
+  std::vector<std::string> fields;
+  fields.reserve(2 + environment.size() + command.size());
+  fields.push_back(directory);
+  fields.push_back(std::to_string(environment.size()));
+  cm::append(fields, environment);
+  cm::append(fields, command);
+
+  this->Tests[id] = RemoteTest{ worker, process };
+  w.Connection->Send({ "run", std::to_string(id) },
+                     cmCTestWorkerConnection::EncodeList(fields));
+  return true;
+}
+
+void cmCTestWorkerPool::Kill(int id, int signal)
+{
+  auto it = this->Tests.find(id);
+  if (it != this->Tests.end()) {
+    this->Workers[it->second.Worker]->Connection->Send(
+      { "kill", std::to_string(id), std::to_string(signal) });
+  }
+}
+
+void cmCTestWorkerPool::Shutdown()
+{
+  for (auto const& w : this->Workers) {
+    if (w->Alive) {
+      w->Alive = false;
+      w->Connection->Send({ "quit" });
+    }
+  }
+}
+
+void cmCTestWorkerPool::OnMessage(size_t worker,
+                                  std::vector<std::string> const& words,
+                                  std::string const& payload)
+{
+  Worker& w = *this->Workers[worker];
+  std::string const& type = words[0];
+  unsigned long slots;
+  long id;
+  if (type == "hello" && words.size() == 2 &&
+      cmStrToULong(words[1], &slots)) {
+    if (w.Alive && w.Slots == 0) {
+      w.HelloTimer.stop();
+      w.Slots = w.Free = slots;
+      this->OnSlots();
+    }
+    return;
+  }
+  if (words.size() < 2 || !cmStrToLong(words[1], &id)) {
+    return;
+  }
+  auto it = this->Tests.find(static_cast<int>(id));
+  if (it == this->Tests.end() || it->second.Worker != worker) {
+    return;
+  }
+  cmProcess* process = it->second.Process;
+  long long status;
+  long signal;
+  if (type == "output") {
+    process->OnRemoteOutput(payload);
+  } else if (type == "exit" && words.size() == 4 &&
+             cmStrToLongLong(words[2], &status) &&
+             cmStrToLong(words[3], &signal)) {
+    // Forget the test first.  Finishing it may run it again.
+    this->Tests.erase(it);
+    process->OnRemoteExit(status, static_cast<int>(signal));
+  } else if (type == "error") {
+    this->Tests.erase(it);
+    process->OnRemoteError(payload);
+  }
+}
+
+void cmCTestWorkerPool::OnClose(size_t worker)
+{
+  this->Drop(worker, "Lost connection to worker");
+}
+
+void cmCTestWorkerPool::Drop(size_t worker, std::string const& reason)
+{
+  Worker& w = *this->Workers[worker];
+  bool const wasAlive = w.Alive;
+  if (wasAlive) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               reason << "\n " << w.Command << std::endl);
+  }
+  w.Alive = false;
+  w.Slots = w.Free = 0;
+  w.HelloTimer.stop();
+
+  std::vector<cmProcess*> lost;
+  for (auto it = this->Tests.begin(); it != this->Tests.end();) {
+    if (it->second.Worker == worker) {
+      lost.push_back(it->second.Process);
+      it = this->Tests.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  for (cmProcess* process : lost) {
+    process->OnRemoteError(cmStrCat(reason, "\n ", w.Command));
+  }
+  if (wasAlive && !this->HasWorkers()) {
+    cmCTestLog(this->CTest, ERROR_MESSAGE,
+               "No worker is left.  Running the remaining tests locally."
+                 << std::endl);
+  }
+  this->OnSlots();
+}
+
+void cmCTestWorkerPool::OnExitCB(uv_process_t* process, int64_t exit_status,
+                                 int term_signal)
+{
+  auto* w = static_cast<Worker*>(process->data);
+  w->Exited = true;
+  std::string reason = term_signal
+    ? cmStrCat("Worker terminated by signal ", term_signal)
+    : cmStrCat("Worker exited with code ", exit_status);
+  w->Pool->Drop(w->Index, reason);
+}
+
+void cmCTestWorkerPool::OnHelloTimeoutCB(uv_timer_t* timer)
+{
+  auto* w = static_cast<Worker*>(timer->data);
+  if (!w->Exited) {
+    uv_process_kill(w->Process, SIGTERM);
+  }
+  w->Pool->Drop(w->Index,
+                cmStrCat("Worker did not announce its slots within ",
+                         kHelloTimeoutSeconds, " seconds"));
+}
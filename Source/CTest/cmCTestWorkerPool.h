@@ -0,0 +1,100 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <cm/optional>
+
+#include <cm3p/uv.h>
+
+#include "cmUVHandlePtr.h"
+
+class cmCTest;
+class cmCTestWorkerConnection;
+class cmProcess;
+
+/** \class cmCTestWorkerPool
+ * \brief Run test processes through 'ctest --test-worker' processes.
+ *
+ * Each worker is started by a command line given with the ctest
+ * '--worker' option, such as 'ctest --test-worker -j8' or a remote shell
+ * running it on another host.  The worker announces how many tests it may
+ * run at a time.  The coordinator keeps scheduling tests itself, so test
+ * dependencies, fixtures, resource allocation and cost data work as in
+ * a local run, and hands each test it starts to a worker with enough
+ * free slots.  The worker streams the output and exit status of the test
+ * back to the cmProcess that represents it in the coordinator.
+ *
+ * A worker that exits, closes its connection, or does not announce its
+ * slots in time is dropped.  Its tests fail, and once no worker is left
+ * the coordinator runs the remaining tests locally.
+ */
+class cmCTestWorkerPool
+{
+public:
+  /** The \a onSlots callback is invoked when a worker announces its slots
+      or is dropped.  */
+  cmCTestWorkerPool(cmCTest* ctest, uv_loop_t& loop,
+                    std::function<void()> onSlots);
+  ~cmCTestWorkerPool();
+
+  cmCTestWorkerPool(cmCTestWorkerPool const&) = delete;
+  cmCTestWorkerPool& operator=(cmCTestWorkerPool const&) = delete;
+
+  /** Start a worker process for each command line.  */
+  void Start(std::vector<std::string> const& commands);
+
+  /** Return whether any worker may still run tests.  A worker that has
+      not announced its slots yet counts until it is dropped.  */
+  bool HasWorkers() const;
+
+  /** Reserve slots for a test on the worker with the most free slots.
+      The number of slots is capped at the size of the worker.  Returns
+      the worker, or nothing if no worker currently has room.  */
+  cm::optional<size_t> AcquireSlots(size_t& slots);
+  void ReleaseSlots(size_t worker, size_t slots);
+
+  /** Run a test process on a worker.  The worker reports to \a process
+      through its OnRemote* methods.  */
+  bool Run(size_t worker, cmProcess* process, int id,
+           std::vector<std::string> const& command,
+           std::string const& directory,
+           std::vector<std::string> const& environment);
+
+  /** Send a signal to a test process, or kill it if \a signal is 0.  */
+  void Kill(int id, int signal);
+
+  /** Ask the workers to exit.  */
+  void Shutdown();
+
+private:
+  struct Worker;
+  struct RemoteTest
+  {
+    size_t Worker;
+    cmProcess* Process;
+  };
+
+  void OnMessage(size_t worker, std::vector<std::string> const& words,
+                 std::string const& payload);
+  void OnClose(size_t worker);
+  void Drop(size_t worker, std::string const& reason);
+
+  static void OnExitCB(uv_process_t* process, int64_t exit_status,
+                       int term_signal);
+  static void OnHelloTimeoutCB(uv_timer_t* timer);
+
+  cmCTest* CTest;
+  uv_loop_t& Loop;
+  std::function<void()> OnSlots;
+  std::vector<std::unique_ptr<Worker>> Workers;
+  std::map<int, RemoteTest> Tests;
+};
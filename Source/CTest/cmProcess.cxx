@@ -15,6 +15,7 @@
 #include "cmCTest.h"
 #include "cmCTestRunTest.h"
 #include "cmCTestTestHandler.h"
+#include "cmCTestWorkerPool.h"
 #include "cmGetPipes.h"
 #include "cmStringAlgorithms.h"
 #if defined(_WIN32)
@@ -156,6 +157,83 @@ bool cmProcess::StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity)
   return true;
 }
 
+bool cmProcess::StartRemoteProcess(
+  uv_loop_t& loop, cmCTestWorkerPool& workers, size_t worker,
+  std::vector<std::string> const& environment)
+{
+  this->ProcessState = cmProcess::State::Error;
+  if (this->Command.empty()) {
+    return false;
+  }
+  this->StartTime = std::chrono::steady_clock::now();
+  this->SystemStartTime = std::chrono::system_clock::now();
+
+  cm::uv_timer_ptr timer;
+  int status = timer.init(loop, this);
+  if (status != 0) {
+    cmCTestLog(this->Runner->GetCTest(), ERROR_MESSAGE,
+               "Error initializing timer: " << uv_strerror(status)
+                                            << std::endl);
+    return false;
+  }
+
+  std::vector<std::string> command;
+  command.reserve(this->Arguments.size() + 1);
+  command.push_back(this->Command);
+  cm::append(command, this->Arguments);
+  if (!workers.Run(worker, this, this->Id, command, this->WorkingDirectory,
+                   environment)) {
+    cmCTestLog(this->Runner->GetCTest(), ERROR_MESSAGE,
+               "Process not started\n " << this->Command
+                                        << "\n[worker not available]\n");
+    return false;
+  }
+
+  this->Workers = &workers;
+  this->Timer = std::move(timer);
+
+  this->StartTimer();
+
+  this->ProcessState = cmProcess::State::Executing;
+  return true;
+}
+
+void cmProcess::OnRemoteOutput(std::string const& data)
+{
+  // Drop output arriving after a forced timeout, as for a local process.
+  if (this->ReadHandleClosed) {
+    return;
+  }
+  uv_buf_t const buf = uv_buf_init(const_cast<char*>(data.data()),
+                                   static_cast<unsigned int>(data.size()));
+  this->OnRead(static_cast<ssize_t>(data.size()), &buf);
+}
+
+void cmProcess::OnRemoteExit(int64_t exit_status, int term_signal)
+{
+  // The worker sends all output before the exit status.
+  if (!this->ReadHandleClosed) {
+    uv_buf_t const buf = uv_buf_init(nullptr, 0);
+    this->OnRead(UV_EOF, &buf);
+  }
+  this->OnExit(exit_status, term_signal);
+}
+
+void cmProcess::OnRemoteError(std::string const& message)
+{
+  cmCTestLog(this->Runner->GetCTest(), ERROR_MESSAGE, message << std::endl);
+  this->Runner->CheckOutput(message);
+
+  // Report the test as not run, or timed out if it was being killed.
+  if (this->ProcessState == cmProcess::State::Executing) {
+    this->ProcessState = cmProcess::State::Error;
+  }
+  this->ReadHandleClosed = true;
+  this->ProcessHandleClosed = true;
+  uv_timer_stop(this->Timer);
+  this->Finish();
+}
+
 void cmProcess::StartTimer()
 {
   if (this->Timeout) {
@@ -292,7 +370,11 @@ void cmProcess::OnTimeout()
       this->Runner->GetTestProperties();
     if (p->TimeoutSignal) {
       this->TerminationStyle = Termination::Custom;
-      uv_process_kill(this->Process, p->TimeoutSignal->Number);
+      if (this->Workers) {
+        this->Workers->Kill(this->Id, p->TimeoutSignal->Number);
+      } else {
+        uv_process_kill(this->Process, p->TimeoutSignal->Number);
+      }
       if (p->TimeoutGracePeriod) {
         this->Timeout = *p->TimeoutGracePeriod;
       } else {
@@ -312,7 +394,11 @@ void cmProcess::OnTimeout()
   }
   if (!this->ProcessHandleClosed) {
     // Kill the child and let our on-exit handler finish the test.
-    cmsysProcess_KillPID(static_cast<unsigned long>(this->Process->pid));
+    if (this->Workers) {
+      this->Workers->Kill(this->Id, 0);
+    } else {
+      cmsysProcess_KillPID(static_cast<unsigned long>(this->Process->pid));
+    }
   } else if (was_still_reading) {
     // Our on-exit handler already ran but did not finish the test
     // because we were still reading output.  We've just dropped
@@ -21,6 +21,7 @@
 #include "cmUVHandlePtr.h"
 
 class cmCTestRunTest;
+class cmCTestWorkerPool;
 
 /** \class cmProcess
  * \brief run a process with c++
@@ -40,6 +41,16 @@ public:
   void ResetStartTime();
   // Return true if the process starts
   bool StartProcess(uv_loop_t& loop, std::vector<size_t>* affinity);
+  // Return true if the process starts on the given worker of the pool.
+  // The environment lists the changes to make for the test.
+  bool StartRemoteProcess(uv_loop_t& loop, cmCTestWorkerPool& workers,
+                          size_t worker,
+                          std::vector<std::string> const& environment);
+
+  // Events reported by the worker pool for a remote process.
+  void OnRemoteOutput(std::string const& data);
+  void OnRemoteExit(int64_t exit_status, int term_signal);
+  void OnRemoteError(std::string const& message);
 
   enum class TimeoutReason
   {
@@ -114,6 +125,7 @@ private:
   cm::uv_pipe_ptr PipeReader;
   cm::uv_timer_ptr Timer;
   std::vector<char> Buf;
+  cmCTestWorkerPool* Workers = nullptr;
 
   std::unique_ptr<cmCTestRunTest> Runner;
   cmProcessOutput Conv;
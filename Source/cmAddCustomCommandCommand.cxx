@@ -57,6 +57,7 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
   bool depends_explicit_only =
     mf.IsOn("CMAKE_ADD_CUSTOM_COMMAND_DEPENDS_EXPLICIT_ONLY");
   bool codegen = false;
+  bool cache = false;
   std::string implicit_depends_lang;
   cmImplicitDependsList implicit_depends;
 
@@ -95,6 +96,7 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
   MAKE_STATIC_KEYWORD(APPEND);
   MAKE_STATIC_KEYWORD(ARGS);
   MAKE_STATIC_KEYWORD(BYPRODUCTS);
+  MAKE_STATIC_KEYWORD(CACHE);
   MAKE_STATIC_KEYWORD(COMMAND);
   MAKE_STATIC_KEYWORD(COMMAND_EXPAND_LISTS);
   MAKE_STATIC_KEYWORD(COMMENT);
@@ -121,6 +123,7 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
     keyAPPEND,
     keyARGS,
     keyBYPRODUCTS,
+    keyCACHE,
     keyCOMMAND,
     keyCOMMAND_EXPAND_LISTS,
     keyCOMMENT,
@@ -163,6 +166,7 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
     keyAPPEND,
     keyARGS,
     keyBYPRODUCTS,
+    keyCACHE,
     keyCODEGEN,
     keyCOMMAND,
     keyCOMMAND_EXPAND_LISTS,
@@ -246,6 +250,8 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
         depends_explicit_only = true;
       } else if (copy == keyCODEGEN) {
         codegen = true;
+      } else if (copy == keyCACHE) {
+        cache = true;
       } else if (copy == keyTARGET) {
         doing = doing_target;
         keywordExpectingValue = &keyTARGET;
@@ -448,6 +454,28 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
     }
   }
 
+  if (cache) {
+    if (output.empty()) {
+      status.SetError("CACHE requires at least 1 OUTPUT.");
+      return false;
+    }
+
+    if (append) {
+      status.SetError("CACHE may not be used with APPEND.");
+      return false;
+    }
+
+    if (!depfile.empty()) {
+      status.SetError("CACHE is not compatible with DEPFILE.");
+      return false;
+    }
+
+    if (!implicit_depends.empty()) {
+      status.SetError("CACHE is not compatible with IMPLICIT_DEPENDS.");
+      return false;
+    }
+  }
+
   // Check for an append request.
   if (append) {
     std::vector<std::string> unsupportedKeywordsUsed;
@@ -586,6 +614,7 @@ bool cmAddCustomCommandCommand(std::vector<std::string> const& args,
     cc->SetMainDependency(main_dependency);
     cc->SetDepends(depends);
     cc->SetCodegen(codegen);
+    cc->SetCache(cache);
     cc->SetImplicitDepends(implicit_depends);
     mf.AddCustomCommandToOutput(std::move(cc));
   } else {
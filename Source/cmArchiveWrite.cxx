@@ -2,16 +2,19 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmArchiveWrite.h"
 
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <ctime>
 #include <iostream>
 #include <limits>
+#include <mutex>
 #include <sstream>
 #include <string>
 #include <thread>
 
 #include <cm/algorithm>
+#include <cm/memory>
 
 #include <cm3p/archive.h>
 #include <cm3p/archive_entry.h>
@@ -63,6 +66,152 @@ public:
   operator struct archive_entry *() { return this->Object; }
 };
 
+/** Read the content of files on multiple threads ahead of adding them to
+    the archive.  The files are read in the order they will be added, and
+    at most a fixed number of bytes is buffered at any time.  */
+class cmArchiveWrite::Prefetcher
+{
+public:
+  Prefetcher(std::vector<std::string> const& paths, int numThreads);
+  ~Prefetcher();
+
+  Prefetcher(Prefetcher const&) = delete;
+  Prefetcher& operator=(Prefetcher const&) = delete;
+
+  /** Wait for the content of the given file if it is the next one
+      announced.  Returns nullptr if the file has not been read ahead,
+      e.g. because it is not a regular file or too large.  The content
+      remains valid until the next call.  */
+  std::string const* Get(std::string const& path);
+
+private:
+  struct File
+  {
+    std::string Path;
+    std::string FullPath;
+    std::string Content;
+    size_t Size = 0;
+    bool Done = false;
+    bool Read = false;
+  };
+
+  void Release(File& file);
+  void Work();
+
+  static size_t const MaxBytes = 64 << 20;
+
+  std::vector<File> Files;
+  size_t Cursor = 0;
+
+  std::mutex Mutex;
+  std::condition_variable Changed;
+  size_t Next = 0;
+  size_t Bytes = 0;
+  bool Stop = false;
+  std::vector<std::thread> Workers;
+};
+
+cmArchiveWrite::Prefetcher::Prefetcher(std::vector<std::string> const& paths,
+                                       int numThreads)
+{
+  // The workers may outlive a change of the working directory.
+  this->Files.resize(paths.size());
+  for (size_t i = 0; i < paths.size(); ++i) {
+    this->Files[i].Path = paths[i];
+    this->Files[i].FullPath = cmSystemTools::CollapseFullPath(paths[i]);
+  }
+  for (int i = 0; i < numThreads; ++i) {
+    this->Workers.emplace_back(&Prefetcher::Work, this);
+  }
+}
+
+cmArchiveWrite::Prefetcher::~Prefetcher()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    this->Stop = true;
+  }
+  this->Changed.notify_all();
+  for (std::thread& worker : this->Workers) {
+    worker.join();
+  }
+}
+
+std::string const* cmArchiveWrite::Prefetcher::Get(std::string const& path)
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  if (this->Cursor > 0) {
+    this->Release(this->Files[this->Cursor - 1]);
+  }
+  if (this->Cursor == this->Files.size() ||
+      this->Files[this->Cursor].Path != path) {
+    return nullptr;
+  }
+  File& file = this->Files[this->Cursor++];
+  // The worker reading this file may be waiting for buffer space.
+  this->Changed.notify_all();
+  this->Changed.wait(lock, [&file] { return file.Done; });
+  return file.Read ? &file.Content : nullptr;
+}
+
+void cmArchiveWrite::Prefetcher::Release(File& file)
+{
+  if (file.Read) {
+    this->Bytes -= file.Size;
+    file.Read = false;
+    std::string().swap(file.Content);
+    this->Changed.notify_all();
+  }
+}
+
+void cmArchiveWrite::Prefetcher::Work()
+{
+  std::unique_lock<std::mutex> lock(this->Mutex);
+  while (!this->Stop && this->Next < this->Files.size()) {
+    size_t const index = this->Next++;
+    File& file = this->Files[index];
+    lock.unlock();
+
+    unsigned long size = 0;
+    if (!cmSystemTools::FileIsSymlink(file.FullPath) &&
+        cmSystemTools::FileExists(file.FullPath, true)) {
+      size = cmSystemTools::FileLength(file.FullPath);
+    }
+
+    lock.lock();
+    if (size > 0 && size <= MaxBytes) {
+      // The file added next is read even if the buffer is full.
+      this->Changed.wait(lock, [this, index, size] {
+        return this->Stop || index + 1 == this->Cursor ||
+          this->Bytes + size <= MaxBytes;
+      });
+      if (this->Stop) {
+        break;
+      }
+      this->Bytes += size;
+      lock.unlock();
+
+      file.Content.resize(size);
+      cmsys::ifstream fin(file.FullPath.c_str(),
+                          std::ios::in | std::ios::binary);
+      bool const read = fin &&
+        fin.read(&file.Content[0], static_cast<std::streamsize>(size)) &&
+        static_cast<unsigned long>(fin.gcount()) == size;
+
+      lock.lock();
+      if (read) {
+        file.Size = size;
+        file.Read = true;
+      } else {
+        this->Bytes -= size;
+        std::string().swap(file.Content);
+      }
+    }
+    file.Done = true;
+    this->Changed.notify_all();
+  }
+}
+
 struct cmArchiveWrite::Callback
 {
   // archive_write_callback
@@ -96,6 +245,7 @@ cmArchiveWrite::cmArchiveWrite(std::ostream& os, Compress c,
     numThreads =
       cm::clamp<int>(std::thread::hardware_concurrency(), 1, upperLimit);
   }
+  this->NumThreads = numThreads;
 
   std::string sNumThreads = std::to_string(numThreads);
 
@@ -280,6 +430,14 @@ bool cmArchiveWrite::Add(std::string path, size_t skip, char const* prefix,
   return this->Okay();
 }
 
+void cmArchiveWrite::PrefetchFiles(std::vector<std::string> const& paths)
+{
+  this->Prefetch.reset();
+  if (this->NumThreads > 1 && !paths.empty()) {
+    this->Prefetch = cm::make_unique<Prefetcher>(paths, this->NumThreads);
+  }
+}
+
 bool cmArchiveWrite::AddPath(char const* path, size_t skip, char const* prefix,
                              bool recursive)
 {
@@ -318,6 +476,9 @@ bool cmArchiveWrite::AddPath(char const* path, size_t skip, char const* prefix,
 bool cmArchiveWrite::AddFile(char const* file, size_t skip, char const* prefix)
 {
   this->Error = "";
+  std::string const* content =
+    this->Prefetch ? this->Prefetch->Get(file) : nullptr;
+
   // Skip the file if we have no name for it.  This may happen on a
   // top-level directory, which does not need to be included anyway.
   if (skip >= strlen(file)) {
@@ -411,6 +572,9 @@ bool cmArchiveWrite::AddFile(char const* file, size_t skip, char const* prefix)
   if (!archive_entry_symlink(e)) {
     // Content.
     if (size_t size = static_cast<size_t>(archive_entry_size(e))) {
+      if (content && content->size() == size) {
+        return this->AddData(*content);
+      }
       return this->AddData(file, size);
     }
   }
@@ -453,3 +617,15 @@ bool cmArchiveWrite::AddData(char const* file, size_t size)
   }
   return true;
 }
+
+bool cmArchiveWrite::AddData(std::string const& content)
+{
+  auto const size = static_cast<__LA_SSIZE_T>(content.size());
+  if (archive_write_data(this->Archive, content.data(), content.size()) !=
+      size) {
+    this->Error = cmStrCat("archive_write_data: ",
+                           cm_archive_error_string(this->Archive));
+    return false;
+  }
+  return true;
+}
@@ -6,7 +6,9 @@
 
 #include <cstddef>
 #include <iosfwd>
+#include <memory>
 #include <string>
+#include <vector>
 
 #if defined(CMAKE_BOOTSTRAP)
 #  error "cmArchiveWrite not allowed during bootstrap build!"
@@ -75,6 +77,13 @@ public:
   bool Add(std::string path, size_t skip = 0, char const* prefix = nullptr,
            bool recursive = true);
 
+  /**
+   * Announce the paths that will be passed to Add next, in this order.
+   * If the archive is written with more than one thread, the content of
+   * these files is read on worker threads ahead of adding them.
+   */
+  void PrefetchFiles(std::vector<std::string> const& paths);
+
   /** Returns true if there has been no error.  */
   explicit operator bool() const { return this->Okay(); }
 
@@ -147,15 +156,19 @@ private:
                bool recursive = true);
   bool AddFile(char const* file, size_t skip, char const* prefix);
   bool AddData(char const* file, size_t size);
+  bool AddData(std::string const& content);
 
   struct Callback;
   friend struct Callback;
 
   class Entry;
+  class Prefetcher;
 
   std::ostream& Stream;
   struct archive* Archive;
   struct archive* Disk;
+  std::unique_ptr<Prefetcher> Prefetch;
+  int NumThreads = 1;
   bool Verbose = false;
   std::string Format;
   std::string Error;
@@ -2490,6 +2490,16 @@ int cmCTest::Run(std::vector<std::string> const& args)
         }
         return true;
       } },
+    CommandArgument{ "--schedule-critical-path", CommandArgument::Values::Zero,
+                     [this](std::string const&) -> bool {
+                       this->Impl->TestOptions.ScheduleCriticalPath = true;
+                       return true;
+                     } },
+    CommandArgument{ "--worker", CommandArgument::Values::One,
+                     [this](std::string const& command) -> bool {
+                       this->Impl->TestOptions.Workers.push_back(command);
+                       return true;
+                     } },
     CommandArgument{ "--rerun-failed", CommandArgument::Values::Zero,
                      [this](std::string const&) -> bool {
                        this->Impl->TestOptions.RerunFailed = true;
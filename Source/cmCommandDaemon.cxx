@@ -0,0 +1,780 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmCommandDaemon.h"
+
+#include <iostream>
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+#  include <algorithm>
+#  include <cerrno>
+#  include <chrono>
+#  include <csignal>
+#  include <cstddef>
+#  include <cstdlib>
+#  include <cstring>
+#  include <map>
+#  include <utility>
+
+#  include <fcntl.h>
+#  include <poll.h>
+#  include <unistd.h>
+
+#  include <sys/resource.h>
+#  include <sys/socket.h>
+#  include <sys/stat.h>
+#  include <sys/types.h>
+#  include <sys/uio.h>
+#  include <sys/un.h>
+#  include <sys/wait.h>
+
+#  include "cmStdIoStream.h"
+#  include "cmStringAlgorithms.h"
+#  include "cmSystemTools.h"
+#endif
+
+#if defined(_WIN32) || defined(__CYGWIN__)
+
+int cmCommandDaemon::Serve(Options const& /*options*/,
+                           Executor const& /*execute*/)
+{
+  std::cerr << "cmake -E daemon is not supported on this platform.\n";
+  return 1;
+}
+
+#else
+
+namespace {
+
+// Limits on the size of a request, to reject garbage early.
+std::uint32_t const MaxStrings = 1 << 16;
+std::uint32_t const MaxStringSize = 1 << 24;
+std::size_t const MaxRequestSize = std::size_t(1) << 26;
+
+// Time a client has to send its whole request.  A client that stalls
+// must not hold up the others.
+std::chrono::seconds const RequestTimeout(10);
+
+int SignalPipe[2] = { -1, -1 };
+
+extern "C" void cmCommandDaemonSignal(int sig)
+{
+  int const savedErrno = errno;
+  char const c = static_cast<char>(sig);
+  static_cast<void>(!write(SignalPipe[1], &c, 1));
+  errno = savedErrno;
+}
+
+int const HandledSignals[] = { SIGCHLD, SIGTERM, SIGINT, SIGHUP };
+
+void SetSignalHandlers(void (*handler)(int))
+{
+  struct sigaction sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = handler;
+  sigemptyset(&sa.sa_mask);
+  for (int sig : HandledSignals) {
+    sigaction(sig, &sa, nullptr);
+  }
+  sa.sa_handler = handler == SIG_DFL ? SIG_DFL : SIG_IGN;
+  sigaction(SIGPIPE, &sa, nullptr);
+}
+
+void SetCloseOnExec(int fd)
+{
+  fcntl(fd, F_SETFD, fcntl(fd, F_GETFD) | FD_CLOEXEC);
+}
+
+bool WriteFully(int fd, void const* data, std::size_t size)
+{
+  char const* p = static_cast<char const*>(data);
+  while (size > 0) {
+    ssize_t const n = write(fd, p, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    p += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+void SendCode(int fd, std::int32_t code)
+{
+  WriteFully(fd, &code, sizeof(code));
+}
+
+bool PeerIsSameUser(int fd)
+{
+#  if defined(__linux__)
+  struct ucred cred;
+  socklen_t len = sizeof(cred);
+  return getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == 0 &&
+    cred.uid == geteuid();
+#  elif defined(__APPLE__) || defined(__FreeBSD__) || defined(__NetBSD__) ||  \
+    defined(__OpenBSD__) || defined(__DragonFly__)
+  uid_t uid;
+  gid_t gid;
+  return getpeereid(fd, &uid, &gid) == 0 && uid == geteuid();
+#  else
+  // Rely on the permissions of the socket, which only its owner may use.
+  static_cast<void>(fd);
+  return true;
+#  endif
+}
+
+struct Request
+{
+  cmCommandDaemon::Header Header;
+  std::string CMake;
+  std::string WorkDir;
+  std::vector<std::string> Args;
+  std::vector<std::string> Env;
+  int Fds[3] = { -1, -1, -1 };
+
+  void CloseFds()
+  {
+    for (int& fd : this->Fds) {
+      if (fd >= 0) {
+        close(fd);
+        fd = -1;
+      }
+    }
+  }
+};
+
+// A connection whose request has not arrived completely.
+struct Connection
+{
+  int Fd = -1;
+  std::chrono::steady_clock::time_point Deadline;
+  std::string Data;
+  Request Req;
+};
+
+// Reads what is available on the non-blocking connection, and takes the
+// descriptors sent with it.  Returns false if the connection closed.
+bool ReceiveSome(Connection& conn)
+{
+  char buffer[1 << 16];
+  struct iovec iov;
+  iov.iov_base = buffer;
+  iov.iov_len = sizeof(buffer);
+  union
+  {
+    struct cmsghdr Align;
+    char Buffer[CMSG_SPACE(3 * sizeof(int))];
+  } control;
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.Buffer;
+  msg.msg_controllen = sizeof(control.Buffer);
+
+  ssize_t n;
+  do {
+    n = recvmsg(conn.Fd, &msg, 0);
+  } while (n < 0 && errno == EINTR);
+  if (n < 0) {
+    return errno == EAGAIN || errno == EWOULDBLOCK;
+  }
+
+  for (struct cmsghdr* c = CMSG_FIRSTHDR(&msg); c; c = CMSG_NXTHDR(&msg, c)) {
+    if (c->cmsg_level != SOL_SOCKET || c->cmsg_type != SCM_RIGHTS) {
+      continue;
+    }
+    std::size_t const count = (c->cmsg_len - CMSG_LEN(0)) / sizeof(int);
+    for (std::size_t i = 0; i < count; ++i) {
+      int received;
+      std::memcpy(&received, CMSG_DATA(c) + i * sizeof(int), sizeof(int));
+      if (i < 3 && conn.Req.Fds[i] < 0) {
+        SetCloseOnExec(received);
+        conn.Req.Fds[i] = received;
+      } else {
+        close(received);
+      }
+    }
+  }
+
+  if (n == 0 || conn.Data.size() + static_cast<std::size_t>(n) >
+        MaxRequestSize) {
+    return false;
+  }
+  conn.Data.append(buffer, static_cast<std::size_t>(n));
+  return true;
+}
+
+enum class Parse
+{
+  Incomplete,
+  Invalid,
+  Refused,
+  Complete,
+};
+
+// Decodes the request from the bytes received so far.
+Parse ParseRequest(std::string const& data, Request& req)
+{
+  cmCommandDaemon::Header& header = req.Header;
+  std::size_t const versionEnd = 2 * sizeof(std::uint32_t);
+  if (data.size() < versionEnd) {
+    return Parse::Incomplete;
+  }
+  std::memcpy(&header, data.data(), versionEnd);
+  if (header.Tag != cmCommandDaemon::Magic) {
+    return Parse::Invalid;
+  }
+  if (header.ProtocolVersion != cmCommandDaemon::Version) {
+    return Parse::Refused;
+  }
+  if (data.size() < sizeof(header)) {
+    return Parse::Incomplete;
+  }
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.ArgCount == 0 || header.ArgCount > MaxStrings ||
+      header.EnvCount > MaxStrings) {
+    return Parse::Invalid;
+  }
+
+  std::size_t pos = sizeof(header);
+  auto next = [&data, &pos](std::string& s) -> Parse {
+    std::uint32_t size;
+    if (data.size() - pos < sizeof(size)) {
+      return Parse::Incomplete;
+    }
+    std::memcpy(&size, data.data() + pos, sizeof(size));
+    pos += sizeof(size);
+    if (size > MaxStringSize) {
+      return Parse::Invalid;
+    }
+    if (data.size() - pos < size) {
+      return Parse::Incomplete;
+    }
+    s.assign(data, pos, size);
+    pos += size;
+    return Parse::Complete;
+  };
+
+  req.Args.resize(header.ArgCount);
+  req.Env.resize(header.EnvCount);
+  std::vector<std::string*> strings = { &req.CMake, &req.WorkDir };
+  for (std::string& arg : req.Args) {
+    strings.push_back(&arg);
+  }
+  for (std::string& var : req.Env) {
+    strings.push_back(&var);
+  }
+  for (std::string* s : strings) {
+    Parse const result = next(*s);
+    if (result != Parse::Complete) {
+      return result;
+    }
+  }
+
+  // The client sends its descriptors with the header, and nothing after
+  // the strings.
+  if (pos != data.size() || req.Fds[0] < 0 || req.Fds[1] < 0 ||
+      req.Fds[2] < 0) {
+    return Parse::Invalid;
+  }
+  return Parse::Complete;
+}
+
+// Whether the child can take the resource limits of the client.  It may
+// lower its hard limits, but not raise them.
+bool CanApplyLimits(cmCommandDaemon::Header const& header)
+{
+  for (std::size_t i = 0; i < cmCommandDaemon::LimitCount; ++i) {
+    struct rlimit limit;
+    if (getrlimit(cmCommandDaemon::LimitResource(i), &limit) != 0) {
+      return false;
+    }
+    std::uint64_t const hard = header.Limits[i][1];
+    if (header.Limits[i][0] > hard ||
+        (limit.rlim_max != RLIM_INFINITY &&
+         hard > static_cast<std::uint64_t>(limit.rlim_max))) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool ApplyLimits(cmCommandDaemon::Header const& header)
+{
+  auto toLimit = [](std::uint64_t value) -> rlim_t {
+    return value == cmCommandDaemon::NoLimit ? RLIM_INFINITY
+                                             : static_cast<rlim_t>(value);
+  };
+  for (std::size_t i = 0; i < cmCommandDaemon::LimitCount; ++i) {
+    struct rlimit limit;
+    limit.rlim_cur = toLimit(header.Limits[i][0]);
+    limit.rlim_max = toLimit(header.Limits[i][1]);
+    if (setrlimit(cmCommandDaemon::LimitResource(i), &limit) != 0) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Give the signals the dispositions and mask of the client.  The signals
+// it does not ignore get their default action.
+void ApplySignals(cmCommandDaemon::Header const& header)
+{
+  struct sigaction sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sigemptyset(&sa.sa_mask);
+  sigset_t blocked;
+  sigemptyset(&blocked);
+  for (int sig = 1; sig <= 64; ++sig) {
+    std::uint64_t const bit = std::uint64_t(1) << (sig - 1);
+    if (sig != SIGKILL && sig != SIGSTOP) {
+      sa.sa_handler = (header.IgnoredSignals & bit) ? SIG_IGN : SIG_DFL;
+      sigaction(sig, &sa, nullptr);
+    }
+    if (header.BlockedSignals & bit) {
+      sigaddset(&blocked, sig);
+    }
+  }
+  sigprocmask(SIG_SETMASK, &blocked, nullptr);
+}
+
+class Daemon
+{
+public:
+  Daemon(cmCommandDaemon::Options const& options,
+         cmCommandDaemon::Executor const& execute)
+    : Options(options)
+    , Execute(execute)
+  {
+  }
+
+  int Run();
+
+private:
+  cmCommandDaemon::Options const& Options;
+  cmCommandDaemon::Executor const& Execute;
+  std::string CMake;
+  int Listener = -1;
+  // Connection of the client waiting for each running child, or -1 if
+  // the client went away.
+  std::map<pid_t, int> Running;
+  // Connections still sending their request.
+  std::vector<Connection> Connecting;
+
+  bool Listen();
+  void Accept();
+  void Receive(Connection& conn);
+  void Dispatch(int fd, Request& req);
+  void DropStalled();
+  void RemoveClosed();
+  void Reap();
+  void Shutdown();
+  [[noreturn]] void RunChild(int fd, Request& req);
+};
+
+bool Daemon::Listen()
+{
+  std::string const& path = this->Options.SocketPath;
+  struct sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.empty() || path.size() >= sizeof(addr.sun_path)) {
+    std::cerr << "cmake -E daemon: socket path is empty or too long:\n  "
+              << path << '\n';
+    return false;
+  }
+  std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+  auto* sa = reinterpret_cast<struct sockaddr*>(&addr);
+
+  struct stat st;
+  if (lstat(path.c_str(), &st) == 0) {
+    if (!S_ISSOCK(st.st_mode)) {
+      std::cerr << "cmake -E daemon: path exists and is not a socket:\n  "
+                << path << '\n';
+      return false;
+    }
+    // Refuse to take over the socket of a daemon that is still running.
+    int const probe = socket(AF_UNIX, SOCK_STREAM, 0);
+    bool const alive = probe >= 0 && connect(probe, sa, sizeof(addr)) == 0;
+    if (probe >= 0) {
+      close(probe);
+    }
+    if (alive) {
+      std::cerr << "cmake -E daemon: another daemon is listening on:\n  "
+                << path << '\n';
+      return false;
+    }
+    unlink(path.c_str());
+  }
+
+  this->Listener = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (this->Listener < 0) {
+    std::cerr << "cmake -E daemon: socket: " << std::strerror(errno) << '\n';
+    return false;
+  }
+  SetCloseOnExec(this->Listener);
+  mode_t const mask = umask(077);
+  int const bound = bind(this->Listener, sa, sizeof(addr));
+  int const bindErrno = errno;
+  umask(mask);
+  if (bound != 0 || listen(this->Listener, 128) != 0) {
+    std::cerr << "cmake -E daemon: cannot listen on:\n  " << path << "\n"
+              << std::strerror(bound != 0 ? bindErrno : errno) << '\n';
+    return false;
+  }
+  return true;
+}
+
+int Daemon::Run()
+{
+  this->CMake = cmSystemTools::GetRealPath(cmSystemTools::GetCMakeCommand());
+  if (!this->Listen()) {
+    if (this->Listener >= 0) {
+      close(this->Listener);
+    }
+    return 1;
+  }
+  if (pipe(SignalPipe) != 0) {
+    std::cerr << "cmake -E daemon: pipe: " << std::strerror(errno) << '\n';
+    close(this->Listener);
+    unlink(this->Options.SocketPath.c_str());
+    return 1;
+  }
+  SetCloseOnExec(SignalPipe[0]);
+  SetCloseOnExec(SignalPipe[1]);
+  fcntl(SignalPipe[1], F_SETFL, fcntl(SignalPipe[1], F_GETFL) | O_NONBLOCK);
+  SetSignalHandlers(cmCommandDaemonSignal);
+
+  if (this->Options.Verbose) {
+    std::cerr << "cmake -E daemon: listening on " << this->Options.SocketPath
+              << std::endl;
+  }
+
+  bool terminate = false;
+  std::vector<struct pollfd> fds;
+  while (!terminate) {
+    this->DropStalled();
+    fds.clear();
+    fds.push_back({ this->Listener, POLLIN, 0 });
+    fds.push_back({ SignalPipe[0], POLLIN, 0 });
+    for (auto const& r : this->Running) {
+      if (r.second >= 0) {
+        // The client sends nothing after its request, so any event
+        // means it went away.
+        fds.push_back({ r.second, POLLIN, 0 });
+      }
+    }
+    std::size_t const firstConnecting = fds.size();
+    for (Connection const& conn : this->Connecting) {
+      fds.push_back({ conn.Fd, POLLIN, 0 });
+    }
+    bool const idle = this->Running.empty() && this->Connecting.empty();
+    int timeout = idle && this->Options.IdleTimeout > 0
+      ? static_cast<int>(this->Options.IdleTimeout) * 1000
+      : -1;
+    if (!this->Connecting.empty()) {
+      // Wake up for the first connection to stall.
+      auto deadline = this->Connecting.front().Deadline;
+      for (Connection const& conn : this->Connecting) {
+        deadline = std::min(deadline, conn.Deadline);
+      }
+      auto const wait = std::chrono::duration_cast<std::chrono::milliseconds>(
+        deadline - std::chrono::steady_clock::now());
+      timeout = static_cast<int>(std::max<long long>(wait.count() + 1, 0));
+    }
+
+    int const n = poll(fds.data(), fds.size(), timeout);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::cerr << "cmake -E daemon: poll: " << std::strerror(errno) << '\n';
+      break;
+    }
+    if (n == 0) {
+      if (!idle) {
+        continue;
+      }
+      if (this->Options.Verbose) {
+        std::cerr << "cmake -E daemon: idle timeout reached" << std::endl;
+      }
+      break;
+    }
+
+    if (fds[1].revents) {
+      char signals[64];
+      ssize_t const count = read(SignalPipe[0], signals, sizeof(signals));
+      for (ssize_t i = 0; i < count; ++i) {
+        if (signals[i] == SIGCHLD) {
+          this->Reap();
+        } else {
+          terminate = true;
+        }
+      }
+    }
+    for (std::size_t i = 2; i < firstConnecting; ++i) {
+      if (!fds[i].revents) {
+        continue;
+      }
+      // The client went away.  Terminate the command together with any
+      // processes it started.
+      for (auto& r : this->Running) {
+        if (r.second == fds[i].fd) {
+          kill(-r.first, SIGTERM);
+          close(r.second);
+          r.second = -1;
+        }
+      }
+    }
+    if (terminate) {
+      break;
+    }
+    for (std::size_t i = 0; i < this->Connecting.size(); ++i) {
+      if (fds[firstConnecting + i].revents) {
+        this->Receive(this->Connecting[i]);
+      }
+    }
+    this->RemoveClosed();
+    if (fds[0].revents) {
+      this->Accept();
+    }
+  }
+
+  for (Connection& conn : this->Connecting) {
+    conn.Req.CloseFds();
+    close(conn.Fd);
+  }
+  this->Connecting.clear();
+
+  this->Shutdown();
+  return 0;
+}
+
+void Daemon::Accept()
+{
+  int const fd = accept(this->Listener, nullptr, nullptr);
+  if (fd < 0) {
+    return;
+  }
+  SetCloseOnExec(fd);
+  if (!PeerIsSameUser(fd)) {
+    close(fd);
+    return;
+  }
+  fcntl(fd, F_SETFL, fcntl(fd, F_GETFL) | O_NONBLOCK);
+
+  Connection conn;
+  conn.Fd = fd;
+  conn.Deadline = std::chrono::steady_clock::now() + RequestTimeout;
+  this->Connecting.push_back(std::move(conn));
+}
+
+void Daemon::Receive(Connection& conn)
+{
+  Parse result = Parse::Invalid;
+  if (ReceiveSome(conn)) {
+    result = ParseRequest(conn.Data, conn.Req);
+  }
+  switch (result) {
+    case Parse::Incomplete:
+      return;
+    case Parse::Complete: {
+      // Dispatching forks a child, which must not see the connection.
+      int const fd = conn.Fd;
+      Request req = std::move(conn.Req);
+      conn.Fd = -1;
+      conn.Req = Request();
+      this->Dispatch(fd, req);
+      return;
+    }
+    case Parse::Refused:
+      SendCode(conn.Fd, cmCommandDaemon::RefuseCode);
+      CM_FALLTHROUGH;
+    case Parse::Invalid:
+      conn.Req.CloseFds();
+      close(conn.Fd);
+      break;
+  }
+  conn.Fd = -1;
+}
+
+void Daemon::DropStalled()
+{
+  auto const now = std::chrono::steady_clock::now();
+  for (Connection& conn : this->Connecting) {
+    if (conn.Deadline <= now) {
+      // Should the client still be listening, it runs the command itself.
+      SendCode(conn.Fd, cmCommandDaemon::RefuseCode);
+      conn.Req.CloseFds();
+      close(conn.Fd);
+      conn.Fd = -1;
+    }
+  }
+  this->RemoveClosed();
+}
+
+void Daemon::RemoveClosed()
+{
+  this->Connecting.erase(
+    std::remove_if(this->Connecting.begin(), this->Connecting.end(),
+                   [](Connection const& conn) { return conn.Fd < 0; }),
+    this->Connecting.end());
+}
+
+void Daemon::Dispatch(int fd, Request& req)
+{
+  // A client built for another cmake, asking to nest a daemon, or with
+  // resource limits the daemon cannot give its child, runs the command
+  // itself.
+  if (req.Args[0] == "daemon" ||
+      cmSystemTools::GetRealPath(req.CMake) != this->CMake ||
+      !CanApplyLimits(req.Header)) {
+    SendCode(fd, cmCommandDaemon::RefuseCode);
+    req.CloseFds();
+    close(fd);
+    return;
+  }
+
+  if (this->Options.Verbose) {
+    std::cerr << "cmake -E daemon: " << req.WorkDir << ": "
+              << cmJoin(req.Args, " ") << std::endl;
+  }
+
+  std::cout.flush();
+  std::cerr.flush();
+  pid_t const pid = fork();
+  if (pid == 0) {
+    this->RunChild(fd, req);
+  }
+  req.CloseFds();
+  if (pid < 0) {
+    SendCode(fd, cmCommandDaemon::RefuseCode);
+    close(fd);
+    return;
+  }
+  // The child does this as well.  Whichever runs first makes sure the
+  // group exists before it is signaled.
+  setpgid(pid, pid);
+  this->Running[pid] = fd;
+}
+
+void Daemon::RunChild(int fd, Request& req)
+{
+  setpgid(0, 0);
+  SetSignalHandlers(SIG_DFL);
+  close(this->Listener);
+  close(SignalPipe[0]);
+  close(SignalPipe[1]);
+  close(fd);
+  for (auto const& r : this->Running) {
+    if (r.second >= 0) {
+      close(r.second);
+    }
+  }
+  for (Connection& conn : this->Connecting) {
+    if (conn.Fd >= 0) {
+      conn.Req.CloseFds();
+      close(conn.Fd);
+    }
+  }
+
+  for (int i = 0; i < 3; ++i) {
+    dup2(req.Fds[i], i);
+  }
+  for (int received : req.Fds) {
+    if (received > 2) {
+      close(received);
+    }
+  }
+  cm::StdIo::In().DetectKind();
+  cm::StdIo::Out().DetectKind();
+  cm::StdIo::Err().DetectKind();
+
+  for (std::string const& var : cmSystemTools::GetEnvironmentVariables()) {
+    std::string::size_type const eq = var.find('=', 1);
+    if (eq != std::string::npos) {
+      cmSystemTools::UnsetEnv(var.substr(0, eq).c_str());
+    }
+  }
+  for (std::string const& var : req.Env) {
+    cmSystemTools::PutEnv(var);
+  }
+
+  umask(static_cast<mode_t>(req.Header.Umask));
+
+  int ret = 1;
+  if (chdir(req.WorkDir.c_str()) != 0) {
+    std::cerr << "cmake -E daemon: cannot change directory to:\n  "
+              << req.WorkDir << '\n';
+  } else if (!ApplyLimits(req.Header)) {
+    std::cerr << "cmake -E daemon: cannot set the resource limits: "
+              << std::strerror(errno) << '\n';
+  } else {
+    ApplySignals(req.Header);
+    std::vector<std::string> args;
+    args.reserve(req.Args.size() + 1);
+    args.emplace_back(cmSystemTools::GetCMakeCommand());
+    for (std::string& arg : req.Args) {
+      args.emplace_back(std::move(arg));
+    }
+    ret = this->Execute(args);
+  }
+  std::cout.flush();
+  std::cerr.flush();
+  std::exit(ret);
+}
+
+void Daemon::Reap()
+{
+  int status;
+  pid_t pid;
+  while ((pid = waitpid(-1, &status, WNOHANG)) > 0) {
+    auto const i = this->Running.find(pid);
+    if (i == this->Running.end()) {
+      continue;
+    }
+    if (i->second >= 0) {
+      std::int32_t const code = WIFSIGNALED(status)
+        ? cmCommandDaemon::SignalCode - WTERMSIG(status)
+        : WEXITSTATUS(status);
+      SendCode(i->second, code);
+      close(i->second);
+    }
+    this->Running.erase(i);
+  }
+}
+
+void Daemon::Shutdown()
+{
+  SetSignalHandlers(SIG_DFL);
+  for (auto const& r : this->Running) {
+    kill(-r.first, SIGTERM);
+  }
+  for (auto const& r : this->Running) {
+    int status;
+    while (waitpid(r.first, &status, 0) < 0 && errno == EINTR) {
+    }
+    if (r.second >= 0) {
+      close(r.second);
+    }
+  }
+  this->Running.clear();
+  close(this->Listener);
+  unlink(this->Options.SocketPath.c_str());
+  close(SignalPipe[0]);
+  close(SignalPipe[1]);
+  SignalPipe[0] = SignalPipe[1] = -1;
+}
+
+} // anonymous namespace
+
+int cmCommandDaemon::Serve(Options const& options, Executor const& execute)
+{
+  Daemon daemon(options, execute);
+  return daemon.Run();
+}
+
+#endif
@@ -0,0 +1,104 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+#  include <sys/resource.h>
+#endif
+
+/** \class cmCommandDaemon
+ * \brief Run "cmake -E" commands on behalf of short-lived clients.
+ *
+ * Build systems run "cmake -E" commands many times, and each one pays
+ * for starting a cmake process.  The daemon is a long-lived cmake
+ * process listening on a local socket.  The cmake-daemon-client tool
+ * sends it the command line, working directory, environment, and
+ * standard streams of each command.  The daemon forks a child that
+ * takes them over and runs the command in a process group of its own,
+ * and reports its exit code or terminating signal back.
+ * The child also takes the file mode creation mask, signal mask, ignored
+ * signals, and resource limits of the client.
+ *
+ * Only clients running as the same user are served.  The daemon is
+ * available on POSIX platforms only.
+ */
+class cmCommandDaemon
+{
+public:
+  using Executor = std::function<int(std::vector<std::string> const& args)>;
+
+  struct Options
+  {
+    std::string SocketPath;
+    // Exit after this many seconds without a request, or never if 0.
+    unsigned int IdleTimeout = 0;
+    // Report each request on stderr.
+    bool Verbose = false;
+  };
+
+  /** Serve requests until terminated or idle.  Each request is run by
+      'execute' in a forked child process, with the arguments that follow
+      "-E" preceded by the path to cmake.  Returns the exit code of the
+      daemon itself.  */
+  static int Serve(Options const& options, Executor const& execute);
+
+  // -- Protocol shared with the client.
+  //
+  // A request starts with a header, sent together with the client's
+  // stdin, stdout, and stderr descriptors.  It is followed by the
+  // strings it counts, each as a 32-bit length and its bytes: the path
+  // of the cmake the client would run, the working directory, the
+  // arguments that follow "-E", and the environment.  The daemon
+  // replies with a 32-bit exit code, SignalCode minus the number of the
+  // signal that terminated the command, or RefuseCode if the client
+  // should run the command itself.  It refuses requests of another
+  // version.
+
+  enum : std::uint32_t
+  {
+    Magic = 0x444b4d43, // "CMKD" in little-endian byte order
+    Version = 3,
+    LimitCount = 7,
+  };
+  enum : std::int32_t
+  {
+    RefuseCode = -1,
+    SignalCode = -256,
+  };
+
+  struct Header
+  {
+    std::uint32_t Tag;
+    std::uint32_t ProtocolVersion;
+    std::uint32_t ArgCount;
+    std::uint32_t EnvCount;
+    std::uint32_t Umask;
+    std::uint32_t Reserved;
+    // Bit n-1 is set for each signal n the client blocks, or ignores.
+    std::uint64_t BlockedSignals;
+    std::uint64_t IgnoredSignals;
+    // The soft and hard limit of each LimitResource(), or NoLimit.
+    std::uint64_t Limits[LimitCount][2];
+  };
+
+#if !defined(_WIN32) && !defined(__CYGWIN__)
+  static std::uint64_t const NoLimit = ~std::uint64_t(0);
+
+  static int LimitResource(std::size_t i)
+  {
+    static int const resources[LimitCount] = {
+      RLIMIT_AS,    RLIMIT_CORE,   RLIMIT_CPU,   RLIMIT_DATA,
+      RLIMIT_FSIZE, RLIMIT_NOFILE, RLIMIT_STACK,
+    };
+    return resources[i];
+  }
+#endif
+};
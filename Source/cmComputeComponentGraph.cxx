@@ -117,6 +117,37 @@ void cmComputeComponentGraph::TarjanVisit(size_t i)
   }
 }
 
+void cmComputeComponentGraph::VisitReachableComponents(
+  std::function<void(size_t, cmGraphNodeSet const&)> const& visit) const
+{
+  // Count the edges into each component.  Its set is no longer needed
+  // after the last of them has been followed.
+  size_t n = this->ComponentGraph.size();
+  std::vector<size_t> pending(n, 0);
+  for (EdgeList const& edges : this->ComponentGraph) {
+    for (cmGraphEdge const& edge : edges) {
+      ++pending[edge];
+    }
+  }
+
+  // Components are numbered after all components they reach, so the
+  // sets of the successors are complete when a component is visited.
+  std::vector<cmGraphNodeSet> reachable(n);
+  for (size_t c = 0; c < n; ++c) {
+    reachable[c].Insert(c);
+    for (cmGraphEdge const& edge : this->ComponentGraph[c]) {
+      reachable[c].Merge(reachable[edge]);
+      if (--pending[edge] == 0) {
+        reachable[edge].Clear();
+      }
+    }
+    visit(c, reachable[c]);
+    if (pending[c] == 0) {
+      reachable[c].Clear();
+    }
+  }
+}
+
 void cmComputeComponentGraph::TransferEdges()
 {
   // Map inter-component edges in the original graph to edges in the
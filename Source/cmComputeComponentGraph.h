@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstddef>
+#include <functional>
 #include <stack>
 #include <vector>
 
@@ -54,6 +55,14 @@ public:
     return this->TarjanComponents;
   }
 
+  /** Call a function with each component and the set of components
+      reachable from it, including itself.  A component is visited after
+      all components it reaches.  The set of a component is released
+      once every component with an edge to it has been visited, so only
+      the sets still needed are held at the same time.  */
+  void VisitReachableComponents(
+    std::function<void(size_t, cmGraphNodeSet const&)> const& visit) const;
+
   static size_t const INVALID_COMPONENT;
 
 private:
@@ -125,7 +125,7 @@ bool cmComputeTargetDepends::Compute()
   }
 
   // Compute the intermediate graph.
-  this->CollectSideEffects();
+  this->CollectSideEffects(ccg1);
   this->ComputeIntermediateGraph();
   if (this->DebugMode) {
     this->DisplaySideEffects();
@@ -401,37 +401,44 @@ void cmComputeTargetDepends::AddTargetDepend(
   }
 }
 
-void cmComputeTargetDepends::CollectSideEffects()
+void cmComputeTargetDepends::CollectSideEffects(
+  cmComputeComponentGraph const& ccg)
 {
+  // Every target of a component reaches the same targets, so compute
+  // the side effects once per component.  Components are numbered
+  // after all components they depend on, so the side effects of the
+  // dependees are complete when a component is visited.
+  std::vector<NodeList> const& components = ccg.GetComponents();
   this->SideEffects.resize(0);
-  this->SideEffects.resize(this->InitialGraph.size());
-
-  size_t n = this->InitialGraph.size();
-  std::set<size_t> visited;
-  for (size_t i = 0; i < n; ++i) {
-    this->CollectSideEffectsForTarget(visited, i);
-  }
-}
+  this->SideEffects.resize(components.size());
+  this->SideEffectsComponent = ccg.GetComponentMap();
+
+  for (size_t c = 0; c < components.size(); ++c) {
+    auto& se = this->SideEffects[c];
+    for (size_t depender_index : components[c]) {
+      std::set<cmGeneratorTarget const*> customCommandSideEffects;
+      std::map<std::string, std::set<cmGeneratorTarget const*>>
+        languageSideEffects;
+      this->Targets[depender_index]->AppendCustomCommandSideEffects(
+        customCommandSideEffects);
+      this->Targets[depender_index]->AppendLanguageSideEffects(
+        languageSideEffects);
+      for (cmGeneratorTarget const* gt : customCommandSideEffects) {
+        se.CustomCommandSideEffects.Insert(this->TargetIndex[gt]);
+      }
+      for (auto const& it : languageSideEffects) {
+        auto& lse = se.LanguageSideEffects[it.first];
+        for (cmGeneratorTarget const* gt : it.second) {
+          lse.Insert(this->TargetIndex[gt]);
+        }
+      }
+    }
 
-void cmComputeTargetDepends::CollectSideEffectsForTarget(
-  std::set<size_t>& visited, size_t depender_index)
-{
-  if (!visited.count(depender_index)) {
-    auto& se = this->SideEffects[depender_index];
-    visited.insert(depender_index);
-    this->Targets[depender_index]->AppendCustomCommandSideEffects(
-      se.CustomCommandSideEffects);
-    this->Targets[depender_index]->AppendLanguageSideEffects(
-      se.LanguageSideEffects);
-
-    for (auto const& edge : this->InitialGraph[depender_index]) {
-      this->CollectSideEffectsForTarget(visited, edge);
+    for (cmGraphEdge const& edge : ccg.GetComponentGraphEdges(c)) {
       auto const& dse = this->SideEffects[edge];
-      se.CustomCommandSideEffects.insert(dse.CustomCommandSideEffects.cbegin(),
-                                         dse.CustomCommandSideEffects.cend());
+      se.CustomCommandSideEffects.Merge(dse.CustomCommandSideEffects);
       for (auto const& it : dse.LanguageSideEffects) {
-        se.LanguageSideEffects[it.first].insert(it.second.cbegin(),
-                                                it.second.cend());
+        se.LanguageSideEffects[it.first].Merge(it.second);
       }
     }
   }
@@ -454,7 +461,7 @@ void cmComputeTargetDepends::ComputeIntermediateGraph()
       if (cmValue optimizeDependencies =
             gt->GetProperty("OPTIMIZE_DEPENDENCIES")) {
         if (optimizeDependencies.IsOn()) {
-          this->OptimizeLinkDependencies(gt, intermediateEdges, initialEdges);
+          this->OptimizeLinkDependencies(i, intermediateEdges, initialEdges);
         } else {
           intermediateEdges = initialEdges;
         }
@@ -466,40 +473,36 @@ void cmComputeTargetDepends::ComputeIntermediateGraph()
 }
 
 void cmComputeTargetDepends::OptimizeLinkDependencies(
-  cmGeneratorTarget const* gt, cmGraphEdgeList& outputEdges,
+  size_t depender_index, cmGraphEdgeList& outputEdges,
   cmGraphEdgeList const& inputEdges)
 {
-  std::set<size_t> emitted;
+  cmGeneratorTarget const* gt = this->Targets[depender_index];
+  cmGraphNodeSet emitted;
+  // A target in a cycle reaches its own side effects.
+  emitted.Insert(depender_index);
   for (auto const& edge : inputEdges) {
     if (edge.IsStrong()) {
       // Preserve strong edges
       outputEdges.push_back(edge);
     } else {
-      auto const& dse = this->SideEffects[edge];
-
-      // Add edges that have custom command side effects
-      for (cmGeneratorTarget const* dep : dse.CustomCommandSideEffects) {
-        auto index = this->TargetIndex[dep];
-        if (!emitted.count(index)) {
-          emitted.insert(index);
+      auto const& dse = this->GetSideEffects(edge);
+      auto emit = [&](size_t index) {
+        if (!emitted.Contains(index)) {
+          emitted.Insert(index);
           outputEdges.push_back(
             cmGraphEdge(index, false, edge.IsCross(), edge.GetBacktrace()));
         }
-      }
+      };
+
+      // Add edges that have custom command side effects
+      dse.CustomCommandSideEffects.ForEach(emit);
 
       // Add edges that have language side effects for languages we
       // care about
       for (auto const& lang : gt->GetAllConfigCompileLanguages()) {
         auto it = dse.LanguageSideEffects.find(lang);
         if (it != dse.LanguageSideEffects.end()) {
-          for (cmGeneratorTarget const* dep : it->second) {
-            auto index = this->TargetIndex[dep];
-            if (!emitted.count(index)) {
-              emitted.insert(index);
-              outputEdges.push_back(cmGraphEdge(index, false, edge.IsCross(),
-                                                edge.GetBacktrace()));
-            }
-          }
+          it->second.ForEach(emit);
         }
       }
     }
@@ -529,26 +532,23 @@ void cmComputeTargetDepends::DisplayGraph(Graph const& graph,
 void cmComputeTargetDepends::DisplaySideEffects()
 {
   fprintf(stderr, "The side effects are:\n");
-  size_t n = this->SideEffects.size();
+  auto display = [this](size_t index) {
+    fprintf(stderr, "    from target %zu [%s]\n", index,
+            this->Targets[index]->GetName().c_str());
+  };
+  size_t n = this->Targets.size();
   for (size_t depender_index = 0; depender_index < n; ++depender_index) {
     cmGeneratorTarget const* depender = this->Targets[depender_index];
     fprintf(stderr, "target %zu is [%s]\n", depender_index,
             depender->GetName().c_str());
-    if (!this->SideEffects[depender_index].CustomCommandSideEffects.empty()) {
+    TargetSideEffects const& se = this->GetSideEffects(depender_index);
+    if (!se.CustomCommandSideEffects.Empty()) {
       fprintf(stderr, "  custom commands\n");
-      for (auto const* gt :
-           this->SideEffects[depender_index].CustomCommandSideEffects) {
-        fprintf(stderr, "    from target %zu [%s]\n", this->TargetIndex[gt],
-                gt->GetName().c_str());
-      }
+      se.CustomCommandSideEffects.ForEach(display);
     }
-    for (auto const& it :
-         this->SideEffects[depender_index].LanguageSideEffects) {
+    for (auto const& it : se.LanguageSideEffects) {
       fprintf(stderr, "  language %s\n", it.first.c_str());
-      for (auto const* gt : it.second) {
-        fprintf(stderr, "    from target %zu [%s]\n", this->TargetIndex[gt],
-                gt->GetName().c_str());
-      }
+      it.second.ForEach(display);
     }
   }
   fprintf(stderr, "\n");
@@ -43,11 +43,11 @@ public:
                               cmTargetDependSet& deps);
 
 private:
+  // Targets with side effects reachable from a target, by target index.
   struct TargetSideEffects
   {
-    std::set<cmGeneratorTarget const*> CustomCommandSideEffects;
-    std::map<std::string, std::set<cmGeneratorTarget const*>>
-      LanguageSideEffects;
+    cmGraphNodeSet CustomCommandSideEffects;
+    std::map<std::string, cmGraphNodeSet> LanguageSideEffects;
   };
 
   void CollectTargets();
@@ -59,11 +59,9 @@ private:
                        cmGeneratorTarget const* dependee,
                        cmListFileBacktrace const& dependee_backtrace,
                        bool linking, bool cross);
-  void CollectSideEffects();
-  void CollectSideEffectsForTarget(std::set<size_t>& visited,
-                                   size_t depender_index);
+  void CollectSideEffects(cmComputeComponentGraph const& ccg);
   void ComputeIntermediateGraph();
-  void OptimizeLinkDependencies(cmGeneratorTarget const* gt,
+  void OptimizeLinkDependencies(size_t depender_index,
                                 cmGraphEdgeList& outputEdges,
                                 cmGraphEdgeList const& inputEdges);
   bool ComputeFinalDepends(cmComputeComponentGraph const& ccg);
@@ -95,7 +93,14 @@ private:
   Graph InitialGraph;
   Graph IntermediateGraph;
   Graph FinalGraph;
+  // The side effects are shared by the targets of a strongly connected
+  // component of the initial graph.
   std::vector<TargetSideEffects> SideEffects;
+  std::vector<size_t> SideEffectsComponent;
+  TargetSideEffects const& GetSideEffects(size_t index) const
+  {
+    return this->SideEffects[this->SideEffectsComponent[index]];
+  }
   void DisplayGraph(Graph const& graph, std::string const& name);
   void DisplaySideEffects();
 
@@ -140,6 +140,11 @@ public:
   bool GetCodegen() const { return Codegen; }
   void SetCodegen(bool b) { Codegen = b; }
 
+  /** Set/Get whether the outputs may be restored from a cache instead
+      of running the command.  */
+  bool GetCache() const { return Cache; }
+  void SetCache(bool b) { Cache = b; }
+
 private:
   std::vector<std::string> Outputs;
   std::vector<std::string> Byproducts;
@@ -163,6 +168,7 @@ private:
   bool HasMainDependency_ = false;
   bool DependsExplicitOnly = false;
   bool Codegen = false;
+  bool Cache = false;
 
 // Policies are NEW for synthesized custom commands, and set by cmMakefile for
 // user-created custom commands.
@@ -0,0 +1,318 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmCustomCommandCache.h"
+
+#include <cstdio>
+#include <iostream>
+
+#include <cm/string_view>
+#include <cmext/string_view>
+
+#include "cmsys/FStream.hxx"
+#include "cmsys/SystemTools.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+// Change this to invalidate all existing entries of all stores.
+cm::string_view const KeyVersion = "cmake_cached_command 2"_s;
+
+char const HitMark = 'h';
+char const MissMark = 'm';
+
+std::string HashFileIfPresent(std::string const& path)
+{
+  if (path.empty() || !cmSystemTools::FileExists(path, true)) {
+    return std::string();
+  }
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  return hasher.HashFile(path);
+}
+
+std::string ComputeKey(std::vector<std::string> const& outputs,
+                       std::vector<std::string> const& byproducts,
+                       std::vector<std::string> const& depends,
+                       std::vector<std::vector<std::string>> const& commands)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  auto add = [&hasher](cm::string_view field, cm::string_view value) {
+    hasher.Append(field);
+    hasher.Append("=", 1);
+    hasher.Append(value);
+    hasher.Append("\0", 1);
+  };
+
+  add("version"_s, KeyVersion);
+  add("cwd"_s, cmSystemTools::GetLogicalWorkingDirectory());
+  for (std::vector<std::string> const& command : commands) {
+    // The executable may be rebuilt, so its content is part of the key.
+    add("command"_s,
+        HashFileIfPresent(cmSystemTools::FindProgram(command.front())));
+    for (std::string const& arg : command) {
+      add("arg"_s, arg);
+    }
+  }
+  for (std::string const& output : outputs) {
+    add("output"_s, output);
+  }
+  for (std::string const& byproduct : byproducts) {
+    add("byproduct"_s, byproduct);
+  }
+  for (std::string const& depend : depends) {
+    add("depends"_s, depend);
+    add("content"_s, HashFileIfPresent(depend));
+  }
+  return hasher.FinalizeHex();
+}
+
+std::string EntryDirectory(std::string const& store, std::string const& key)
+{
+  return cmStrCat(store, '/', cm::string_view(key).substr(0, 2), '/', key);
+}
+
+bool CopyOutput(std::string const& from, std::string const& to)
+{
+  return cmSystemTools::CopySingleFile(
+           from, to, cmSystemTools::CopyWhen::Always,
+           cmSystemTools::CopyInputRecent::No) ==
+    cmSystemTools::CopyResult::Success;
+}
+
+// An entry holds each output as its index, and each byproduct the
+// commands created as its index prefixed with 'b'.
+std::string OutputInEntry(std::string const& entry, std::size_t i)
+{
+  return cmStrCat(entry, '/', i);
+}
+
+std::string ByproductInEntry(std::string const& entry, std::size_t i)
+{
+  return cmStrCat(entry, "/b", i);
+}
+
+bool Restore(std::string const& entry, std::vector<std::string> const& outputs,
+             std::vector<std::string> const& byproducts)
+{
+  if (!cmSystemTools::FileIsDirectory(entry)) {
+    return false;
+  }
+  for (std::size_t i = 0; i < outputs.size(); ++i) {
+    cmSystemTools::MakeDirectory(
+      cmSystemTools::GetFilenamePath(outputs[i]));
+    if (!CopyOutput(OutputInEntry(entry, i), outputs[i])) {
+      return false;
+    }
+  }
+  for (std::size_t i = 0; i < byproducts.size(); ++i) {
+    std::string const stored = ByproductInEntry(entry, i);
+    if (!cmSystemTools::FileExists(stored, true)) {
+      continue;
+    }
+    cmSystemTools::MakeDirectory(
+      cmSystemTools::GetFilenamePath(byproducts[i]));
+    if (!CopyOutput(stored, byproducts[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void Store(std::string const& store, std::string const& entry,
+           std::vector<std::string> const& outputs,
+           std::vector<std::string> const& byproducts)
+{
+  // Only regular files can be cached.  Byproducts the commands did not
+  // create are not restored either.
+  for (std::string const& output : outputs) {
+    if (!cmSystemTools::FileExists(output, true)) {
+      std::cerr << "Not storing the outputs of the cached command because "
+                   "this output is not a regular file:\n  "
+                << output << '\n';
+      return;
+    }
+  }
+
+  // Populate a new entry under a temporary name and move it into place
+  // as a whole, so that concurrent builds never see a partial entry.
+  if (!cmSystemTools::MakeDirectory(store)) {
+    return;
+  }
+  std::string temp = cmStrCat(store, "/tmp-XXXXXX");
+  if (!cmSystemTools::MakeTempDirectory(temp)) {
+    return;
+  }
+  bool okay = true;
+  for (std::size_t i = 0; okay && i < outputs.size(); ++i) {
+    okay = CopyOutput(outputs[i], OutputInEntry(temp, i));
+  }
+  for (std::size_t i = 0; okay && i < byproducts.size(); ++i) {
+    if (cmSystemTools::FileExists(byproducts[i], true)) {
+      okay = CopyOutput(byproducts[i], ByproductInEntry(temp, i));
+    }
+  }
+  if (okay && cmSystemTools::MakeDirectory(
+                cmSystemTools::GetFilenamePath(entry))) {
+    // Renaming a directory fails if the destination is not empty.
+    okay = cmSystemTools::RenameFile(temp, entry);
+  } else {
+    okay = false;
+  }
+  if (!okay) {
+    // Another build may have stored the same entry first.
+    cmSystemTools::RemoveADirectory(temp);
+  }
+}
+
+void AppendLog(std::string const& log, char mark)
+{
+  if (log.empty()) {
+    return;
+  }
+  // Appending a single character is atomic, so concurrent commands may
+  // share the log.
+  if (FILE* f = cmsys::SystemTools::Fopen(log, "ab")) {
+    std::fputc(mark, f);
+    std::fclose(f);
+  }
+}
+}
+
+cmCustomCommandLine cmCustomCommandCache::MakeCommandLine(
+  std::string const& store, std::string const& log,
+  std::vector<std::string> const& outputs,
+  std::vector<std::string> const& byproducts,
+  std::vector<std::string> const& depends,
+  std::vector<std::vector<std::string>> const& commands)
+{
+  cmCustomCommandLine argv;
+  argv.push_back(cmSystemTools::GetCMakeCommand());
+  argv.emplace_back("-E");
+  argv.emplace_back("cmake_cached_command");
+  argv.push_back(cmStrCat("--store=", store));
+  argv.push_back(cmStrCat("--log=", log));
+  for (std::string const& output : outputs) {
+    argv.push_back(cmStrCat("--output=", output));
+  }
+  for (std::string const& byproduct : byproducts) {
+    argv.push_back(cmStrCat("--byproduct=", byproduct));
+  }
+  for (std::string const& depend : depends) {
+    argv.push_back(cmStrCat("--depends=", depend));
+  }
+  for (std::vector<std::string> const& command : commands) {
+    argv.push_back(cmStrCat("--command=", command.size()));
+    argv.insert(argv.end(), command.begin(), command.end());
+  }
+  return argv;
+}
+
+int cmCustomCommandCache::Run(std::vector<std::string>::const_iterator argBeg,
+                              std::vector<std::string>::const_iterator argEnd)
+{
+  std::string store;
+  std::string log;
+  std::vector<std::string> outputs;
+  std::vector<std::string> byproducts;
+  std::vector<std::string> depends;
+  std::vector<std::vector<std::string>> commands;
+  for (auto a = argBeg; a != argEnd; ++a) {
+    std::string const& arg = *a;
+    if (cmHasLiteralPrefix(arg, "--store=")) {
+      store = arg.substr(8);
+    } else if (cmHasLiteralPrefix(arg, "--log=")) {
+      log = arg.substr(6);
+    } else if (cmHasLiteralPrefix(arg, "--output=")) {
+      outputs.push_back(arg.substr(9));
+    } else if (cmHasLiteralPrefix(arg, "--byproduct=")) {
+      byproducts.push_back(arg.substr(12));
+    } else if (cmHasLiteralPrefix(arg, "--depends=")) {
+      depends.push_back(arg.substr(10));
+    } else if (cmHasLiteralPrefix(arg, "--command=")) {
+      unsigned long count = 0;
+      if (!cmStrToULong(arg.substr(10), &count) || count == 0 ||
+          count > static_cast<unsigned long>(argEnd - a - 1)) {
+        cmSystemTools::Error(
+          cmStrCat("-E cmake_cached_command invalid argument: ", arg));
+        return 1;
+      }
+      commands.emplace_back(a + 1, a + 1 + count);
+      a += count;
+    } else {
+      cmSystemTools::Error(
+        cmStrCat("-E cmake_cached_command unknown argument: ", arg));
+      return 1;
+    }
+  }
+  if (store.empty() || commands.empty()) {
+    cmSystemTools::Error("-E cmake_cached_command requires --store and "
+                         "at least one --command");
+    return 1;
+  }
+
+  std::string const key = ComputeKey(outputs, byproducts, depends, commands);
+  std::string const entry = EntryDirectory(store, key);
+  if (Restore(entry, outputs, byproducts)) {
+    AppendLog(log, HitMark);
+    return 0;
+  }
+  if (cmSystemTools::FileIsDirectory(entry)) {
+    // The entry is partial or damaged.  Remove it so that it can be
+    // stored again below, since an existing entry is never replaced.
+    cmSystemTools::RemoveADirectory(entry);
+  }
+
+  for (std::vector<std::string> const& command : commands) {
+    int ret = 0;
+    if (!cmSystemTools::RunSingleCommand(command, nullptr, nullptr, &ret,
+                                         nullptr,
+                                         cmSystemTools::OUTPUT_PASSTHROUGH)) {
+      std::cerr << "Error running '" << command.front() << "'\n";
+      return 1;
+    }
+    if (ret != 0) {
+      return ret;
+    }
+  }
+
+  Store(store, entry, outputs, byproducts);
+  AppendLog(log, MissMark);
+  return 0;
+}
+
+std::string cmCustomCommandCache::GetDefaultStore(
+  std::string const& topBinaryDir)
+{
+  return cmStrCat(topBinaryDir, "/CMakeFiles/CustomCommandCache");
+}
+
+std::string cmCustomCommandCache::GetLogFile(std::string const& topBinaryDir)
+{
+  return cmStrCat(topBinaryDir, "/CMakeFiles/CustomCommandCache.log");
+}
+
+bool cmCustomCommandCache::TakeStatistics(std::string const& logFile,
+                                          unsigned long& hits,
+                                          unsigned long& misses)
+{
+  hits = 0;
+  misses = 0;
+  cmsys::ifstream fin(logFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  char c;
+  while (fin.get(c)) {
+    if (c == HitMark) {
+      ++hits;
+    } else if (c == MissMark) {
+      ++misses;
+    }
+  }
+  fin.close();
+  cmSystemTools::RemoveFile(logFile);
+  return hits + misses > 0;
+}
@@ -0,0 +1,54 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <vector>
+
+#include "cmCustomCommandLines.h"
+
+/** \class cmCustomCommandCache
+ * \brief Reuse the outputs of custom commands from a content-addressed store.
+ *
+ * A custom command created with the CACHE option of add_custom_command
+ * runs through "cmake -E cmake_cached_command".  The command hashes its
+ * command lines, working directory, declared outputs, and the content
+ * of its dependencies and executables to form a key.  If the store has
+ * an entry for the key, the outputs are copied from it and the command
+ * does not run.  Otherwise the command runs and its outputs, and the
+ * byproducts it created, are added to the store.
+ *
+ * Each cached command appends one character to a log in the build tree
+ * that records whether it hit the store.  "cmake --build" reports the
+ * totals when the build finishes.
+ */
+class cmCustomCommandCache
+{
+public:
+  /** The arguments of "cmake -E cmake_cached_command" for the given
+      command lines, each starting with the path to its executable.  */
+  static cmCustomCommandLine MakeCommandLine(
+    std::string const& store, std::string const& log,
+    std::vector<std::string> const& outputs,
+    std::vector<std::string> const& byproducts,
+    std::vector<std::string> const& depends,
+    std::vector<std::vector<std::string>> const& commands);
+
+  /** Run "cmake -E cmake_cached_command" with the arguments following
+      the command name.  Returns the exit code.  */
+  static int Run(std::vector<std::string>::const_iterator argBeg,
+                 std::vector<std::string>::const_iterator argEnd);
+
+  /** The store used if CMAKE_CUSTOM_COMMAND_CACHE_DIR is not set.  */
+  static std::string GetDefaultStore(std::string const& topBinaryDir);
+
+  /** The log of the build tree with the given top directory.  */
+  static std::string GetLogFile(std::string const& topBinaryDir);
+
+  /** Count and remove the entries of a log.  Returns false if no cached
+      command wrote to it.  */
+  static bool TakeStatistics(std::string const& logFile, unsigned long& hits,
+                             unsigned long& misses);
+};
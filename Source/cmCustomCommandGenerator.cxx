@@ -13,6 +13,7 @@
 
 #include "cmCryptoHash.h"
 #include "cmCustomCommand.h"
+#include "cmCustomCommandCache.h"
 #include "cmCustomCommandLines.h"
 #include "cmGeneratorExpression.h"
 #include "cmGeneratorTarget.h"
@@ -272,6 +273,61 @@ cmCustomCommandGenerator::cmCustomCommandGenerator(
   }
 
   this->FillEmulatorsWithArguments();
+
+  if (cc.GetCache() && !this->HasOnlyEmptyCommandLines()) {
+    this->WrapCommandLinesForCache();
+  }
+}
+
+void cmCustomCommandGenerator::WrapCommandLinesForCache()
+{
+  // Run the final command lines, with their emulators and executable
+  // locations, through a single cached command.
+  std::vector<std::vector<std::string>> commands;
+  for (unsigned int c = 0; c < this->GetNumberOfCommands(); ++c) {
+    cmCustomCommandLine const& commandLine = this->CommandLines[c];
+    if (commandLine.front().empty()) {
+      continue;
+    }
+    std::vector<std::string> command = this->GetCrossCompilingEmulator(c);
+    if (char const* location = this->GetArgv0Location(c)) {
+      command.emplace_back(location);
+    } else {
+      command.push_back(commandLine.front());
+    }
+    command.insert(command.end(), commandLine.begin() + 1,
+                   commandLine.end());
+    commands.push_back(std::move(command));
+  }
+  if (commands.empty()) {
+    return;
+  }
+
+  std::vector<std::string> depends;
+  for (std::string const& d : this->Depends) {
+    std::string dep;
+    if (this->LG->GetRealDependency(d, this->OutputConfig, dep)) {
+      depends.push_back(std::move(dep));
+    }
+  }
+
+  std::string const& topBinaryDir = this->LG->GetBinaryDirectory();
+  std::string store = this->LG->GetMakefile()->GetSafeDefinition(
+    "CMAKE_CUSTOM_COMMAND_CACHE_DIR");
+  if (store.empty()) {
+    store = cmCustomCommandCache::GetDefaultStore(topBinaryDir);
+  } else {
+    store = cmSystemTools::CollapseFullPath(store, topBinaryDir);
+  }
+
+  this->CommandLines.clear();
+  this->CommandLines.push_back(cmCustomCommandCache::MakeCommandLine(
+    store, cmCustomCommandCache::GetLogFile(topBinaryDir), this->Outputs,
+    this->Byproducts, depends, commands));
+  this->EmulatorsWithArguments.assign(1, std::vector<std::string>());
+
+  // The cached command runs its command lines without a shell.
+  this->OldStyle = false;
 }
 
 unsigned int cmCustomCommandGenerator::GetNumberOfCommands() const
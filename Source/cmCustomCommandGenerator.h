@@ -41,6 +41,7 @@ class cmCustomCommandGenerator
     ComputeInternalDepfile;
 
   void FillEmulatorsWithArguments();
+  void WrapCommandLinesForCache();
   std::vector<std::string> GetCrossCompilingEmulator(unsigned int c) const;
   char const* GetArgv0Location(unsigned int c) const;
 
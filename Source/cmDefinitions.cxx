@@ -3,6 +3,7 @@
 #include "cmDefinitions.h"
 
 #include <cassert>
+#include <functional>
 #include <unordered_set>
 #include <utility>
 
@@ -10,13 +11,19 @@
 
 cmDefinitions::Def cmDefinitions::NoDef;
 
-cmDefinitions::Def const& cmDefinitions::GetInternal(std::string const& key,
+cmDefinitions::Key::Key(cm::String name)
+  : Name(std::move(name))
+  , Hash(std::hash<cm::String>{}(this->Name))
+{
+}
+
+cmDefinitions::Def const& cmDefinitions::GetInternal(Key const& key,
                                                      StackIter begin,
                                                      StackIter end, bool raise)
 {
   assert(begin != end);
   {
-    auto it = begin->Map.find(cm::String::borrow(key));
+    auto it = begin->Map.find(key);
     if (it != begin->Map.end()) {
       return it->second;
     }
@@ -30,27 +37,33 @@ cmDefinitions::Def const& cmDefinitions::GetInternal(std::string const& key,
   if (!raise) {
     return def;
   }
-  return begin->Map.emplace(key, def).first->second;
+  // The key may borrow the caller's buffer.  Store an owned copy.
+  return begin->Map
+    .emplace(Key(std::string(key.Name.view()), key.Hash), def)
+    .first->second;
 }
 
 cmValue cmDefinitions::Get(std::string const& key, StackIter begin,
                            StackIter end)
 {
-  Def const& def = cmDefinitions::GetInternal(key, begin, end, false);
+  Def const& def =
+    cmDefinitions::GetInternal(Key(cm::String::borrow(key)), begin, end,
+                               false);
   return def.Value ? cmValue(def.Value.str_if_stable()) : nullptr;
 }
 
 void cmDefinitions::Raise(std::string const& key, StackIter begin,
                           StackIter end)
 {
-  cmDefinitions::GetInternal(key, begin, end, true);
+  cmDefinitions::GetInternal(Key(cm::String::borrow(key)), begin, end, true);
 }
 
 bool cmDefinitions::HasKey(std::string const& key, StackIter begin,
                            StackIter end)
 {
+  Key const lookup(cm::String::borrow(key));
   for (StackIter it = begin; it != end; ++it) {
-    if (it->Map.find(cm::String::borrow(key)) != it->Map.end()) {
+    if (it->Map.find(lookup) != it->Map.end()) {
       return true;
     }
   }
@@ -66,11 +79,11 @@ cmDefinitions cmDefinitions::MakeClosure(StackIter begin, StackIter end)
     for (auto const& mi : it->Map) {
       // Use this key if it is not already set or unset.
       if (closure.Map.find(mi.first) == closure.Map.end() &&
-          undefined.find(mi.first.view()) == undefined.end()) {
+          undefined.find(mi.first.Name.view()) == undefined.end()) {
         if (mi.second.Value) {
           closure.Map.insert(mi);
         } else {
-          undefined.emplace(mi.first.view());
+          undefined.emplace(mi.first.Name.view());
         }
       }
     }
@@ -88,8 +101,8 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
     defined.reserve(defined.size() + it->Map.size());
     for (auto const& mi : it->Map) {
       // Use this key if it is not already set or unset.
-      if (bound.emplace(mi.first.view()).second && mi.second.Value) {
-        defined.push_back(*mi.first.str_if_stable());
+      if (bound.emplace(mi.first.Name.view()).second && mi.second.Value) {
+        defined.push_back(*mi.first.Name.str_if_stable());
       }
     }
   }
@@ -99,10 +112,10 @@ std::vector<std::string> cmDefinitions::ClosureKeys(StackIter begin,
 
 void cmDefinitions::Set(std::string const& key, cm::string_view value)
 {
-  this->Map[key] = Def(value);
+  this->Map[Key(key)] = Def(value);
 }
 
 void cmDefinitions::Unset(std::string const& key)
 {
-  this->Map[key] = Def();
+  this->Map[Key(key)] = Def();
 }
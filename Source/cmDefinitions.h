@@ -4,8 +4,10 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include <cm/string_view>
@@ -60,8 +62,33 @@ private:
   };
   static Def NoDef;
 
-  std::unordered_map<cm::String, Def> Map;
+  /** Variable name with its hash.  A lookup hashes the name once and
+      reuses the hash in every scope it searches.  */
+  struct Key
+  {
+    Key(cm::String name);
+    Key(cm::String name, std::size_t hash)
+      : Name(std::move(name))
+      , Hash(hash)
+    {
+    }
+    cm::String Name;
+    std::size_t Hash;
+  };
+  struct KeyHash
+  {
+    std::size_t operator()(Key const& key) const noexcept { return key.Hash; }
+  };
+  struct KeyEqual
+  {
+    bool operator()(Key const& l, Key const& r) const noexcept
+    {
+      return l.Hash == r.Hash && l.Name == r.Name;
+    }
+  };
+
+  std::unordered_map<Key, Def, KeyHash, KeyEqual> Map;
 
-  static Def const& GetInternal(std::string const& key, StackIter begin,
+  static Def const& GetInternal(Key const& key, StackIter begin,
                                 StackIter end, bool raise);
 };
@@ -26,7 +26,7 @@ cmDepends::~cmDepends() = default;
 
 bool cmDepends::Write(std::ostream& makeDepends, std::ostream& internalDepends)
 {
-  std::map<std::string, std::set<std::string>> dependencies;
+  ObjectSourcesMap dependencies;
   {
     // Lookup the set of sources to scan.
     cmList pairs;
@@ -45,15 +45,26 @@ bool cmDepends::Write(std::ostream& makeDepends, std::ostream& internalDepends)
       dependencies[obj].insert(src);
     }
   }
-  for (auto const& d : dependencies) {
+  if (!this->WriteAllDependencies(dependencies, makeDepends,
+                                  internalDepends)) {
+    return false;
+  }
+
+  return this->Finalize(makeDepends, internalDepends);
+}
+
+bool cmDepends::WriteAllDependencies(ObjectSourcesMap const& objects,
+                                     std::ostream& makeDepends,
+                                     std::ostream& internalDepends)
+{
+  for (auto const& d : objects) {
     // Write the dependencies for this pair.
     if (!this->WriteDependencies(d.second, d.first, makeDepends,
                                  internalDepends)) {
       return false;
     }
   }
-
-  return this->Finalize(makeDepends, internalDepends);
+  return true;
 }
 
 bool cmDepends::Finalize(std::ostream& /*unused*/, std::ostream& /*unused*/)
@@ -75,6 +75,16 @@ public:
   void SetFileTimeCache(cmFileTimeCache* fc) { this->FileTimeCache = fc; }
 
 protected:
+  // Map from each object file to the sources it is compiled from.
+  using ObjectSourcesMap = std::map<std::string, std::set<std::string>>;
+
+  // Write dependencies for all objects of the target to the given
+  // streams, in order.  By default this calls WriteDependencies for
+  // each object.  Return true for success and false for failure.
+  virtual bool WriteAllDependencies(ObjectSourcesMap const& objects,
+                                    std::ostream& makeDepends,
+                                    std::ostream& internalDepends);
+
   // Write dependencies for the target file to the given stream.
   // Return true for success and false for failure.
   virtual bool WriteDependencies(std::set<std::string> const& sources,
@@ -2,19 +2,32 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmDependsC.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <queue>
+#include <unordered_set>
 #include <utility>
 
+#include <cm/string_view>
+
 #include "cmsys/FStream.hxx"
 
-#include "cmFileTime.h"
+#include "cmCryptoHash.h"
+#include "cmGeneratedFileStream.h"
 #include "cmGlobalUnixMakefileGenerator3.h"
 #include "cmList.h"
 #include "cmLocalUnixMakefileGenerator3.h"
 #include "cmMakefile.h"
+#include "cmParallelFor.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmValue.h"
 
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFileLock.h"
+#  include "cmFileLockResult.h"
+#endif
+
 #define INCLUDE_REGEX_LINE                                                    \
   "^[ \t]*[#%][ \t]*(include|import)[ \t]*[<\"]([^\">]+)([\">])"
 
@@ -23,6 +36,82 @@
 #define INCLUDE_REGEX_COMPLAIN_MARKER "#IncludeRegexComplain: "
 #define INCLUDE_REGEX_TRANSFORM_MARKER "#IncludeRegexTransform: "
 
+namespace {
+
+// Threads used to scan the objects of one target at most.
+unsigned int const MaxScanJobs = 4;
+
+// Match a line against INCLUDE_REGEX_LINE.  On a match, get the name
+// of the included file and the delimiter that closes it.
+bool MatchIncludeLine(cm::string_view line, cm::string_view& name,
+                      char& close)
+{
+  std::size_t const n = line.size();
+  std::size_t i = 0;
+  auto skipBlanks = [&]() {
+    while (i < n && (line[i] == ' ' || line[i] == '\t')) {
+      ++i;
+    }
+  };
+
+  skipBlanks();
+  if (i == n || (line[i] != '#' && line[i] != '%')) {
+    return false;
+  }
+  ++i;
+  skipBlanks();
+  cm::string_view const directive = line.substr(i);
+  if (cmHasLiteralPrefix(directive, "include")) {
+    i += 7;
+  } else if (cmHasLiteralPrefix(directive, "import")) {
+    i += 6;
+  } else {
+    return false;
+  }
+  skipBlanks();
+  if (i == n || (line[i] != '<' && line[i] != '"')) {
+    return false;
+  }
+  std::size_t const start = ++i;
+  while (i < n && line[i] != '"' && line[i] != '>') {
+    ++i;
+  }
+  if (i == start || i == n) {
+    return false;
+  }
+  name = line.substr(start, i - start);
+  close = line[i];
+  return true;
+}
+
+bool ReadFileContent(std::string const& fullName, std::string& content)
+{
+  cmsys::ifstream fin(fullName.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  cmsys::FStream::BOM bom = cmsys::FStream::ReadBOM(fin);
+  if (bom != cmsys::FStream::BOM_None && bom != cmsys::FStream::BOM_UTF8) {
+    // Skip file with encoding we do not implement.
+    return false;
+  }
+  std::streamoff const begin = fin.tellg();
+  fin.seekg(0, std::ios::end);
+  std::streamoff const end = fin.tellg();
+  fin.seekg(begin);
+  if (begin < 0 || end < begin) {
+    return false;
+  }
+  content.resize(static_cast<std::size_t>(end - begin));
+  if (!content.empty()) {
+    fin.read(&content[0], static_cast<std::streamsize>(content.size()));
+    content.resize(static_cast<std::size_t>(fin.gcount()));
+  }
+  return true;
+}
+
+} // anonymous namespace
+
 cmDependsC::cmDependsC() = default;
 
 cmDependsC::cmDependsC(cmLocalUnixMakefileGenerator3* lg,
@@ -51,9 +140,8 @@ cmDependsC::cmDependsC(cmLocalUnixMakefileGenerator3* lg,
     }
   }
 
-  this->IncludeRegexLine.compile(INCLUDE_REGEX_LINE);
-  this->IncludeRegexScan.compile(scanRegex);
-  this->IncludeRegexComplain.compile(complainRegex);
+  this->Regex.IncludeRegexScan.compile(scanRegex);
+  this->Regex.IncludeRegexComplain.compile(complainRegex);
   this->IncludeRegexLineString = INCLUDE_REGEX_LINE_MARKER INCLUDE_REGEX_LINE;
   this->IncludeRegexScanString =
     cmStrCat(INCLUDE_REGEX_SCAN_MARKER, scanRegex);
@@ -62,10 +150,21 @@ cmDependsC::cmDependsC(cmLocalUnixMakefileGenerator3* lg,
 
   this->SetupTransforms();
 
-  this->CacheFileName =
-    cmStrCat(this->TargetDirectory, '/', lang, ".includecache");
+  // The include lines of a file depend on the target only through its
+  // include transforms, so all targets in the directory with the same
+  // transforms share one cache.
+  std::string cacheName = lang;
+  if (!this->TransformRules.empty()) {
+    cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+    cacheName += cmStrCat(
+      '-', hasher.HashString(this->IncludeRegexTransformString).substr(0, 8));
+  }
+  this->CacheFileName = cmStrCat(lg->GetCurrentBinaryDirectory(),
+                                 "/CMakeFiles/", cacheName, ".includecache");
 
-  this->ReadCacheFile();
+  if (!this->ReadCacheFile(this->FileCache)) {
+    this->CacheModified = true;
+  }
 }
 
 cmDependsC::~cmDependsC()
@@ -73,141 +172,211 @@ cmDependsC::~cmDependsC()
   this->WriteCacheFile();
 }
 
-bool cmDependsC::WriteDependencies(std::set<std::string> const& sources,
-                                   std::string const& obj,
-                                   std::ostream& makeDepends,
-                                   std::ostream& internalDepends)
+bool cmDependsC::WriteAllDependencies(ObjectSourcesMap const& objects,
+                                      std::ostream& makeDepends,
+                                      std::ostream& internalDepends)
 {
-  // Make sure this is a scanning instance.
-  if (sources.empty() || sources.begin()->empty()) {
-    cmSystemTools::Error("Cannot scan dependencies without a source file.");
-    return false;
-  }
-  if (obj.empty()) {
-    cmSystemTools::Error("Cannot scan dependencies without an object file.");
-    return false;
-  }
+  struct Object
+  {
+    std::set<std::string> const* Sources;
+    std::string Path;
+    std::set<std::string> Dependencies;
+    std::string Missing;
+    bool Found = true;
+  };
+  std::vector<Object> work;
+  std::vector<Object*> unscanned;
+  work.reserve(objects.size());
+
+  for (auto const& o : objects) {
+    // Make sure this is a scanning instance.
+    if (o.second.empty() || o.second.begin()->empty()) {
+      cmSystemTools::Error("Cannot scan dependencies without a source file.");
+      return false;
+    }
+    if (o.first.empty()) {
+      cmSystemTools::Error(
+        "Cannot scan dependencies without an object file.");
+      return false;
+    }
 
-  std::set<std::string> dependencies;
-  bool haveDeps = false;
+    // Compute a path to the object file to write to the internal depend
+    // file.  Any existing content of the internal depend file has already
+    // been loaded in ValidDeps with this path as a key.
+    Object obj;
+    obj.Sources = &o.second;
+    obj.Path = this->LocalGenerator->MaybeRelativeToTopBinDir(o.first);
+    work.emplace_back(std::move(obj));
+  }
 
-  // Compute a path to the object file to write to the internal depend file.
-  // Any existing content of the internal depend file has already been
-  // loaded in ValidDeps with this path as a key.
-  std::string obj_i = this->LocalGenerator->MaybeRelativeToTopBinDir(obj);
+  for (Object& obj : work) {
+    if (this->ValidDeps) {
+      auto const tmpIt = this->ValidDeps->find(obj.Path);
+      if (tmpIt != this->ValidDeps->end()) {
+        obj.Dependencies.insert(tmpIt->second.begin(), tmpIt->second.end());
+        continue;
+      }
+    }
+    unscanned.push_back(&obj);
+  }
 
-  if (this->ValidDeps) {
-    auto const tmpIt = this->ValidDeps->find(obj_i);
-    if (tmpIt != this->ValidDeps->end()) {
-      dependencies.insert(tmpIt->second.begin(), tmpIt->second.end());
-      haveDeps = true;
+  // Walk the dependency graph of each object that needs it.  The walks
+  // are independent except for the shared caches, so spread them over
+  // threads.  Each thread matches with its own copy of the expressions.
+  // The build tool usually runs several of these processes at once, so
+  // use only a few threads each.
+  unsigned int const jobs =
+    std::min(cmParallelForJobs(unscanned.size(), 0), MaxScanJobs);
+  std::vector<Matchers> regex(jobs, this->Regex);
+  cmParallelFor(unscanned.size(), jobs,
+                [this, &unscanned, &regex](std::size_t i, unsigned int w) {
+                  Object& obj = *unscanned[i];
+                  obj.Found = this->ScanObject(*obj.Sources, regex[w],
+                                               obj.Dependencies, obj.Missing);
+                });
+
+  // Write the dependencies in order, stopping at the first object
+  // whose dependencies could not be found.
+  for (Object const& obj : work) {
+    if (!obj.Found) {
+      cmSystemTools::Error("Cannot find file \"" + obj.Missing + "\".");
+      return false;
     }
+    this->WriteObjectDependencies(obj.Path, obj.Dependencies, makeDepends,
+                                  internalDepends);
   }
+  return true;
+}
 
-  if (!haveDeps) {
-    // Walk the dependency graph starting with the source file.
-    int srcFiles = static_cast<int>(sources.size());
-    this->Encountered.clear();
+bool cmDependsC::ScanObject(std::set<std::string> const& sources,
+                            Matchers& regex,
+                            std::set<std::string>& dependencies,
+                            std::string& missing)
+{
+  // Walk the dependency graph starting with the source file.  Entries
+  // are owned by the roots or by the file cache, which keeps them in
+  // place, so the walk refers to them without copies.
+  int srcFiles = static_cast<int>(sources.size());
+  std::vector<UnscannedEntry> roots(sources.size());
+  std::unordered_set<cm::string_view> encountered;
+  std::queue<UnscannedEntry const*> unscanned;
+
+  auto root = roots.begin();
+  for (std::string const& src : sources) {
+    root->FileName = src;
+    unscanned.push(&*root);
+    encountered.insert(root->FileName);
+    ++root;
+  }
 
-    for (std::string const& src : sources) {
-      UnscannedEntry root;
-      root.FileName = src;
-      this->Unscanned.push(root);
-      this->Encountered.insert(src);
+  std::unordered_set<cm::string_view> scanned;
+  while (!unscanned.empty()) {
+    // Get the next file to scan.
+    UnscannedEntry const& current = *unscanned.front();
+    unscanned.pop();
+
+    // If not a full path, find the file in the include path.
+    std::string const* fullName = nullptr;
+    if ((srcFiles > 0) || cmSystemTools::FileIsFullPath(current.FileName)) {
+      if (cmSystemTools::FileExists(current.FileName, true)) {
+        fullName = &current.FileName;
+      }
+    } else {
+      fullName = this->FindFile(current);
     }
 
-    std::set<std::string> scanned;
-    while (!this->Unscanned.empty()) {
-      // Get the next file to scan.
-      UnscannedEntry current = this->Unscanned.front();
-      this->Unscanned.pop();
-
-      // If not a full path, find the file in the include path.
-      std::string fullName;
-      if ((srcFiles > 0) || cmSystemTools::FileIsFullPath(current.FileName)) {
-        if (cmSystemTools::FileExists(current.FileName, true)) {
-          fullName = current.FileName;
-        }
-      } else if (!current.QuotedLocation.empty() &&
-                 cmSystemTools::FileExists(current.QuotedLocation, true)) {
-        // The include statement producing this entry was a double-quote
-        // include and the included file is present in the directory of
-        // the source containing the include statement.
-        fullName = current.QuotedLocation;
-      } else {
-        auto headerLocationIt =
-          this->HeaderLocationCache.find(current.FileName);
-        if (headerLocationIt != this->HeaderLocationCache.end()) {
-          fullName = headerLocationIt->second;
-        } else {
-          for (std::string const& iPath : this->IncludePath) {
-            // Construct the name of the file as if it were in the current
-            // include directory.  Avoid using a leading "./".
-            std::string tmpPath =
-              cmSystemTools::CollapseFullPath(current.FileName, iPath);
-
-            // Look for the file in this location.
-            if (cmSystemTools::FileExists(tmpPath, true)) {
-              fullName = tmpPath;
-              this->HeaderLocationCache[current.FileName] = std::move(tmpPath);
-              break;
-            }
+    // Complain if the file cannot be found and matches the complain
+    // regex.
+    if (!fullName && regex.IncludeRegexComplain.find(current.FileName)) {
+      missing = current.FileName;
+      return false;
+    }
+
+    // Scan the file if it was found and has not been scanned already.
+    // Just leave it out if we cannot read it.
+    if (fullName && scanned.insert(*fullName).second) {
+      if (cmIncludeLines const* lines =
+            this->GetIncludeLines(*fullName, regex)) {
+        dependencies.insert(*fullName);
+        for (UnscannedEntry const& inc : lines->UnscannedEntries) {
+          if (encountered.insert(inc.FileName).second) {
+            unscanned.push(&inc);
           }
         }
       }
+    }
 
-      // Complain if the file cannot be found and matches the complain
-      // regex.
-      if (fullName.empty() &&
-          this->IncludeRegexComplain.find(current.FileName)) {
-        cmSystemTools::Error("Cannot find file \"" + current.FileName + "\".");
-        return false;
-      }
+    srcFiles--;
+  }
+  return true;
+}
 
-      // Scan the file if it was found and has not been scanned already.
-      if (!fullName.empty() && (scanned.find(fullName) == scanned.end())) {
-        // Record scanned files.
-        scanned.insert(fullName);
-
-        // Check whether this file is already in the cache
-        auto fileIt = this->FileCache.find(fullName);
-        if (fileIt != this->FileCache.end()) {
-          fileIt->second.Used = true;
-          dependencies.insert(fullName);
-          for (UnscannedEntry const& inc : fileIt->second.UnscannedEntries) {
-            if (this->Encountered.find(inc.FileName) ==
-                this->Encountered.end()) {
-              this->Encountered.insert(inc.FileName);
-              this->Unscanned.push(inc);
-            }
-          }
-        } else {
-
-          // Try to scan the file.  Just leave it out if we cannot find
-          // it.
-          cmsys::ifstream fin(fullName.c_str());
-          if (fin) {
-            cmsys::FStream::BOM bom = cmsys::FStream::ReadBOM(fin);
-            if (bom == cmsys::FStream::BOM_None ||
-                bom == cmsys::FStream::BOM_UTF8) {
-              // Add this file as a dependency.
-              dependencies.insert(fullName);
-
-              // Scan this file for new dependencies.  Pass the directory
-              // containing the file to handle double-quote includes.
-              std::string dir = cmSystemTools::GetFilenamePath(fullName);
-              this->Scan(fin, dir, fullName);
-            } else {
-              // Skip file with encoding we do not implement.
-            }
-          }
-        }
-      }
+std::string const* cmDependsC::FindFile(UnscannedEntry const& entry)
+{
+  std::lock_guard<std::mutex> lock(this->CacheMutex);
+  if (!entry.QuotedLocation.empty()) {
+    // The include statement producing this entry was a double-quote
+    // include.  Use the file if it is present in the directory of the
+    // source containing the include statement.
+    auto quotedIt = this->QuotedLocationCache.find(entry.QuotedLocation);
+    if (quotedIt == this->QuotedLocationCache.end()) {
+      quotedIt =
+        this->QuotedLocationCache
+          .emplace(entry.QuotedLocation,
+                   cmSystemTools::FileExists(entry.QuotedLocation, true))
+          .first;
+    }
+    if (quotedIt->second) {
+      return &entry.QuotedLocation;
+    }
+  }
+
+  auto headerLocationIt = this->HeaderLocationCache.find(entry.FileName);
+  if (headerLocationIt != this->HeaderLocationCache.end()) {
+    return &headerLocationIt->second;
+  }
+  for (std::string const& iPath : this->IncludePath) {
+    // Construct the name of the file as if it were in the current
+    // include directory.  Avoid using a leading "./".
+    std::string tmpPath =
+      cmSystemTools::CollapseFullPath(entry.FileName, iPath);
+
+    // Look for the file in this location.
+    if (cmSystemTools::FileExists(tmpPath, true)) {
+      return &this->HeaderLocationCache
+                .emplace(entry.FileName, std::move(tmpPath))
+                .first->second;
+    }
+  }
+  return nullptr;
+}
 
-      srcFiles--;
+cmDependsC::cmIncludeLines const* cmDependsC::GetIncludeLines(
+  std::string const& fullName, Matchers& regex)
+{
+  {
+    std::lock_guard<std::mutex> lock(this->CacheMutex);
+    auto fileIt = this->FileCache.find(fullName);
+    if (fileIt != this->FileCache.end()) {
+      return &fileIt->second;
     }
   }
 
+  // Scan without holding the lock.  Another thread may scan the same
+  // file meanwhile, in which case the first result is kept.
+  cmIncludeLines lines;
+  if (!this->Scan(fullName, regex, lines)) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lock(this->CacheMutex);
+  this->CacheModified = true;
+  return &this->FileCache.emplace(fullName, std::move(lines)).first->second;
+}
+
+void cmDependsC::WriteObjectDependencies(
+  std::string const& obj_i, std::set<std::string> const& dependencies,
+  std::ostream& makeDepends, std::ostream& internalDepends)
+{
   // Write the dependencies to the output stream.  Makefile rules
   // written by the original local generator for this directory
   // convert the dependencies to paths relative to the home output
@@ -225,8 +394,17 @@ bool cmDependsC::WriteDependencies(std::set<std::string> const& sources,
       makeDepends << obj_m << ':';
     }
     for (std::string const& dep : dependencies) {
-      std::string dependee = this->LocalGenerator->ConvertToMakefilePath(
-        this->LocalGenerator->MaybeRelativeToTopBinDir(dep));
+      // Most dependencies are shared by many objects.
+      auto dependeeIt = this->MakefilePaths.find(dep);
+      if (dependeeIt == this->MakefilePaths.end()) {
+        dependeeIt =
+          this->MakefilePaths
+            .emplace(dep,
+                     this->LocalGenerator->ConvertToMakefilePath(
+                       this->LocalGenerator->MaybeRelativeToTopBinDir(dep)))
+            .first;
+      }
+      std::string const& dependee = dependeeIt->second;
       if (supportLongLineDepend) {
         makeDepends << ' ' << lineContinue << ' ' << dependee;
       } else {
@@ -236,159 +414,199 @@ bool cmDependsC::WriteDependencies(std::set<std::string> const& sources,
     }
     makeDepends << '\n';
   }
-
-  return true;
 }
 
-void cmDependsC::ReadCacheFile()
+bool cmDependsC::ReadCacheFile(
+  std::unordered_map<std::string, cmIncludeLines>& cache) const
 {
   if (this->CacheFileName.empty()) {
-    return;
+    return true;
   }
   cmsys::ifstream fin(this->CacheFileName.c_str());
   if (!fin) {
-    return;
+    return true;
   }
 
+  // The cache is valid only for the same regular expressions.
   std::string line;
-  cmIncludeLines* cacheEntry = nullptr;
-  bool haveFileName = false;
-
-  cmFileTime cacheFileTime;
-  bool const cacheFileTimeGood = cacheFileTime.Load(this->CacheFileName);
-  while (cmSystemTools::GetLineFromStream(fin, line)) {
-    if (line.empty()) {
-      cacheEntry = nullptr;
-      haveFileName = false;
-      continue;
+  for (std::string const* expect :
+       { &this->IncludeRegexLineString, &this->IncludeRegexScanString,
+         &this->IncludeRegexComplainString,
+         &this->IncludeRegexTransformString }) {
+    if (!cmSystemTools::GetLineFromStream(fin, line) || line != *expect) {
+      return false;
     }
-    // the first line after an empty line is the name of the parsed file
-    if (!haveFileName) {
-      haveFileName = true;
-
-      cmFileTime fileTime;
-      bool const res = cacheFileTimeGood && fileTime.Load(line);
-      bool const newer = res && cacheFileTime.Newer(fileTime);
+  }
 
-      if (res && newer) // cache is newer than the parsed file
-      {
-        cacheEntry = &this->FileCache[line];
-      }
-      // file doesn't exist, check that the regular expressions
-      // haven't changed
-      else if (!res) {
-        if (cmHasLiteralPrefix(line, INCLUDE_REGEX_LINE_MARKER)) {
-          if (line != this->IncludeRegexLineString) {
-            return;
-          }
-        } else if (cmHasLiteralPrefix(line, INCLUDE_REGEX_SCAN_MARKER)) {
-          if (line != this->IncludeRegexScanString) {
-            return;
-          }
-        } else if (cmHasLiteralPrefix(line, INCLUDE_REGEX_COMPLAIN_MARKER)) {
-          if (line != this->IncludeRegexComplainString) {
-            return;
-          }
-        } else if (cmHasLiteralPrefix(line, INCLUDE_REGEX_TRANSFORM_MARKER)) {
-          if (line != this->IncludeRegexTransformString) {
-            return;
-          }
-        }
+  // Each entry names a file, its modification time when it was scanned,
+  // and then the pairs of lines of its UnscannedEntries.  An empty line
+  // ends the entry.
+  bool complete = true;
+  std::string fileName;
+  std::string time;
+  while (cmSystemTools::GetLineFromStream(fin, fileName)) {
+    if (fileName.empty()) {
+      continue;
+    }
+    cmIncludeLines entry;
+    long long entryTime = 0;
+    cmFileTime fileTime;
+    bool valid = cmSystemTools::GetLineFromStream(fin, time) &&
+      cmStrToLongLong(time, &entryTime) && fileTime.Load(fileName) &&
+      fileTime.GetTime() == entryTime;
+    entry.Time = entryTime;
+    while (cmSystemTools::GetLineFromStream(fin, line) && !line.empty()) {
+      UnscannedEntry inc;
+      inc.FileName = line;
+      if (!cmSystemTools::GetLineFromStream(fin, line)) {
+        break;
       }
-    } else if (cacheEntry) {
-      UnscannedEntry entry;
-      entry.FileName = line;
-      if (cmSystemTools::GetLineFromStream(fin, line)) {
-        if (line != "-") {
-          entry.QuotedLocation = line;
-        }
-        cacheEntry->UnscannedEntries.push_back(std::move(entry));
+      if (line != "-") {
+        inc.QuotedLocation = line;
       }
+      entry.UnscannedEntries.push_back(std::move(inc));
+    }
+    if (valid) {
+      cache.emplace(fileName, std::move(entry));
+    } else {
+      // Drop the entry of a file that changed or went away.
+      complete = false;
     }
   }
+  return complete;
 }
 
-void cmDependsC::WriteCacheFile() const
+void cmDependsC::WriteCacheFile()
 {
-  if (this->CacheFileName.empty()) {
+  if (this->CacheFileName.empty() || !this->CacheModified) {
+    return;
+  }
+
+#ifndef CMAKE_BOOTSTRAP
+  // Other targets in the directory may update the cache concurrently.
+  // Serialize the updates so that none of them is lost.
+  std::string const lockFile = cmStrCat(this->CacheFileName, ".lock");
+  if (!cmSystemTools::FileExists(lockFile, true)) {
+    cmSystemTools::Touch(lockFile, true);
+  }
+  cmFileLock lock;
+  cmFileLockResult const lockResult =
+    lock.Lock(lockFile, static_cast<unsigned long>(-1));
+  if (!lockResult.IsOk()) {
+    // Without the lock, the entries of another target written meanwhile
+    // could be lost.  The cache only saves rescanning, so skip the update.
     return;
   }
-  cmsys::ofstream cacheOut(this->CacheFileName.c_str());
+#endif
+
+  // Keep the entries written since this cache was loaded.  Entries of
+  // this instance are at least as recent, so they are kept too.
+  this->ReadCacheFile(this->FileCache);
+
+  // Replace the cache atomically so readers never see a partial file.
+  cmGeneratedFileStream cacheOut(this->CacheFileName);
   if (!cacheOut) {
     return;
   }
 
-  cacheOut << this->IncludeRegexLineString << "\n\n";
-  cacheOut << this->IncludeRegexScanString << "\n\n";
-  cacheOut << this->IncludeRegexComplainString << "\n\n";
-  cacheOut << this->IncludeRegexTransformString << "\n\n";
+  cacheOut << this->IncludeRegexLineString << '\n'
+           << this->IncludeRegexScanString << '\n'
+           << this->IncludeRegexComplainString << '\n'
+           << this->IncludeRegexTransformString << '\n';
 
+  std::vector<std::string const*> files;
+  files.reserve(this->FileCache.size());
   for (auto const& fileIt : this->FileCache) {
-    if (fileIt.second.Used) {
-      cacheOut << fileIt.first << '\n';
-
-      for (UnscannedEntry const& inc : fileIt.second.UnscannedEntries) {
-        cacheOut << inc.FileName << '\n';
-        if (inc.QuotedLocation.empty()) {
-          cacheOut << '-' << '\n';
-        } else {
-          cacheOut << inc.QuotedLocation << '\n';
-        }
+    files.push_back(&fileIt.first);
+  }
+  std::sort(files.begin(), files.end(),
+            [](std::string const* l, std::string const* r) -> bool {
+              return *l < *r;
+            });
+  for (std::string const* file : files) {
+    cmIncludeLines const& lines = this->FileCache.at(*file);
+    cacheOut << '\n' << *file << '\n' << lines.Time << '\n';
+    for (UnscannedEntry const& inc : lines.UnscannedEntries) {
+      cacheOut << inc.FileName << '\n';
+      if (inc.QuotedLocation.empty()) {
+        cacheOut << '-' << '\n';
+      } else {
+        cacheOut << inc.QuotedLocation << '\n';
       }
-      cacheOut << '\n';
     }
   }
 }
 
-void cmDependsC::Scan(std::istream& is, std::string const& directory,
-                      std::string const& fullName)
+bool cmDependsC::Scan(std::string const& fullName, Matchers& regex,
+                      cmIncludeLines& lines) const
 {
-  cmIncludeLines& newCacheEntry = this->FileCache[fullName];
-  newCacheEntry.Used = true;
+  // Record the time before reading so a concurrent change is noticed
+  // by the next scan.
+  cmFileTime fileTime;
+  std::string content;
+  if (!fileTime.Load(fullName) || !ReadFileContent(fullName, content)) {
+    return false;
+  }
+  lines.Time = fileTime.GetTime();
+
+  // Pass the directory containing the file to handle double-quote
+  // includes.
+  std::string const directory = cmSystemTools::GetFilenamePath(fullName);
+  std::string transformed;
 
   // Read one line at a time.
-  std::string line;
-  while (cmSystemTools::GetLineFromStream(is, line)) {
+  std::size_t pos = 0;
+  while (pos < content.size()) {
+    std::size_t eol = content.find('\n', pos);
+    if (eol == std::string::npos) {
+      eol = content.size();
+    }
+    cm::string_view line(content.data() + pos, eol - pos);
+    pos = eol + 1;
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+
     // Transform the line content first.
     if (!this->TransformRules.empty()) {
-      this->TransformLine(line);
+      transformed.assign(line.data(), line.size());
+      this->TransformLine(regex, transformed);
+      line = transformed;
     }
 
     // Match include directives.
-    if (this->IncludeRegexLine.find(line)) {
-      // Get the file being included.
-      UnscannedEntry entry;
-      entry.FileName = this->IncludeRegexLine.match(2);
-      cmSystemTools::ConvertToUnixSlashes(entry.FileName);
-      if (this->IncludeRegexLine.match(3) == "\"" &&
-          !cmSystemTools::FileIsFullPath(entry.FileName)) {
-        // This was a double-quoted include with a relative path.  We
-        // must check for the file in the directory containing the
-        // file we are scanning.
-        entry.QuotedLocation =
-          cmSystemTools::CollapseFullPath(entry.FileName, directory);
-      }
+    cm::string_view name;
+    char close;
+    if (!MatchIncludeLine(line, name, close)) {
+      continue;
+    }
 
-      // Queue the file if it has not yet been encountered and it
-      // matches the regular expression for recursive scanning.  Note
-      // that this check does not account for the possibility of two
-      // headers with the same name in different directories when one
-      // is included by double-quotes and the other by angle brackets.
-      // It also does not work properly if two header files with the same
-      // name exist in different directories, and both are included from a
-      // file their own directory by simply using "filename.h" (#12619)
-      // This kind of problem will be fixed when a more
-      // preprocessor-like implementation of this scanner is created.
-      if (this->IncludeRegexScan.find(entry.FileName)) {
-        newCacheEntry.UnscannedEntries.push_back(entry);
-        if (this->Encountered.find(entry.FileName) ==
-            this->Encountered.end()) {
-          this->Encountered.insert(entry.FileName);
-          this->Unscanned.push(entry);
-        }
-      }
+    // Get the file being included.
+    UnscannedEntry entry;
+    entry.FileName = std::string(name);
+    cmSystemTools::ConvertToUnixSlashes(entry.FileName);
+    if (close == '"' && !cmSystemTools::FileIsFullPath(entry.FileName)) {
+      // This was a double-quoted include with a relative path.  We
+      // must check for the file in the directory containing the
+      // file we are scanning.
+      entry.QuotedLocation =
+        cmSystemTools::CollapseFullPath(entry.FileName, directory);
+    }
+
+    // Queue the file if it matches the regular expression for recursive
+    // scanning.  Note that this check does not account for the
+    // possibility of two headers with the same name in different
+    // directories when one is included by double-quotes and the other by
+    // angle brackets.  It also does not work properly if two header files
+    // with the same name exist in different directories, and both are
+    // included from a file their own directory by simply using
+    // "filename.h" (#12619) This kind of problem will be fixed when a
+    // more preprocessor-like implementation of this scanner is created.
+    if (regex.IncludeRegexScan.find(entry.FileName)) {
+      lines.UnscannedEntries.push_back(std::move(entry));
     }
   }
+  return true;
 }
 
 void cmDependsC::SetupTransforms()
@@ -413,7 +631,7 @@ void cmDependsC::SetupTransforms()
       sep = "|";
     }
     xform += ")[ \t]*\\(([^),]*)\\)";
-    this->IncludeRegexTransform.compile(xform);
+    this->Regex.IncludeRegexTransform.compile(xform);
 
     // Build a string that encodes all transformation rules and will
     // change when rules are changed.
@@ -440,20 +658,20 @@ void cmDependsC::ParseTransform(std::string const& xform)
   this->TransformRules[name] = value;
 }
 
-void cmDependsC::TransformLine(std::string& line)
+void cmDependsC::TransformLine(Matchers& regex, std::string& line) const
 {
   // Check for a transform rule match.  Return if none.
-  if (!this->IncludeRegexTransform.find(line)) {
+  if (!regex.IncludeRegexTransform.find(line)) {
     return;
   }
-  auto tri = this->TransformRules.find(this->IncludeRegexTransform.match(3));
+  auto tri = this->TransformRules.find(regex.IncludeRegexTransform.match(3));
   if (tri == this->TransformRules.end()) {
     return;
   }
 
   // Construct the transformed line.
-  std::string newline = this->IncludeRegexTransform.match(1);
-  std::string arg = this->IncludeRegexTransform.match(4);
+  std::string newline = regex.IncludeRegexTransform.match(1);
+  std::string arg = regex.IncludeRegexTransform.match(4);
   for (char c : tri->second) {
     if (c == '%') {
       newline += arg;
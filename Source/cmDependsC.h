@@ -6,14 +6,16 @@
 
 #include <iosfwd>
 #include <map>
-#include <queue>
+#include <mutex>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cmsys/RegularExpression.hxx"
 
 #include "cmDepends.h"
+#include "cmFileTime.h"
 
 class cmLocalUnixMakefileGenerator3;
 
@@ -37,33 +39,32 @@ public:
 
 protected:
   // Implement writing/checking methods required by superclass.
-  bool WriteDependencies(std::set<std::string> const& sources,
-                         std::string const& obj, std::ostream& makeDepends,
-                         std::ostream& internalDepends) override;
-
-  // Method to scan a single file.
-  void Scan(std::istream& is, std::string const& directory,
-            std::string const& fullName);
-
-  // Regular expression to identify C preprocessor include directives.
-  cmsys::RegularExpression IncludeRegexLine;
+  bool WriteAllDependencies(ObjectSourcesMap const& objects,
+                            std::ostream& makeDepends,
+                            std::ostream& internalDepends) override;
 
   // Regular expressions to choose which include files to scan
-  // recursively and which to complain about not finding.
-  cmsys::RegularExpression IncludeRegexScan;
-  cmsys::RegularExpression IncludeRegexComplain;
+  // recursively and which to complain about not finding, and to
+  // transform #include lines.  Matching modifies a regular expression,
+  // so each scanning thread uses its own copy.
+  struct Matchers
+  {
+    cmsys::RegularExpression IncludeRegexScan;
+    cmsys::RegularExpression IncludeRegexComplain;
+    cmsys::RegularExpression IncludeRegexTransform;
+  };
+  Matchers Regex;
   std::string IncludeRegexLineString;
   std::string IncludeRegexScanString;
   std::string IncludeRegexComplainString;
-
-  // Regex to transform #include lines.
   std::string IncludeRegexTransformString;
-  cmsys::RegularExpression IncludeRegexTransform;
+
+  // Rules to transform #include lines.
   using TransformRulesType = std::map<std::string, std::string>;
   TransformRulesType TransformRules;
   void SetupTransforms();
   void ParseTransform(std::string const& xform);
-  void TransformLine(std::string& line);
+  void TransformLine(Matchers& regex, std::string& line) const;
 
 public:
   // Data structures for dependency graph walk.
@@ -76,19 +77,56 @@ public:
   struct cmIncludeLines
   {
     std::vector<UnscannedEntry> UnscannedEntries;
-    bool Used = false;
+    // Modification time of the file when it was scanned.
+    cmFileTime::TimeType Time = 0;
   };
 
 protected:
   DependencyMap const* ValidDeps = nullptr;
-  std::set<std::string> Encountered;
-  std::queue<UnscannedEntry> Unscanned;
 
-  std::map<std::string, cmIncludeLines> FileCache;
-  std::map<std::string, std::string> HeaderLocationCache;
+  // Walk the dependency graph of one object starting with its sources.
+  // This may be called concurrently.  On failure, 'missing' names the
+  // include file that could not be found.
+  bool ScanObject(std::set<std::string> const& sources, Matchers& regex,
+                  std::set<std::string>& dependencies, std::string& missing);
+
+  // Find the file named by an include directive.  Returns nullptr if it
+  // does not exist.
+  std::string const* FindFile(UnscannedEntry const& entry);
+
+  // Get the include lines of a file, scanning it if it is not cached.
+  // Returns nullptr if the file cannot be read.
+  cmIncludeLines const* GetIncludeLines(std::string const& fullName,
+                                        Matchers& regex);
+
+  // Method to scan a single file.
+  bool Scan(std::string const& fullName, Matchers& regex,
+            cmIncludeLines& lines) const;
+
+  void WriteObjectDependencies(std::string const& obj_i,
+                               std::set<std::string> const& dependencies,
+                               std::ostream& makeDepends,
+                               std::ostream& internalDepends);
+
+  // Include lines of the files in the current directory, shared with
+  // its other targets through the cache file.  Guarded by CacheMutex while
+  // objects are scanned concurrently.
+  std::unordered_map<std::string, cmIncludeLines> FileCache;
+  std::unordered_map<std::string, std::string> HeaderLocationCache;
+  std::unordered_map<std::string, bool> QuotedLocationCache;
+  std::mutex CacheMutex;
+  bool CacheModified = false;
 
   std::string CacheFileName;
 
-  void WriteCacheFile() const;
-  void ReadCacheFile();
+  // Dependencies converted to paths for the makefile.
+  std::unordered_map<std::string, std::string> MakefilePaths;
+
+  // Write the cache file, merged with entries written by other targets
+  // since it was read.
+  void WriteCacheFile();
+  // Add the valid entries of the cache file to the given map, keeping
+  // entries already present.  Returns false if any entry was dropped.
+  bool ReadCacheFile(
+    std::unordered_map<std::string, cmIncludeLines>& cache) const;
 };
@@ -4,8 +4,13 @@
 #include "cmDependsCompiler.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <ios>
 #include <map>
+#include <ostream>
 #include <string>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 
@@ -24,6 +29,172 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+namespace {
+
+/*
+ * The consolidated dependencies of a target are stored in a small
+ * binary database, in native byte order since it never leaves the build
+ * tree.  Every path is stored once, NUL-terminated, in a string table,
+ * and each depender lists its dependees as indices into that table:
+ *
+ *   char     magic[8]
+ *   uint32   number of strings
+ *   char     strings[]            (each NUL-terminated)
+ *   uint32   number of dependers
+ *   { uint32 depender, uint32 count, uint32 dependees[count] }...
+ */
+char const DatabaseMagic[8] = { 'C', 'M', 'D', 'E', 'P', 'D', 'B', '1' };
+
+class DatabaseReader
+{
+public:
+  explicit DatabaseReader(std::string const& data)
+    : Next(data.data())
+    , End(data.data() + data.size())
+  {
+  }
+
+  bool ReadMagic()
+  {
+    if (static_cast<std::size_t>(this->End - this->Next) <
+          sizeof(DatabaseMagic) ||
+        std::memcmp(this->Next, DatabaseMagic, sizeof(DatabaseMagic)) != 0) {
+      return false;
+    }
+    this->Next += sizeof(DatabaseMagic);
+    return true;
+  }
+
+  bool ReadCount(std::uint32_t& value)
+  {
+    if (static_cast<std::size_t>(this->End - this->Next) < sizeof(value)) {
+      return false;
+    }
+    std::memcpy(&value, this->Next, sizeof(value));
+    this->Next += sizeof(value);
+    return true;
+  }
+
+  bool ReadString(cm::string_view& value)
+  {
+    char const* nul = static_cast<char const*>(std::memchr(
+      this->Next, 0, static_cast<std::size_t>(this->End - this->Next)));
+    if (!nul) {
+      return false;
+    }
+    value = cm::string_view(this->Next,
+                            static_cast<std::size_t>(nul - this->Next));
+    this->Next = nul + 1;
+    return true;
+  }
+
+  bool AtEnd() const { return this->Next == this->End; }
+
+private:
+  char const* Next;
+  char const* End;
+};
+
+} // anonymous namespace
+
+bool cmDependsCompiler::ReadDatabase(std::string const& path,
+                                     cmDepends::DependencyMap& dependencies)
+{
+  std::string data;
+  {
+    cmsys::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+    if (!fin) {
+      return false;
+    }
+    fin.seekg(0, std::ios::end);
+    std::streamoff const size = fin.tellg();
+    if (size <= 0) {
+      return false;
+    }
+    data.resize(static_cast<std::size_t>(size));
+    fin.seekg(0, std::ios::beg);
+    if (!fin.read(&data[0], size)) {
+      return false;
+    }
+  }
+
+  DatabaseReader reader(data);
+  std::uint32_t stringCount;
+  if (!reader.ReadMagic() || !reader.ReadCount(stringCount)) {
+    return false;
+  }
+  std::vector<cm::string_view> strings;
+  strings.reserve(std::min<std::size_t>(stringCount, data.size()));
+  for (std::uint32_t i = 0; i < stringCount; ++i) {
+    cm::string_view s;
+    if (!reader.ReadString(s)) {
+      return false;
+    }
+    strings.push_back(s);
+  }
+
+  std::uint32_t dependerCount;
+  if (!reader.ReadCount(dependerCount)) {
+    return false;
+  }
+  for (std::uint32_t i = 0; i < dependerCount; ++i) {
+    std::uint32_t depender;
+    std::uint32_t count;
+    if (!reader.ReadCount(depender) || !reader.ReadCount(count) ||
+        depender >= strings.size()) {
+      return false;
+    }
+    auto& dependees = dependencies[std::string(strings[depender])];
+    dependees.reserve(std::min<std::size_t>(count, data.size()));
+    for (std::uint32_t j = 0; j < count; ++j) {
+      std::uint32_t dependee;
+      if (!reader.ReadCount(dependee) || dependee >= strings.size()) {
+        return false;
+      }
+      dependees.emplace_back(strings[dependee]);
+    }
+  }
+  return reader.AtEnd();
+}
+
+void cmDependsCompiler::WriteDatabase(
+  cmDepends::DependencyMap const& dependencies, std::ostream& out)
+{
+  std::unordered_map<cm::string_view, std::uint32_t> index;
+  std::vector<cm::string_view> strings;
+  auto intern = [&index, &strings](std::string const& s) -> std::uint32_t {
+    auto const inserted =
+      index.emplace(s, static_cast<std::uint32_t>(strings.size()));
+    if (inserted.second) {
+      strings.emplace_back(s);
+    }
+    return inserted.first->second;
+  };
+
+  std::vector<std::uint32_t> adjacency;
+  for (auto const& node : dependencies) {
+    adjacency.push_back(intern(node.first));
+    adjacency.push_back(static_cast<std::uint32_t>(node.second.size()));
+    for (auto const& dep : node.second) {
+      adjacency.push_back(intern(dep));
+    }
+  }
+
+  auto writeCount = [&out](std::size_t n) {
+    std::uint32_t const value = static_cast<std::uint32_t>(n);
+    out.write(reinterpret_cast<char const*>(&value), sizeof(value));
+  };
+  out.write(DatabaseMagic, sizeof(DatabaseMagic));
+  writeCount(strings.size());
+  for (cm::string_view s : strings) {
+    out.write(s.data(), s.size());
+    out.put('\0');
+  }
+  writeCount(dependencies.size());
+  out.write(reinterpret_cast<char const*>(adjacency.data()),
+            adjacency.size() * sizeof(std::uint32_t));
+}
+
 bool cmDependsCompiler::CheckDependencies(
   std::string const& internalDepFile, std::vector<std::string> const& depFiles,
   cmDepends::DependencyMap& dependencies,
@@ -33,151 +204,136 @@ bool cmDependsCompiler::CheckDependencies(
   bool forceReadDeps = true;
 
   cmFileTime internalDepFileTime;
-  // read cached dependencies stored in internal file
-  if (cmSystemTools::FileExists(internalDepFile)) {
-    internalDepFileTime.Load(internalDepFile);
+  if (internalDepFileTime.Load(internalDepFile)) {
     forceReadDeps = false;
+  }
 
-    // read current dependencies
-    cmsys::ifstream fin(internalDepFile.c_str());
-    if (fin) {
-      std::string line;
-      std::string depender;
-      std::vector<std::string>* currentDependencies = nullptr;
-      while (std::getline(fin, line)) {
-        if (line.empty() || line.front() == '#') {
-          continue;
-        }
-        // Drop carriage return character at the end
-        if (line.back() == '\r') {
-          line.pop_back();
-          if (line.empty()) {
-            continue;
-          }
-        }
-        // Check if this a depender line
-        if (line.front() != ' ') {
-          depender = std::move(line);
-          currentDependencies = &dependencies[depender];
-          continue;
-        }
-        // This is a dependee line
-        if (currentDependencies) {
-          currentDependencies->emplace_back(line.substr(1));
-        }
+  // Find the compiler generated dependencies files that are newer than
+  // the consolidated dependencies.  In the common case there are none,
+  // and the consolidated dependencies need not be read at all.
+  std::vector<std::size_t> changedDepFiles;
+  cmFileTime depFileTime;
+  for (std::size_t i = 0; i + 3 < depFiles.size(); i += 4) {
+    if (depFileTime.Load(depFiles[i + 3]) &&
+        (forceReadDeps || depFileTime.Compare(internalDepFileTime) >= 0)) {
+      changedDepFiles.push_back(i);
+    }
+  }
+  if (changedDepFiles.empty()) {
+    return status;
+  }
+
+  // read cached dependencies stored in internal file
+  if (!forceReadDeps && !ReadDatabase(internalDepFile, dependencies)) {
+    // The database is unreadable, perhaps written by another version.
+    // Start over from the dependencies files of all sources.
+    dependencies.clear();
+    changedDepFiles.clear();
+    for (std::size_t i = 0; i + 3 < depFiles.size(); i += 4) {
+      if (cmSystemTools::FileExists(depFiles[i + 3])) {
+        changedDepFiles.push_back(i);
       }
-      fin.close();
     }
   }
 
   // Now, update dependencies map with all new compiler generated
   // dependencies files
-  cmFileTime depFileTime;
-  for (auto dep = depFiles.begin(); dep != depFiles.end(); dep++) {
-    auto const& source = *dep++;
-    auto const& target = *dep++;
-    auto const& format = *dep++;
-    auto const& depFile = *dep;
+  for (std::size_t i : changedDepFiles) {
+    auto const& source = depFiles[i];
+    auto const& target = depFiles[i + 1];
+    auto const& format = depFiles[i + 2];
+    auto const& depFile = depFiles[i + 3];
 
-    if (!cmSystemTools::FileExists(depFile)) {
-      continue;
+    status = false;
+    if (this->Verbose) {
+      cmSystemTools::Stdout(cmStrCat("Dependencies file \"", depFile,
+                                     "\" is newer than depends file \"",
+                                     internalDepFile, "\".\n"));
     }
 
-    if (!forceReadDeps) {
-      depFileTime.Load(depFile);
-    }
-    if (forceReadDeps || depFileTime.Compare(internalDepFileTime) >= 0) {
-      status = false;
-      if (this->Verbose) {
-        cmSystemTools::Stdout(cmStrCat("Dependencies file \"", depFile,
-                                       "\" is newer than depends file \"",
-                                       internalDepFile, "\".\n"));
+    std::vector<std::string> depends;
+    if (format == "custom"_s) {
+      auto deps = cmReadGccDepfile(
+        depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory());
+      if (!deps) {
+        continue;
+      }
+
+      for (auto& entry : *deps) {
+        depends = std::move(entry.paths);
+        if (isValidPath) {
+          cm::erase_if(depends, isValidPath);
+        }
+        // copy depends for each target, except first one, which can be
+        // moved
+        for (auto index = entry.rules.size() - 1; index > 0; --index) {
+          dependencies[entry.rules[index]] = depends;
+        }
+        dependencies[entry.rules.front()] = std::move(depends);
       }
+    } else {
+      if (format == "msvc"_s) {
+        cmsys::ifstream fin(depFile.c_str());
+        if (!fin) {
+          continue;
+        }
 
-      std::vector<std::string> depends;
-      if (format == "custom"_s) {
+        std::string line;
+        if (!isValidPath && !source.empty()) {
+          // insert source as first dependency
+          depends.push_back(source);
+        }
+        while (cmSystemTools::GetLineFromStream(fin, line)) {
+          depends.emplace_back(std::move(line));
+        }
+      } else if (format == "gcc"_s) {
         auto deps = cmReadGccDepfile(
-          depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory());
+          depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory(),
+          GccDepfilePrependPaths::Deps);
         if (!deps) {
           continue;
         }
 
-        for (auto& entry : *deps) {
-          depends = std::move(entry.paths);
-          if (isValidPath) {
-            cm::erase_if(depends, isValidPath);
-          }
-          // copy depends for each target, except first one, which can be
-          // moved
-          for (auto index = entry.rules.size() - 1; index > 0; --index) {
-            dependencies[entry.rules[index]] = depends;
-          }
-          dependencies[entry.rules.front()] = std::move(depends);
+        // dependencies generated by the compiler contains only one target
+        depends = std::move(deps->front().paths);
+        if (depends.empty()) {
+          // unexpectedly empty, ignore it and continue
+          continue;
         }
-      } else {
-        if (format == "msvc"_s) {
-          cmsys::ifstream fin(depFile.c_str());
-          if (!fin) {
-            continue;
-          }
 
-          std::string line;
-          if (!isValidPath && !source.empty()) {
-            // insert source as first dependency
-            depends.push_back(source);
-          }
-          while (cmSystemTools::GetLineFromStream(fin, line)) {
-            depends.emplace_back(std::move(line));
-          }
-        } else if (format == "gcc"_s) {
-          auto deps = cmReadGccDepfile(
-            depFile.c_str(), this->LocalGenerator->GetCurrentBinaryDirectory(),
-            GccDepfilePrependPaths::Deps);
-          if (!deps) {
-            continue;
-          }
-
-          // dependencies generated by the compiler contains only one target
-          depends = std::move(deps->front().paths);
-          if (depends.empty()) {
-            // unexpectedly empty, ignore it and continue
-            continue;
-          }
-
-          // depending of the effective format of the dependencies file
-          // generated by the compiler, the target can be wrongly identified
-          // as a dependency so remove it from the list
-          if (depends.front() == target) {
-            depends.erase(depends.begin());
-          }
+        // depending of the effective format of the dependencies file
+        // generated by the compiler, the target can be wrongly identified
+        // as a dependency so remove it from the list
+        if (depends.front() == target) {
+          depends.erase(depends.begin());
+        }
 
-          // ensure source file is the first dependency
-          if (!source.empty()) {
-            if (depends.front() != source) {
-              cm::erase(depends, source);
-              if (!isValidPath) {
-                depends.insert(depends.begin(), source);
-              }
-            } else if (isValidPath) {
-              // remove first dependency because it must not be filtered out
-              depends.erase(depends.begin());
+        // ensure source file is the first dependency
+        if (!source.empty()) {
+          if (depends.front() != source) {
+            cm::erase(depends, source);
+            if (!isValidPath) {
+              depends.insert(depends.begin(), source);
             }
+          } else if (isValidPath) {
+            // remove first dependency because it must not be filtered out
+            depends.erase(depends.begin());
           }
-        } else {
-          // unknown format, ignore it
-          continue;
         }
+      } else {
+        // unknown format, ignore it
+        continue;
+      }
 
-        if (isValidPath) {
-          cm::erase_if(depends, isValidPath);
-          if (!source.empty()) {
-            // insert source as first dependency
-            depends.insert(depends.begin(), source);
-          }
+      if (isValidPath) {
+        cm::erase_if(depends, isValidPath);
+        if (!source.empty()) {
+          // insert source as first dependency
+          depends.insert(depends.begin(), source);
         }
-
-        dependencies[target] = std::move(depends);
       }
+
+      dependencies[target] = std::move(depends);
     }
   }
 
@@ -195,25 +351,32 @@ void cmDependsCompiler::WriteDependencies(
   bool supportLongLineDepend = static_cast<cmGlobalUnixMakefileGenerator3*>(
                                  this->LocalGenerator->GetGlobalGenerator())
                                  ->SupportsLongLineDependencies();
-  cmDepends::DependencyMap makeDependencies(dependencies);
+  // Many sources share the same headers.  Convert each path once.
+  std::unordered_map<cm::string_view, std::string> makePaths;
+  auto convert = [this, &makePaths](std::string const& path)
+    -> std::string const& {
+    auto it = makePaths.find(path);
+    if (it == makePaths.end()) {
+      it = makePaths
+             .emplace(path,
+                      this->LocalGenerator->ConvertToMakefilePath(
+                        this->LocalGenerator->MaybeRelativeToTopBinDir(path)))
+             .first;
+    }
+    return it->second;
+  };
   std::unordered_set<cm::string_view> phonyTargets;
 
   // external dependencies file
-  for (auto& node : makeDependencies) {
-    auto target = this->LocalGenerator->ConvertToMakefilePath(
-      this->LocalGenerator->MaybeRelativeToTopBinDir(node.first));
-    auto& deps = node.second;
-    std::transform(deps.cbegin(), deps.cend(), deps.begin(),
-                   [this](std::string const& dep) {
-                     return this->LocalGenerator->ConvertToMakefilePath(
-                       this->LocalGenerator->MaybeRelativeToTopBinDir(dep));
-                   });
+  for (auto const& node : dependencies) {
+    auto const& target = convert(node.first);
 
     bool first_dep = true;
     if (supportLongLineDepend) {
       makeDepends << target << ": ";
     }
-    for (auto const& dep : deps) {
+    for (auto const& dependee : node.second) {
+      auto const& dep = convert(dependee);
       if (supportLongLineDepend) {
         if (first_dep) {
           first_dep = false;
@@ -225,7 +388,7 @@ void cmDependsCompiler::WriteDependencies(
         makeDepends << target << ": " << dep << std::endl;
       }
 
-      phonyTargets.emplace(dep.data(), dep.length());
+      phonyTargets.emplace(dep);
     }
     makeDepends << std::endl << std::endl;
   }
@@ -235,14 +398,8 @@ void cmDependsCompiler::WriteDependencies(
     makeDepends << std::endl << target << ':' << std::endl;
   }
 
-  // internal dependencies file
-  for (auto const& node : dependencies) {
-    internalDepends << node.first << std::endl;
-    for (auto const& dep : node.second) {
-      internalDepends << ' ' << dep << std::endl;
-    }
-    internalDepends << std::endl;
-  }
+  // internal dependencies database
+  WriteDatabase(dependencies, internalDepends);
 }
 
 void cmDependsCompiler::ClearDependencies(
@@ -39,14 +39,16 @@ public:
 
   /** Read dependencies for the target file. Return true if
       dependencies didn't changed and false if not.
-      Up-to-date Dependencies will be stored in deps. */
+      If they changed, up-to-date dependencies will be stored in deps.
+      The consolidated dependencies are not read if they are current.  */
   bool CheckDependencies(
     std::string const& internalDepFile,
     std::vector<std::string> const& depFiles,
     cmDepends::DependencyMap& dependencies,
     std::function<bool(std::string const&)> const& isValidPath);
 
-  /** Write dependencies for the target file.  */
+  /** Write dependencies for the target file: a makefile fragment for
+      the make tool, and a binary database for CheckDependencies.  */
   void WriteDependencies(cmDepends::DependencyMap const& dependencies,
                          std::ostream& makeDepends,
                          std::ostream& internalDepends);
@@ -54,6 +56,15 @@ public:
   /** Clear dependencies for the target so they will be regenerated.  */
   void ClearDependencies(std::vector<std::string> const& depFiles);
 
+  /** Read the binary database of consolidated dependencies.  Returns
+      false if the file is missing, truncated, or not such a database.  */
+  static bool ReadDatabase(std::string const& path,
+                           cmDepends::DependencyMap& dependencies);
+
+  /** Write the binary database of consolidated dependencies.  */
+  static void WriteDatabase(cmDepends::DependencyMap const& dependencies,
+                            std::ostream& out);
+
 private:
   bool Verbose = false;
   cmLocalUnixMakefileGenerator3* LocalGenerator = nullptr;
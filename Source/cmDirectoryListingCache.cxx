@@ -0,0 +1,313 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmDirectoryListingCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <ratio>
+#include <utility>
+
+#include <cm/optional>
+
+#include "cmsys/Directory.hxx"
+#include "cmsys/FStream.hxx"
+
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+// Bump the last byte whenever the encoding changes.
+char const Magic[8] = { 'C', 'M', 'F', 'D', 'L', 'C', '\0', '\1' };
+
+// A directory modified less than this long before it was read may be
+// modified again without a visible change of its time stamp.
+cmFileTime::TimeType const RacyWindow = 2 * cmFileTime::UtPerS;
+
+cmFileTime::TimeType Now()
+{
+  auto const since = std::chrono::system_clock::now().time_since_epoch();
+#if !defined(_WIN32) || defined(__CYGWIN__)
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(since).count();
+#else
+  // File times count 100ns intervals since 1601-01-01.
+  using FileTimeUnits =
+    std::chrono::duration<cmFileTime::TimeType, std::ratio<1, 10000000>>;
+  return std::chrono::duration_cast<FileTimeUnits>(since).count() +
+    116444736000000000LL;
+#endif
+}
+
+std::string DirectoryKey(std::string dir)
+{
+  while (dir.size() > 1 && dir.back() == '/') {
+    dir.pop_back();
+  }
+  if (!dir.empty() && dir.back() == ':') {
+    // "C:" names the current directory on a drive, not its root.
+    dir += '/';
+  }
+  return dir;
+}
+
+void Write(std::string& out, std::uint32_t value)
+{
+  char buf[sizeof(value)];
+  std::memcpy(buf, &value, sizeof(value));
+  out.append(buf, sizeof(value));
+}
+
+void Write(std::string& out, std::int64_t value)
+{
+  char buf[sizeof(value)];
+  std::memcpy(buf, &value, sizeof(value));
+  out.append(buf, sizeof(value));
+}
+
+void WriteString(std::string& out, std::string const& s)
+{
+  Write(out, static_cast<std::uint32_t>(s.size()));
+  out.append(s);
+}
+
+class Decoder
+{
+public:
+  Decoder(char const* begin, char const* end)
+    : Pos(begin)
+    , End(end)
+  {
+  }
+
+  bool AtEnd() const { return this->Pos == this->End; }
+  std::size_t Remaining() const
+  {
+    return static_cast<std::size_t>(this->End - this->Pos);
+  }
+
+  template <typename T>
+  bool Read(T& value)
+  {
+    if (this->Remaining() < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, this->Pos, sizeof(T));
+    this->Pos += sizeof(T);
+    return true;
+  }
+
+  bool ReadString(std::string& s)
+  {
+    std::uint32_t size;
+    if (!this->Read(size) || this->Remaining() < size) {
+      return false;
+    }
+    s.assign(this->Pos, size);
+    this->Pos += size;
+    return true;
+  }
+
+private:
+  char const* Pos;
+  char const* End;
+};
+
+} // anonymous namespace
+
+cmDirectoryListingCache::cmDirectoryListingCache() = default;
+
+cmDirectoryListingCache::~cmDirectoryListingCache() = default;
+
+void cmDirectoryListingCache::BeginSearch()
+{
+  ++this->Search;
+}
+
+bool cmDirectoryListingCache::MayExist(std::string const& path)
+{
+  std::string::size_type const slash = path.rfind('/');
+  if (slash == std::string::npos) {
+    return true;
+  }
+  std::string name = path.substr(slash + 1);
+  if (name.empty() || name == "." || name == "..") {
+    return true;
+  }
+#if defined(_WIN32)
+  // Short names and names with trailing dots or spaces may refer to
+  // entries listed under another name.
+  if (name.find('~') != std::string::npos || name.back() == '.' ||
+      name.back() == ' ') {
+    return true;
+  }
+#endif
+
+  Entry const* entry =
+    this->Lookup(DirectoryKey(path.substr(0, slash == 0 ? 1 : slash)));
+  if (!entry->Exists) {
+    return false;
+  }
+  if (!entry->Listed) {
+    return true;
+  }
+  if (entry->CaseInsensitive) {
+    return std::binary_search(entry->Folded.begin(), entry->Folded.end(),
+                              cmSystemTools::LowerCase(name));
+  }
+  return std::binary_search(entry->Names.begin(), entry->Names.end(), name);
+}
+
+std::vector<std::string> const* cmDirectoryListingCache::GetNames(
+  std::string const& dir)
+{
+  Entry const* entry = this->Lookup(DirectoryKey(dir));
+  return entry->Listed ? &entry->Names : nullptr;
+}
+
+cmDirectoryListingCache::Entry const* cmDirectoryListingCache::Lookup(
+  std::string const& dir)
+{
+  Entry& entry = this->Entries[dir];
+  if (entry.Search == this->Search) {
+    return &entry;
+  }
+
+  cmFileTime ft;
+  if (!ft.Load(dir)) {
+    entry = Entry();
+  } else if (!entry.Listed || entry.Racy || entry.MTime != ft.GetTime()) {
+    Read(dir, ft.GetTime(), entry);
+    this->Modified = true;
+  }
+  entry.Search = this->Search;
+  return &entry;
+}
+
+void cmDirectoryListingCache::Read(std::string const& dir, long long mtime,
+                                   Entry& entry)
+{
+  entry = Entry();
+  entry.Exists = true;
+  entry.MTime = mtime;
+
+  cmsys::Directory d;
+  if (!d.Load(dir)) {
+    return;
+  }
+  unsigned long const n = d.GetNumberOfFiles();
+  entry.Names.reserve(n);
+  for (unsigned long i = 0; i < n; ++i) {
+    std::string const& f = d.GetFileName(i);
+    if (f != "." && f != "..") {
+      entry.Names.emplace_back(f);
+    }
+  }
+  std::sort(entry.Names.begin(), entry.Names.end());
+
+  entry.Listed = true;
+  entry.Racy = Now() - mtime < RacyWindow;
+  entry.CaseInsensitive = cmSystemTools::GetDirCase(dir) ==
+    cmSystemTools::DirCase::Insensitive;
+  if (entry.CaseInsensitive) {
+    entry.Folded.reserve(entry.Names.size());
+    for (std::string const& name : entry.Names) {
+      entry.Folded.emplace_back(cmSystemTools::LowerCase(name));
+    }
+    std::sort(entry.Folded.begin(), entry.Folded.end());
+  }
+}
+
+void cmDirectoryListingCache::Load(std::string const& cacheFile)
+{
+  cmsys::ifstream fin(cacheFile.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return;
+  }
+  std::string const data((std::istreambuf_iterator<char>(fin)),
+                         std::istreambuf_iterator<char>());
+  if (data.size() < sizeof(Magic) ||
+      std::memcmp(data.data(), Magic, sizeof(Magic)) != 0) {
+    this->Modified = true;
+    return;
+  }
+
+  std::unordered_map<std::string, Entry> entries;
+  Decoder d(data.data() + sizeof(Magic), data.data() + data.size());
+  while (!d.AtEnd()) {
+    std::string dir;
+    std::int64_t mtime;
+    std::uint32_t caseInsensitive;
+    std::uint32_t count;
+    if (!d.ReadString(dir) || !d.Read(mtime) || !d.Read(caseInsensitive) ||
+        !d.Read(count) || count > d.Remaining() / sizeof(count)) {
+      break;
+    }
+    Entry entry;
+    entry.MTime = mtime;
+    entry.Exists = true;
+    entry.Listed = true;
+    entry.CaseInsensitive = caseInsensitive != 0;
+    entry.Names.resize(count);
+    if (!std::all_of(entry.Names.begin(), entry.Names.end(),
+                     [&d](std::string& name) { return d.ReadString(name); }) ||
+        !std::is_sorted(entry.Names.begin(), entry.Names.end())) {
+      break;
+    }
+    if (entry.CaseInsensitive) {
+      for (std::string const& name : entry.Names) {
+        entry.Folded.emplace_back(cmSystemTools::LowerCase(name));
+      }
+      std::sort(entry.Folded.begin(), entry.Folded.end());
+    }
+    entries.emplace(std::move(dir), std::move(entry));
+  }
+
+  if (!d.AtEnd()) {
+    // The file is truncated or corrupt.  Start over.
+    this->Modified = true;
+    return;
+  }
+  for (auto& e : entries) {
+    this->Entries.emplace(e.first, std::move(e.second));
+  }
+}
+
+bool cmDirectoryListingCache::Save(std::string const& cacheFile)
+{
+  std::string out(Magic, sizeof(Magic));
+  for (auto const& e : this->Entries) {
+    Entry const& entry = e.second;
+    if (entry.Search == 0) {
+      // Drop listings of directories this run did not search.
+      this->Modified = true;
+      continue;
+    }
+    if (!entry.Listed || entry.Racy) {
+      continue;
+    }
+    WriteString(out, e.first);
+    Write(out, static_cast<std::int64_t>(entry.MTime));
+    Write(out, static_cast<std::uint32_t>(entry.CaseInsensitive ? 1 : 0));
+    Write(out, static_cast<std::uint32_t>(entry.Names.size()));
+    for (std::string const& name : entry.Names) {
+      WriteString(out, name);
+    }
+  }
+  if (!this->Modified) {
+    return true;
+  }
+
+  cmGeneratedFileStream fout;
+  fout.Open(cacheFile, true, true);
+  fout.write(out.data(), static_cast<std::streamsize>(out.size()));
+  if (!fout.Close()) {
+    return false;
+  }
+  this->Modified = false;
+  return true;
+}
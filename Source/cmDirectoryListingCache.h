@@ -0,0 +1,75 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/** \class cmDirectoryListingCache
+ * \brief Cache the content of directories searched by find commands.
+ *
+ * Find commands probe many candidate file names in the same directories.
+ * This class reads each directory once and answers whether a candidate
+ * may exist from the listing, so that only candidates present in the
+ * listing need to be checked on disk.
+ *
+ * A listing is trusted by the find command that read it.  Later commands
+ * check the modification time of the directory once before using it and
+ * read the directory again if it changed.  Listings of directories that
+ * were modified shortly before they were read are read again by every
+ * command, because a later change may not be visible in the time stamp.
+ *
+ * The listings may be saved to a file and loaded by a later run, which
+ * then only needs to check the modification times of the directories.
+ */
+class cmDirectoryListingCache
+{
+public:
+  cmDirectoryListingCache();
+  ~cmDirectoryListingCache();
+
+  cmDirectoryListingCache(cmDirectoryListingCache const&) = delete;
+  cmDirectoryListingCache& operator=(cmDirectoryListingCache const&) =
+    delete;
+
+  /** Start a new search.  Listings read by earlier searches are checked
+      against the directory modification time before they are used.  */
+  void BeginSearch();
+
+  /** Return false if the given path certainly does not exist.  */
+  bool MayExist(std::string const& path);
+
+  /** Get the names of the entries of a directory, sorted, or nullptr if
+      the directory cannot be read.  */
+  std::vector<std::string> const* GetNames(std::string const& dir);
+
+  /** Load the listings saved by a previous run, if any.  */
+  void Load(std::string const& cacheFile);
+
+  /** Save the listings that a later run may use.  */
+  bool Save(std::string const& cacheFile);
+
+private:
+  struct Entry
+  {
+    long long MTime = 0;
+    unsigned long Search = 0;
+    bool Exists = false;
+    bool Listed = false;
+    bool Racy = false;
+    bool CaseInsensitive = false;
+    std::vector<std::string> Names;
+    // Lower-case names of a case-insensitive directory, sorted.
+    std::vector<std::string> Folded;
+  };
+
+  Entry const* Lookup(std::string const& dir);
+  static void Read(std::string const& dir, long long mtime, Entry& entry);
+
+  unsigned long Search = 1;
+  bool Modified = false;
+  std::unordered_map<std::string, Entry> Entries;
+};
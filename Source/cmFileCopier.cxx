@@ -8,9 +8,13 @@
 
 #include "cmExecutionStatus.h"
 #include "cmFSPermissions.h"
+#include "cmFileTime.h"
 #include "cmFileTimes.h"
+#include "cmInstallHashManifest.h"
 #include "cmList.h"
 #include "cmMakefile.h"
+#include "cmMessageType.h"
+#include "cmParallelFor.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmValue.h"
@@ -23,9 +27,13 @@
 #  include <cerrno>
 #endif
 
+#include <atomic>
+#include <cstddef>
 #include <cstring>
 #include <sstream>
 
+#include <cm/optional>
+
 using namespace cmFSPermissions;
 
 cmFileCopier::cmFileCopier(cmExecutionStatus& status, char const* name)
@@ -47,14 +55,18 @@ cmFileCopier::MatchProperties cmFileCopier::CollectMatchProperties(
   std::string const& file_to_match = file;
 #endif
 
-  // Collect properties from all matching rules.
+  // Collect properties from all matching rules.  The excluding rules
+  // come first, and the permissions of an excluded file do not matter.
   bool matched = false;
   MatchProperties result;
   for (MatchRule& mr : this->MatchRules) {
-    if (mr.Regex.find(file_to_match)) {
+    if (mr.Matches(file_to_match)) {
       matched = true;
       result.Exclude |= mr.Properties.Exclude;
       result.Permissions |= mr.Properties.Permissions;
+      if (result.Exclude) {
+        break;
+      }
     }
   }
   if (!matched && !this->MatchlessFiles) {
@@ -63,6 +75,38 @@ cmFileCopier::MatchProperties cmFileCopier::CollectMatchProperties(
   return result;
 }
 
+void cmFileCopier::MatchRule::SetPattern(std::string const& pattern)
+{
+  std::string::size_type const start =
+    (!pattern.empty() && pattern[0] == '*') ? 1 : 0;
+  if (pattern.find_first_of("*?[\\/", start) != std::string::npos) {
+    return;
+  }
+  this->Kind = start ? MatchSuffix : MatchName;
+  this->Suffix = pattern.substr(start);
+  if (this->Kind == MatchName) {
+    this->Suffix.insert(0, 1, '/');
+  }
+#if defined(_WIN32) || defined(__APPLE__) || defined(__CYGWIN__)
+  this->Suffix = cmSystemTools::LowerCase(this->Suffix);
+#endif
+}
+
+bool cmFileCopier::MatchRule::Matches(std::string const& file)
+{
+  switch (this->Kind) {
+    case MatchName:
+      return cmHasSuffix(file, this->Suffix);
+    case MatchSuffix:
+      // The suffix must follow a slash and contains none itself.
+      return cmHasSuffix(file, this->Suffix) &&
+        file.find('/') < file.size() - this->Suffix.size();
+    case MatchRegex:
+      break;
+  }
+  return this->Regex.find(file);
+}
+
 bool cmFileCopier::SetPermissions(std::string const& toFile,
                                   mode_t permissions)
 {
@@ -221,6 +265,13 @@ bool cmFileCopier::Parse(std::vector<std::string> const& args)
     this->DefaultDirectoryPermissions();
   }
 
+  // Check the excluding rules first.  Properties of all matching rules
+  // are combined, so the order does not matter otherwise.
+  this->CurrentMatchRule = nullptr;
+  std::stable_partition(
+    this->MatchRules.begin(), this->MatchRules.end(),
+    [](MatchRule const& mr) { return mr.Properties.Exclude; });
+
   return true;
 }
 
@@ -335,6 +386,7 @@ bool cmFileCopier::CheckValue(std::string const& arg)
       this->MatchRules.emplace_back(regex);
       this->CurrentMatchRule = &*(this->MatchRules.end() - 1);
       if (this->CurrentMatchRule->Regex.is_valid()) {
+        this->CurrentMatchRule->SetPattern(arg);
         this->Doing = DoingNone;
       } else {
         std::ostringstream e;
@@ -383,6 +435,12 @@ bool cmFileCopier::Run(std::vector<std::string> const& args)
     return false;
   }
 
+  // With a hash manifest the files are examined and copied on threads,
+  // like the files of a directory tree.
+  if (this->HashManifest) {
+    ++this->DirectoryDepth;
+  }
+  bool okay = true;
   for (std::string const& f : this->Files) {
     std::string file;
     if (!f.empty() && !cmSystemTools::FileIsFullPath(f)) {
@@ -396,7 +454,8 @@ bool cmFileCopier::Run(std::vector<std::string> const& args)
     } else if (!this->FilesFromDir.empty()) {
       this->Status.SetError("option FILES_FROM_DIR requires all files "
                             "to be specified as relative paths.");
-      return false;
+      okay = false;
+      break;
     } else {
       file = f;
     }
@@ -432,10 +491,15 @@ bool cmFileCopier::Run(std::vector<std::string> const& args)
     }
 
     if (!this->Install(fromFile, toFile)) {
-      return false;
+      okay = false;
+      break;
     }
   }
-  return true;
+  if (this->HashManifest) {
+    --this->DirectoryDepth;
+    return this->FinishDirectoryTree(std::string(), okay) && okay;
+  }
+  return okay;
 }
 
 bool cmFileCopier::Install(std::string const& fromFile,
@@ -502,7 +566,7 @@ bool cmFileCopier::InstallSymlinkChain(std::string& fromFile,
       }
     }
 
-    this->ReportCopy(toFile, TypeLink, copy);
+    this->ReportCopyOrDefer(toFile, TypeLink, copy);
 
     if (copy) {
       cmSystemTools::RemoveFile(toFile);
@@ -554,7 +618,7 @@ bool cmFileCopier::InstallSymlink(std::string const& fromFile,
   }
 
   // Inform the user about this file installation.
-  this->ReportCopy(toFile, TypeLink, copy);
+  this->ReportCopyOrDefer(toFile, TypeLink, copy);
 
   if (copy) {
     // Remove the destination file so we can always create the symlink.
@@ -593,15 +657,26 @@ bool cmFileCopier::InstallFile(std::string const& fromFile,
                                std::string const& toFile,
                                MatchProperties match_properties)
 {
-  // Determine whether we will copy the file.
+  // Determine whether we will copy the file.  With a hash manifest this
+  // is decided when the file is examined.
   bool copy = true;
-  if (!this->Always) {
+  if (!this->Always && !this->HashManifest) {
     // If both files exist with the same time do not copy.
     if (!this->FileTimes.DifferS(fromFile, toFile)) {
       copy = false;
     }
   }
 
+  // Report and set the permissions after copying the whole directory tree.
+  mode_t permissions =
+    (match_properties.Permissions ? match_properties.Permissions
+                                  : this->FilePermissions);
+  if (this->DirectoryDepth > 0) {
+    this->DeferredFiles.push_back(DeferredFile{
+      TypeFile, fromFile, toFile, permissions, copy, std::string() });
+    return true;
+  }
+
   // Inform the user about this file installation.
   this->ReportCopy(toFile, TypeFile, copy);
 
@@ -636,9 +711,6 @@ bool cmFileCopier::InstallFile(std::string const& fromFile,
   }
 
   // Set permissions of the destination file.
-  mode_t permissions =
-    (match_properties.Permissions ? match_properties.Permissions
-                                  : this->FilePermissions);
   if (!permissions) {
     // No permissions were explicitly provided but the user requested
     // that the source file permissions be used.
@@ -652,11 +724,12 @@ bool cmFileCopier::InstallDirectory(std::string const& source,
                                     MatchProperties match_properties)
 {
   // Inform the user about this directory installation.
-  this->ReportCopy(destination, TypeDir,
-                   !( // Report "Up-to-date:" for existing directories,
-                      // but not symlinks to them.
-                     cmSystemTools::FileIsDirectory(destination) &&
-                     !cmSystemTools::FileIsSymlink(destination)));
+  this->ReportCopyOrDefer(
+    destination, TypeDir,
+    !( // Report "Up-to-date:" for existing directories,
+       // but not symlinks to them.
+      cmSystemTools::FileIsDirectory(destination) &&
+      !cmSystemTools::FileIsSymlink(destination)));
 
   // check if default dir creation permissions were set
   mode_t default_dir_mode_v = 0;
@@ -713,18 +786,181 @@ bool cmFileCopier::InstallDirectory(std::string const& source,
   if (!source.empty()) {
     dir.Load(source);
   }
+  bool okay = true;
+  ++this->DirectoryDepth;
   unsigned long numFiles = dir.GetNumberOfFiles();
-  for (unsigned long fileNum = 0; fileNum < numFiles; ++fileNum) {
+  for (unsigned long fileNum = 0; okay && fileNum < numFiles; ++fileNum) {
     if (!(strcmp(dir.GetFile(fileNum), ".") == 0 ||
           strcmp(dir.GetFile(fileNum), "..") == 0)) {
       std::string fromPath = cmStrCat(source, '/', dir.GetFile(fileNum));
       std::string toPath = cmStrCat(destination, '/', dir.GetFile(fileNum));
-      if (!this->Install(fromPath, toPath)) {
-        return false;
+      okay = this->Install(fromPath, toPath);
+    }
+  }
+  --this->DirectoryDepth;
+
+  // Set the requested permissions of the destination directory once
+  // the files in it have been copied.
+  this->DeferredDirectories.emplace_back(destination, permissions_after);
+  if (this->DirectoryDepth > 0) {
+    return okay;
+  }
+
+  // The files of the tree that have been reported are copied even if
+  // the traversal stopped early, but its error takes precedence.
+  return this->FinishDirectoryTree(source, okay) && okay;
+}
+
+void cmFileCopier::ReportCopyOrDefer(std::string const& toFile, Type type,
+                                     bool copy)
+{
+  if (this->DirectoryDepth > 0) {
+    this->DeferredFiles.push_back(
+      DeferredFile{ type, std::string(), toFile, 0, copy, std::string() });
+  } else {
+    this->ReportCopy(toFile, type, copy);
+  }
+}
+
+void cmFileCopier::CopyDeferredFile(DeferredFile& file) const
+{
+  if (file.FileType != TypeFile) {
+    return;
+  }
+  cmInstallHashManifest::Examination examination;
+  if (this->HashManifest) {
+    // Copy unless the destination holds the content of the source or, as
+    // without a manifest, both files have the same time.  A destination
+    // modified since it was installed is always replaced.
+    examination = this->HashManifest->Examine(file.FromFile, file.ToFile);
+    cmFileTime fromTime;
+    cmFileTime toTime;
+    file.Copy = !examination.UpToDate &&
+      (examination.Modified || !fromTime.Load(file.FromFile) ||
+       !toTime.Load(file.ToFile) || fromTime.DifferS(toTime));
+  }
+  if (file.Copy) {
+    auto copy_status = cmSystemTools::CopyAFile(file.FromFile, file.ToFile);
+    if (!copy_status) {
+      file.Error =
+        cmStrCat(this->Name, " cannot copy file \"", file.FromFile, "\" to \"",
+                 file.ToFile, "\": ", copy_status.GetString(), '.');
+      return;
+    }
+    if (!this->Always) {
+      // Add write permission so we can set the file time.
+      // Permissions are set unconditionally afterwards anyway.
+      mode_t perm = 0;
+      if (cmSystemTools::GetPermissions(file.ToFile, perm)) {
+        cmSystemTools::SetPermissions(file.ToFile, perm | mode_owner_write);
+      }
+      auto time_status = cmFileTimes::Copy(file.FromFile, file.ToFile);
+      if (!time_status) {
+        file.Error =
+          cmStrCat(this->Name, " cannot set modification time on \"",
+                   file.ToFile, "\": ", time_status.GetString(), '.');
+        return;
       }
     }
   }
+  if (this->HashManifest) {
+    this->HashManifest->Record(examination, file.ToFile, file.Copy);
+  }
+  if (!file.Permissions) {
+    // No permissions were explicitly provided but the user requested
+    // that the source file permissions be used.
+    cmSystemTools::GetPermissions(file.FromFile, file.Permissions);
+  }
+}
 
-  // Set the requested permissions of the destination directory.
-  return this->SetPermissions(destination, permissions_after);
+unsigned int cmFileCopier::GetCopyJobs() const
+{
+  // Use one thread per core unless CMAKE_FILE_COPY_PARALLEL_LEVEL sets
+  // a limit, e.g. for install scripts running in parallel.
+  unsigned long jobs = 0;
+  if (cm::optional<std::string> level =
+        cmSystemTools::GetEnvVar("CMAKE_FILE_COPY_PARALLEL_LEVEL")) {
+    if (!cmStrToULong(*level, &jobs) || jobs < 1) {
+      this->Makefile->IssueMessage(
+        MessageType::WARNING,
+        cmStrCat("Ignoring CMAKE_FILE_COPY_PARALLEL_LEVEL value '", *level,
+                 "' which is not a positive integer."));
+      jobs = 0;
+    }
+  }
+  return static_cast<unsigned int>(jobs);
+}
+
+bool cmFileCopier::FinishDirectoryTree(std::string const& source,
+                                       bool traversed)
+{
+  std::vector<DeferredFile> files = std::move(this->DeferredFiles);
+  std::vector<std::pair<std::string, mode_t>> directories =
+    std::move(this->DeferredDirectories);
+  this->DeferredFiles.clear();
+  this->DeferredDirectories.clear();
+
+  // Examine and copy the files on several threads.  Once a copy failed,
+  // the files after it are left alone, as in a serial copy.
+  std::atomic<std::size_t> failed(files.size());
+  if (!files.empty()) {
+    cmParallelFor(files.size(), this->GetCopyJobs(),
+                  [this, &files, &failed](std::size_t i, unsigned int) {
+                    if (i > failed.load()) {
+                      return;
+                    }
+                    this->CopyDeferredFile(files[i]);
+                    if (!files[i].Error.empty()) {
+                      std::size_t first = failed.load();
+                      while (i < first &&
+                             !failed.compare_exchange_weak(first, i)) {
+                      }
+                    }
+                  });
+  }
+
+  // Inform the user about the entries in the order they were found, up
+  // to the first file that could not be copied.  Its error precedes any
+  // error of the traversal, which stopped after finding the file.
+  for (std::size_t i = 0; i < files.size(); ++i) {
+    DeferredFile const& file = files[i];
+    this->ReportCopy(file.ToFile, file.FileType, file.Copy);
+    if (i == failed) {
+      this->Status.SetError(file.Error);
+      return false;
+    }
+  }
+  if (!traversed) {
+    return false;
+  }
+
+  std::size_t total = 0;
+  std::size_t copied = 0;
+  for (DeferredFile const& file : files) {
+    if (file.FileType != TypeFile) {
+      continue;
+    }
+    ++total;
+    if (!this->SetPermissions(file.ToFile, file.Permissions)) {
+      return false;
+    }
+    if (file.Copy) {
+      ++copied;
+    }
+  }
+  for (auto const& directory : directories) {
+    if (!this->SetPermissions(directory.first, directory.second)) {
+      return false;
+    }
+  }
+
+  // Summarize directory trees, but not the files of a whole call.
+  if (!source.empty() &&
+      this->Makefile->GetCurrentLogLevel() >= Message::LogLevel::LOG_VERBOSE) {
+    this->Makefile->DisplayStatus(
+      cmStrCat(this->Name, " \"", source, "\": ", copied, " of ", total,
+               " files copied, ", total - copied, " up-to-date"),
+      -1);
+  }
+  return true;
 }
@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "cmsys/RegularExpression.hxx"
@@ -14,6 +15,7 @@
 #include "cmFileTimeCache.h"
 
 class cmExecutionStatus;
+class cmInstallHashManifest;
 class cmMakefile;
 
 // File installation helper class.
@@ -31,6 +33,10 @@ protected:
   bool Always = false;
   cmFileTimeCache FileTimes;
 
+  // Records the content of installed files, if enabled.  Files are then
+  // examined on threads and all files of a call are deferred.
+  cmInstallHashManifest* HashManifest = nullptr;
+
   // Whether to install a file not matching any expression.
   bool MatchlessFiles = true;
 
@@ -49,11 +55,24 @@ protected:
     cmsys::RegularExpression Regex;
     MatchProperties Properties;
     std::string RegexString;
+    // A PATTERN that is a plain file name, or "*" followed by a plain
+    // suffix, is matched by comparing the end of the file instead of
+    // running the regular expression.
+    enum MatchKind
+    {
+      MatchRegex,
+      MatchName,
+      MatchSuffix
+    };
+    MatchKind Kind = MatchRegex;
+    std::string Suffix;
     MatchRule(std::string const& regex)
       : Regex(regex)
       , RegexString(regex)
     {
     }
+    void SetPattern(std::string const& pattern);
+    bool Matches(std::string const& file);
   };
   std::vector<MatchRule> MatchRules;
 
@@ -73,8 +92,6 @@ protected:
   bool InstallDirectory(std::string const& source,
                         std::string const& destination,
                         MatchProperties match_properties);
-  virtual bool Install(std::string const& fromFile, std::string const& toFile);
-  virtual std::string const& ToName(std::string const& fromName);
 
   enum Type
   {
@@ -82,7 +99,33 @@ protected:
     TypeDir,
     TypeLink
   };
+
+  // Entries found while installing a directory tree are reported, and
+  // regular files copied by a pool of threads, after the whole tree has
+  // been traversed.  Directories and symlinks are only reported.
+  struct DeferredFile
+  {
+    Type FileType;
+    std::string FromFile;
+    std::string ToFile;
+    mode_t Permissions;
+    bool Copy;
+    std::string Error;
+  };
+  std::vector<DeferredFile> DeferredFiles;
+  // Final permissions of directories in the tree, in the order to set them.
+  std::vector<std::pair<std::string, mode_t>> DeferredDirectories;
+  unsigned int DirectoryDepth = 0;
+  void CopyDeferredFile(DeferredFile& file) const;
+  unsigned int GetCopyJobs() const;
+  // Copy and report the deferred entries.  If the traversal of the tree
+  // did not complete, its error stands unless a copy failed first.
+  bool FinishDirectoryTree(std::string const& source, bool traversed);
+  virtual bool Install(std::string const& fromFile, std::string const& toFile);
+  virtual std::string const& ToName(std::string const& fromName);
+
   virtual void ReportCopy(std::string const&, Type, bool) {}
+  void ReportCopyOrDefer(std::string const& toFile, Type type, bool copy);
   virtual bool ReportMissing(std::string const& fromFile);
 
   MatchRule* CurrentMatchRule = nullptr;
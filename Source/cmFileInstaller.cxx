@@ -18,6 +18,7 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmValue.h"
+#include "cmake.h"
 
 using namespace cmFSPermissions;
 
@@ -139,7 +140,7 @@ bool cmFileInstaller::InstallFile(std::string const& fromFile,
   }
 
   // Inform the user about this file installation.
-  this->ReportCopy(toFile, TypeLink, copy);
+  this->ReportCopyOrDefer(toFile, TypeLink, copy);
 
   if (copy) {
     // Remove the destination file so we can always create the symlink.
@@ -253,6 +254,17 @@ bool cmFileInstaller::Parse(std::vector<std::string> const& args)
     }
   }
 
+  // Compare installed files by content if the install script names a
+  // hash manifest.  Symbolic links have no content of their own.
+  cmValue hashManifest =
+    this->Makefile->GetDefinition("CMAKE_INSTALL_HASH_MANIFEST");
+  if (!this->Always && this->InstallMode == cmInstallMode::COPY &&
+      cmNonempty(hashManifest)) {
+    this->HashManifest =
+      this->Makefile->GetCMakeInstance()->GetInstallHashManifest(
+        *hashManifest);
+  }
+
   return true;
 }
 
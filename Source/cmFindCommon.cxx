@@ -8,6 +8,7 @@
 
 #include <cmext/algorithm>
 
+#include "cmDirectoryListingCache.h"
 #include "cmExecutionStatus.h"
 #include "cmList.h"
 #include "cmMakefile.h"
@@ -45,7 +46,12 @@ cmFindCommon::PathLabel cmFindCommon::PathLabel::Guess("GUESS");
 cmFindCommon::cmFindCommon(cmExecutionStatus& status)
   : Makefile(&status.GetMakefile())
   , Status(status)
+  , DirectoryListing(this->Makefile->GetCMakeInstance()
+                       ->GetDirectoryListingCache())
 {
+  // Directories listed by earlier commands may have changed since.
+  this->DirectoryListing->BeginSearch();
+
   this->FindRootPathMode = RootPathModeBoth;
   this->FullDebugMode = false;
   this->NoDefaultPath = false;
@@ -16,6 +16,7 @@
 #include "cmWindowsRegistry.h"
 
 class cmConfigureLog;
+class cmDirectoryListingCache;
 class cmFindCommonDebugState;
 class cmExecutionStatus;
 class cmMakefile;
@@ -172,6 +173,9 @@ protected:
 
   cmMakefile* Makefile;
   cmExecutionStatus& Status;
+
+  // Listings of the directories searched, shared by all find commands.
+  cmDirectoryListingCache* DirectoryListing;
 };
 
 class cmFindCommonDebugState
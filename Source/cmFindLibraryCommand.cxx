@@ -14,6 +14,7 @@
 
 #include "cmsys/RegularExpression.hxx"
 
+#include "cmDirectoryListingCache.h"
 #include "cmFindCommon.h"
 #include "cmGlobalGenerator.h"
 #include "cmList.h"
@@ -23,6 +24,7 @@
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmValue.h"
+#include "cmake.h"
 
 class cmExecutionStatus;
 
@@ -203,6 +205,7 @@ struct cmFindLibraryHelper
   cmMakefile* Makefile;
   cmFindBase const* FindBase;
   cmGlobalGenerator* GG;
+  cmDirectoryListingCache* DirectoryListing;
 
   // List of valid prefixes and suffixes.
   cmList Prefixes;
@@ -317,6 +320,8 @@ cmFindLibraryHelper::cmFindLibraryHelper(cmMakefile* mf,
   , DebugState(debugState)
 {
   this->GG = this->Makefile->GetGlobalGenerator();
+  this->DirectoryListing =
+    this->Makefile->GetCMakeInstance()->GetDirectoryListingCache();
 
   // Collect the list of library name prefixes/suffixes to try.
   std::string const& prefixes_list = get_prefixes(this->Makefile);
@@ -456,7 +461,8 @@ bool cmFindLibraryHelper::CheckDirectoryForName(std::string const& path,
   if (name.TryRaw) {
     std::string testPath = cmStrCat(path, name.Raw);
 
-    if (cmSystemTools::FileExists(testPath, true)) {
+    if (this->DirectoryListing->MayExist(testPath) &&
+        cmSystemTools::FileExists(testPath, true)) {
       testPath = cmSystemTools::ToNormalizedPathOnDisk(testPath);
       if (this->Validate(testPath)) {
         this->DebugLibraryFound(name.Raw, path);
@@ -591,7 +597,8 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryNamesPerDir()
   for (std::string const& d : this->SearchPaths) {
     for (std::string const& n : this->Names) {
       fwPath = cmStrCat(d, n, ".xcframework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->DirectoryListing->MayExist(fwPath) &&
+          cmSystemTools::FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -599,7 +606,8 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryNamesPerDir()
       }
 
       fwPath = cmStrCat(d, n, ".framework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->DirectoryListing->MayExist(fwPath) &&
+          cmSystemTools::FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -619,7 +627,8 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryDirsPerName()
   for (std::string const& n : this->Names) {
     for (std::string const& d : this->SearchPaths) {
       fwPath = cmStrCat(d, n, ".xcframework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->DirectoryListing->MayExist(fwPath) &&
+          cmSystemTools::FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -627,7 +636,8 @@ std::string cmFindLibraryCommand::FindFrameworkLibraryDirsPerName()
       }
 
       fwPath = cmStrCat(d, n, ".framework");
-      if (cmSystemTools::FileIsDirectory(fwPath)) {
+      if (this->DirectoryListing->MayExist(fwPath) &&
+          cmSystemTools::FileIsDirectory(fwPath)) {
         auto finalPath = cmSystemTools::ToNormalizedPathOnDisk(fwPath);
         if (this->Validate(finalPath)) {
           return finalPath;
@@ -26,6 +26,7 @@
 #include "cmAlgorithms.h"
 #include "cmConfigureLog.h"
 #include "cmDependencyProvider.h"
+#include "cmDirectoryListingCache.h"
 #include "cmExecutionStatus.h"
 #include "cmExperimental.h"
 #include "cmFindPackageStack.h"
@@ -114,14 +115,6 @@ public:
 };
 #endif
 
-bool isDirentryToIgnore(char const* const fname)
-{
-  assert(fname);
-  assert(fname[0] != 0);
-  return fname[0] == '.' &&
-    (fname[1] == 0 || (fname[1] == '.' && fname[2] == 0));
-}
-
 class cmAppendPathSegmentGenerator
 {
 public:
@@ -173,32 +166,37 @@ private:
 class cmCaseInsensitiveDirectoryListGenerator
 {
 public:
-  cmCaseInsensitiveDirectoryListGenerator(cm::string_view name)
-    : DirName{ name }
+  cmCaseInsensitiveDirectoryListGenerator(cmDirectoryListingCache& listing,
+                                          cm::string_view name)
+    : Listing(listing)
+    , DirName{ name }
   {
   }
 
   std::string GetNextCandidate(std::string const& parent)
   {
     if (!this->Loaded) {
+      this->Matches.clear();
       this->CurrentIdx = 0ul;
       this->Loaded = true;
-      if (!this->DirectoryLister.Load(parent)) {
+      std::vector<std::string> const* names =
+        this->Listing.GetNames(parent);
+      if (!names) {
         return {};
       }
+      for (std::string const& fname : *names) {
+        if (cmsysString_strcasecmp(fname.c_str(), this->DirName.data()) ==
+            0) {
+          this->Matches.push_back(fname);
+        }
+      }
     }
 
-    while (this->CurrentIdx < this->DirectoryLister.GetNumberOfFiles()) {
-      char const* const fname =
-        this->DirectoryLister.GetFile(this->CurrentIdx++);
-      if (isDirentryToIgnore(fname)) {
-        continue;
-      }
-      if (cmsysString_strcasecmp(fname, this->DirName.data()) == 0) {
-        auto candidate = cmStrCat(parent, fname, '/');
-        if (cmSystemTools::FileIsDirectory(candidate)) {
-          return candidate;
-        }
+    while (this->CurrentIdx < this->Matches.size()) {
+      auto candidate =
+        cmStrCat(parent, this->Matches[this->CurrentIdx++], '/');
+      if (cmSystemTools::FileIsDirectory(candidate)) {
+        return candidate;
       }
     }
     return {};
@@ -207,18 +205,21 @@ public:
   void Reset() { this->Loaded = false; }
 
 private:
-  cmsys::Directory DirectoryLister;
+  cmDirectoryListingCache& Listing;
   cm::string_view const DirName;
-  unsigned long CurrentIdx = 0ul;
+  std::vector<std::string> Matches;
+  std::size_t CurrentIdx = 0ul;
   bool Loaded = false;
 };
 
 class cmDirectoryListGenerator
 {
 public:
-  cmDirectoryListGenerator(std::vector<std::string> const* names,
+  cmDirectoryListGenerator(cmDirectoryListingCache& listing,
+                           std::vector<std::string> const* names,
                            bool exactMatch)
-    : Names{ names }
+    : Listing(listing)
+    , Names{ names }
     , ExactMatch{ exactMatch }
     , Current{ this->Matches.cbegin() }
   {
@@ -231,27 +232,15 @@ public:
   {
     // Construct a list of matches if not yet
     if (this->Matches.empty()) {
-      cmsys::Directory directoryLister;
-      // ALERT `Directory::Load()` keeps only names
-      // internally and LOST entry type from `dirent`.
-      // So, `Directory::FileIsDirectory` gonna use
-      // `SystemTools::FileIsDirectory()` and waste a syscall.
-      // TODO Need to enhance the `Directory` class.
-      directoryLister.Load(parent);
-
-      // ATTENTION Is it guaranteed that first two entries are
-      // `.` and `..`?
-      // TODO If so, just start with index 2 and drop the
-      // `isDirentryToIgnore(i)` condition to check.
-      for (auto i = 0ul; i < directoryLister.GetNumberOfFiles(); ++i) {
-        char const* const fname = directoryLister.GetFile(i);
-        // Skip entries to ignore or that aren't directories.
-        if (isDirentryToIgnore(fname)) {
-          continue;
-        }
-
+      // The listing is shared with the other generators and find commands
+      // searching the same directory.  It keeps only names, so matching
+      // entries are checked to be directories one by one.
+      std::vector<std::string> const* entries =
+        this->Listing.GetNames(parent);
+      std::vector<std::string> const noEntries;
+      for (std::string const& fname : entries ? *entries : noEntries) {
         if (!this->Names) {
-          if (directoryLister.FileIsDirectory(i)) {
+          if (cmSystemTools::FileIsDirectory(cmStrCat(parent, fname))) {
             this->Matches.emplace_back(fname);
           }
         } else {
@@ -262,11 +251,11 @@ public:
             // Skip entries that don't match.
             auto const equal =
               ((this->ExactMatch
-                  ? cmsysString_strcasecmp(fname, name.c_str())
-                  : cmsysString_strncasecmp(fname, name.c_str(),
+                  ? cmsysString_strcasecmp(fname.c_str(), name.c_str())
+                  : cmsysString_strncasecmp(fname.c_str(), name.c_str(),
                                             name.length())) == 0);
             if (equal) {
-              if (directoryLister.FileIsDirectory(i)) {
+              if (cmSystemTools::FileIsDirectory(cmStrCat(parent, fname))) {
                 this->Matches.emplace_back(fname);
               }
               break;
@@ -298,6 +287,7 @@ protected:
   virtual void OnMatchesLoaded() {}
   virtual std::string TransformNameBeforeCmp(std::string same) { return same; }
 
+  cmDirectoryListingCache& Listing;
   std::vector<std::string> const* Names;
   bool const ExactMatch;
   std::vector<std::string> Matches;
@@ -307,11 +297,12 @@ protected:
 class cmProjectDirectoryListGenerator : public cmDirectoryListGenerator
 {
 public:
-  cmProjectDirectoryListGenerator(std::vector<std::string> const* names,
+  cmProjectDirectoryListGenerator(cmDirectoryListingCache& listing,
+                                  std::vector<std::string> const* names,
                                   cmFindPackageCommand::SortOrderType so,
                                   cmFindPackageCommand::SortDirectionType sd,
                                   bool exactMatch)
-    : cmDirectoryListGenerator{ names, exactMatch }
+    : cmDirectoryListGenerator{ listing, names, exactMatch }
     , SortOrder{ so }
     , SortDirection{ sd }
   {
@@ -336,9 +327,10 @@ private:
 class cmMacProjectDirectoryListGenerator : public cmDirectoryListGenerator
 {
 public:
-  cmMacProjectDirectoryListGenerator(std::vector<std::string> const* names,
+  cmMacProjectDirectoryListGenerator(cmDirectoryListingCache& listing,
+                                     std::vector<std::string> const* names,
                                      cm::string_view ext)
-    : cmDirectoryListGenerator{ names, true }
+    : cmDirectoryListGenerator{ listing, names, true }
     , Extension{ ext }
   {
   }
@@ -356,9 +348,10 @@ private:
 class cmAnyDirectoryListGenerator : public cmProjectDirectoryListGenerator
 {
 public:
-  cmAnyDirectoryListGenerator(cmFindPackageCommand::SortOrderType so,
+  cmAnyDirectoryListGenerator(cmDirectoryListingCache& listing,
+                              cmFindPackageCommand::SortOrderType so,
                               cmFindPackageCommand::SortDirectionType sd)
-    : cmProjectDirectoryListGenerator(nullptr, so, sd, false)
+    : cmProjectDirectoryListGenerator(listing, nullptr, so, sd, false)
   {
   }
 };
@@ -2916,7 +2909,8 @@ bool cmFindPackageCommand::FindConfigFile(std::string const& dir,
     if (this->DebugModeEnabled()) {
       this->DebugBuffer = cmStrCat(this->DebugBuffer, "  ", file, '\n');
     }
-    if (cmSystemTools::FileExists(file, true)) {
+    if (this->DirectoryListing->MayExist(file) &&
+        cmSystemTools::FileExists(file, true)) {
       if (this->CheckVersion(file)) {
         // Allow resolving symlinks when the config file is found through a
         // link
@@ -3081,14 +3075,16 @@ bool cmFindPackageCommand::CheckVersion(std::string const& config_file)
 
     // Look for foo-config-version.cmake
     std::string version_file = cmStrCat(version_file_base, "-version.cmake");
-    if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+    if (!haveResult && this->DirectoryListing->MayExist(version_file) &&
+        cmSystemTools::FileExists(version_file, true)) {
       result = this->CheckVersionFile(version_file, version);
       haveResult = true;
     }
 
     // Look for fooConfigVersion.cmake
     version_file = cmStrCat(version_file_base, "Version.cmake");
-    if (!haveResult && cmSystemTools::FileExists(version_file, true)) {
+    if (!haveResult && this->DirectoryListing->MayExist(version_file) &&
+        cmSystemTools::FileExists(version_file, true)) {
       result = this->CheckVersionFile(version_file, version);
       haveResult = true;
     }
@@ -3252,15 +3248,18 @@ bool cmFindPackageCommand::SearchPrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
-  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ "cps"_s };
-  auto iCMakeGen = cmCaseInsensitiveDirectoryListGenerator{ "cmake"_s };
+  cmDirectoryListingCache& listing = *this->DirectoryListing;
+  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ listing, "cps"_s };
+  auto iCMakeGen =
+    cmCaseInsensitiveDirectoryListGenerator{ listing, "cmake"_s };
   auto anyDirGen =
-    cmAnyDirectoryListGenerator{ this->SortOrder, this->SortDirection };
+    cmAnyDirectoryListGenerator{ listing, this->SortOrder,
+                                 this->SortDirection };
   auto cpsPkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ listing, &this->Names, this->SortOrder,
                                      this->SortDirection, true };
   auto cmakePkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ listing, &this->Names, this->SortOrder,
                                      this->SortDirection, false };
 
   // PREFIX/(Foo|foo|FOO)/(cps|CPS)/
@@ -3312,7 +3311,7 @@ bool cmFindPackageCommand::SearchPrefix(std::string const& prefix)
   }
 
   auto secondPkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
+    cmProjectDirectoryListGenerator{ listing, &this->Names, this->SortOrder,
                                      this->SortDirection, false };
 
   // PREFIX/(Foo|foo|FOO).*/(cmake|CMake)/(Foo|foo|FOO).*/
@@ -3405,14 +3404,16 @@ bool cmFindPackageCommand::SearchFrameworkPrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
-  auto iCMakeGen = cmCaseInsensitiveDirectoryListGenerator{ "cmake"_s };
-  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ "cps"_s };
-  auto fwGen =
-    cmMacProjectDirectoryListGenerator{ &this->Names, ".framework"_s };
+  cmDirectoryListingCache& listing = *this->DirectoryListing;
+  auto iCMakeGen =
+    cmCaseInsensitiveDirectoryListGenerator{ listing, "cmake"_s };
+  auto iCpsGen = cmCaseInsensitiveDirectoryListGenerator{ listing, "cps"_s };
+  auto fwGen = cmMacProjectDirectoryListGenerator{ listing, &this->Names,
+                                                   ".framework"_s };
   auto rGen = cmAppendPathSegmentGenerator{ "Resources"_s };
   auto vGen = cmAppendPathSegmentGenerator{ "Versions"_s };
-  auto anyGen =
-    cmAnyDirectoryListGenerator{ this->SortOrder, this->SortDirection };
+  auto anyGen = cmAnyDirectoryListGenerator{ listing, this->SortOrder,
+                                             this->SortDirection };
 
   // <prefix>/Foo.framework/Versions/*/Resources/CPS/
   if (TryGeneratedPaths(searchFn, pdt::Cps, prefix, fwGen, vGen, anyGen, rGen,
@@ -3456,12 +3457,15 @@ bool cmFindPackageCommand::SearchAppBundlePrefix(std::string const& prefix)
     return this->SearchDirectory(fullPath, type);
   };
 
-  auto appGen = cmMacProjectDirectoryListGenerator{ &this->Names, ".app"_s };
+  cmDirectoryListingCache& listing = *this->DirectoryListing;
+  auto appGen =
+    cmMacProjectDirectoryListGenerator{ listing, &this->Names, ".app"_s };
   auto crGen = cmAppendPathSegmentGenerator{ "Contents/Resources"_s };
 
   // <prefix>/Foo.app/Contents/Resources/CPS/
-  if (TryGeneratedPaths(searchFn, pdt::Cps, prefix, appGen, crGen,
-                        cmCaseInsensitiveDirectoryListGenerator{ "cps"_s })) {
+  if (TryGeneratedPaths(
+        searchFn, pdt::Cps, prefix, appGen, crGen,
+        cmCaseInsensitiveDirectoryListGenerator{ listing, "cps"_s })) {
     return true;
   }
 
@@ -3473,7 +3477,7 @@ bool cmFindPackageCommand::SearchAppBundlePrefix(std::string const& prefix)
   // <prefix>/Foo.app/Contents/Resources/CMake/
   return TryGeneratedPaths(
     searchFn, pdt::CMake, prefix, appGen, crGen,
-    cmCaseInsensitiveDirectoryListGenerator{ "cmake"_s });
+    cmCaseInsensitiveDirectoryListGenerator{ listing, "cmake"_s });
 }
 
 bool cmFindPackageCommand::SearchEnvironmentPrefix(std::string const& prefix)
@@ -3491,8 +3495,9 @@ bool cmFindPackageCommand::SearchEnvironmentPrefix(std::string const& prefix)
   };
 
   auto pkgDirGen =
-    cmProjectDirectoryListGenerator{ &this->Names, this->SortOrder,
-                                     this->SortDirection, true };
+    cmProjectDirectoryListGenerator{ *this->DirectoryListing, &this->Names,
+                                     this->SortOrder, this->SortDirection,
+                                     true };
 
   // <environment-path>/(Foo|foo|FOO)/cps/
   if (TryGeneratedPaths(searchFn, pdt::Cps, prefix, pkgDirGen,
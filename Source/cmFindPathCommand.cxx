@@ -8,6 +8,7 @@
 
 #include "cmsys/Glob.hxx"
 
+#include "cmDirectoryListingCache.h"
 #include "cmFindCommon.h"
 #include "cmStateTypes.h"
 #include "cmStringAlgorithms.h"
@@ -92,7 +93,8 @@ std::string cmFindPathCommand::FindHeaderInFramework(
     if (!frameWorkName.empty()) {
       std::string fpath = cmStrCat(dir, frameWorkName, ".framework");
       std::string intPath = cmStrCat(fpath, "/Headers/", fileName);
-      if (cmSystemTools::FileExists(intPath) &&
+      if (this->DirectoryListing->MayExist(intPath) &&
+          cmSystemTools::FileExists(intPath) &&
           this->Validate(this->IncludeFileInPath ? intPath : fpath)) {
         if (this->DebugState) {
           this->DebugState->FoundAt(intPath);
@@ -135,7 +137,8 @@ std::string cmFindPathCommand::FindNormalHeader()
   for (std::string const& n : this->Names) {
     for (std::string const& sp : this->SearchPaths) {
       tryPath = cmStrCat(sp, n);
-      if (cmSystemTools::FileExists(tryPath) &&
+      if (this->DirectoryListing->MayExist(tryPath) &&
+          cmSystemTools::FileExists(tryPath) &&
           this->Validate(this->IncludeFileInPath ? tryPath : sp)) {
         if (this->DebugState) {
           this->DebugState->FoundAt(tryPath);
@@ -7,6 +7,7 @@
 
 #include <cm/memory>
 
+#include "cmDirectoryListingCache.h"
 #include "cmFindCommon.h"
 #include "cmMakefile.h"
 #include "cmMessageType.h"
@@ -16,6 +17,7 @@
 #include "cmSystemTools.h"
 #include "cmValue.h"
 #include "cmWindowsRegistry.h"
+#include "cmake.h"
 
 class cmExecutionStatus;
 
@@ -32,6 +34,8 @@ struct cmFindProgramHelper
     : DebugState(debugState)
     , Makefile(makefile)
     , FindBase(base)
+    , DirectoryListing(
+        makefile->GetCMakeInstance()->GetDirectoryListingCache())
     , PolicyCMP0109(makefile->GetPolicyStatus(cmPolicies::CMP0109))
   {
 #if defined(_WIN32) || defined(__CYGWIN__) || defined(__MINGW32__)
@@ -56,6 +60,7 @@ struct cmFindProgramHelper
   cmFindCommonDebugState* DebugState;
   cmMakefile* Makefile;
   cmFindBase const* FindBase;
+  cmDirectoryListingCache* DirectoryListing;
 
   cmPolicies::PolicyStatus PolicyCMP0109;
 
@@ -92,7 +97,8 @@ struct cmFindProgramHelper
                          std::string testNameExt = cmStrCat(name, ext);
                          std::string testPath =
                            cmSystemTools::CollapseFullPath(testNameExt, path);
-                         if (this->FileIsExecutable(testPath)) {
+                         if (this->DirectoryListing->MayExist(testPath) &&
+                             this->FileIsExecutable(testPath)) {
                            testPath =
                              cmSystemTools::ToNormalizedPathOnDisk(testPath);
                            if (this->FindBase->Validate(testPath)) {
@@ -2,25 +2,411 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmGccDepfileReader.h"
 
+#include <algorithm>
+#include <cstdio>
 #include <type_traits>
 #include <utility>
 #include <vector>
 
 #include <cm/optional>
+#include <cm/string_view>
+
+#include "cmsys/SystemTools.hxx"
 
-#include "cmGccDepfileLexerHelper.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
+#ifdef _WIN32
+#  include <cctype>
+#endif
+
+namespace {
+
+/*
+ * Parser for the Makefile subset written by compilers to depfiles.
+ *
+ * The input is scanned in runs of ordinary characters, which are copied
+ * into the current file name as a whole.  Only the few characters that
+ * can separate file names or start an escape sequence are looked at
+ * individually:
+ *
+ *   $$                  A literal '$'.
+ *   \#  \:              A literal '#' or ':'.
+ *   2N+1 '\' + space    N backslashes and a space in the file name.
+ *   2N '\' + space      2N backslashes, then the end of the file name.
+ *   [ \t]* '\' newline  A line continuation, ending the file name.
+ *   newline             The end of the file name and of the rule.
+ *   ':' + newline       The end of the rules and of the dependencies.
+ *   ':' + blank or '\' newline
+ *                       The end of the rules.
+ *   [ \t]+              The end of the file name.
+ *
+ * Any other character, including a lone '\', '$', or ':', is part of
+ * the file name.
+ */
+class DepfileParser
+{
+public:
+  bool Parse(cm::string_view text);
+  cmGccDepfileContent Content;
+
+private:
+  void NewEntry();
+  void NewRule();
+  void NewDependency();
+  void NewRuleOrDependency();
+  void AddToCurrentPath(char const* s, std::size_t n);
+  void SanitizeContent();
+
+  enum class State
+  {
+    Rule,
+    Dependency,
+    Failed,
+  };
+  State ParserState = State::Rule;
+};
+
+// Characters that may not be copied as part of a run of file name text.
+struct SpecialCharTable
+{
+  bool Special[256] = {};
+  SpecialCharTable()
+  {
+    for (unsigned char c : { '$', '\\', ':', ' ', '\t', '\r', '\n' }) {
+      this->Special[c] = true;
+    }
+  }
+};
+SpecialCharTable const SpecialChars;
+
+inline bool IsSpecial(char c)
+{
+  return SpecialChars.Special[static_cast<unsigned char>(c)];
+}
+
+// Length of the newline at 'p', or 0 if there is none.
+inline std::size_t NewlineLength(char const* p, char const* end)
+{
+  if (p != end) {
+    if (*p == '\n') {
+      return 1;
+    }
+    if (*p == '\r' && p + 1 != end && p[1] == '\n') {
+      return 2;
+    }
+  }
+  return 0;
+}
+
+inline char const* SkipBlanks(char const* p, char const* end)
+{
+  while (p != end && (*p == ' ' || *p == '\t')) {
+    ++p;
+  }
+  return p;
+}
+
+bool DepfileParser::Parse(cm::string_view text)
+{
+  char const* p = text.data();
+  char const* const end = p + text.size();
+
+  this->NewEntry();
+  while (p != end) {
+    switch (*p) {
+      case '$':
+        // Unescape the dollar sign.
+        this->AddToCurrentPath(p, 1);
+        p += (p + 1 != end && p[1] == '$') ? 2 : 1;
+        break;
+      case '\\': {
+        char const* q = p;
+        while (q != end && *q == '\\') {
+          ++q;
+        }
+        std::size_t const count = static_cast<std::size_t>(q - p);
+        if (q != end && *q == ' ') {
+          if (count % 2 == 1) {
+            // 2N+1 backslashes plus space -> N backslashes plus space.
+            this->AddToCurrentPath(p, count / 2);
+            this->AddToCurrentPath(q, 1);
+          } else {
+            // 2N backslashes plus space -> 2N backslashes, end of filename.
+            this->AddToCurrentPath(p, count);
+            this->NewDependency();
+          }
+          p = q + 1;
+          break;
+        }
+        if (count > 1) {
+          // All but the last backslash escape nothing.
+          this->AddToCurrentPath(p, count - 1);
+          p = q - 1;
+        }
+        if (q != end && (*q == '#' || *q == ':')) {
+          // Unescape the hash or colon.
+          this->AddToCurrentPath(q, 1);
+          p = q + 1;
+        } else if (std::size_t const nl = NewlineLength(q, end)) {
+          // A line continuation ends the current file name.
+          this->NewRuleOrDependency();
+          p = q + nl;
+        } else {
+          this->AddToCurrentPath(p, 1);
+          ++p;
+        }
+      } break;
+      case ' ':
+      case '\t': {
+        // Rules and dependencies are separated by blocks of whitespace,
+        // possibly ending in a line continuation.
+        char const* q = SkipBlanks(p, end);
+        if (q != end && *q == '\\') {
+          if (std::size_t const nl = NewlineLength(q + 1, end)) {
+            q += 1 + nl;
+          }
+        }
+        this->NewRuleOrDependency();
+        p = q;
+      } break;
+      case '\r':
+        if (p + 1 != end && p[1] == '\n') {
+          this->NewEntry();
+          p += 2;
+        } else {
+          this->AddToCurrentPath(p, 1);
+          ++p;
+        }
+        break;
+      case '\n':
+        // A newline ends the current file name and the current rule.
+        this->NewEntry();
+        ++p;
+        break;
+      case ':': {
+        char const* q = p + 1;
+        std::size_t nl = NewlineLength(q, end);
+        if (nl != 0) {
+          // A colon ends the rules.  A newline after it ends the rule.
+          this->NewDependency();
+          this->NewEntry();
+          p = q + nl;
+        } else if (q != end && (*q == ' ' || *q == '\t')) {
+          // A colon followed by space ends the rules and starts a new
+          // dependency.
+          this->NewDependency();
+          p = SkipBlanks(q, end);
+        } else if (q != end && *q == '\\' &&
+                   (nl = NewlineLength(q + 1, end)) != 0) {
+          // So does a colon followed by a line continuation.
+          this->NewDependency();
+          p = q + 1 + nl;
+        } else {
+          this->AddToCurrentPath(p, 1);
+          ++p;
+        }
+      } break;
+      default: {
+        // Got a span of plain text.
+        char const* q = p + 1;
+        while (q != end && !IsSpecial(*q)) {
+          ++q;
+        }
+        this->AddToCurrentPath(p, static_cast<std::size_t>(q - p));
+        p = q;
+      } break;
+    }
+  }
+  this->SanitizeContent();
+  return this->ParserState != State::Failed;
+}
+
+void DepfileParser::NewEntry()
+{
+  if (this->ParserState == State::Rule && !this->Content.empty()) {
+    if (!this->Content.back().rules.empty() &&
+        !this->Content.back().rules.back().empty()) {
+      this->ParserState = State::Failed;
+    }
+    return;
+  }
+  this->ParserState = State::Rule;
+  this->Content.emplace_back();
+  this->NewRule();
+}
+
+void DepfileParser::NewRule()
+{
+  auto& entry = this->Content.back();
+  if (entry.rules.empty() || !entry.rules.back().empty()) {
+    entry.rules.emplace_back();
+  }
+}
+
+void DepfileParser::NewDependency()
+{
+  if (this->ParserState == State::Failed) {
+    return;
+  }
+  this->ParserState = State::Dependency;
+  auto& entry = this->Content.back();
+  if (entry.paths.empty() || !entry.paths.back().empty()) {
+    entry.paths.emplace_back();
+  }
+}
+
+void DepfileParser::NewRuleOrDependency()
+{
+  if (this->ParserState == State::Rule) {
+    this->NewRule();
+  } else if (this->ParserState == State::Dependency) {
+    this->NewDependency();
+  }
+}
+
+void DepfileParser::AddToCurrentPath(char const* s, std::size_t n)
+{
+  if (this->Content.empty()) {
+    return;
+  }
+  cmGccStyleDependency* dep = &this->Content.back();
+  std::string* dst = nullptr;
+  switch (this->ParserState) {
+    case State::Rule: {
+      if (dep->rules.empty()) {
+        return;
+      }
+      dst = &dep->rules.back();
+    } break;
+    case State::Dependency: {
+      if (dep->paths.empty()) {
+        return;
+      }
+      dst = &dep->paths.back();
+    } break;
+    case State::Failed:
+      return;
+  }
+  dst->append(s, n);
+}
+
+void DepfileParser::SanitizeContent()
+{
+  for (auto it = this->Content.begin(); it != this->Content.end();) {
+    // remove duplicate path entries
+    std::sort(it->paths.begin(), it->paths.end());
+    auto last = std::unique(it->paths.begin(), it->paths.end());
+    it->paths.erase(last, it->paths.end());
+
+    // Remove empty paths and normalize windows paths
+    for (auto pit = it->paths.begin(); pit != it->paths.end();) {
+      if (pit->empty()) {
+        pit = it->paths.erase(pit);
+      } else {
+#if defined(_WIN32)
+        // Unescape the colon following the drive letter.
+        // Some versions of GNU compilers can escape this character.
+        // c\:\path must be transformed to c:\path
+        if (pit->size() >= 3 && std::toupper((*pit)[0]) >= 'A' &&
+            std::toupper((*pit)[0]) <= 'Z' && (*pit)[1] == '\\' &&
+            (*pit)[2] == ':') {
+          pit->erase(1, 1);
+        }
+#endif
+        ++pit;
+      }
+    }
+    // Remove empty rules
+    for (auto rit = it->rules.begin(); rit != it->rules.end();) {
+      if (rit->empty()) {
+        rit = it->rules.erase(rit);
+      } else {
+        ++rit;
+      }
+    }
+    // Remove the entry if rules are empty
+    if (it->rules.empty()) {
+      it = this->Content.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+bool ReadFile(char const* filePath, std::string& content)
+{
+  FILE* file = cmsys::SystemTools::Fopen(filePath, "rb");
+  if (!file) {
+    return false;
+  }
+  unsigned long const length = cmSystemTools::FileLength(filePath);
+  content.resize(length);
+  std::size_t size = std::fread(&content[0], 1, length, file);
+  content.resize(size);
+  // Pick up anything appended since we checked the length.
+  char buffer[4096];
+  while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+    content.append(buffer, size);
+  }
+  bool const ok = !std::ferror(file);
+  std::fclose(file);
+  return ok;
+}
+
+// Whether CollapseFullPath would return the given full path unchanged.
+bool IsCollapsedFullPath(std::string const& path)
+{
+#ifdef _WIN32
+  static_cast<void>(path);
+  return false;
+#else
+  if (path.size() < 2 || path[0] != '/' ||
+      path.find('\\') != std::string::npos) {
+    return false;
+  }
+  std::string::size_type begin = 1;
+  for (;;) {
+    std::string::size_type const end = path.find('/', begin);
+    std::string::size_type const len =
+      (end == std::string::npos ? path.size() : end) - begin;
+    if (len == 0 ||
+        (path[begin] == '.' &&
+         (len == 1 || (len == 2 && path[begin + 1] == '.')))) {
+      return false;
+    }
+    if (end == std::string::npos) {
+      return true;
+    }
+    begin = end + 1;
+  }
+#endif
+}
+
+void NormalizePath(std::string& path)
+{
+  // Most paths written by compilers are already normal.
+  if (cmSystemTools::FileIsFullPath(path) && !IsCollapsedFullPath(path)) {
+    path = cmSystemTools::CollapseFullPath(path);
+  }
+  cmSystemTools::ConvertToLongPath(path);
+}
+
+} // anonymous namespace
+
 cm::optional<cmGccDepfileContent> cmReadGccDepfile(
   char const* filePath, std::string const& prefix,
   GccDepfilePrependPaths prependPaths)
 {
-  cmGccDepfileLexerHelper helper;
-  if (!helper.readFile(filePath)) {
+  std::string text;
+  if (!ReadFile(filePath, text)) {
+    return cm::nullopt;
+  }
+  DepfileParser parser;
+  if (!parser.Parse(text)) {
     return cm::nullopt;
   }
-  auto deps = cm::make_optional(std::move(helper).extractContent());
+  auto deps = cm::make_optional(std::move(parser.Content));
 
   for (auto& dep : *deps) {
     for (auto& rule : dep.rules) {
@@ -28,19 +414,13 @@ cm::optional<cmGccDepfileContent> cmReadGccDepfile(
           !cmSystemTools::FileIsFullPath(rule)) {
         rule = cmStrCat(prefix, '/', rule);
       }
-      if (cmSystemTools::FileIsFullPath(rule)) {
-        rule = cmSystemTools::CollapseFullPath(rule);
-      }
-      cmSystemTools::ConvertToLongPath(rule);
+      NormalizePath(rule);
     }
     for (auto& path : dep.paths) {
       if (!prefix.empty() && !cmSystemTools::FileIsFullPath(path)) {
         path = cmStrCat(prefix, '/', path);
       }
-      if (cmSystemTools::FileIsFullPath(path)) {
-        path = cmSystemTools::CollapseFullPath(path);
-      }
-      cmSystemTools::ConvertToLongPath(path);
+      NormalizePath(path);
     }
   }
 
@@ -2,9 +2,14 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmGeneratedFileStream.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <locale>
+#include <unordered_map>
+#include <utility>
 
+#include "cmParallelFor.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 
@@ -159,6 +164,18 @@ bool cmGeneratedFileStreamBase::Close()
     resname += ".gz";
   }
 
+  // Let an active batch compare and replace the destination later.
+  // The temporary file now belongs to the batch.
+  if (cmGeneratedFileStreamBatch::Current && this->CopyIfDifferent &&
+      !this->Compress && this->Okay && !this->Name.empty() &&
+      !this->TempName.empty()) {
+    cmGeneratedFileStreamBatch::Current->Entries.push_back(
+      { std::move(this->TempName), std::move(this->Name) });
+    this->TempName.clear();
+    this->Name.clear();
+    return true;
+  }
+
   // Only consider replacing the destination file if no error
   // occurred.
   if (!this->Name.empty() && this->Okay &&
@@ -253,3 +270,71 @@ void cmGeneratedFileStream::WriteAltEncoding(std::string const& data,
   this->write(data.data(), data.size());
 #endif
 }
+
+cmGeneratedFileStreamBatch* cmGeneratedFileStreamBatch::Current = nullptr;
+
+cmGeneratedFileStreamBatch::cmGeneratedFileStreamBatch()
+  : Previous(cmGeneratedFileStreamBatch::Current)
+{
+  cmGeneratedFileStreamBatch::Current = this;
+}
+
+cmGeneratedFileStreamBatch::~cmGeneratedFileStreamBatch()
+{
+  cmGeneratedFileStreamBatch::Current = this->Previous;
+  this->Commit(1);
+}
+
+bool cmGeneratedFileStreamBatch::Commit(unsigned int jobs, std::size_t* count)
+{
+  std::vector<Entry> entries = std::move(this->Entries);
+  this->Entries.clear();
+
+  // Only the last content written to a destination matters.
+  std::unordered_map<std::string, std::size_t> last;
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    last[entries[i].Name] = i;
+  }
+  std::vector<Entry> work;
+  work.reserve(last.size());
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (last[entries[i].Name] == i) {
+      work.push_back(std::move(entries[i]));
+    } else {
+      cmSystemTools::RemoveFile(entries[i].TempName);
+    }
+  }
+
+  // Failures are recorded per file and reported in order afterward.
+  std::atomic<std::size_t> replaced(0);
+  std::vector<std::string> errors(work.size());
+  cmParallelFor(
+    work.size(), std::max(jobs, 1u),
+    [&work, &replaced, &errors](std::size_t i, unsigned int) {
+      Entry const& e = work[i];
+      if (cmSystemTools::FilesDiffer(e.TempName, e.Name)) {
+        if (cmSystemTools::RenameFile(e.TempName, e.Name,
+                                      cmSystemTools::Replace::Yes,
+                                      &errors[i]) ==
+            cmSystemTools::RenameResult::Success) {
+          ++replaced;
+        } else if (errors[i].empty()) {
+          errors[i] = "unknown error";
+        }
+      }
+      cmSystemTools::RemoveFile(e.TempName);
+    });
+  if (count) {
+    *count = replaced;
+  }
+
+  bool okay = true;
+  for (std::size_t i = 0; i < work.size(); ++i) {
+    if (!errors[i].empty()) {
+      cmSystemTools::Error(cmStrCat("Could not replace generated file\n  ",
+                                    work[i].Name, "\nbecause: ", errors[i]));
+      okay = false;
+    }
+  }
+  return okay;
+}
@@ -4,7 +4,9 @@
 
 #include "cmConfigure.h" // IWYU pragma: keep
 
+#include <cstddef>
 #include <string>
+#include <vector>
 
 #include "cmsys/FStream.hxx"
 
@@ -116,7 +118,9 @@ public:
    * Close the output file.  This should be used only with an open
    * stream.  The temporary file is atomically renamed to the
    * destination file if the stream is still valid when this method
-   * is called.
+   * is called.  If copy-if-different is enabled and a
+   * cmGeneratedFileStreamBatch is active, the replacement is deferred
+   * to the batch and this method returns true.
    */
   bool Close();
 
@@ -158,3 +162,48 @@ public:
    */
   void WriteAltEncoding(std::string const& data, codecvt_Encoding encoding);
 };
+
+/** \class cmGeneratedFileStreamBatch
+ * \brief Defers replacement of copy-if-different generated files.
+ *
+ * While an instance is alive, closing a cmGeneratedFileStream with
+ * copy-if-different enabled only records its temporary file.  The
+ * Commit method later compares each temporary file against its
+ * destination and replaces the destination if the content differs.
+ * The recorded files are independent of each other so the comparisons
+ * may run on several threads at once.
+ */
+class cmGeneratedFileStreamBatch
+{
+public:
+  cmGeneratedFileStreamBatch();
+  ~cmGeneratedFileStreamBatch();
+
+  cmGeneratedFileStreamBatch(cmGeneratedFileStreamBatch const&) = delete;
+  cmGeneratedFileStreamBatch& operator=(cmGeneratedFileStreamBatch const&) =
+    delete;
+
+  /**
+   * Replace the destinations of all recorded files using at most the
+   * given number of threads.  If the same destination was recorded
+   * more than once the last content wins.  Each destination that could
+   * not be replaced is reported as an error, and false is returned.
+   * The number of destination files that were replaced is stored in
+   * the optional count.
+   */
+  bool Commit(unsigned int jobs, std::size_t* count = nullptr);
+
+private:
+  friend class cmGeneratedFileStreamBase;
+
+  struct Entry
+  {
+    std::string TempName;
+    std::string Name;
+  };
+
+  std::vector<Entry> Entries;
+  cmGeneratedFileStreamBatch* Previous;
+
+  static cmGeneratedFileStreamBatch* Current;
+};
@@ -15,8 +15,6 @@
 #include "cmGeneratorExpressionContext.h"
 #include "cmGeneratorExpressionDAGChecker.h"
 #include "cmGeneratorExpressionEvaluator.h"
-#include "cmGeneratorExpressionLexer.h"
-#include "cmGeneratorExpressionParser.h"
 #include "cmList.h"
 #include "cmLocalGenerator.h"
 #include "cmStringAlgorithms.h"
@@ -68,18 +66,37 @@ std::string const& cmCompiledGeneratorExpression::Evaluate(
   cmGeneratorExpressionDAGChecker* dagChecker,
   cmGeneratorTarget const* currentTarget, std::string const& language) const
 {
+  if (!this->Parsed->NeedsEvaluation) {
+    return this->Parsed->Input;
+  }
+
+  cmGeneratorExpressionCache* cache =
+    lg->GetCMakeInstance()->GetGeneratorExpressionCache();
+  auto const reuse = this->Parsed->InvariantResults.find(language);
+  if (reuse != this->Parsed->InvariantResults.end()) {
+    cache->CountEvaluation(true);
+    // The evaluation that produced the result reached no node that
+    // depends on the context, so it had none of these side effects.
+    this->MaxLanguageStandard.clear();
+    this->HadContextSensitiveCondition = false;
+    this->HadHeadSensitiveCondition = false;
+    this->HadLinkLanguageSensitiveCondition = false;
+    this->HadConfigSensitiveCondition = false;
+    this->SourceSensitiveTargets.clear();
+    this->DependTargets.clear();
+    this->AllTargetsSeen.clear();
+    return reuse->second;
+  }
+  cache->CountEvaluation(false);
+
   cmGeneratorExpressionContext context(
     lg, config, this->Quiet, headTarget,
     currentTarget ? currentTarget : headTarget, this->EvaluateForBuildsystem,
     this->Backtrace, language);
 
-  if (!this->NeedsEvaluation) {
-    return this->Input;
-  }
-
   this->Output.clear();
 
-  for (auto const& it : this->Evaluators) {
+  for (auto const& it : this->Parsed->Evaluators) {
     this->Output += it->Evaluate(&context, dagChecker);
 
     this->SeenTargetProperties.insert(context.SeenTargetProperties.cbegin(),
@@ -97,7 +114,14 @@ std::string const& cmCompiledGeneratorExpression::Evaluate(
     this->HadHeadSensitiveCondition = context.HadHeadSensitiveCondition;
     this->HadLinkLanguageSensitiveCondition =
       context.HadLinkLanguageSensitiveCondition;
+    this->HadConfigSensitiveCondition = context.HadConfigSensitiveCondition;
     this->SourceSensitiveTargets = context.SourceSensitiveTargets;
+    if (!context.HadConfigSensitiveCondition) {
+      this->Parsed->InvariantResults.emplace(language, this->Output);
+    }
+  } else {
+    // The result of a failed evaluation must not be reused.
+    this->HadConfigSensitiveCondition = true;
   }
 
   this->DependTargets = context.DependTargets;
@@ -108,20 +132,16 @@ std::string const& cmCompiledGeneratorExpression::Evaluate(
 cmCompiledGeneratorExpression::cmCompiledGeneratorExpression(
   cmake& cmakeInstance, cmListFileBacktrace backtrace, std::string input)
   : Backtrace(std::move(backtrace))
-  , Input(std::move(input))
 {
+  cmGeneratorExpressionCache* cache =
+    cmakeInstance.GetGeneratorExpressionCache();
+  this->Parsed = cache->Find(input);
+  if (!this->Parsed) {
 #ifndef CMAKE_BOOTSTRAP
-  auto profilingRAII =
-    cmakeInstance.CreateProfilingEntry("genex_compile", this->Input);
+    auto profilingRAII =
+      cmakeInstance.CreateProfilingEntry("genex_compile", input);
 #endif
-
-  cmGeneratorExpressionLexer l;
-  std::vector<cmGeneratorExpressionToken> tokens = l.Tokenize(this->Input);
-  this->NeedsEvaluation = l.GetSawGeneratorExpression();
-
-  if (this->NeedsEvaluation) {
-    cmGeneratorExpressionParser p(tokens);
-    p.Parse(this->Evaluators);
+    this->Parsed = cache->Insert(std::move(input));
   }
 }
 
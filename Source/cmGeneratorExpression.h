@@ -13,6 +13,7 @@
 
 #include <cm/string_view>
 
+#include "cmGeneratorExpressionCache.h"
 #include "cmListFileCache.h"
 #include "cmLocalGenerator.h"
 
@@ -20,7 +21,6 @@ class cmake;
 class cmCompiledGeneratorExpression;
 class cmGeneratorTarget;
 struct cmGeneratorExpressionDAGChecker;
-struct cmGeneratorExpressionEvaluator;
 
 /** \class cmGeneratorExpression
  * \brief Evaluate generate-time query expression syntax.
@@ -125,7 +125,7 @@ public:
     return this->AllTargetsSeen;
   }
 
-  std::string const& GetInput() const { return this->Input; }
+  std::string const& GetInput() const { return this->Parsed->Input; }
 
   cmListFileBacktrace GetBacktrace() const { return this->Backtrace; }
   bool GetHadContextSensitiveCondition() const
@@ -140,6 +140,10 @@ public:
   {
     return this->HadLinkLanguageSensitiveCondition;
   }
+  bool GetHadConfigSensitiveCondition() const
+  {
+    return this->HadConfigSensitiveCondition;
+  }
   std::set<cmGeneratorTarget const*> GetSourceSensitiveTargets() const
   {
     return this->SourceSensitiveTargets;
@@ -163,9 +167,7 @@ private:
   friend class cmGeneratorExpression;
 
   cmListFileBacktrace Backtrace;
-  std::vector<std::unique_ptr<cmGeneratorExpressionEvaluator>> Evaluators;
-  std::string const Input;
-  bool NeedsEvaluation;
+  std::shared_ptr<cmGeneratorExpressionCache::Entry> Parsed;
   bool EvaluateForBuildsystem = false;
   bool Quiet = false;
 
@@ -179,6 +181,7 @@ private:
   mutable bool HadContextSensitiveCondition = false;
   mutable bool HadHeadSensitiveCondition = false;
   mutable bool HadLinkLanguageSensitiveCondition = false;
+  mutable bool HadConfigSensitiveCondition = false;
   mutable std::set<cmGeneratorTarget const*> SourceSensitiveTargets;
 };
 
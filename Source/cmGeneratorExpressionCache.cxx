@@ -0,0 +1,44 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmGeneratorExpressionCache.h"
+
+#include <utility>
+
+#include "cmGeneratorExpressionEvaluator.h"
+#include "cmGeneratorExpressionLexer.h"
+#include "cmGeneratorExpressionParser.h"
+
+cmGeneratorExpressionCache::cmGeneratorExpressionCache() = default;
+
+cmGeneratorExpressionCache::~cmGeneratorExpressionCache() = default;
+
+std::shared_ptr<cmGeneratorExpressionCache::Entry>
+cmGeneratorExpressionCache::Find(std::string const& input)
+{
+  ++this->Compilations;
+  auto it = this->Entries.find(input);
+  if (it == this->Entries.end()) {
+    return nullptr;
+  }
+  return it->second;
+}
+
+std::shared_ptr<cmGeneratorExpressionCache::Entry>
+cmGeneratorExpressionCache::Insert(std::string input)
+{
+  ++this->Parses;
+  auto entry = std::make_shared<Entry>();
+  entry->Input = std::move(input);
+
+  cmGeneratorExpressionLexer l;
+  std::vector<cmGeneratorExpressionToken> tokens = l.Tokenize(entry->Input);
+  entry->NeedsEvaluation = l.GetSawGeneratorExpression();
+
+  if (entry->NeedsEvaluation) {
+    cmGeneratorExpressionParser p(tokens);
+    p.Parse(entry->Evaluators);
+  }
+
+  this->Entries.emplace(entry->Input, entry);
+  return entry;
+}
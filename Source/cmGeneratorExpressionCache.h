@@ -0,0 +1,81 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <cm/string_view>
+
+struct cmGeneratorExpressionEvaluator;
+
+/** \class cmGeneratorExpressionCache
+ * \brief Share parsed generator expressions among all their evaluations.
+ *
+ * The same property values are compiled into cmCompiledGeneratorExpression
+ * instances many times, e.g. once per target that uses a library.  This
+ * cache keeps the evaluator tree of each distinct input so that it is
+ * lexed and parsed only once.
+ *
+ * An evaluation that reached only nodes whose result depends on nothing
+ * but their parameters and the compile language (see
+ * cmGeneratorExpressionNode::IsConfigInvariant) gives the same result for
+ * every configuration, target, directory, and DAG checker.  Such results
+ * are kept per compile language and returned by later evaluations of the
+ * same input without walking the tree again.
+ */
+class cmGeneratorExpressionCache
+{
+public:
+  struct Entry
+  {
+    // The evaluators refer to the characters of this string.
+    std::string Input;
+    std::vector<std::unique_ptr<cmGeneratorExpressionEvaluator>> Evaluators;
+    bool NeedsEvaluation = false;
+    // Results of context independent evaluations, keyed by language.
+    std::unordered_map<std::string, std::string> InvariantResults;
+  };
+
+  cmGeneratorExpressionCache();
+  ~cmGeneratorExpressionCache();
+
+  cmGeneratorExpressionCache(cmGeneratorExpressionCache const&) = delete;
+  cmGeneratorExpressionCache& operator=(cmGeneratorExpressionCache const&) =
+    delete;
+
+  /** Get the entry of a previously parsed input, or nullptr.  */
+  std::shared_ptr<Entry> Find(std::string const& input);
+
+  /** Parse an input and add its entry.  */
+  std::shared_ptr<Entry> Insert(std::string input);
+
+  /** Count an evaluation of an expression that needs evaluation, and
+      whether it returned a result kept from an earlier evaluation.  */
+  void CountEvaluation(bool reused)
+  {
+    ++this->Evaluations;
+    if (reused) {
+      ++this->ReusedEvaluations;
+    }
+  }
+
+  unsigned long GetCompilations() const { return this->Compilations; }
+  unsigned long GetParses() const { return this->Parses; }
+  unsigned long GetEvaluations() const { return this->Evaluations; }
+  unsigned long GetReusedEvaluations() const
+  {
+    return this->ReusedEvaluations;
+  }
+
+private:
+  std::unordered_map<cm::string_view, std::shared_ptr<Entry>> Entries;
+  unsigned long Compilations = 0;
+  unsigned long Parses = 0;
+  unsigned long Evaluations = 0;
+  unsigned long ReusedEvaluations = 0;
+};
@@ -40,5 +40,8 @@ struct cmGeneratorExpressionContext
   bool HadContextSensitiveCondition = false;
   bool HadHeadSensitiveCondition = false;
   bool HadLinkLanguageSensitiveCondition = false;
+  // Whether a node whose result may differ between configurations,
+  // targets, or directories was evaluated.
+  bool HadConfigSensitiveCondition = false;
   bool EvaluateForBuildsystem;
 };
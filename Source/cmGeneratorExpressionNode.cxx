@@ -73,10 +73,20 @@ std::string cmGeneratorExpressionNode::EvaluateDependentExpression(
   if (cge->GetHadLinkLanguageSensitiveCondition()) {
     context->HadLinkLanguageSensitiveCondition = true;
   }
+  if (cge->GetHadConfigSensitiveCondition()) {
+    context->HadConfigSensitiveCondition = true;
+  }
   return result;
 }
 
-static const struct ZeroNode : public cmGeneratorExpressionNode
+// Base of the nodes whose result depends only on their parameters and
+// the compile language.
+struct ConfigInvariantNode : public cmGeneratorExpressionNode
+{
+  bool IsConfigInvariant() const final { return true; }
+};
+
+static const struct ZeroNode : public ConfigInvariantNode
 {
   ZeroNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -94,7 +104,7 @@ static const struct ZeroNode : public cmGeneratorExpressionNode
   }
 } zeroNode;
 
-static const struct OneNode : public cmGeneratorExpressionNode
+static const struct OneNode : public ConfigInvariantNode
 {
   OneNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -116,7 +126,7 @@ static const struct ZeroNode installInterfaceNode;
 
 static const struct OneNode buildLocalInterfaceNode;
 
-struct BooleanOpNode : public cmGeneratorExpressionNode
+struct BooleanOpNode : public ConfigInvariantNode
 {
   BooleanOpNode(char const* op_, char const* successVal_,
                 char const* failureVal_)
@@ -163,7 +173,7 @@ struct BooleanOpNode : public cmGeneratorExpressionNode
 
 static BooleanOpNode const andNode("AND", "1", "0"), orNode("OR", "0", "1");
 
-static const struct NotNode : public cmGeneratorExpressionNode
+static const struct NotNode : public ConfigInvariantNode
 {
   NotNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -183,7 +193,7 @@ static const struct NotNode : public cmGeneratorExpressionNode
   }
 } notNode;
 
-static const struct BoolNode : public cmGeneratorExpressionNode
+static const struct BoolNode : public ConfigInvariantNode
 {
   BoolNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -199,7 +209,7 @@ static const struct BoolNode : public cmGeneratorExpressionNode
   }
 } boolNode;
 
-static const struct IfNode : public cmGeneratorExpressionNode
+static const struct IfNode : public ConfigInvariantNode
 {
   IfNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -227,7 +237,7 @@ static const struct IfNode : public cmGeneratorExpressionNode
   }
 } ifNode;
 
-static const struct StrEqualNode : public cmGeneratorExpressionNode
+static const struct StrEqualNode : public ConfigInvariantNode
 {
   StrEqualNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -243,7 +253,7 @@ static const struct StrEqualNode : public cmGeneratorExpressionNode
   }
 } strEqualNode;
 
-static const struct EqualNode : public cmGeneratorExpressionNode
+static const struct EqualNode : public ConfigInvariantNode
 {
   EqualNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -342,7 +352,7 @@ static const struct InListNode : public cmGeneratorExpressionNode
   }
 } inListNode;
 
-static const struct FilterNode : public cmGeneratorExpressionNode
+static const struct FilterNode : public ConfigInvariantNode
 {
   FilterNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -381,7 +391,7 @@ static const struct FilterNode : public cmGeneratorExpressionNode
   }
 } filterNode;
 
-static const struct RemoveDuplicatesNode : public cmGeneratorExpressionNode
+static const struct RemoveDuplicatesNode : public ConfigInvariantNode
 {
   RemoveDuplicatesNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -585,7 +595,7 @@ static const struct GenexEvalNode : public GenexEvaluator
   }
 } genexEvalNode;
 
-static const struct LowerCaseNode : public cmGeneratorExpressionNode
+static const struct LowerCaseNode : public ConfigInvariantNode
 {
   LowerCaseNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -601,7 +611,7 @@ static const struct LowerCaseNode : public cmGeneratorExpressionNode
   }
 } lowerCaseNode;
 
-static const struct UpperCaseNode : public cmGeneratorExpressionNode
+static const struct UpperCaseNode : public ConfigInvariantNode
 {
   UpperCaseNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -714,7 +724,7 @@ std::string ToString(bool isTrue)
 };
 }
 
-static const struct PathNode : public cmGeneratorExpressionNode
+static const struct PathNode : public ConfigInvariantNode
 {
   PathNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -1162,7 +1172,7 @@ static const struct PathNode : public cmGeneratorExpressionNode
   }
 } pathNode;
 
-static const struct PathEqualNode : public cmGeneratorExpressionNode
+static const struct PathEqualNode : public ConfigInvariantNode
 {
   PathEqualNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -1249,7 +1259,7 @@ bool GetNumericArguments(
 }
 }
 
-static const struct ListNode : public cmGeneratorExpressionNode
+static const struct ListNode : public ConfigInvariantNode
 {
   ListNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -1855,7 +1865,7 @@ static const struct ListNode : public cmGeneratorExpressionNode
   }
 } listNode;
 
-static const struct MakeCIdentifierNode : public cmGeneratorExpressionNode
+static const struct MakeCIdentifierNode : public ConfigInvariantNode
 {
   MakeCIdentifierNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -1872,7 +1882,7 @@ static const struct MakeCIdentifierNode : public cmGeneratorExpressionNode
 } makeCIdentifierNode;
 
 template <char C>
-struct CharacterNode : public cmGeneratorExpressionNode
+struct CharacterNode : public ConfigInvariantNode
 {
   CharacterNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -2126,7 +2136,7 @@ struct PlatformIdNode : public cmGeneratorExpressionNode
 static struct PlatformIdNode platformIdNode;
 
 template <cmSystemTools::CompareOp Op>
-struct VersionNode : public cmGeneratorExpressionNode
+struct VersionNode : public ConfigInvariantNode
 {
   VersionNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -2366,7 +2376,7 @@ static const struct ConfigurationTestNode : public cmGeneratorExpressionNode
   }
 } configurationTestNode;
 
-static const struct JoinNode : public cmGeneratorExpressionNode
+static const struct JoinNode : public ConfigInvariantNode
 {
   JoinNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -2384,7 +2394,7 @@ static const struct JoinNode : public cmGeneratorExpressionNode
   }
 } joinNode;
 
-static const struct CompileLanguageNode : public cmGeneratorExpressionNode
+static const struct CompileLanguageNode : public ConfigInvariantNode
 {
   CompileLanguageNode() {} // NOLINT(modernize-use-equals-default)
 
@@ -2405,6 +2415,10 @@ static const struct CompileLanguageNode : public cmGeneratorExpressionNode
         "components of the file(GENERATE) command.");
       return std::string();
     }
+    if (context->Language.empty()) {
+      // Whether this is allowed depends on the property being evaluated.
+      context->HadConfigSensitiveCondition = true;
+    }
 
     cmGlobalGenerator const* gg = context->LG->GetGlobalGenerator();
     std::string genName = gg->GetName();
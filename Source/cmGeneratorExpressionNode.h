@@ -33,6 +33,11 @@ struct cmGeneratorExpressionNode
 
   virtual int NumExpectedParameters() const { return 1; }
 
+  // Whether the result depends only on the parameters and the compile
+  // language, and so is the same for every configuration, target, and
+  // directory.
+  virtual bool IsConfigInvariant() const { return false; }
+
   virtual bool ShouldEvaluateNextParameter(std::vector<std::string> const&,
                                            std::string&) const
   {
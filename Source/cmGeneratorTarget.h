@@ -1009,6 +1009,18 @@ public:
     std::string const& prop, cmGeneratorExpressionContext* context,
     cmGeneratorExpressionDAGChecker* dagCheckerParent, UseTo usage) const;
 
+  /** Number of evaluations of this target's own interface property values,
+      and how many of them reused the result of an earlier evaluation for
+      another configuration or head target.  */
+  unsigned long GetInterfacePropertyEvaluations() const
+  {
+    return this->InterfacePropertyEvaluations;
+  }
+  unsigned long GetInterfacePropertyReuses() const
+  {
+    return this->InterfacePropertyReuses;
+  }
+
   struct TransitiveProperty
   {
 #if defined(__SUNPRO_CC) || (defined(__ibmxl__) && defined(__clang__))
@@ -1319,6 +1331,22 @@ private:
                                   cmGeneratorExpressionContext* context,
                                   UseTo usage) const;
 
+  struct InterfacePropertyValue
+  {
+    std::string Value;
+    std::string Result;
+  };
+  // Results of evaluating interface property values that are the same for
+  // every configuration and head target, keyed by property and language.
+  mutable std::unordered_map<std::string, InterfacePropertyValue>
+    InterfacePropertyValues;
+  mutable unsigned long InterfacePropertyEvaluations = 0;
+  mutable unsigned long InterfacePropertyReuses = 0;
+  std::string EvaluateInterfacePropertyValue(
+    std::string const& prop, std::string const& value,
+    cmGeneratorExpressionContext* context, cmGeneratorTarget const* headTarget,
+    cmGeneratorExpressionDAGChecker* dagChecker) const;
+
   using TargetPropertyEntryVector =
     std::vector<std::unique_ptr<TargetPropertyEntry>>;
 
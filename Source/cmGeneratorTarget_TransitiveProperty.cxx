@@ -96,6 +96,38 @@ bool cmGeneratorTarget::MaybeHaveInterfaceProperty(
   return i->second;
 }
 
+std::string cmGeneratorTarget::EvaluateInterfacePropertyValue(
+  std::string const& prop, std::string const& value,
+  cmGeneratorExpressionContext* context, cmGeneratorTarget const* headTarget,
+  cmGeneratorExpressionDAGChecker* dagChecker) const
+{
+  ++this->InterfacePropertyEvaluations;
+
+  // The value is evaluated again for every configuration and head target.
+  // Reuse the result if an earlier evaluation found it does not depend on
+  // either of them.
+  std::string const key = cmStrCat(prop, '@', context->Language);
+  auto i = this->InterfacePropertyValues.find(key);
+  if (i != this->InterfacePropertyValues.end() && i->second.Value == value) {
+    ++this->InterfacePropertyReuses;
+    return i->second.Result;
+  }
+
+  bool const hadConfigSensitiveCondition =
+    context->HadConfigSensitiveCondition;
+  context->HadConfigSensitiveCondition = false;
+  std::string result = cmGeneratorExpressionNode::EvaluateDependentExpression(
+    value, context->LG, context, headTarget, dagChecker, this);
+  if (!context->HadConfigSensitiveCondition) {
+    InterfacePropertyValue& cached = this->InterfacePropertyValues[key];
+    cached.Value = value;
+    cached.Result = result;
+  }
+  context->HadConfigSensitiveCondition =
+    context->HadConfigSensitiveCondition || hadConfigSensitiveCondition;
+  return result;
+}
+
 std::string cmGeneratorTarget::EvaluateInterfaceProperty(
   std::string const& prop, cmGeneratorExpressionContext* context,
   cmGeneratorExpressionDAGChecker* dagCheckerParent, UseTo usage) const
@@ -137,8 +169,8 @@ std::string cmGeneratorTarget::EvaluateInterfaceProperty(
     context->HeadTarget ? context->HeadTarget : this;
 
   if (cmValue p = this->GetProperty(prop)) {
-    result = cmGeneratorExpressionNode::EvaluateDependentExpression(
-      *p, context->LG, context, headTarget, &dagChecker, this);
+    result = this->EvaluateInterfacePropertyValue(prop, *p, context,
+                                                  headTarget, &dagChecker);
   }
 
   if (cmLinkInterfaceLibraries const* iface =
@@ -176,6 +208,9 @@ std::string cmGeneratorTarget::EvaluateInterfaceProperty(
         context->HadHeadSensitiveCondition =
           context->HadHeadSensitiveCondition ||
           libContext.HadHeadSensitiveCondition;
+        context->HadConfigSensitiveCondition =
+          context->HadConfigSensitiveCondition ||
+          libContext.HadConfigSensitiveCondition;
       }
     }
   }
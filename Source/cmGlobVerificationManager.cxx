@@ -2,15 +2,23 @@
    file LICENSE.rst or https://cmake.org/licensing for details.  */
 #include "cmGlobVerificationManager.h"
 
+#include <algorithm>
+#include <cstddef>
+#include <iostream>
 #include <sstream>
+#include <unordered_set>
 
+#include "cmsys/Directory.hxx"
 #include "cmsys/FStream.hxx"
+#include "cmsys/Glob.hxx"
 
+#include "cmFileTime.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGlobCacheEntry.h"
 #include "cmListFileCache.h"
 #include "cmMessageType.h"
 #include "cmMessenger.h"
+#include "cmParallelFor.h"
 #include "cmStringAlgorithms.h"
 #include "cmSystemTools.h"
 #include "cmVersion.h"
@@ -24,9 +32,13 @@ bool cmGlobVerificationManager::SaveVerificationScript(std::string const& path,
 
   std::string scriptFile = cmStrCat(path, "/CMakeFiles");
   std::string stampFile = scriptFile;
+  std::string manifestFile = scriptFile;
+  std::string stateFile = scriptFile;
   cmSystemTools::MakeDirectory(scriptFile);
   scriptFile += "/VerifyGlobs.cmake";
   stampFile += "/cmake.verify_globs";
+  manifestFile += "/VerifyGlobs.txt";
+  stateFile += "/VerifyGlobs.state";
   cmGeneratedFileStream verifyScriptFile(scriptFile);
   verifyScriptFile.SetCopyIfDifferent(true);
   if (!verifyScriptFile) {
@@ -90,6 +102,39 @@ bool cmGlobVerificationManager::SaveVerificationScript(std::string const& path,
   }
   verifyScriptFile.Close();
 
+  // The manifest holds the same globs for "cmake -E cmake_verify_globs".
+  // It is only replaced when its content changes, so its modification
+  // time tells the verifier whether its saved state still applies.
+  cmGeneratedFileStream manifest(manifestFile);
+  manifest.SetCopyIfDifferent(true);
+  if (!manifest) {
+    cmSystemTools::Error("Unable to open verification manifest for save. " +
+                         manifestFile);
+    cmSystemTools::ReportLastSystemError("");
+    return false;
+  }
+  manifest << "# CMAKE generated file: DO NOT EDIT!\n"
+           << "S" << stampFile << "\n"
+           << "T" << stateFile << "\n";
+  for (auto const& i : this->Cache) {
+    CacheEntryKey const& k = i.first;
+    CacheEntryValue const& v = i.second;
+    if (!v.Initialized) {
+      continue;
+    }
+    manifest << "G" << (k.Recurse ? '1' : '0')
+             << (k.ListDirectories ? '1' : '0')
+             << (k.FollowSymlinks ? '1' : '0') << "\n";
+    if (!k.Relative.empty()) {
+      manifest << "R" << k.Relative << "\n";
+    }
+    manifest << "E" << k.Expression << "\n";
+    for (std::string const& file : v.Files) {
+      manifest << "F" << file << "\n";
+    }
+  }
+  manifest.Close();
+
   cmsys::ofstream verifyStampFile(stampFile.c_str());
   if (!verifyStampFile) {
     cmSystemTools::Error("Unable to open verification stamp file for write. " +
@@ -100,6 +145,7 @@ bool cmGlobVerificationManager::SaveVerificationScript(std::string const& path,
                      "VerifyGlobs.cmake file\n";
   this->VerifyScript = scriptFile;
   this->VerifyStamp = stampFile;
+  this->VerifyManifest = manifestFile;
   return true;
 }
 
@@ -210,4 +256,331 @@ void cmGlobVerificationManager::Reset()
   this->Cache.clear();
   this->VerifyScript.clear();
   this->VerifyStamp.clear();
+  this->VerifyManifest.clear();
+}
+
+namespace {
+
+// A directory whose modification time is within this many seconds of the
+// time the verifier saves its state is not trusted to reveal later changes
+// on file systems with coarse time stamps.
+cmFileTime::TimeType const RacyDirectorySeconds = 2;
+
+struct VerifyEntry
+{
+  bool Recurse = false;
+  bool ListDirectories = false;
+  bool FollowSymlinks = false;
+  std::string Relative;
+  std::string Expression;
+  std::vector<std::string> Files;
+
+  // The directories read by the glob with their modification times as
+  // of the last verification that found the expected files.
+  std::vector<std::pair<std::string, cmFileTime::TimeType>> Directories;
+  bool Unchanged = false;
+  bool Record = false;
+  std::vector<std::string> Found;
+};
+
+bool LoadManifest(std::string const& manifest, std::string& stamp,
+                  std::string& state, std::vector<VerifyEntry>& entries)
+{
+  cmsys::ifstream fin(manifest.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::string line;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty() || line[0] == '#') {
+      continue;
+    }
+    std::string value = line.substr(1);
+    switch (line[0]) {
+      case 'S':
+        stamp = std::move(value);
+        continue;
+      case 'T':
+        state = std::move(value);
+        continue;
+      case 'G':
+        if (value.size() != 3) {
+          return false;
+        }
+        entries.emplace_back();
+        entries.back().Recurse = value[0] == '1';
+        entries.back().ListDirectories = value[1] == '1';
+        entries.back().FollowSymlinks = value[2] == '1';
+        continue;
+      default:
+        break;
+    }
+    if (entries.empty()) {
+      return false;
+    }
+    VerifyEntry& entry = entries.back();
+    switch (line[0]) {
+      case 'R':
+        entry.Relative = std::move(value);
+        break;
+      case 'E':
+        entry.Expression = std::move(value);
+        break;
+      case 'F':
+        entry.Files.emplace_back(std::move(value));
+        break;
+      default:
+        return false;
+    }
+  }
+  return !stamp.empty();
+}
+
+// The state lists the directories of each entry found unchanged by the
+// last run.  It applies only to the manifest it was saved for.
+void LoadState(std::string const& state, cmFileTime const& manifestTime,
+               std::vector<VerifyEntry>& entries)
+{
+  cmsys::ifstream fin(state.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return;
+  }
+  std::string line;
+  if (!cmSystemTools::GetLineFromStream(fin, line) ||
+      line != cmStrCat('M', manifestTime.GetTime())) {
+    return;
+  }
+  VerifyEntry* entry = nullptr;
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    if (line.empty()) {
+      continue;
+    }
+    if (line[0] == 'E') {
+      unsigned long index = 0;
+      if (!cmStrToULong(line.substr(1), &index) || index >= entries.size()) {
+        return;
+      }
+      entry = &entries[index];
+      entry->Directories.clear();
+      continue;
+    }
+    std::string::size_type const space = line.find(' ');
+    long long time = 0;
+    if (!entry || line[0] != 'D' || space == std::string::npos ||
+        !cmStrToLongLong(line.substr(1, space - 1), &time)) {
+      return;
+    }
+    entry->Directories.emplace_back(line.substr(space + 1), time);
+  }
+}
+
+bool SaveState(std::string const& state, cmFileTime const& manifestTime,
+               std::vector<VerifyEntry> const& entries)
+{
+  cmsys::ofstream fout(state.c_str(), std::ios::out | std::ios::binary);
+  if (!fout) {
+    return false;
+  }
+  fout << 'M' << manifestTime.GetTime() << '\n';
+  for (std::size_t i = 0; i < entries.size(); ++i) {
+    if (!entries[i].Record) {
+      continue;
+    }
+    fout << 'E' << i << '\n';
+    for (auto const& dir : entries[i].Directories) {
+      fout << 'D' << dir.second << ' ' << dir.first << '\n';
+    }
+  }
+  return static_cast<bool>(fout);
+}
+
+void CollectSubdirectories(std::string const& dir,
+                           std::vector<std::string>& dirs)
+{
+  cmsys::Directory d;
+  if (!d.Load(dir)) {
+    return;
+  }
+  for (unsigned long i = 0; i < d.GetNumberOfFiles(); ++i) {
+    std::string const& name = d.GetFileName(i);
+    if (name == "." || name == ".." || !d.FileIsDirectory(i) ||
+        d.FileIsSymlink(i)) {
+      continue;
+    }
+    dirs.emplace_back(cmStrCat(dir, '/', name));
+    CollectSubdirectories(dirs.back(), dirs);
+  }
+}
+
+// Collect the directories whose entries determine the result of a glob.
+// Returns false if the glob must always be evaluated, either because
+// wildcards select the directories or because it follows symlinks.
+bool CollectDirectories(VerifyEntry const& entry,
+                        std::vector<std::string>& dirs)
+{
+  std::string const& expr = entry.Expression;
+  std::string::size_type const slash = expr.rfind('/');
+  if (entry.FollowSymlinks || slash == std::string::npos ||
+      !cmSystemTools::FileIsFullPath(expr) ||
+      expr.find_first_of("*?[\\") < slash) {
+    return false;
+  }
+  std::string base = expr.substr(0, slash);
+  if (base.empty()) {
+    base = "/";
+  }
+  if (!cmSystemTools::FileIsDirectory(base)) {
+    return false;
+  }
+  dirs.emplace_back(base);
+  if (entry.Recurse) {
+    CollectSubdirectories(base == "/" ? std::string() : base, dirs);
+  }
+  return true;
+}
+
+bool DirectoriesUnchanged(VerifyEntry const& entry)
+{
+  if (entry.Directories.empty()) {
+    return false;
+  }
+  cmFileTime time;
+  return std::all_of(
+    entry.Directories.begin(), entry.Directories.end(),
+    [&time](std::pair<std::string, cmFileTime::TimeType> const& dir) {
+      return time.Load(dir.first) && time.GetTime() == dir.second;
+    });
+}
+
+void Verify(VerifyEntry& entry)
+{
+  if (DirectoriesUnchanged(entry)) {
+    entry.Unchanged = true;
+    return;
+  }
+
+  // Read the directory times before the glob, so that changes made
+  // while it runs are seen next time.
+  std::vector<std::string> dirs;
+  entry.Directories.clear();
+  entry.Record = CollectDirectories(entry, dirs);
+  cmFileTime time;
+  for (std::string& dir : dirs) {
+    if (!time.Load(dir)) {
+      entry.Record = false;
+      break;
+    }
+    entry.Directories.emplace_back(std::move(dir), time.GetTime());
+  }
+
+  // Evaluate the glob like file(GLOB) does.
+  cmsys::Glob g;
+  g.SetRecurse(entry.Recurse);
+  if (entry.Recurse && !entry.FollowSymlinks) {
+    g.RecurseThroughSymlinksOff();
+  }
+  g.SetListDirs(entry.ListDirectories);
+  g.SetRecurseListDirs(entry.ListDirectories);
+  if (!entry.Relative.empty()) {
+    g.SetRelative(entry.Relative.c_str());
+  }
+  cmsys::Glob::GlobMessages messages;
+  g.FindFiles(entry.Expression, &messages);
+  entry.Found = g.GetFiles();
+  std::sort(entry.Found.begin(), entry.Found.end());
+  entry.Found.erase(std::unique(entry.Found.begin(), entry.Found.end()),
+                    entry.Found.end());
+  entry.Record = entry.Record && entry.Found == entry.Files;
+}
+
+void ReportMismatch(VerifyEntry const& entry)
+{
+  std::unordered_set<std::string> const oldFiles(entry.Files.begin(),
+                                                 entry.Files.end());
+  std::unordered_set<std::string> const newFiles(entry.Found.begin(),
+                                                 entry.Found.end());
+  std::cerr << "-- GLOB mismatch!\n";
+  char const* header = "The following files were added:\n";
+  for (std::string const& file : entry.Found) {
+    if (oldFiles.find(file) == oldFiles.end()) {
+      std::cerr << header << "  +" << file << '\n';
+      header = "";
+    }
+  }
+  header = "The following files were removed:\n";
+  for (std::string const& file : entry.Files) {
+    if (newFiles.find(file) == newFiles.end()) {
+      std::cerr << header << "  -" << file << '\n';
+      header = "";
+    }
+  }
+}
+}
+
+int cmGlobVerificationManager::RunVerification(std::string const& manifest)
+{
+  std::string stamp;
+  std::string state;
+  std::vector<VerifyEntry> entries;
+  cmFileTime manifestTime;
+  if (!manifestTime.Load(manifest) ||
+      !LoadManifest(manifest, stamp, state, entries)) {
+    cmSystemTools::Error(
+      cmStrCat("-E cmake_verify_globs unable to read manifest: ", manifest));
+    return 1;
+  }
+  if (!state.empty()) {
+    LoadState(state, manifestTime, entries);
+  }
+
+  // Check and, if needed, evaluate each glob.  They are independent, so
+  // spread them over threads.
+  cmParallelFor(entries.size(), 0, [&entries](std::size_t i, unsigned int) {
+    Verify(entries[i]);
+  });
+
+  bool changed = false;
+  bool evaluated = false;
+  for (VerifyEntry& entry : entries) {
+    if (entry.Unchanged) {
+      entry.Record = true;
+      continue;
+    }
+    evaluated = true;
+    if (entry.Found != entry.Files) {
+      ReportMismatch(entry);
+      changed = true;
+    }
+  }
+  if (changed) {
+    cmSystemTools::Touch(stamp, false);
+  }
+
+  // Save the directory times for the next run.  Entries whose directories
+  // changed too recently to be trusted are left out, which the time of
+  // the saved state itself reveals.
+  if (evaluated && !state.empty() &&
+      SaveState(state, manifestTime, entries)) {
+    cmFileTime stateTime;
+    bool const known = stateTime.Load(state);
+    cmFileTime::TimeType const limit =
+      stateTime.GetTime() - RacyDirectorySeconds * cmFileTime::UtPerS;
+    auto const isRacy =
+      [known, limit](std::pair<std::string, cmFileTime::TimeType> const& d) {
+        return !known || d.second > limit;
+      };
+    bool racy = false;
+    for (VerifyEntry& entry : entries) {
+      if (entry.Record &&
+          std::any_of(entry.Directories.begin(), entry.Directories.end(),
+                      isRacy)) {
+        entry.Record = false;
+        racy = true;
+      }
+    }
+    if (racy) {
+      SaveState(state, manifestTime, entries);
+    }
+  }
+  return 0;
 }
@@ -18,14 +18,22 @@ struct cmGlobCacheEntry;
 /** \class cmGlobVerificationManager
  * \brief Class for expressing build-time dependencies on glob expressions.
  *
- * Generates a CMake script which verifies glob outputs during prebuild.
+ * Generates a CMake script which verifies glob outputs during prebuild,
+ * and a manifest of the same globs for the native verification done by
+ * "cmake -E cmake_verify_globs".
  *
  */
 class cmGlobVerificationManager
 {
+public:
+  //! Run "cmake -E cmake_verify_globs" on the given manifest.  Touches
+  //! the stamp file named in the manifest if any glob result changed.
+  static int RunVerification(std::string const& manifest);
+
 protected:
-  //! Save verification script for given makefile.
+  //! Save verification script and manifest for given makefile.
   //! Saves to output <path>/<CMakeFilesDirectory>/VerifyGlobs.cmake
+  //! and <path>/<CMakeFilesDirectory>/VerifyGlobs.txt
   bool SaveVerificationScript(std::string const& path, cmMessenger* messenger);
 
   //! Add an entry into the glob cache
@@ -42,9 +50,13 @@ protected:
   //! Check targets should be written in generated build system.
   bool DoWriteVerifyTarget() const;
 
-  //! Get the paths to the generated script and stamp files
+  //! Get the paths to the generated script, stamp, and manifest files
   std::string const& GetVerifyScript() const { return this->VerifyScript; }
   std::string const& GetVerifyStamp() const { return this->VerifyStamp; }
+  std::string const& GetVerifyManifest() const
+  {
+    return this->VerifyManifest;
+  }
 
 private:
   struct CacheEntryKey
@@ -78,6 +90,7 @@ private:
   CacheEntryMap Cache;
   std::string VerifyScript;
   std::string VerifyStamp;
+  std::string VerifyManifest;
 
   // Only cmState should be able to add cache values.
   // cmGlobVerificationManager should never be used directly.
@@ -1489,8 +1489,10 @@ void cmGlobalFastbuildGenerator::AddGlobCheckExec()
     FastbuildExecNode globCheck;
     globCheck.Name = FASTBUILD_GLOB_CHECK_TARGET;
     globCheck.ExecExecutable = cmSystemTools::GetCMakeCommand();
-    globCheck.ExecArguments = "-P " FASTBUILD_1_INPUT_PLACEHOLDER;
-    globCheck.ExecInput = { this->ConvertToFastbuildPath(globScript) };
+    globCheck.ExecArguments =
+      "-E cmake_verify_globs " FASTBUILD_1_INPUT_PLACEHOLDER;
+    globCheck.ExecInput = { this->ConvertToFastbuildPath(
+      this->GetCMakeInstance()->GetGlobVerifyManifest()) };
     globCheck.ExecAlways = false;
     globCheck.ExecUseStdOutAsOutput = false;
     auto const cache = this->GetCMakeInstance()->GetGlobCacheEntries();
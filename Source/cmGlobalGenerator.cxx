@@ -39,6 +39,7 @@
 #include "cmExternalMakefileProjectGenerator.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorExpression.h"
+#include "cmGeneratorExpressionCache.h"
 #include "cmGeneratorTarget.h"
 #include "cmInstallGenerator.h"
 #include "cmInstallRuntimeDependencySet.h"
@@ -69,6 +70,7 @@
 #  include <cm3p/json/writer.h>
 
 #  include "cmQtAutoGenGlobalInitializer.h"
+#  include "cmToolchainSnapshot.h"
 #endif
 
 class cmListFileBacktrace;
@@ -596,6 +598,19 @@ void cmGlobalGenerator::EnableLanguage(
       "Platform information initialized", cmStateEnums::INTERNAL);
   }
 
+#if !defined(CMAKE_BOOTSTRAP)
+  // Seed the platform information directory from a snapshot taken by
+  // another build tree using the same toolchain, if any.
+  if (!this->CMakeInstance->GetIsInTryCompile()) {
+    if (!mf->GetDefinition("CMAKE_SYSTEM_LOADED")) {
+      this->ToolchainSnapshot = cmToolchainSnapshot::New(mf, rootBin);
+    }
+    if (this->ToolchainSnapshot) {
+      this->ToolchainSnapshot->Restore(mf, languages);
+    }
+  }
+#endif
+
   // try and load the CMakeSystem.cmake if it is there
   std::string fpath = rootBin;
   bool const readCMakeSystem = !mf->GetDefinition("CMAKE_SYSTEM_LOADED");
@@ -971,6 +986,13 @@ void cmGlobalGenerator::EnableLanguage(
     this->ExtraGenerator->EnableLanguage(languages, mf, false);
   }
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->ToolchainSnapshot && !this->CMakeInstance->GetIsInTryCompile() &&
+      !fatalError && !cmSystemTools::GetFatalErrorOccurred()) {
+    this->ToolchainSnapshot->Save(mf, languages);
+  }
+#endif
+
   if (fatalError) {
     cmSystemTools::SetFatalErrorOccurred();
   }
@@ -1634,6 +1656,29 @@ void cmGlobalGenerator::Generate()
   }
 #endif
 
+  // With CMAKE_GENERATE_PARALLEL_LEVEL, defer the comparison and
+  // replacement of copy-if-different files written by the local
+  // generators and perform them on several threads afterward.
+  // Visual Studio generators need to know immediately which files
+  // were replaced, so they always replace files as they go.
+  unsigned long generateJobs = 1;
+  if (!this->IsVisualStudio()) {
+    if (cm::optional<std::string> level =
+          cmSystemTools::GetEnvVar("CMAKE_GENERATE_PARALLEL_LEVEL")) {
+      if (!cmStrToULong(*level, &generateJobs) || generateJobs < 1) {
+        this->GetCMakeInstance()->IssueMessage(
+          MessageType::WARNING,
+          cmStrCat("Ignoring CMAKE_GENERATE_PARALLEL_LEVEL value '", *level,
+                   "' which is not a positive integer."));
+        generateJobs = 1;
+      }
+    }
+  }
+  std::unique_ptr<cmGeneratedFileStreamBatch> generateBatch;
+  if (generateJobs > 1) {
+    generateBatch = cm::make_unique<cmGeneratedFileStreamBatch>();
+  }
+
   // Generate project files
   for (unsigned int i = 0; i < this->LocalGenerators.size(); ++i) {
     this->SetCurrentMakefile(this->LocalGenerators[i]->GetMakefile());
@@ -1651,6 +1696,15 @@ void cmGlobalGenerator::Generate()
   }
   this->SetCurrentMakefile(nullptr);
 
+  if (generateBatch) {
+    bool const committed =
+      generateBatch->Commit(static_cast<unsigned int>(generateJobs));
+    generateBatch.reset();
+    if (!committed) {
+      return;
+    }
+  }
+
   if (!this->GenerateCPackPropertiesFile()) {
     this->GetCMakeInstance()->IssueMessage(
       MessageType::FATAL_ERROR, "Could not write CPack properties file.");
@@ -1677,6 +1731,31 @@ void cmGlobalGenerator::Generate()
   // Perform validation checks on memoized link structures.
   this->CheckTargetLinkLibraries();
 
+  if (this->CMakeInstance->GetDebugOutput()) {
+    unsigned long evaluations = 0;
+    unsigned long reuses = 0;
+    for (auto const& lg : this->LocalGenerators) {
+      for (auto const& gt : lg->GetGeneratorTargets()) {
+        evaluations += gt->GetInterfacePropertyEvaluations();
+        reuses += gt->GetInterfacePropertyReuses();
+      }
+    }
+    this->CMakeInstance->UpdateProgress(
+      cmStrCat("Reused ", reuses, " of ", evaluations,
+               " interface property evaluations"),
+      -1);
+
+    cmGeneratorExpressionCache const* genexCache =
+      this->CMakeInstance->GetGeneratorExpressionCache();
+    this->CMakeInstance->UpdateProgress(
+      cmStrCat("Parsed ", genexCache->GetParses(), " of ",
+               genexCache->GetCompilations(),
+               " generator expressions, reused ",
+               genexCache->GetReusedEvaluations(), " of ",
+               genexCache->GetEvaluations(), " evaluations"),
+      -1);
+  }
+
   if (!this->CMP0068WarnTargets.empty()) {
     std::ostringstream w;
     /* clang-format off */
@@ -2378,6 +2457,16 @@ void cmGlobalGenerator::AddMakefile(std::unique_ptr<cmMakefile> mf)
   this->CMakeInstance->UpdateProgress("Configuring", prog);
 }
 
+std::string const& cmGlobalGenerator::GetCMakeCommandForBuild() const
+{
+  std::string const& client = cmSystemTools::GetCMakeDaemonClientCommand();
+  if (!client.empty() &&
+      this->CMakeInstance->GetCacheDefinition("CMAKE_COMMAND_DAEMON").IsOn()) {
+    return client;
+  }
+  return cmSystemTools::GetCMakeCommand();
+}
+
 void cmGlobalGenerator::AddInstallComponent(std::string const& component)
 {
   if (!component.empty()) {
@@ -57,6 +57,7 @@ class cmQtAutoGenGlobalInitializer;
 class cmSourceFile;
 class cmState;
 class cmStateDirectory;
+class cmToolchainSnapshot;
 class cmake;
 
 namespace detail {
@@ -515,6 +516,10 @@ public:
   // Lookup edit_cache target command preferred by this generator.
   virtual std::string GetEditCacheCommand() const { return ""; }
 
+  // Get the cmake executable that build rules run for "-E" commands.
+  // This is cmake-daemon-client if CMAKE_COMMAND_DAEMON is enabled.
+  std::string const& GetCMakeCommandForBuild() const;
+
   // Default config to use for cmake --build
   virtual std::string GetDefaultBuildConfig() const { return "Debug"; }
 
@@ -785,6 +790,7 @@ protected:
 
 #ifndef CMAKE_BOOTSTRAP
   std::unique_ptr<cmQtAutoGenGlobalInitializer> QtAutoGen;
+  std::unique_ptr<cmToolchainSnapshot> ToolchainSnapshot;
 #endif
 
   cmMakefile* CurrentConfigureMakefile;
@@ -42,6 +42,7 @@
 #include "cmMessageType.h"
 #include "cmNinjaLinkLineComputer.h"
 #include "cmOutputConverter.h"
+#include "cmParallelFor.h"
 #include "cmRange.h"
 #include "cmScanDepFormat.h"
 #include "cmSourceFile.h"
@@ -68,6 +69,39 @@ std::string const cmGlobalNinjaGenerator::SHELL_NOOP = ":";
 #endif
 
 namespace {
+// Append the assignment of a variable, unless its value is empty.
+bool AppendVariable(std::string& out, std::string const& name,
+                    std::string const& value, int indent)
+{
+  cm::string_view val = value;
+  static std::unordered_set<std::string> const variablesShouldNotBeTrimmed = {
+    "CODE_CHECK", "LAUNCHER"
+  };
+  if (variablesShouldNotBeTrimmed.find(name) ==
+      variablesShouldNotBeTrimmed.end()) {
+    while (!val.empty() && cmIsSpace(val.front())) {
+      val.remove_prefix(1);
+    }
+    while (!val.empty() && cmIsSpace(val.back())) {
+      val.remove_suffix(1);
+    }
+  }
+
+  // Do not add a variable if the value is empty.
+  if (val.empty()) {
+    return false;
+  }
+
+  for (int i = 0; i < indent; ++i) {
+    out += cmGlobalNinjaGenerator::INDENT;
+  }
+  out += name;
+  out += " = ";
+  out.append(val.data(), val.size());
+  out += '\n';
+  return true;
+}
+
 #ifdef _WIN32
 bool DetectGCCOnWindows(cm::string_view compilerId, cm::string_view simulateId,
                         cm::string_view compilerFrontendVariant)
@@ -146,14 +180,15 @@ void cmGlobalNinjaGenerator::WriteComment(std::ostream& os,
     return;
   }
 
+  cm::string_view const text = comment;
   std::string::size_type lpos = 0;
   std::string::size_type rpos;
   os << "\n#############################################\n";
-  while ((rpos = comment.find('\n', lpos)) != std::string::npos) {
-    os << "# " << comment.substr(lpos, rpos - lpos) << "\n";
+  while ((rpos = text.find('\n', lpos)) != std::string::npos) {
+    os << "# " << text.substr(lpos, rpos - lpos) << "\n";
     lpos = rpos + 1;
   }
-  os << "# " << comment.substr(lpos) << "\n\n";
+  os << "# " << text.substr(lpos) << "\n\n";
 }
 
 std::unique_ptr<cmLinkLineComputer>
@@ -197,17 +232,55 @@ std::string& cmGlobalNinjaGenerator::EncodeLiteral(std::string& lit)
 
 std::string cmGlobalNinjaGenerator::EncodePath(std::string const& path)
 {
-  std::string result = path;
+  std::string result;
+  this->AppendEncodedPath(result, path);
+  return result;
+}
+
+void cmGlobalNinjaGenerator::AppendEncodedPath(std::string& out,
+                                               std::string const& path)
+{
+  // This produces the same result as EncodeLiteral followed by escaping
+  // spaces and colons, but in a single pass without temporary strings.
+  // Runs of characters that need no escaping are appended at once.
+  // The configuration placeholder starts with '$' and is left for Ninja
+  // to expand.
+  cm::string_view const intDir = this->IsMultiConfig()
+    ? cm::string_view(this->GetCMakeCFGIntDir())
+    : cm::string_view();
 #ifdef _WIN32
-  if (this->IsGCCOnWindows())
-    std::replace(result.begin(), result.end(), '\\', '/');
-  else
-    std::replace(result.begin(), result.end(), '/', '\\');
+  char const* const special = "$ :\n/\\";
+  char const slash = this->IsGCCOnWindows() ? '/' : '\\';
+#else
+  char const* const special = "$ :\n";
 #endif
-  this->EncodeLiteral(result);
-  cmSystemTools::ReplaceString(result, " ", "$ ");
-  cmSystemTools::ReplaceString(result, ":", "$:");
-  return result;
+  out.reserve(out.size() + path.size() + 8);
+  std::string::size_type pos = 0;
+  for (;;) {
+    std::string::size_type const next = path.find_first_of(special, pos);
+    if (next == std::string::npos) {
+      out.append(path, pos, std::string::npos);
+      return;
+    }
+    out.append(path, pos, next - pos);
+    char const c = path[next];
+    pos = next + 1;
+#ifdef _WIN32
+    if (c == '/' || c == '\\') {
+      out += slash;
+      continue;
+    }
+#endif
+    if (c == '$' && !intDir.empty() &&
+        path.compare(next, intDir.size(), intDir.data(), intDir.size()) ==
+          0) {
+      out.append(intDir.data(), intDir.size());
+      pos = next + intDir.size();
+      continue;
+    }
+    out += '$';
+    out += c;
+  }
 }
 
 void cmGlobalNinjaGenerator::WriteBuild(std::ostream& os,
@@ -231,20 +304,27 @@ void cmGlobalNinjaGenerator::WriteBuild(std::ostream& os,
 
   cmGlobalNinjaGenerator::WriteComment(os, build.Comment);
 
+  // Format the whole statement into a buffer reused by all statements
+  // and hand it to the stream at once.
+  std::string& out = this->BuildStatementBuffer;
+  out.clear();
+
   // Write output files.
-  std::string buildStr("build");
+  out += "build";
   {
     // Write explicit outputs
     for (std::string const& output : build.Outputs) {
-      buildStr = cmStrCat(buildStr, ' ', this->EncodePath(output));
+      out += ' ';
+      this->AppendEncodedPath(out, output);
     }
     // Write implicit outputs
     if (!build.ImplicitOuts.empty()) {
       // Assume Ninja is new enough to support implicit outputs.
       // Callers should not populate this field otherwise.
-      buildStr = cmStrCat(buildStr, " |");
+      out += " |";
       for (std::string const& implicitOut : build.ImplicitOuts) {
-        buildStr = cmStrCat(buildStr, ' ', this->EncodePath(implicitOut));
+        out += ' ';
+        this->AppendEncodedPath(out, implicitOut);
       }
     }
 
@@ -255,66 +335,61 @@ void cmGlobalNinjaGenerator::WriteBuild(std::ostream& os,
     if (!build.WorkDirOuts.empty()) {
       if (this->SupportsImplicitOuts() && build.ImplicitOuts.empty()) {
         // Make them implicit outputs if supported by this version of Ninja.
-        buildStr = cmStrCat(buildStr, " |");
+        out += " |";
       }
       for (std::string const& workdirOut : build.WorkDirOuts) {
-        buildStr = cmStrCat(buildStr, " ${cmake_ninja_workdir}",
-                            this->EncodePath(workdirOut));
+        out += " ${cmake_ninja_workdir}";
+        this->AppendEncodedPath(out, workdirOut);
       }
     }
 
     // Write the rule.
-    buildStr = cmStrCat(buildStr, ": ", build.Rule);
+    out += ": ";
+    out += build.Rule;
   }
 
-  std::string arguments;
   {
     // TODO: Better formatting for when there are multiple input/output files.
 
     // Write explicit dependencies.
     for (std::string const& explicitDep : build.ExplicitDeps) {
-      arguments += cmStrCat(' ', this->EncodePath(explicitDep));
+      out += ' ';
+      this->AppendEncodedPath(out, explicitDep);
     }
 
     // Write implicit dependencies.
     if (!build.ImplicitDeps.empty()) {
-      arguments += " |";
+      out += " |";
       for (std::string const& implicitDep : build.ImplicitDeps) {
-        arguments += cmStrCat(' ', this->EncodePath(implicitDep));
+        out += ' ';
+        this->AppendEncodedPath(out, implicitDep);
       }
     }
 
     // Write order-only dependencies.
     if (!build.OrderOnlyDeps.empty()) {
-      arguments += " ||";
+      out += " ||";
       for (std::string const& orderOnlyDep : build.OrderOnlyDeps) {
-        arguments += cmStrCat(' ', this->EncodePath(orderOnlyDep));
+        out += ' ';
+        this->AppendEncodedPath(out, orderOnlyDep);
       }
     }
 
-    arguments += '\n';
+    out += '\n';
   }
 
   // Write the variables bound to this build statement.
-  std::string assignments;
   {
-    std::ostringstream variable_assignments;
     for (auto const& variable : build.Variables) {
-      cmGlobalNinjaGenerator::WriteVariable(
-        variable_assignments, variable.first, variable.second, "", 1);
+      AppendVariable(out, variable.first, variable.second, 1);
     }
 
     // check if a response file rule should be used
-    assignments = variable_assignments.str();
     bool useResponseFile = false;
     if (cmdLineLimit < 0 ||
         (cmdLineLimit > 0 &&
-         (arguments.size() + buildStr.size() + assignments.size() + 1000) >
-           static_cast<size_t>(cmdLineLimit))) {
-      variable_assignments.str(std::string());
-      cmGlobalNinjaGenerator::WriteVariable(variable_assignments, "RSP_FILE",
-                                            build.RspFile, "", 1);
-      assignments += variable_assignments.str();
+         (out.size() + 1000) > static_cast<size_t>(cmdLineLimit))) {
+      AppendVariable(out, "RSP_FILE", build.RspFile, 1);
       useResponseFile = true;
     }
     if (usedResponseFile) {
@@ -322,7 +397,8 @@ void cmGlobalNinjaGenerator::WriteBuild(std::ostream& os,
     }
   }
 
-  os << buildStr << arguments << assignments << "\n";
+  out += '\n';
+  os.write(out.data(), static_cast<std::streamsize>(out.size()));
 }
 
 void cmGlobalNinjaGenerator::AddCustomCommandRule()
@@ -514,25 +590,13 @@ void cmGlobalNinjaGenerator::WriteVariable(std::ostream& os,
     return;
   }
 
-  std::string val;
-  static std::unordered_set<std::string> const variablesShouldNotBeTrimmed = {
-    "CODE_CHECK", "LAUNCHER"
-  };
-  if (variablesShouldNotBeTrimmed.find(name) ==
-      variablesShouldNotBeTrimmed.end()) {
-    val = cmTrimWhitespace(value);
-  } else {
-    val = value;
-  }
-
-  // Do not add a variable if the value is empty.
-  if (val.empty()) {
+  std::string assignment;
+  if (!AppendVariable(assignment, name, value, indent)) {
     return;
   }
 
   cmGlobalNinjaGenerator::WriteComment(os, comment);
-  cmGlobalNinjaGenerator::Indent(os, indent);
-  os << name << " = " << val << "\n";
+  os << assignment;
 }
 
 void cmGlobalNinjaGenerator::WriteInclude(std::ostream& os,
@@ -1877,8 +1941,8 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
     {
       cmNinjaRule rule("VERIFY_GLOBS");
       rule.Command =
-        cmStrCat(this->CMakeCmd(), " -P ",
-                 lg->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
+        cmStrCat(this->CMakeCmd(), " -E cmake_verify_globs ",
+                 lg->ConvertToOutputFormat(cm->GetGlobVerifyManifest(),
                                            cmOutputConverter::SHELL));
       rule.Description = "Re-checking globbed directories...";
       rule.Comment = "Rule for re-checking globbed directories.";
@@ -1948,7 +2012,7 @@ void cmGlobalNinjaGenerator::WriteTargetRebuildManifest(std::ostream& os)
 std::string cmGlobalNinjaGenerator::CMakeCmd() const
 {
   auto const& lgen = this->LocalGenerators.at(0);
-  return lgen->ConvertToOutputFormat(cmSystemTools::GetCMakeCommand(),
+  return lgen->ConvertToOutputFormat(this->GetCMakeCommandForBuild(),
                                      cmOutputConverter::SHELL);
 }
 
@@ -2599,15 +2663,22 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
     this->LocalGenerators.push_back(std::move(lgd));
   }
 
-  std::vector<cmScanDepInfo> objects;
-  for (std::string const& arg_ddi : arg_ddis) {
-    cmScanDepInfo info;
-    if (!cmScanDepFormat_P1689_Parse(arg_ddi, &info)) {
-      cmSystemTools::Error(
-        cmStrCat("-E cmake_ninja_dyndep failed to parse ddi file ", arg_ddi));
+  // The ddi files are independent of each other, so parse them on
+  // several threads.  Errors are reported afterwards, in order.
+  std::vector<cmScanDepInfo> objects(arg_ddis.size());
+  std::vector<std::string> errors(arg_ddis.size());
+  std::vector<char> parsed(arg_ddis.size(), 0);
+  cmParallelFor(arg_ddis.size(), 0, [&](std::size_t i, unsigned int) {
+    parsed[i] =
+      cmScanDepFormat_P1689_Parse(arg_ddis[i], &objects[i], errors[i]);
+  });
+  for (std::size_t i = 0; i < arg_ddis.size(); ++i) {
+    if (!parsed[i]) {
+      cmSystemTools::Error(errors[i]);
+      cmSystemTools::Error(cmStrCat(
+        "-E cmake_ninja_dyndep failed to parse ddi file ", arg_ddis[i]));
       return false;
     }
-    objects.push_back(std::move(info));
   }
 
   CxxModuleUsage usages;
@@ -2745,7 +2816,10 @@ bool cmGlobalNinjaGenerator::WriteDyndepFile(
     }
   }
 
+  // Leave the dyndep file untouched if its content does not change so
+  // that the restat on the dyndep rule can prune the work after it.
   cmGeneratedFileStream ddf(arg_dd);
+  ddf.SetCopyIfDifferent(true);
   ddf << "ninja_dyndep_version = 1.0\n";
 
   {
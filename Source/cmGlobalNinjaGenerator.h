@@ -78,6 +78,8 @@ public:
   static std::string EncodeRuleName(std::string const& name);
   std::string& EncodeLiteral(std::string& lit) override;
   std::string EncodePath(std::string const& path);
+  /// Append @a path encoded as by EncodePath to @a out.
+  void AppendEncodedPath(std::string& out, std::string const& path);
 
   std::unique_ptr<cmLinkLineComputer> CreateLinkLineComputer(
     cmOutputConverter* outputConverter,
@@ -270,6 +272,9 @@ public:
   std::string const& ConvertToNinjaPath(std::string const& path) const;
   std::string ConvertToNinjaAbsPath(std::string path) const;
 
+  /// The shell command that build rules run for "cmake".
+  std::string CMakeCmd() const;
+
   struct MapToNinjaPathImpl
   {
     cmGlobalNinjaGenerator* GG;
@@ -545,7 +550,6 @@ private:
     cmGeneratorTarget const* target,
     std::set<cmGeneratorTarget const*>& depends);
 
-  std::string CMakeCmd() const;
   std::string NinjaCmd() const;
 
   /// The file containing the build statement. (the relationship of the
@@ -556,6 +560,10 @@ private:
   std::unique_ptr<cmGeneratedFileStream> RulesFileStream;
   std::unique_ptr<cmGeneratedFileStream> CompileCommandsStream;
 
+  /// Buffer in which WriteBuild formats each build statement.  It keeps
+  /// its capacity so that statements are formatted without allocations.
+  std::string BuildStatementBuffer;
+
   /// The set of rules added to the generated build system.
   std::unordered_set<std::string> Rules;
 
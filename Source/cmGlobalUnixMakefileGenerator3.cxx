@@ -11,9 +11,14 @@
 #include <cmext/algorithm>
 #include <cmext/memory>
 
+#include "cmsys/FStream.hxx"
+
+#include "cmComputeComponentGraph.h"
 #include "cmGeneratedFileStream.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobalGenerator.h"
+#include "cmGraphAdjacencyList.h"
+#include "cmListFileCache.h"
 #include "cmLocalGenerator.h"
 #include "cmLocalUnixMakefileGenerator3.h"
 #include "cmMakefile.h"
@@ -25,6 +30,7 @@
 #include "cmSystemTools.h"
 #include "cmTarget.h"
 #include "cmTargetDepend.h"
+#include "cmTargetFingerprints.h"
 #include "cmValue.h"
 #include "cmake.h"
 
@@ -109,6 +115,19 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   this->ClangTidyExportFixesDirs.clear();
   this->ClangTidyExportFixesFiles.clear();
 
+  // Keep the rule files of targets whose inputs did not change.
+  this->TargetFingerprints.reset();
+  this->PendingFingerprints.clear();
+  this->FingerprintFiles.clear();
+  this->ReusedTargets = 0;
+  this->FingerprintedTargets = 0;
+  if (!this->CMakeInstance->GetIsInTryCompile() &&
+      !this->LocalGenerators.empty() &&
+      this->LocalGenerators[0]->GetMakefile()->IsOn(
+        "CMAKE_INCREMENTAL_GENERATE")) {
+    this->TargetFingerprints = cm::make_unique<cmTargetFingerprints>(this);
+  }
+
   // first do superclass method
   this->cmGlobalGenerator::Generate();
 
@@ -129,6 +148,7 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   for (auto& pmi : this->ProgressMap) {
     pmi.second.WriteProgressVariables(total, current);
   }
+  this->ComputeProgressMarks();
   for (auto const& lg : this->LocalGenerators) {
     std::string markFileName =
       cmStrCat(lg->GetCurrentBinaryDirectory(), "/CMakeFiles/progress.marks");
@@ -146,6 +166,23 @@ void cmGlobalUnixMakefileGenerator3::Generate()
   }
 
   this->RemoveUnknownClangTidyExportFixesFiles();
+
+  if (this->TargetFingerprints) {
+    // Record the fingerprints only once all rule files are complete.
+    if (!cmSystemTools::GetErrorOccurredFlag()) {
+      for (auto const& ff : this->FingerprintFiles) {
+        cmGeneratedFileStream fout(ff.first);
+        fout << ff.second;
+      }
+    }
+    this->CMakeInstance->UpdateProgress(
+      cmStrCat("Reused build rules of ", this->ReusedTargets, " of ",
+               this->FingerprintedTargets, " targets"),
+      -1);
+    this->TargetFingerprints.reset();
+    this->PendingFingerprints.clear();
+    this->FingerprintFiles.clear();
+  }
 }
 
 void cmGlobalUnixMakefileGenerator3::AddCXXCompileCommand(
@@ -723,9 +760,7 @@ void cmGlobalUnixMakefileGenerator3::WriteConvenienceRules2(
         progCmd << lg.ConvertToOutputFormat(progress.Dir,
                                             cmOutputConverter::SHELL);
         //
-        std::set<cmGeneratorTarget const*> emitted;
-        progCmd << " "
-                << this->CountProgressMarksInTarget(gtarget.get(), emitted);
+        progCmd << " " << this->CountProgressMarksInTarget(gtarget.get());
         commands.push_back(progCmd.str());
       }
       std::string tmp = "CMakeFiles/Makefile2";
@@ -830,34 +865,100 @@ void cmGlobalUnixMakefileGenerator3::InitializeProgressMarks()
   }
 }
 
-size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInTarget(
-  cmGeneratorTarget const* target, std::set<cmGeneratorTarget const*>& emitted)
+void cmGlobalUnixMakefileGenerator3::ComputeProgressMarks()
 {
-  size_t count = 0;
-  if (emitted.insert(target).second) {
-    count = this->ProgressMap[target].Marks.size();
-    for (cmTargetDepend const& depend : this->GetTargetDirectDepends(target)) {
-      if (!depend->IsInBuildSystem()) {
-        continue;
+  this->TargetProgressMarks.clear();
+  this->DirectoryProgressMarks.clear();
+
+  // Number all targets densely.
+  std::vector<cmGeneratorTarget const*> targets;
+  std::unordered_map<cmGeneratorTarget const*, size_t> index;
+  for (auto const& lg : this->LocalGenerators) {
+    for (auto const& gt : lg->GetGeneratorTargets()) {
+      index.emplace(gt.get(), targets.size());
+      targets.push_back(gt.get());
+    }
+  }
+
+  // Dependencies outside the build system do not contribute marks.
+  cmGraphAdjacencyList graph;
+  graph.resize(targets.size());
+  for (size_t i = 0; i < targets.size(); ++i) {
+    for (cmTargetDepend const& depend :
+         this->GetTargetDirectDepends(targets[i])) {
+      auto di = index.find(depend);
+      if (di != index.end() && depend->IsInBuildSystem()) {
+        graph[i].emplace_back(di->second, false, false,
+                              cmListFileBacktrace());
       }
-      count += this->CountProgressMarksInTarget(depend, emitted);
     }
   }
-  return count;
-}
 
-size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInAll(
-  cmLocalGenerator const& lg)
-{
-  size_t count = 0;
-  std::set<cmGeneratorTarget const*> emitted;
-  for (cmGeneratorTarget const* target :
-       this->DirectoryTargetsMap[lg.GetStateSnapshot()]) {
-    if (!this->IsExcluded(&lg, target)) {
-      count += this->CountProgressMarksInTarget(target, emitted);
+  cmComputeComponentGraph ccg(graph);
+  ccg.Compute();
+  std::vector<size_t> const& componentMap = ccg.GetComponentMap();
+  size_t const componentCount = ccg.GetComponentGraph().size();
+  std::vector<size_t> marks(componentCount, 0);
+  for (size_t i = 0; i < targets.size(); ++i) {
+    auto pmi = this->ProgressMap.find(targets[i]);
+    if (pmi != this->ProgressMap.end()) {
+      marks[componentMap[i]] += pmi->second.Marks.size();
     }
   }
-  return count;
+
+  // The "all" target of a directory reaches the union of what its
+  // targets reach.  Collect the unions while the sets are visited.
+  std::vector<std::vector<size_t>> componentDirectories(componentCount);
+  for (size_t d = 0; d < this->LocalGenerators.size(); ++d) {
+    cmLocalGenerator const* lg = this->LocalGenerators[d].get();
+    for (cmGeneratorTarget const* target :
+         this->DirectoryTargetsMap[lg->GetStateSnapshot()]) {
+      auto ti = index.find(target);
+      if (ti != index.end() && !this->IsExcluded(lg, target)) {
+        std::vector<size_t>& dirs =
+          componentDirectories[componentMap[ti->second]];
+        if (dirs.empty() || dirs.back() != d) {
+          dirs.push_back(d);
+        }
+      }
+    }
+  }
+  std::vector<cmGraphNodeSet> directoryComponents(
+    this->LocalGenerators.size());
+
+  // Sum the marks of the reachable components of each component.
+  std::vector<size_t> counts(componentCount, 0);
+  ccg.VisitReachableComponents(
+    [&](size_t c, cmGraphNodeSet const& reachable) {
+      reachable.ForEach([&](size_t r) { counts[c] += marks[r]; });
+      for (size_t d : componentDirectories[c]) {
+        directoryComponents[d].Merge(reachable);
+      }
+    });
+
+  for (size_t i = 0; i < targets.size(); ++i) {
+    this->TargetProgressMarks.emplace(targets[i], counts[componentMap[i]]);
+  }
+  for (size_t d = 0; d < this->LocalGenerators.size(); ++d) {
+    size_t count = 0;
+    directoryComponents[d].ForEach([&](size_t r) { count += marks[r]; });
+    this->DirectoryProgressMarks.emplace(this->LocalGenerators[d].get(),
+                                         count);
+  }
+}
+
+size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInTarget(
+  cmGeneratorTarget const* target) const
+{
+  auto it = this->TargetProgressMarks.find(target);
+  return it == this->TargetProgressMarks.end() ? 0 : it->second;
+}
+
+size_t cmGlobalUnixMakefileGenerator3::CountProgressMarksInAll(
+  cmLocalGenerator const& lg) const
+{
+  auto it = this->DirectoryProgressMarks.find(&lg);
+  return it == this->DirectoryProgressMarks.end() ? 0 : it->second;
 }
 
 void cmGlobalUnixMakefileGenerator3::RecordTargetProgress(
@@ -868,6 +969,72 @@ void cmGlobalUnixMakefileGenerator3::RecordTargetProgress(
   tp.VariableFile = tg->GetProgressFileNameFull();
 }
 
+bool cmGlobalUnixMakefileGenerator3::ReuseTargetRuleFiles(
+  cmGeneratorTarget* gt, std::string const& config)
+{
+  std::string const dir = gt->GetSupportDirectory();
+  std::string const fingerprintFile = cmStrCat(dir, "/fingerprint.txt");
+  if (!this->TargetFingerprints) {
+    // Do not leave a fingerprint that may not match the rule files.
+    cmSystemTools::RemoveFile(fingerprintFile);
+    return false;
+  }
+
+  switch (gt->GetType()) {
+    case cmStateEnums::EXECUTABLE:
+    case cmStateEnums::STATIC_LIBRARY:
+    case cmStateEnums::SHARED_LIBRARY:
+    case cmStateEnums::MODULE_LIBRARY:
+    case cmStateEnums::OBJECT_LIBRARY:
+      break;
+    default:
+      return false;
+  }
+  ++this->FingerprintedTargets;
+
+  std::string const& fingerprint = this->TargetFingerprints->Get(gt, config);
+  if (!fingerprint.empty()) {
+    bool reuse = false;
+    unsigned long actions = 0;
+    {
+      cmsys::ifstream fin(fingerprintFile.c_str());
+      std::string line;
+      reuse = fin && cmSystemTools::GetLineFromStream(fin, line) &&
+        line == fingerprint && cmSystemTools::GetLineFromStream(fin, line) &&
+        cmStrToULong(line, &actions);
+    }
+    for (char const* name : { "build.make", "flags.make", "depend.make",
+                              "DependInfo.cmake", "cmake_clean.cmake" }) {
+      reuse = reuse && cmSystemTools::FileExists(cmStrCat(dir, '/', name));
+    }
+    if (reuse) {
+      TargetProgress& tp = this->ProgressMap[gt];
+      tp.NumberOfActions = actions;
+      tp.VariableFile = cmStrCat(dir, "/progress.make");
+      ++this->ReusedTargets;
+      return true;
+    }
+    this->PendingFingerprints[gt] = fingerprint;
+  }
+
+  // The rule files are about to be rewritten.
+  cmSystemTools::RemoveFile(fingerprintFile);
+  return false;
+}
+
+void cmGlobalUnixMakefileGenerator3::RecordTargetFingerprint(
+  cmMakefileTargetGenerator* tg)
+{
+  auto it = this->PendingFingerprints.find(tg->GetGeneratorTarget());
+  if (it == this->PendingFingerprints.end()) {
+    return;
+  }
+  this->FingerprintFiles[cmStrCat(
+    tg->GetGeneratorTarget()->GetSupportDirectory(), "/fingerprint.txt")] =
+    cmStrCat(it->second, '\n', tg->GetNumberOfProgressActions(), '\n');
+  this->PendingFingerprints.erase(it);
+}
+
 void cmGlobalUnixMakefileGenerator3::TargetProgress::WriteProgressVariables(
   unsigned long total, unsigned long& current)
 {
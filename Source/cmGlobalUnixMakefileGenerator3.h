@@ -10,6 +10,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include "cmBuildOptions.h"
@@ -23,6 +24,7 @@ class cmLocalGenerator;
 class cmLocalUnixMakefileGenerator3;
 class cmMakefile;
 class cmMakefileTargetGenerator;
+class cmTargetFingerprints;
 class cmake;
 
 /** \class cmGlobalUnixMakefileGenerator3
@@ -179,6 +181,15 @@ public:
   /** Record per-target progress information.  */
   void RecordTargetProgress(cmMakefileTargetGenerator* tg);
 
+  /** Return true if the rule files written for the target by a previous
+      run are still valid, recording the progress information they need.
+      Only used when CMAKE_INCREMENTAL_GENERATE is enabled.  */
+  bool ReuseTargetRuleFiles(cmGeneratorTarget* gt,
+                            std::string const& config);
+
+  /** Record the fingerprint of a target whose rule files were written.  */
+  void RecordTargetFingerprint(cmMakefileTargetGenerator* tg);
+
   void AddCXXCompileCommand(std::string const& sourceFile,
                             std::string const& workingDirectory,
                             std::string const& compileCommand,
@@ -285,13 +296,25 @@ protected:
                                    cmGeneratorTarget::StrictTargetComparison>;
   ProgressMapType ProgressMap;
 
-  size_t CountProgressMarksInTarget(
-    cmGeneratorTarget const* target,
-    std::set<cmGeneratorTarget const*>& emitted);
-  size_t CountProgressMarksInAll(cmLocalGenerator const& lg);
+  // The progress marks of a target include those of all targets it
+  // depends on.  Count them in one pass over the global dependency
+  // graph instead of walking it again for every target, and keep only
+  // the counts.
+  std::unordered_map<cmGeneratorTarget const*, size_t> TargetProgressMarks;
+  std::unordered_map<cmLocalGenerator const*, size_t> DirectoryProgressMarks;
+  void ComputeProgressMarks();
+  size_t CountProgressMarksInTarget(cmGeneratorTarget const* target) const;
+  size_t CountProgressMarksInAll(cmLocalGenerator const& lg) const;
 
   std::unique_ptr<cmGeneratedFileStream> CommandDatabase;
 
+  // Fingerprints of targets for incremental generation.
+  std::unique_ptr<cmTargetFingerprints> TargetFingerprints;
+  std::map<cmGeneratorTarget const*, std::string> PendingFingerprints;
+  std::map<std::string, std::string> FingerprintFiles;
+  unsigned long ReusedTargets = 0;
+  unsigned long FingerprintedTargets = 0;
+
 private:
   char const* GetBuildIgnoreErrorsFlag() const override { return "-i"; }
 
@@ -286,11 +286,13 @@ bool cmGlobalVisualStudio8Generator::AddCheckTarget()
     // The custom rule runs cmake so set UTF-8 pipes.
     bool stdPipesUTF8 = true;
 
-    // Add a custom prebuild target to run the VerifyGlobs script.
+    // Add a custom prebuild target to verify the globs.
     cmake* cm = this->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
-      cmCustomCommandLines verifyCommandLines = cmMakeSingleCommandLine(
-        { cmSystemTools::GetCMakeCommand(), "-P", cm->GetGlobVerifyScript() });
+      cmCustomCommandLines verifyCommandLines =
+        cmMakeSingleCommandLine({ cmSystemTools::GetCMakeCommand(), "-E",
+                                  "cmake_verify_globs",
+                                  cm->GetGlobVerifyManifest() });
       std::vector<std::string> byproducts;
       byproducts.push_back(cm->GetGlobVerifyStamp());
 
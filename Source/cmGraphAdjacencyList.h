@@ -5,6 +5,7 @@
 #include "cmConfigure.h" // IWYU pragma: keep
 
 #include <cstddef>
+#include <cstdint>
 #include <utility>
 #include <vector>
 
@@ -48,3 +49,63 @@ struct cmGraphNodeList : public std::vector<size_t>
 struct cmGraphAdjacencyList : public std::vector<cmGraphEdgeList>
 {
 };
+
+/**
+ * Set of graph nodes stored as one bit per node index.  Merging the
+ * set of another node costs one word operation per 64 node indices,
+ * no matter how many nodes either set contains, so sets of nodes
+ * reachable from each node can be accumulated over large graphs.
+ */
+class cmGraphNodeSet
+{
+public:
+  bool Empty() const { return this->Words.empty(); }
+
+  /** Remove all nodes and release the memory of the set.  */
+  void Clear() { std::vector<Word>().swap(this->Words); }
+
+  bool Contains(size_t n) const
+  {
+    size_t const w = n / WordBits;
+    return w < this->Words.size() &&
+      (this->Words[w] & (Word(1) << (n % WordBits))) != 0;
+  }
+
+  void Insert(size_t n)
+  {
+    size_t const w = n / WordBits;
+    if (w >= this->Words.size()) {
+      this->Words.resize(w + 1);
+    }
+    this->Words[w] |= Word(1) << (n % WordBits);
+  }
+
+  void Merge(cmGraphNodeSet const& other)
+  {
+    if (other.Words.size() > this->Words.size()) {
+      this->Words.resize(other.Words.size());
+    }
+    for (size_t w = 0; w < other.Words.size(); ++w) {
+      this->Words[w] |= other.Words[w];
+    }
+  }
+
+  /** Call a function with each node index in increasing order.  */
+  template <typename F>
+  void ForEach(F f) const
+  {
+    for (size_t w = 0; w < this->Words.size(); ++w) {
+      size_t n = w * WordBits;
+      for (Word bits = this->Words[w]; bits != 0; bits >>= 1, ++n) {
+        if (bits & 1) {
+          f(n);
+        }
+      }
+    }
+  }
+
+private:
+  using Word = std::uint64_t;
+  static size_t const WordBits = 64;
+  std::vector<Word> Words;
+};
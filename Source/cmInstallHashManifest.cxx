@@ -0,0 +1,209 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmInstallHashManifest.h"
+
+#include <utility>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+#ifndef CMAKE_BOOTSTRAP
+#  include "cmFileLock.h"
+#  include "cmFileLockResult.h"
+#endif
+
+namespace {
+// Change this to invalidate all existing manifests.
+char const ManifestHeader[] = "# CMake install hash manifest 1";
+
+std::string HashFile(std::string const& path)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  return hasher.HashFile(path);
+}
+}
+
+bool cmInstallHashManifest::FileState::Load(std::string const& path)
+{
+  cmFileTime time;
+  if (!time.Load(path)) {
+    return false;
+  }
+  this->Time = time.GetTime();
+  this->Size = cmSystemTools::FileLength(path);
+  return true;
+}
+
+cmInstallHashManifest::cmInstallHashManifest(std::string path)
+  : Path(std::move(path))
+{
+  ReadFile(this->Path, this->Entries);
+}
+
+bool cmInstallHashManifest::ReadFile(std::string const& path,
+                                     EntryMap& entries)
+{
+  cmsys::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  std::string line;
+  if (!cmSystemTools::GetLineFromStream(fin, line) ||
+      line != ManifestHeader) {
+    return false;
+  }
+  // Each line holds the source time and size, the destination time and
+  // size, the content hash, and the destination path.
+  while (cmSystemTools::GetLineFromStream(fin, line)) {
+    std::vector<std::string> fields;
+    std::string::size_type pos = 0;
+    for (int i = 0; i < 5; ++i) {
+      std::string::size_type const space = line.find(' ', pos);
+      if (space == std::string::npos) {
+        return false;
+      }
+      fields.emplace_back(line.substr(pos, space - pos));
+      pos = space + 1;
+    }
+    Entry entry;
+    if (!cmStrToLongLong(fields[0], &entry.Source.Time) ||
+        !cmStrToULongLong(fields[1], &entry.Source.Size) ||
+        !cmStrToLongLong(fields[2], &entry.Destination.Time) ||
+        !cmStrToULongLong(fields[3], &entry.Destination.Size) ||
+        fields[4].empty() || pos >= line.size()) {
+      return false;
+    }
+    entry.Hash = std::move(fields[4]);
+    entries[line.substr(pos)] = std::move(entry);
+  }
+  return true;
+}
+
+cmInstallHashManifest::Examination cmInstallHashManifest::Examine(
+  std::string const& source, std::string const& destination)
+{
+  Examination examination;
+  FileState dest;
+  if (!examination.Source.Load(source) || !dest.Load(destination)) {
+    return examination;
+  }
+
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto const i = this->Entries.find(destination);
+    if (i == this->Entries.end()) {
+      return examination;
+    }
+    entry = i->second;
+  }
+
+  // The destination must not have changed since it was recorded.
+  if (entry.Destination != dest) {
+    examination.Modified = true;
+    return examination;
+  }
+  if (entry.Source == examination.Source) {
+    examination.UpToDate = true;
+    return examination;
+  }
+
+  // The source has been rewritten.  Read it only if it may still have
+  // the content of the destination.
+  if (examination.Source.Size == dest.Size &&
+      HashFile(source) == entry.Hash) {
+    examination.UpToDate = true;
+  }
+  return examination;
+}
+
+void cmInstallHashManifest::Record(Examination const& examination,
+                                   std::string const& destination,
+                                   bool copied)
+{
+  if (examination.UpToDate && !copied) {
+    // Remember the new state of a rewritten source with the same content.
+    std::lock_guard<std::mutex> lock(this->Mutex);
+    auto const i = this->Entries.find(destination);
+    if (i != this->Entries.end() &&
+        i->second.Source != examination.Source) {
+      i->second.Source = examination.Source;
+      this->Updated.insert(destination);
+    }
+    return;
+  }
+
+  // Hash what was actually installed, which is already in memory after
+  // a copy.
+  Entry entry;
+  entry.Source = examination.Source;
+  if (!entry.Destination.Load(destination)) {
+    return;
+  }
+  entry.Hash = HashFile(destination);
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  if (entry.Hash.empty()) {
+    this->Entries.erase(destination);
+  } else {
+    this->Entries[destination] = std::move(entry);
+  }
+  this->Updated.insert(destination);
+}
+
+bool cmInstallHashManifest::Save()
+{
+  std::lock_guard<std::mutex> lock(this->Mutex);
+  if (this->Updated.empty()) {
+    return true;
+  }
+
+  cmSystemTools::MakeDirectory(cmSystemTools::GetFilenamePath(this->Path));
+
+#ifndef CMAKE_BOOTSTRAP
+  // Another process may save the manifest at the same time.
+  std::string const lockFile = cmStrCat(this->Path, ".lock");
+  if (!cmSystemTools::FileExists(lockFile, true) &&
+      !cmSystemTools::Touch(lockFile, true)) {
+    return false;
+  }
+  cmFileLock fileLock;
+  if (!fileLock.Lock(lockFile, static_cast<unsigned long>(-1)).IsOk()) {
+    return false;
+  }
+#endif
+
+  // Another process may have saved entries since this one loaded.
+  EntryMap entries;
+  ReadFile(this->Path, entries);
+  for (std::string const& destination : this->Updated) {
+    auto const i = this->Entries.find(destination);
+    if (i != this->Entries.end()) {
+      entries[destination] = i->second;
+    } else {
+      entries.erase(destination);
+    }
+  }
+
+  cmGeneratedFileStream fout(this->Path);
+  if (!fout) {
+    return false;
+  }
+  fout << ManifestHeader << '\n';
+  for (auto const& i : entries) {
+    Entry const& entry = i.second;
+    fout << entry.Source.Time << ' ' << entry.Source.Size << ' '
+         << entry.Destination.Time << ' ' << entry.Destination.Size << ' '
+         << entry.Hash << ' ' << i.first << '\n';
+  }
+  if (!fout.Close()) {
+    return false;
+  }
+  this->Updated.clear();
+  return true;
+}
@@ -0,0 +1,91 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+
+/** \class cmInstallHashManifest
+ * \brief Record the content of installed files to skip unchanged ones.
+ *
+ * When the CMAKE_INSTALL_HASH_MANIFEST variable names a file,
+ * file(INSTALL) records there, for each destination file, the SHA-256
+ * hash of its content together with its own modification time and size
+ * and those of its source.  A later installation does not copy a file
+ * whose destination is unchanged and whose source still has the
+ * recorded content, even if the source has been rewritten.  The source
+ * is read only if its time or size changed.
+ *
+ * The manifest is loaded when constructed and written by Save.  Saving
+ * locks the file, and merges the entries updated by this process into
+ * the file on disk, so that install scripts running in parallel do not
+ * lose each other's entries.  Examine and Record may be called from
+ * multiple threads.
+ */
+class cmInstallHashManifest
+{
+public:
+  cmInstallHashManifest(std::string path);
+
+  cmInstallHashManifest(cmInstallHashManifest const&) = delete;
+  cmInstallHashManifest& operator=(cmInstallHashManifest const&) = delete;
+
+  std::string const& GetPath() const { return this->Path; }
+
+  struct FileState
+  {
+    long long Time = 0;
+    unsigned long long Size = 0;
+    bool Load(std::string const& path);
+    bool operator==(FileState const& r) const
+    {
+      return this->Time == r.Time && this->Size == r.Size;
+    }
+    bool operator!=(FileState const& r) const { return !(*this == r); }
+  };
+
+  struct Examination
+  {
+    // Whether the destination holds the content of the source.
+    bool UpToDate = false;
+    // Whether the destination changed since its content was recorded.
+    bool Modified = false;
+    // The state of the source before it was examined.
+    FileState Source;
+  };
+
+  /** Check whether the destination still holds the recorded content and
+      the source has the same content.  */
+  Examination Examine(std::string const& source,
+                      std::string const& destination);
+
+  /** Record the state of a destination after the given examination of
+      its source, and whether the source was then copied to it.  */
+  void Record(Examination const& examination, std::string const& destination,
+              bool copied);
+
+  /** Write the entries updated since loading or the last save.  Returns
+      false if the manifest could not be written.  */
+  bool Save();
+
+private:
+  struct Entry
+  {
+    FileState Source;
+    FileState Destination;
+    std::string Hash;
+  };
+  // Ordered so that the manifest is written in a stable order.
+  using EntryMap = std::map<std::string, Entry>;
+
+  static bool ReadFile(std::string const& path, EntryMap& entries);
+
+  std::string Path;
+  std::mutex Mutex;
+  EntryMap Entries;
+  std::unordered_set<std::string> Updated;
+};
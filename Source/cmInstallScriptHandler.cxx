@@ -7,6 +7,7 @@
 #include <cstddef>
 #include <memory>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -126,6 +127,16 @@ int cmInstallScriptHandler::Install(unsigned int j,
     cmd.insert(cmd.begin(), instrument_arg.begin(), instrument_arg.end());
     scripts.emplace_back(cmd);
   }
+
+  // The scripts copy files on multiple threads.  Share the processors
+  // among the scripts running at the same time.
+  if (j > 1 && !cmSystemTools::HasEnv("CMAKE_FILE_COPY_PARALLEL_LEVEL")) {
+    unsigned int const cores =
+      std::max(std::thread::hardware_concurrency(), 1u);
+    cmSystemTools::PutEnv(cmStrCat("CMAKE_FILE_COPY_PARALLEL_LEVEL=",
+                                   std::max(cores / j, 1u)));
+  }
+
   std::size_t working = 0;
   std::size_t installed = 0;
   std::size_t i = 0;
@@ -13,6 +13,9 @@
 
 #include "cmList.h"
 #include "cmListFileLexer.h"
+#if !defined(CMAKE_BOOTSTRAP)
+#  include "cmListFileParseCache.h"
+#endif
 #include "cmMessageType.h"
 #include "cmMessenger.h"
 #include "cmStringAlgorithms.h"
@@ -53,6 +56,8 @@ public:
   bool ParseFile(char const* filename);
   bool ParseString(char const* str, char const* virtual_filename);
 
+  bool IssuedWarning() const { return this->Warned; }
+
 private:
   bool Parse();
   bool ParseFunction(char const* name, long line);
@@ -79,6 +84,7 @@ private:
   long FunctionLine;
   long FunctionLineEnd;
   std::vector<cmListFileArgument> FunctionArguments;
+  bool Warned = false;
 };
 
 cmListFileParser::cmListFileParser(cmListFile* lf, cmListFileBacktrace lfbt,
@@ -326,6 +332,7 @@ bool cmListFileParser::AddArgument(cmListFileLexer_Token* token,
     return false;
   }
   this->Messenger->IssueMessage(MessageType::AUTHOR_WARNING, msg, lfbt);
+  this->Warned = true;
   return true;
 }
 
@@ -425,19 +432,41 @@ cm::optional<cmListFileContext> cmListFileParser::CheckNesting() const
 } // anonymous namespace
 
 bool cmListFile::ParseFile(char const* filename, cmMessenger* messenger,
-                           cmListFileBacktrace const& lfbt)
+                           cmListFileBacktrace const& lfbt,
+                           cmListFileParseCache* cache)
 {
   if (!cmSystemTools::FileExists(filename) ||
       cmSystemTools::FileIsDirectory(filename)) {
     return false;
   }
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (cache && this->Functions.empty() &&
+      cache->Find(filename, this->Functions)) {
+    return true;
+  }
+#else
+  static_cast<void>(cache);
+#endif
+
   bool parseError = false;
+  bool warned = false;
 
   {
     cmListFileParser parser(this, lfbt, messenger);
     parseError = !parser.ParseFile(filename);
+    warned = parser.IssuedWarning();
+  }
+
+#if !defined(CMAKE_BOOTSTRAP)
+  // Files that produce diagnostics are parsed every time so that the
+  // diagnostics are reported every time.
+  if (cache && !parseError && !warned) {
+    cache->Insert(filename, this->Functions);
   }
+#else
+  static_cast<void>(warned);
+#endif
 
   return !parseError;
 }
@@ -23,6 +23,7 @@
  * cmake list files.
  */
 
+class cmListFileParseCache;
 class cmMessenger;
 
 struct cmListFileArgument
@@ -239,7 +240,8 @@ std::vector<BT<std::string>> cmExpandListWithBacktrace(
 struct cmListFile
 {
   bool ParseFile(char const* path, cmMessenger* messenger,
-                 cmListFileBacktrace const& lfbt);
+                 cmListFileBacktrace const& lfbt,
+                 cmListFileParseCache* cache = nullptr);
 
   bool ParseString(char const* str, char const* virtual_filename,
                    cmMessenger* messenger, cmListFileBacktrace const& lfbt);
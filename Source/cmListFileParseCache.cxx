@@ -0,0 +1,384 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmListFileParseCache.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <utility>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmSystemTools.h"
+#include "cmVersion.h"
+
+namespace {
+
+// Bump the last byte whenever the encoding changes.  The magic is
+// followed by the version of the cmake that wrote the file, because the
+// parser of another version may produce different commands.
+char const Magic[8] = { 'C', 'M', 'L', 'F', 'P', 'C', '\0', '\2' };
+
+class Encoder
+{
+public:
+  explicit Encoder(std::string& out)
+    : Out(out)
+  {
+  }
+
+  template <typename T>
+  void Write(T value)
+  {
+    char buf[sizeof(T)];
+    std::memcpy(buf, &value, sizeof(T));
+    this->Out.append(buf, sizeof(T));
+  }
+
+  void WriteString(std::string const& s)
+  {
+    this->Write(static_cast<std::uint32_t>(s.size()));
+    this->Out.append(s);
+  }
+
+  void WriteFunctions(std::vector<cmListFileFunction> const& functions)
+  {
+    this->Write(static_cast<std::uint32_t>(functions.size()));
+    for (cmListFileFunction const& func : functions) {
+      this->WriteString(func.OriginalName());
+      this->Write(static_cast<std::int64_t>(func.Line()));
+      this->Write(static_cast<std::int64_t>(func.LineEnd()));
+      this->Write(static_cast<std::uint32_t>(func.Arguments().size()));
+      for (cmListFileArgument const& arg : func.Arguments()) {
+        this->WriteString(arg.Value);
+        this->Write(static_cast<std::uint8_t>(arg.Delim));
+        this->Write(static_cast<std::int64_t>(arg.Line));
+      }
+    }
+  }
+
+private:
+  std::string& Out;
+};
+
+class Decoder
+{
+public:
+  Decoder(char const* begin, char const* end)
+    : Pos(begin)
+    , End(end)
+  {
+  }
+
+  bool AtEnd() const { return this->Pos == this->End; }
+  std::size_t Remaining() const
+  {
+    return static_cast<std::size_t>(this->End - this->Pos);
+  }
+  char const* Position() const { return this->Pos; }
+
+  template <typename T>
+  bool Read(T& value)
+  {
+    if (static_cast<std::size_t>(this->End - this->Pos) < sizeof(T)) {
+      return false;
+    }
+    std::memcpy(&value, this->Pos, sizeof(T));
+    this->Pos += sizeof(T);
+    return true;
+  }
+
+  bool Skip(std::uint64_t n)
+  {
+    if (static_cast<std::uint64_t>(this->End - this->Pos) < n) {
+      return false;
+    }
+    this->Pos += n;
+    return true;
+  }
+
+  bool ReadString(std::string& s)
+  {
+    std::uint32_t size;
+    if (!this->Read(size)) {
+      return false;
+    }
+    char const* data = this->Pos;
+    if (!this->Skip(size)) {
+      return false;
+    }
+    s.assign(data, size);
+    return true;
+  }
+
+  bool ReadBytes(std::vector<unsigned char>& bytes)
+  {
+    std::uint32_t size;
+    if (!this->Read(size)) {
+      return false;
+    }
+    char const* data = this->Pos;
+    if (!this->Skip(size)) {
+      return false;
+    }
+    bytes.assign(data, data + size);
+    return true;
+  }
+
+  bool ReadFunctions(std::vector<cmListFileFunction>& functions)
+  {
+    std::uint32_t count;
+    if (!this->Read(count)) {
+      return false;
+    }
+    // The counts come from the file.  Each element takes at least one
+    // byte, so do not reserve more than the bytes left.
+    functions.reserve(std::min<std::size_t>(count, this->Remaining()));
+    for (std::uint32_t i = 0; i < count; ++i) {
+      std::string name;
+      std::int64_t line;
+      std::int64_t lineEnd;
+      std::uint32_t argCount;
+      if (!this->ReadString(name) || !this->Read(line) ||
+          !this->Read(lineEnd) || !this->Read(argCount)) {
+        return false;
+      }
+      std::vector<cmListFileArgument> args;
+      args.reserve(std::min<std::size_t>(argCount, this->Remaining()));
+      for (std::uint32_t j = 0; j < argCount; ++j) {
+        std::string value;
+        std::uint8_t delim;
+        std::int64_t argLine;
+        if (!this->ReadString(value) || !this->Read(delim) ||
+            delim > cmListFileArgument::Bracket || !this->Read(argLine)) {
+          return false;
+        }
+        args.emplace_back(std::move(value),
+                          static_cast<cmListFileArgument::Delimiter>(delim),
+                          static_cast<long>(argLine));
+      }
+      functions.emplace_back(std::move(name), static_cast<long>(line),
+                             static_cast<long>(lineEnd), std::move(args));
+    }
+    return this->AtEnd();
+  }
+
+private:
+  char const* Pos;
+  char const* End;
+};
+
+} // anonymous namespace
+
+cmListFileParseCache::cmListFileParseCache(std::string cacheFile)
+  : CacheFile(std::move(cacheFile))
+{
+}
+
+cmListFileParseCache::~cmListFileParseCache() = default;
+
+void cmListFileParseCache::Load()
+{
+  this->Entries.clear();
+  this->Data.clear();
+
+  cmsys::ifstream fin(this->CacheFile.c_str(),
+                      std::ios::in | std::ios::binary);
+  if (!fin) {
+    return;
+  }
+  this->Data.assign(std::istreambuf_iterator<char>(fin),
+                    std::istreambuf_iterator<char>());
+
+  if (this->Data.size() < sizeof(Magic) ||
+      std::memcmp(this->Data.data(), Magic, sizeof(Magic)) != 0) {
+    this->Data.clear();
+    this->Modified = true;
+    return;
+  }
+
+  // Index the entries without decoding their commands.
+  Decoder d(this->Data.data() + sizeof(Magic),
+            this->Data.data() + this->Data.size());
+  std::string version;
+  if (!d.ReadString(version) || version != cmVersion::GetCMakeVersion()) {
+    // Another cmake wrote the file.  Start over.
+    this->Data.clear();
+    this->Modified = true;
+    return;
+  }
+  while (!d.AtEnd()) {
+    std::string path;
+    Entry entry;
+    std::int64_t mtime;
+    std::uint64_t size;
+    std::uint64_t length;
+    if (!d.ReadString(path) || !d.Read(mtime) || !d.Read(size) ||
+        !d.ReadBytes(entry.Hash) || !d.Read(length)) {
+      break;
+    }
+    entry.State.MTime = mtime;
+    entry.State.Size = size;
+    entry.Offset = static_cast<std::size_t>(d.Position() - this->Data.data());
+    entry.Length = static_cast<std::size_t>(length);
+    if (!d.Skip(length)) {
+      break;
+    }
+    this->Entries.emplace(std::move(path), std::move(entry));
+  }
+
+  if (!d.AtEnd()) {
+    // The file is truncated or corrupt.  Start over.
+    this->Entries.clear();
+    this->Data.clear();
+    this->Modified = true;
+  }
+}
+
+bool cmListFileParseCache::Save()
+{
+  for (auto const& e : this->Entries) {
+    if (!e.second.Used) {
+      this->Modified = true;
+      break;
+    }
+  }
+  if (!this->Modified) {
+    return true;
+  }
+
+  std::string out(Magic, sizeof(Magic));
+  Encoder enc(out);
+  enc.WriteString(cmVersion::GetCMakeVersion());
+  for (auto& e : this->Entries) {
+    Entry& entry = e.second;
+    if (!entry.Used) {
+      // Drop entries for listfiles this run did not read.
+      continue;
+    }
+    enc.WriteString(e.first);
+    enc.Write(static_cast<std::int64_t>(entry.State.MTime));
+    enc.Write(static_cast<std::uint64_t>(entry.State.Size));
+    enc.Write(static_cast<std::uint32_t>(entry.Hash.size()));
+    out.append(entry.Hash.begin(), entry.Hash.end());
+    if (entry.Decoded) {
+      std::string body;
+      Encoder(body).WriteFunctions(entry.Functions);
+      enc.Write(static_cast<std::uint64_t>(body.size()));
+      out.append(body);
+    } else {
+      enc.Write(static_cast<std::uint64_t>(entry.Length));
+      out.append(this->Data, entry.Offset, entry.Length);
+    }
+  }
+
+  cmGeneratedFileStream fout;
+  fout.Open(this->CacheFile, true, true);
+  fout.write(out.data(), static_cast<std::streamsize>(out.size()));
+  if (!fout.Close()) {
+    return false;
+  }
+  this->Modified = false;
+  return true;
+}
+
+bool cmListFileParseCache::Find(std::string const& path,
+                                std::vector<cmListFileFunction>& functions)
+{
+  FileState state;
+  if (!SampleFileState(path, state)) {
+    return false;
+  }
+
+  auto it = this->Entries.find(path);
+  if (it != this->Entries.end()) {
+    Entry& entry = it->second;
+    bool unchanged =
+      entry.State.MTime == state.MTime && entry.State.Size == state.Size;
+    if (!unchanged && entry.State.Size == state.Size) {
+      // The file was touched.  Its content may still be the same.
+      std::vector<unsigned char> hash = HashFile(path);
+      if (!hash.empty() && hash == entry.Hash) {
+        entry.State = state;
+        this->Modified = true;
+        unchanged = true;
+      }
+    }
+    if (unchanged && this->Decode(entry)) {
+      entry.Used = true;
+      functions.insert(functions.end(), entry.Functions.begin(),
+                       entry.Functions.end());
+      return true;
+    }
+    this->Entries.erase(it);
+    this->Modified = true;
+  }
+
+  this->Pending[path] = state;
+  return false;
+}
+
+void cmListFileParseCache::Insert(
+  std::string const& path, std::vector<cmListFileFunction> const& functions)
+{
+  auto pending = this->Pending.find(path);
+  if (pending == this->Pending.end()) {
+    return;
+  }
+  FileState const before = pending->second;
+  this->Pending.erase(pending);
+
+  // Do not cache the result if the file changed while it was parsed.
+  Entry entry;
+  entry.Hash = HashFile(path);
+  FileState after;
+  if (entry.Hash.empty() || !SampleFileState(path, after) ||
+      after.MTime != before.MTime || after.Size != before.Size) {
+    return;
+  }
+
+  entry.State = before;
+  entry.Decoded = true;
+  entry.Used = true;
+  entry.Functions = functions;
+  this->Entries[path] = std::move(entry);
+  this->Modified = true;
+}
+
+bool cmListFileParseCache::SampleFileState(std::string const& path,
+                                           FileState& state)
+{
+  cmFileTime ft;
+  if (!ft.Load(path)) {
+    return false;
+  }
+  state.MTime = ft.GetTime();
+  state.Size = cmSystemTools::FileLength(path);
+  return true;
+}
+
+std::vector<unsigned char> cmListFileParseCache::HashFile(
+  std::string const& path)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  return hasher.ByteHashFile(path);
+}
+
+bool cmListFileParseCache::Decode(Entry& entry)
+{
+  if (entry.Decoded) {
+    return true;
+  }
+  char const* begin = this->Data.data() + entry.Offset;
+  Decoder d(begin, begin + entry.Length);
+  if (!d.ReadFunctions(entry.Functions)) {
+    entry.Functions.clear();
+    return false;
+  }
+  entry.Decoded = true;
+  return true;
+}
@@ -0,0 +1,85 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cmListFileCache.h"
+
+/** \class cmListFileParseCache
+ * \brief Persistent cache of parsed listfiles.
+ *
+ * Stores the commands parsed from each listfile in a compact binary file
+ * in the build tree so that later runs need not lex unchanged listfiles
+ * again.  An entry is reused if the modification time and size of its
+ * listfile are unchanged, or otherwise if the content hash still matches.
+ *
+ * The cache file records the version of cmake that wrote it, and is
+ * discarded by any other version.  It then holds a sequence of entries,
+ * each with a fixed header followed by the encoded commands.  Loading
+ * only reads the headers; the commands of an entry are decoded when it
+ * is first used.
+ */
+class cmListFileParseCache
+{
+public:
+  cmListFileParseCache(std::string cacheFile);
+  ~cmListFileParseCache();
+
+  cmListFileParseCache(cmListFileParseCache const&) = delete;
+  cmListFileParseCache& operator=(cmListFileParseCache const&) = delete;
+
+  /** Load the entries saved by a previous run, if any.  */
+  void Load();
+
+  /** Write the cache file if any entry changed since it was loaded.  */
+  bool Save();
+
+  /**
+   * Look up the given listfile.  On a hit, append its commands to
+   * functions and return true.
+   */
+  bool Find(std::string const& path,
+            std::vector<cmListFileFunction>& functions);
+
+  /**
+   * Store the commands parsed from the given listfile.  The listfile
+   * state must have been sampled by a preceding Find for the same path.
+   */
+  void Insert(std::string const& path,
+              std::vector<cmListFileFunction> const& functions);
+
+private:
+  struct FileState
+  {
+    long long MTime = 0;
+    unsigned long long Size = 0;
+  };
+
+  struct Entry
+  {
+    FileState State;
+    std::vector<unsigned char> Hash;
+    // Location of the encoded commands in the loaded data, if not decoded.
+    std::size_t Offset = 0;
+    std::size_t Length = 0;
+    bool Decoded = false;
+    bool Used = false;
+    std::vector<cmListFileFunction> Functions;
+  };
+
+  static bool SampleFileState(std::string const& path, FileState& state);
+  static std::vector<unsigned char> HashFile(std::string const& path);
+  bool Decode(Entry& entry);
+
+  std::string CacheFile;
+  std::string Data;
+  std::unordered_map<std::string, Entry> Entries;
+  std::unordered_map<std::string, FileState> Pending;
+  bool Modified = false;
+};
@@ -577,6 +577,19 @@ void cmLocalGenerator::GenerateInstallRules()
     /* clang-format on */
   }
 
+  // Compare installed files by content with a manifest of their hashes.
+  if (this->Makefile->IsOn("CMAKE_INSTALL_COMPARE_CONTENT")) {
+    /* clang-format off */
+    fout <<
+      "# Record the content of installed files to skip unchanged ones?\n"
+      "if(NOT DEFINED CMAKE_INSTALL_HASH_MANIFEST)\n"
+      "  set(CMAKE_INSTALL_HASH_MANIFEST \""
+         << homedir << "/install_hash_manifest.txt\")\n"
+      "endif()\n"
+      "\n";
+    /* clang-format on */
+  }
+
   // Copy cmake cross compile state to install code.
   if (cmValue crosscompiling =
         this->Makefile->GetDefinition("CMAKE_CROSSCOMPILING")) {
@@ -186,11 +186,16 @@ void cmLocalUnixMakefileGenerator3::Generate()
       gtVisited.insert(depVisited.begin(), depVisited.end());
     }
 
+    if (gg->ReuseTargetRuleFiles(gt, this->GetConfigName())) {
+      continue;
+    }
+
     std::unique_ptr<cmMakefileTargetGenerator> tg(
       cmMakefileTargetGenerator::New(gt));
     if (tg) {
       tg->WriteRuleFiles();
       gg->RecordTargetProgress(tg.get());
+      gg->RecordTargetFingerprint(tg.get());
     }
   }
 
@@ -692,7 +697,7 @@ void cmLocalUnixMakefileGenerator3::WriteMakeVariables(
   };
 
   std::string cmakeShellCommand =
-    getShellCommand(cmSystemTools::GetCMakeCommand());
+    getShellCommand(this->GlobalGenerator->GetCMakeCommandForBuild());
 
   makefileStream << "# The CMake executable.\n"
                     "CMAKE_COMMAND = "
@@ -844,8 +849,8 @@ void cmLocalUnixMakefileGenerator3::WriteSpecialTargetsBottom(
     cmake* cm = this->GlobalGenerator->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
       std::string rescanRule =
-        cmStrCat("$(CMAKE_COMMAND) -P ",
-                 this->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
+        cmStrCat("$(CMAKE_COMMAND) -E cmake_verify_globs ",
+                 this->ConvertToOutputFormat(cm->GetGlobVerifyManifest(),
                                              cmOutputConverter::SHELL));
       commands.push_back(rescanRule);
     }
@@ -1532,17 +1537,16 @@ bool cmLocalUnixMakefileGenerator3::UpdateDependencies(
         return false;
       }
 
-      // Open the cmake dependency tracking file.  This should not be
+      // Open the cmake dependency database.  This should not be
       // copy-if-different because dependencies are re-scanned when it is
-      // older than the DependInfo.cmake.
-      cmGeneratedFileStream internalRuleFileStream(
-        internalDepFile, false, this->GlobalGenerator->GetMakefileEncoding());
+      // older than the compiler generated dependencies files.
+      cmGeneratedFileStream internalRuleFileStream;
+      internalRuleFileStream.Open(internalDepFile, false, true);
       if (!internalRuleFileStream) {
         return false;
       }
 
       this->WriteDisclaimer(ruleFileStream);
-      this->WriteDisclaimer(internalRuleFileStream);
 
       depsManager.WriteDependencies(dependencies, ruleFileStream,
                                     internalRuleFileStream);
@@ -1857,8 +1861,8 @@ void cmLocalUnixMakefileGenerator3::WriteLocalAllRules(
     cmake* cm = this->GlobalGenerator->GetCMakeInstance();
     if (cm->DoWriteGlobVerifyTarget()) {
       std::string rescanRule =
-        cmStrCat("$(CMAKE_COMMAND) -P ",
-                 this->ConvertToOutputFormat(cm->GetGlobVerifyScript(),
+        cmStrCat("$(CMAKE_COMMAND) -E cmake_verify_globs ",
+                 this->ConvertToOutputFormat(cm->GetGlobVerifyManifest(),
                                              cmOutputConverter::SHELL));
       commands.push_back(rescanRule);
     }
@@ -46,8 +46,9 @@ bool cmMacroHelperCommand::operator()(
   cmMakefile& makefile = inStatus.GetMakefile();
 
   // Expand the argument list to the macro.
-  std::vector<std::string> expandedArgs;
-  makefile.ExpandArguments(args, expandedArgs);
+  cmMakefile::ExpandedArgumentsScope expandedArgsScope(makefile);
+  expandedArgsScope.Expand(args);
+  std::vector<std::string> const& expandedArgs = expandedArgsScope.Get();
 
   // make sure the number of arguments passed is at least the number
   // required by the signature
@@ -494,6 +494,8 @@ public:
           argsValue["location"] = cmStrCat(lfc.FilePath, ':', lfc.Line);
           return argsValue;
         });
+    this->ExpandedArgumentAllocations =
+      this->Makefile->GetExpandedArgumentAllocations();
 #endif
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->Makefile->GetCMakeInstance()->GetDebugAdapter()) {
@@ -507,6 +509,14 @@ public:
   ~CallScope()
   {
 #if !defined(CMAKE_BOOTSTRAP)
+    if (this->ProfilingDataRAII) {
+      Json::Value argsValue = Json::objectValue;
+      argsValue["argumentAllocations"] =
+        static_cast<Json::Value::UInt64>(
+          this->Makefile->GetExpandedArgumentAllocations() -
+          this->ExpandedArgumentAllocations);
+      this->ProfilingDataRAII->Stop(std::move(argsValue));
+    }
     this->ProfilingDataRAII.reset();
 #endif
     auto* const mf = this->Detach();
@@ -525,6 +535,7 @@ public:
 private:
 #if !defined(CMAKE_BOOTSTRAP)
   cm::optional<cmMakefileProfilingData::RAII> ProfilingDataRAII;
+  std::size_t ExpandedArgumentAllocations = 0;
 #endif
 };
 
@@ -680,7 +691,8 @@ bool cmMakefile::ReadDependentFile(std::string const& filename,
 
   cmListFile listFile;
   if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->Backtrace,
+                          this->GetCMakeInstance()->GetListFileParseCache())) {
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->GetCMakeInstance()->GetDebugAdapter()) {
       this->GetCMakeInstance()->GetDebugAdapter()->OnEndFileParse();
@@ -803,7 +815,8 @@ bool cmMakefile::ReadListFile(std::string const& filename)
 
   cmListFile listFile;
   if (!listFile.ParseFile(filenametoread.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->Backtrace,
+                          this->GetCMakeInstance()->GetListFileParseCache())) {
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->GetCMakeInstance()->GetDebugAdapter()) {
       this->GetCMakeInstance()->GetDebugAdapter()->OnEndFileParse();
@@ -1581,7 +1594,8 @@ void cmMakefile::Configure()
 
   cmListFile listFile;
   if (!listFile.ParseFile(currentStart.c_str(), this->GetMessenger(),
-                          this->Backtrace)) {
+                          this->Backtrace,
+                          this->GetCMakeInstance()->GetListFileParseCache())) {
 #ifdef CMake_ENABLE_DEBUGGER
     if (this->GetCMakeInstance()->GetDebugAdapter()) {
       this->GetCMakeInstance()->GetDebugAdapter()->OnEndFileParse();
@@ -3020,6 +3034,93 @@ bool cmMakefile::ExpandArguments(
   return !cmSystemTools::GetFatalErrorOccurred();
 }
 
+cmMakefile::ExpandedArgumentsScope::ExpandedArgumentsScope(cmMakefile& mf)
+  : Makefile(mf)
+{
+  auto& buffers = this->Makefile.ExpandedArgumentBuffers;
+  if (this->Makefile.ExpandedArgumentBuffersInUse == buffers.size()) {
+    buffers.emplace_back(cm::make_unique<std::vector<std::string>>());
+    ++this->Makefile.ExpandedArgumentAllocations;
+  }
+  this->Args = buffers[this->Makefile.ExpandedArgumentBuffersInUse++].get();
+}
+
+cmMakefile::ExpandedArgumentsScope::~ExpandedArgumentsScope()
+{
+  --this->Makefile.ExpandedArgumentBuffersInUse;
+}
+
+std::string& cmMakefile::ExpandedArgumentsScope::NextArgument()
+{
+  std::vector<std::string>& args = *this->Args;
+  if (this->Count == args.size()) {
+    if (args.size() == args.capacity()) {
+      ++this->Makefile.ExpandedArgumentAllocations;
+    }
+    args.emplace_back();
+  }
+  return args[this->Count++];
+}
+
+bool cmMakefile::ExpandedArgumentsScope::Expand(
+  std::vector<cmListFileArgument> const& inArgs)
+{
+  cmMakefile& mf = this->Makefile;
+  std::string const& filename = mf.GetBacktrace().Top().FilePath;
+  std::size_t const sso = std::string().capacity();
+  // Assign to the strings left by the previous command to reuse their
+  // storage, and count the assignments that need a larger one.
+  auto assign = [&mf](std::string& arg, std::string const& value) {
+    if (value.size() > arg.capacity()) {
+      ++mf.ExpandedArgumentAllocations;
+    }
+    arg = value;
+  };
+  this->Count = 0;
+  for (cmListFileArgument const& i : inArgs) {
+    std::string& arg = this->NextArgument();
+    assign(arg, i.Value);
+    // No expansion in a bracket argument.
+    if (i.Delim == cmListFileArgument::Bracket) {
+      continue;
+    }
+    // Expand the variables in the argument.
+    std::size_t const capacity = arg.capacity();
+    mf.ExpandVariablesInString(arg, false, false, false, filename.c_str(),
+                               i.Line, false, false);
+    if (arg.capacity() > capacity) {
+      ++mf.ExpandedArgumentAllocations;
+    }
+
+    // If the argument is quoted, it should be one argument.
+    // Otherwise, it may be a list of arguments.
+    if (i.Delim == cmListFileArgument::Quoted) {
+      continue;
+    }
+    if (arg.empty()) {
+      --this->Count;
+    } else if (arg.find(';') != std::string::npos) {
+      --this->Count;
+      std::vector<std::string>& elements = mf.ExpandedListElements;
+      std::size_t const elementsCapacity = elements.capacity();
+      elements.clear();
+      cmExpandList(arg, elements);
+      if (elements.capacity() > elementsCapacity) {
+        ++mf.ExpandedArgumentAllocations;
+      }
+      for (std::string& element : elements) {
+        if (element.capacity() > sso) {
+          ++mf.ExpandedArgumentAllocations;
+        }
+        // Swap the element into place, its storage is already allocated.
+        std::swap(this->NextArgument(), element);
+      }
+    }
+  }
+  this->Args->resize(this->Count);
+  return !cmSystemTools::GetFatalErrorOccurred();
+}
+
 void cmMakefile::AddFunctionBlocker(std::unique_ptr<cmFunctionBlocker> fb)
 {
   if (!this->ExecutionStatusStack.empty()) {
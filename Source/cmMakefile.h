@@ -779,6 +779,39 @@ public:
   bool ExpandArguments(std::vector<cmListFileArgument> const& inArgs,
                        std::vector<cmExpandedCommandArgument>& outArgs) const;
 
+  /**
+   * Expand list file arguments like ExpandArguments into storage that
+   * is reused by the next command invoked at the same call depth, so
+   * that commands executed repeatedly, e.g. in loops, do not allocate
+   * new argument strings on every invocation.
+   */
+  class ExpandedArgumentsScope
+  {
+  public:
+    ExpandedArgumentsScope(cmMakefile& mf);
+    ~ExpandedArgumentsScope();
+
+    ExpandedArgumentsScope(ExpandedArgumentsScope const&) = delete;
+    ExpandedArgumentsScope& operator=(ExpandedArgumentsScope const&) =
+      delete;
+
+    bool Expand(std::vector<cmListFileArgument> const& inArgs);
+    std::vector<std::string> const& Get() const { return *this->Args; }
+
+  private:
+    std::string& NextArgument();
+
+    cmMakefile& Makefile;
+    std::vector<std::string>* Args;
+    std::size_t Count = 0;
+  };
+
+  /** Number of heap allocations made for expanded arguments so far.  */
+  std::size_t GetExpandedArgumentAllocations() const
+  {
+    return this->ExpandedArgumentAllocations;
+  }
+
   /**
    * Get the instance
    */
@@ -1180,6 +1213,13 @@ private:
 
   std::stack<int> LoopBlockCounter;
 
+  // Storage of ExpandedArgumentsScope, one entry per call depth.
+  std::vector<std::unique_ptr<std::vector<std::string>>>
+    ExpandedArgumentBuffers;
+  std::size_t ExpandedArgumentBuffersInUse = 0;
+  std::vector<std::string> ExpandedListElements;
+  std::size_t ExpandedArgumentAllocations = 0;
+
   mutable cmsys::RegularExpression cmDefineRegex;
   mutable cmsys::RegularExpression cmDefine01Regex;
   mutable cmsys::RegularExpression cmNamedCurly;
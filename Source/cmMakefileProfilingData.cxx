@@ -79,7 +79,7 @@ void cmMakefileProfilingData::StartEntry(std::string const& category,
   }
 }
 
-void cmMakefileProfilingData::StopEntry()
+void cmMakefileProfilingData::StopEntry(cm::optional<Json::Value> args)
 {
   /* Do not try again if we previously failed to write to output. */
   if (!this->ProfileStream.good()) {
@@ -97,6 +97,9 @@ void cmMakefileProfilingData::StopEntry()
         .count());
     v["pid"] = static_cast<int>(info.GetProcessId());
     v["tid"] = 0;
+    if (args) {
+      v["args"] = *std::move(args);
+    }
     this->JsonWriter->write(v, &this->ProfileStream);
   } catch (std::ios_base::failure& fail) {
     cmSystemTools::Error(
@@ -128,6 +131,14 @@ cmMakefileProfilingData::RAII::~RAII()
   }
 }
 
+void cmMakefileProfilingData::RAII::Stop(cm::optional<Json::Value> args)
+{
+  if (this->Data) {
+    this->Data->StopEntry(std::move(args));
+    this->Data = nullptr;
+  }
+}
+
 cmMakefileProfilingData::RAII& cmMakefileProfilingData::RAII::operator=(
   RAII&& other) noexcept
 {
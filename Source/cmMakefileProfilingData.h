@@ -21,7 +21,7 @@ public:
   ~cmMakefileProfilingData() noexcept;
   void StartEntry(std::string const& category, std::string const& name,
                   cm::optional<Json::Value> args = cm::nullopt);
-  void StopEntry();
+  void StopEntry(cm::optional<Json::Value> args = cm::nullopt);
 
   class RAII
   {
@@ -39,6 +39,9 @@ public:
     RAII& operator=(const RAII&) = delete;
     RAII& operator=(RAII&&) noexcept;
 
+    /** End the entry now and record additional arguments with it.  */
+    void Stop(cm::optional<Json::Value> args);
+
   private:
     cmMakefileProfilingData* Data = nullptr;
   };
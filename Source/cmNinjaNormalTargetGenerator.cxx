@@ -635,9 +635,7 @@ void cmNinjaNormalTargetGenerator::WriteLinkRule(
   auto const tgtNames = this->TargetNames(config);
   if (tgtNames.Output != tgtNames.Real &&
       !this->GetGeneratorTarget()->IsFrameworkOnApple()) {
-    std::string cmakeCommand =
-      this->GetLocalGenerator()->ConvertToOutputFormat(
-        cmSystemTools::GetCMakeCommand(), cmOutputConverter::SHELL);
+    std::string cmakeCommand = this->GetGlobalGenerator()->CMakeCmd();
     if (targetType == cmStateEnums::EXECUTABLE) {
       cmNinjaRule rule("CMAKE_SYMLINK_EXECUTABLE");
       {
@@ -691,9 +689,7 @@ void cmNinjaNormalTargetGenerator::WriteLinkRule(
         !this->GetGeneratorTarget()->IsFrameworkOnApple()) {
       cmNinjaRule slRule("CMAKE_SYMLINK_IMPORT_LIBRARY");
       {
-        std::string cmakeCommand =
-          this->GetLocalGenerator()->ConvertToOutputFormat(
-            cmSystemTools::GetCMakeCommand(), cmOutputConverter::SHELL);
+        std::string cmakeCommand = this->GetGlobalGenerator()->CMakeCmd();
         std::string slCmd =
           cmStrCat(cmakeCommand, " -E cmake_symlink_library $in $SONAME $out");
         slRule.Command = this->GetLocalGenerator()->BuildCommandLine(
@@ -757,8 +753,7 @@ std::vector<std::string> cmNinjaNormalTargetGenerator::ComputeLinkCmd(
         cmValue lwyuCheck = mf->GetDefinition("CMAKE_LINK_WHAT_YOU_USE_CHECK");
         if (lwyuCheck) {
           std::string cmakeCommand = cmStrCat(
-            this->GetLocalGenerator()->ConvertToOutputFormat(
-              cmSystemTools::GetCMakeCommand(), cmLocalGenerator::SHELL),
+            this->GetGlobalGenerator()->CMakeCmd(),
             " -E __run_co_compile --lwyu=");
           cmakeCommand +=
             this->GetLocalGenerator()->EscapeForShell(*lwyuCheck);
@@ -778,9 +773,7 @@ std::vector<std::string> cmNinjaNormalTargetGenerator::ComputeLinkCmd(
     case cmStateEnums::STATIC_LIBRARY: {
       // We have archive link commands set. First, delete the existing archive.
       {
-        std::string cmakeCommand =
-          this->GetLocalGenerator()->ConvertToOutputFormat(
-            cmSystemTools::GetCMakeCommand(), cmOutputConverter::SHELL);
+        std::string cmakeCommand = this->GetGlobalGenerator()->CMakeCmd();
         linkCmds.push_back(cmakeCommand + " -E rm -f $TARGET_FILE");
       }
       // TODO: Use ARCHIVE_APPEND for archives over a certain size.
@@ -812,9 +805,7 @@ std::vector<std::string> cmNinjaNormalTargetGenerator::ComputeLinkCmd(
       // leads to re-archiving and updating dependent targets.
       // As a work-around we touch the archive after ranlib (see #19222).
       {
-        std::string cmakeCommand =
-          this->GetLocalGenerator()->ConvertToOutputFormat(
-            cmSystemTools::GetCMakeCommand(), cmOutputConverter::SHELL);
+        std::string cmakeCommand = this->GetGlobalGenerator()->CMakeCmd();
         linkCmds.push_back(cmakeCommand + " -E touch $TARGET_FILE");
       }
 #endif
@@ -1484,9 +1475,7 @@ void cmNinjaNormalTargetGenerator::WriteLinkStatement(
   cmGeneratorTarget::ModuleDefinitionInfo const* mdi =
     gt->GetModuleDefinitionInfo(config);
   if (mdi && mdi->DefFileGenerated) {
-    std::string cmakeCommand =
-      this->GetLocalGenerator()->ConvertToOutputFormat(
-        cmSystemTools::GetCMakeCommand(), cmOutputConverter::SHELL);
+    std::string cmakeCommand = this->GetGlobalGenerator()->CMakeCmd();
     std::string cmd =
       cmStrCat(cmakeCommand, " -E __create_def ",
                this->GetLocalGenerator()->ConvertToOutputFormat(
@@ -708,9 +708,7 @@ void cmNinjaTargetGenerator::WriteCompileRule(std::string const& lang,
     launcher = cmStrCat(val, ' ');
   }
 
-  std::string const cmakeCmd =
-    this->GetLocalGenerator()->ConvertToOutputFormat(
-      cmSystemTools::GetCMakeCommand(), cmLocalGenerator::SHELL);
+  std::string const cmakeCmd = this->GetGlobalGenerator()->CMakeCmd();
 
   if (withScanning == WithScanning::Yes) {
     auto const& scanDepType = this->GetMakefile()->GetSafeDefinition(
@@ -1425,8 +1423,7 @@ void cmNinjaTargetGenerator::WriteObjectBuildStatement(
 
   cmValue const skipCodeCheck = source->GetProperty("SKIP_LINTING");
   if (!skipCodeCheck.IsOn()) {
-    auto const cmakeCmd = this->GetLocalGenerator()->ConvertToOutputFormat(
-      cmSystemTools::GetCMakeCommand(), cmLocalGenerator::SHELL);
+    auto const cmakeCmd = this->GetGlobalGenerator()->CMakeCmd();
     vars["CODE_CHECK"] =
       this->GenerateCodeCheckRules(*source, compilerLauncher, cmakeCmd, config,
                                    [this](std::string const& path) {
@@ -0,0 +1,57 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmParallelFor.h"
+
+#include <algorithm>
+
+#ifndef CMAKE_BOOTSTRAP
+#  include <atomic>
+#  include <thread>
+#  include <vector>
+#endif
+
+unsigned int cmParallelForJobs(std::size_t count, unsigned int jobs)
+{
+#ifndef CMAKE_BOOTSTRAP
+  if (jobs == 0) {
+    jobs = std::thread::hardware_concurrency();
+  }
+#endif
+  jobs = std::max(jobs, 1u);
+  if (count > 0 && count < jobs) {
+    jobs = static_cast<unsigned int>(count);
+  }
+  return jobs;
+}
+
+void cmParallelFor(
+  std::size_t count, unsigned int jobs,
+  std::function<void(std::size_t index, unsigned int worker)> const& func)
+{
+#ifndef CMAKE_BOOTSTRAP
+  unsigned int const threadCount = cmParallelForJobs(count, jobs);
+  if (threadCount > 1) {
+    std::atomic<std::size_t> next(0);
+    auto worker = [count, &func, &next](unsigned int id) {
+      for (std::size_t i = next++; i < count; i = next++) {
+        func(i, id);
+      }
+    };
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    for (unsigned int id = 1; id < threadCount; ++id) {
+      threads.emplace_back(worker, id);
+    }
+    worker(0);
+    for (std::thread& t : threads) {
+      t.join();
+    }
+    return;
+  }
+#else
+  static_cast<void>(jobs);
+#endif
+  for (std::size_t i = 0; i < count; ++i) {
+    func(i, 0);
+  }
+}
@@ -0,0 +1,24 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <cstddef>
+#include <functional>
+
+/** Compute the number of threads cmParallelFor uses for the given number
+    of items and job limit.  A limit of 0 means one job per processor.
+    The result is at least 1 and at most the number of items, if any.  */
+unsigned int cmParallelForJobs(std::size_t count, unsigned int jobs);
+
+/** Call func(index, worker) for each index from 0 up to count.  The calls
+    are spread over cmParallelForJobs(count, jobs) threads, the calling
+    thread included, and return when all have finished.  The worker
+    argument identifies the calling thread with a number less than the
+    thread count so that callers may keep state per thread.  Indices are
+    handed out in increasing order but may complete in any order.  The
+    bootstrap build makes all calls on the calling thread.  */
+void cmParallelFor(
+  std::size_t count, unsigned int jobs,
+  std::function<void(std::size_t index, unsigned int worker)> const& func);
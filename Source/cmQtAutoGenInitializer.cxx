@@ -587,6 +587,13 @@ bool cmQtAutoGenInitializer::InitCustomTargets()
       this->ConfigFileNames(this->AutogenTarget.ParseCacheFile,
                             cmStrCat(this->Dir.Info, "/ParseCache"), ".txt");
       this->ConfigFileClean(this->AutogenTarget.ParseCacheFile);
+
+      // Parse cache shared by all targets of the build tree
+      if (this->GenTarget->GetPropertyAsBool("AUTOGEN_SHARED_PARSE_CACHE")) {
+        this->AutogenTarget.ParseCacheSharedDir =
+          cmStrCat(this->Makefile->GetHomeOutputDirectory(),
+                   "/CMakeFiles/AutogenParseCache");
+      }
     }
 
     // Autogen target: Compute user defined dependencies
@@ -1931,6 +1938,7 @@ bool cmQtAutoGenInitializer::SetupWriteAutogenInfo()
   info.Set("CMAKE_EXECUTABLE", cmSystemTools::GetCMakeCommand());
   info.SetConfig("SETTINGS_FILE", this->AutogenTarget.SettingsFile);
   info.SetConfig("PARSE_CACHE_FILE", this->AutogenTarget.ParseCacheFile);
+  info.Set("PARSE_CACHE_SHARED_DIR", this->AutogenTarget.ParseCacheSharedDir);
   info.SetConfig("DEP_FILE", this->AutogenTarget.DepFile);
   info.SetConfig("DEP_FILE_RULE_NAME", this->AutogenTarget.DepFileRuleName);
   info.SetArray("CMAKE_LIST_FILES", this->Makefile->GetListFiles());
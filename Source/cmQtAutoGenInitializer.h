@@ -192,6 +192,7 @@ private:
     std::string InfoFile;
     ConfigString SettingsFile;
     ConfigString ParseCacheFile;
+    std::string ParseCacheSharedDir;
     // Dependencies
     bool DependOrigin = false;
     std::set<std::string> DependFiles;
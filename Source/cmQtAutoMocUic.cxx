@@ -5,6 +5,7 @@
 #include <algorithm>
 #include <atomic>
 #include <cstddef>
+#include <iosfwd>
 #include <limits>
 #include <map>
 #include <set>
@@ -118,10 +119,18 @@ public:
     bool ReadFromFile(std::string const& fileName);
     bool WriteToFile(std::string const& fileName);
 
+    //! Read or write the single entry of a shared parse cache file
+    static bool ReadEntryFromFile(std::string const& fileName, FileT& file);
+    static bool WriteEntryToFile(std::string const& fileName,
+                                 FileT const& file);
+
     //! Always returns a valid handle
     GetOrInsertT GetOrInsert(std::string const& fileName);
 
   private:
+    static void ReadEntryLine(std::string const& line, FileT& file);
+    static void WriteEntry(std::ostream& os, FileT const& file);
+
     std::unordered_map<std::string, FileHandleT> Map_;
   };
 
@@ -183,6 +192,8 @@ public:
     std::string CMakeExecutable;
     cmFileTime CMakeExecutableTime;
     std::string ParseCacheFile;
+    std::string ParseCacheSharedDir;
+    std::string ParseCacheSharedKey;
     std::string DepFile;
     std::string DepFileRuleName;
     std::vector<std::string> HeaderExtensions;
@@ -378,6 +389,9 @@ public:
     }
 
   protected:
+    std::string SharedCacheEntryFile(bool header) const;
+    bool SharedCacheRead(std::string const& entryFile);
+    void SharedCacheWrite(std::string const& entryFile);
     bool ReadFile();
     void CreateKeys(std::vector<IncludeKeyT>& container,
                     std::set<std::string> const& source,
@@ -662,42 +676,58 @@ bool cmQtAutoMocUicT::ParseCacheT::ReadFromFile(std::string const& fileName)
       continue;
     }
 
-    // Bad line or bad file handle
-    if (!fileHandle || (line.size() < 6)) {
+    // Bad file handle
+    if (!fileHandle) {
       continue;
     }
+    ReadEntryLine(line, *fileHandle);
+  }
+  return true;
+}
 
-    constexpr std::size_t offset = 5;
-    if (cmHasLiteralPrefix(line, " mmc:")) {
-      fileHandle->Moc.Macro = line.substr(offset);
-      continue;
-    }
-    if (cmHasLiteralPrefix(line, " miu:")) {
-      fileHandle->Moc.Include.Underscore.emplace_back(line.substr(offset),
-                                                      MocUnderscoreLength);
-      continue;
-    }
-    if (cmHasLiteralPrefix(line, " mid:")) {
-      fileHandle->Moc.Include.Dot.emplace_back(line.substr(offset), 0);
-      continue;
-    }
-    if (cmHasLiteralPrefix(line, " mdp:")) {
-      fileHandle->Moc.Depends.emplace_back(line.substr(offset));
-      continue;
-    }
-    if (cmHasLiteralPrefix(line, " uic:")) {
-      fileHandle->Uic.Include.emplace_back(line.substr(offset),
-                                           UiUnderscoreLength);
-      continue;
-    }
-    if (cmHasLiteralPrefix(line, " udp:")) {
-      fileHandle->Uic.Depends.emplace_back(line.substr(offset));
-      continue;
+bool cmQtAutoMocUicT::ParseCacheT::ReadEntryFromFile(
+  std::string const& fileName, FileT& file)
+{
+  cmsys::ifstream fin(fileName.c_str());
+  if (!fin) {
+    return false;
+  }
+  std::string line;
+  while (std::getline(fin, line)) {
+    // Drop carriage return character at the end
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
     }
+    ReadEntryLine(line, file);
   }
   return true;
 }
 
+void cmQtAutoMocUicT::ParseCacheT::ReadEntryLine(std::string const& line,
+                                                 FileT& file)
+{
+  // Bad line
+  if (line.size() < 6) {
+    return;
+  }
+
+  constexpr std::size_t offset = 5;
+  if (cmHasLiteralPrefix(line, " mmc:")) {
+    file.Moc.Macro = line.substr(offset);
+  } else if (cmHasLiteralPrefix(line, " miu:")) {
+    file.Moc.Include.Underscore.emplace_back(line.substr(offset),
+                                             MocUnderscoreLength);
+  } else if (cmHasLiteralPrefix(line, " mid:")) {
+    file.Moc.Include.Dot.emplace_back(line.substr(offset), 0);
+  } else if (cmHasLiteralPrefix(line, " mdp:")) {
+    file.Moc.Depends.emplace_back(line.substr(offset));
+  } else if (cmHasLiteralPrefix(line, " uic:")) {
+    file.Uic.Include.emplace_back(line.substr(offset), UiUnderscoreLength);
+  } else if (cmHasLiteralPrefix(line, " udp:")) {
+    file.Uic.Depends.emplace_back(line.substr(offset));
+  }
+}
+
 bool cmQtAutoMocUicT::ParseCacheT::WriteToFile(std::string const& fileName)
 {
   cmGeneratedFileStream ofs(fileName);
@@ -707,29 +737,47 @@ bool cmQtAutoMocUicT::ParseCacheT::WriteToFile(std::string const& fileName)
   ofs << "# Generated by CMake. Changes will be overwritten.\n";
   for (auto const& pair : this->Map_) {
     ofs << pair.first << '\n';
-    FileT const& file = *pair.second;
-    if (!file.Moc.Macro.empty()) {
-      ofs << " mmc:" << file.Moc.Macro << '\n';
-    }
-    for (IncludeKeyT const& item : file.Moc.Include.Underscore) {
-      ofs << " miu:" << item.Key << '\n';
-    }
-    for (IncludeKeyT const& item : file.Moc.Include.Dot) {
-      ofs << " mid:" << item.Key << '\n';
-    }
-    for (std::string const& item : file.Moc.Depends) {
-      ofs << " mdp:" << item << '\n';
-    }
-    for (IncludeKeyT const& item : file.Uic.Include) {
-      ofs << " uic:" << item.Key << '\n';
-    }
-    for (std::string const& item : file.Uic.Depends) {
-      ofs << " udp:" << item << '\n';
-    }
+    WriteEntry(ofs, *pair.second);
+  }
+  return ofs.Close();
+}
+
+bool cmQtAutoMocUicT::ParseCacheT::WriteEntryToFile(
+  std::string const& fileName, FileT const& file)
+{
+  // The entry is written to a temporary file that replaces the old entry
+  // when it is complete.  Concurrent readers see either entry in full.
+  cmGeneratedFileStream ofs(fileName);
+  if (!ofs) {
+    return false;
   }
+  WriteEntry(ofs, file);
   return ofs.Close();
 }
 
+void cmQtAutoMocUicT::ParseCacheT::WriteEntry(std::ostream& os,
+                                              FileT const& file)
+{
+  if (!file.Moc.Macro.empty()) {
+    os << " mmc:" << file.Moc.Macro << '\n';
+  }
+  for (IncludeKeyT const& item : file.Moc.Include.Underscore) {
+    os << " miu:" << item.Key << '\n';
+  }
+  for (IncludeKeyT const& item : file.Moc.Include.Dot) {
+    os << " mid:" << item.Key << '\n';
+  }
+  for (std::string const& item : file.Moc.Depends) {
+    os << " mdp:" << item << '\n';
+  }
+  for (IncludeKeyT const& item : file.Uic.Include) {
+    os << " uic:" << item.Key << '\n';
+  }
+  for (std::string const& item : file.Uic.Depends) {
+    os << " udp:" << item << '\n';
+  }
+}
+
 cmQtAutoMocUicT::BaseSettingsT::BaseSettingsT() = default;
 cmQtAutoMocUicT::BaseSettingsT::~BaseSettingsT() = default;
 
@@ -972,6 +1020,61 @@ bool cmQtAutoMocUicT::JobMocPredefsT::Update(std::string* reason) const
   return false;
 }
 
+std::string cmQtAutoMocUicT::JobParseT::SharedCacheEntryFile(
+  bool header) const
+{
+  if (this->BaseConst().ParseCacheSharedDir.empty()) {
+    return std::string();
+  }
+  // The results depend on the parse settings and on what is parsed
+  cmCryptoHash cryptoHash(cmCryptoHash::AlgoSHA256);
+  cryptoHash.Initialize();
+  cryptoHash.Append(this->BaseConst().ParseCacheSharedKey);
+  cryptoHash.Append(header ? ";h" : ";s");
+  cryptoHash.Append(this->FileHandle->Moc ? "m" : "");
+  cryptoHash.Append(this->FileHandle->Uic ? "u;" : ";");
+  cryptoHash.Append(this->FileHandle->FileName);
+  std::string const key = cryptoHash.FinalizeHex();
+  return cmStrCat(this->BaseConst().ParseCacheSharedDir, '/',
+                  cm::string_view(key).substr(0, 2), '/', key, ".txt");
+}
+
+bool cmQtAutoMocUicT::JobParseT::SharedCacheRead(std::string const& entryFile)
+{
+  if (entryFile.empty()) {
+    return false;
+  }
+  // The entry must be newer than the file and the CMake executable
+  cmFileTime entryTime;
+  if (!entryTime.Load(entryFile) ||
+      entryTime.Older(this->BaseConst().CMakeExecutableTime) ||
+      this->FileHandle->FileTime.Newer(entryTime)) {
+    return false;
+  }
+  ParseCacheT::FileT& parseData = *this->FileHandle->ParseData;
+  parseData.Clear();
+  if (!ParseCacheT::ReadEntryFromFile(entryFile, parseData)) {
+    parseData.Clear();
+    return false;
+  }
+  if (this->Log().Verbose()) {
+    this->Log().Info(
+      GenT::GEN,
+      cmStrCat("Reusing the shared parse cache entry of ",
+               this->MessagePath(this->FileHandle->FileName)));
+  }
+  return true;
+}
+
+void cmQtAutoMocUicT::JobParseT::SharedCacheWrite(std::string const& entryFile)
+{
+  if (entryFile.empty()) {
+    return;
+  }
+  // A failure to write is not an error, the file is parsed again next time
+  ParseCacheT::WriteEntryToFile(entryFile, *this->FileHandle->ParseData);
+}
+
 bool cmQtAutoMocUicT::JobParseT::ReadFile()
 {
   // Clear old parse information
@@ -1129,7 +1232,8 @@ void cmQtAutoMocUicT::JobParseT::UicIncludes()
 
 void cmQtAutoMocUicT::JobParseHeaderT::Process()
 {
-  if (!this->ReadFile()) {
+  std::string const entryFile = this->SharedCacheEntryFile(true);
+  if (this->SharedCacheRead(entryFile) || !this->ReadFile()) {
     return;
   }
   // Moc parsing
@@ -1141,11 +1245,13 @@ void cmQtAutoMocUicT::JobParseHeaderT::Process()
   if (this->FileHandle->Uic) {
     this->UicIncludes();
   }
+  this->SharedCacheWrite(entryFile);
 }
 
 void cmQtAutoMocUicT::JobParseSourceT::Process()
 {
-  if (!this->ReadFile()) {
+  std::string const entryFile = this->SharedCacheEntryFile(false);
+  if (this->SharedCacheRead(entryFile) || !this->ReadFile()) {
     return;
   }
   // Moc parsing
@@ -1158,6 +1264,7 @@ void cmQtAutoMocUicT::JobParseSourceT::Process()
   if (this->FileHandle->Uic) {
     this->UicIncludes();
   }
+  this->SharedCacheWrite(entryFile);
 }
 
 std::string cmQtAutoMocUicT::JobEvalCacheT::MessageSearchLocations() const
@@ -2400,6 +2507,8 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
                       true) ||
       !info.GetStringConfig("PARSE_CACHE_FILE",
                             this->BaseConst_.ParseCacheFile, true) ||
+      !info.GetString("PARSE_CACHE_SHARED_DIR",
+                      this->BaseConst_.ParseCacheSharedDir, false) ||
       !info.GetStringConfig("SETTINGS_FILE", this->SettingsFile_, true) ||
       !info.GetArray("CMAKE_LIST_FILES", this->BaseConst_.ListFiles, true) ||
       !info.GetArray("HEADER_EXTENSIONS", this->BaseConst_.HeaderExtensions,
@@ -2612,6 +2721,31 @@ bool cmQtAutoMocUicT::InitFromInfo(InfoT const& info)
     }
   }
 
+  // -- Shared parse cache
+  if (!this->BaseConst_.ParseCacheSharedDir.empty()) {
+    // Targets share entries only if they parse files the same way
+    cmCryptoHash cryptoHash(cmCryptoHash::AlgoSHA256);
+    cryptoHash.Initialize();
+    auto cha = [&cryptoHash](cm::string_view value) {
+      cryptoHash.Append(value);
+      cryptoHash.Append(";");
+    };
+    if (this->MocConst_.Enabled) {
+      for (auto const& filter : this->MocConst_.MacroFilters) {
+        cha(filter.Key);
+      }
+      if (!this->MocConst_.CanOutputDependencies) {
+        // The filters were validated above
+        Json::Value const& val = info.GetValue("MOC_DEPEND_FILTERS");
+        for (Json::Value const& pairVal : val) {
+          cha(pairVal[0u].asString());
+          cha(pairVal[1u].asString());
+        }
+      }
+    }
+    this->BaseConst_.ParseCacheSharedKey = cryptoHash.FinalizeHex();
+  }
+
   // -- Headers
   {
     Json::Value const& val = info.GetValue("HEADERS");
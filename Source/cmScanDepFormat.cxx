@@ -60,8 +60,8 @@ static Json::Value EncodeFilename(std::string const& path)
 #define PARSE_BLOB(val, res)                                                  \
   do {                                                                        \
     if (!ParseFilename(val, res)) {                                           \
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ", \
-                                    arg_pp, ": invalid blob"));               \
+      error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,      \
+                       ": invalid blob");                                     \
       return false;                                                           \
     }                                                                         \
   } while (0)
@@ -69,8 +69,8 @@ static Json::Value EncodeFilename(std::string const& path)
 #define PARSE_FILENAME(val, res)                                              \
   do {                                                                        \
     if (!ParseFilename(val, res)) {                                           \
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ", \
-                                    arg_pp, ": invalid filename"));           \
+      error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,      \
+                       ": invalid filename");                                 \
       return false;                                                           \
     }                                                                         \
                                                                               \
@@ -82,6 +82,17 @@ static Json::Value EncodeFilename(std::string const& path)
 
 bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
                                  cmScanDepInfo* info)
+{
+  std::string error;
+  if (!cmScanDepFormat_P1689_Parse(arg_pp, info, error)) {
+    cmSystemTools::Error(error);
+    return false;
+  }
+  return true;
+}
+
+bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
+                                 cmScanDepInfo* info, std::string& error)
 {
   Json::Value ppio;
   Json::Value const& ppi = ppio;
@@ -89,25 +100,24 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
   {
     Json::Reader reader;
     if (!reader.parse(ppf, ppio, false)) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    arg_pp,
-                                    reader.getFormattedErrorMessages()));
+      error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                       reader.getFormattedErrorMessages());
       return false;
     }
   }
 
   Json::Value const& version = ppi["version"];
   if (version.asUInt() > 1) {
-    cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                  arg_pp, ": version ", version.asString()));
+    error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                     ": version ", version.asString());
     return false;
   }
 
   Json::Value const& rules = ppi["rules"];
   if (rules.isArray()) {
     if (rules.size() != 1) {
-      cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                    arg_pp, ": expected 1 source entry"));
+      error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                       ": expected 1 source entry");
       return false;
     }
 
@@ -119,9 +129,8 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
         PARSE_BLOB(workdir, wd);
         work_directory = std::move(wd);
       } else if (!workdir.isNull()) {
-        cmSystemTools::Error(cmStrCat("-E cmake_ninja_dyndep failed to parse ",
-                                      arg_pp,
-                                      ": work-directory is not a string"));
+        error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                         ": work-directory is not a string");
         return false;
       }
 
@@ -145,9 +154,8 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
       if (rule.isMember("provides")) {
         Json::Value const& provides = rule["provides"];
         if (!provides.isArray()) {
-          cmSystemTools::Error(
-            cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                     ": provides is not an array"));
+          error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                           ": provides is not an array");
           return false;
         }
 
@@ -168,9 +176,9 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
             Json::Value const& unique_on_source_path =
               provide["unique-on-source-path"];
             if (!unique_on_source_path.isBool()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": unique-on-source-path is not a boolean"));
+              error = cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                               arg_pp,
+                               ": unique-on-source-path is not a boolean");
               return false;
             }
             provide_info.UseSourcePath = unique_on_source_path.asBool();
@@ -182,18 +190,16 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
             Json::Value const& source_path = provide["source-path"];
             PARSE_FILENAME(source_path, provide_info.SourcePath);
           } else if (provide_info.UseSourcePath) {
-            cmSystemTools::Error(
-              cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                       ": source-path is missing"));
+            error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                             ": source-path is missing");
             return false;
           }
 
           if (provide.isMember("is-interface")) {
             Json::Value const& is_interface = provide["is-interface"];
             if (!is_interface.isBool()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": is-interface is not a boolean"));
+              error = cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                               arg_pp, ": is-interface is not a boolean");
               return false;
             }
             provide_info.IsInterface = is_interface.asBool();
@@ -208,9 +214,8 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
       if (rule.isMember("requires")) {
         Json::Value const& reqs = rule["requires"];
         if (!reqs.isArray()) {
-          cmSystemTools::Error(
-            cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                     ": requires is not an array"));
+          error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                           ": requires is not an array");
           return false;
         }
 
@@ -231,9 +236,9 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
             Json::Value const& unique_on_source_path =
               require["unique-on-source-path"];
             if (!unique_on_source_path.isBool()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": unique-on-source-path is not a boolean"));
+              error = cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                               arg_pp,
+                               ": unique-on-source-path is not a boolean");
               return false;
             }
             require_info.UseSourcePath = unique_on_source_path.asBool();
@@ -245,18 +250,16 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
             Json::Value const& source_path = require["source-path"];
             PARSE_FILENAME(source_path, require_info.SourcePath);
           } else if (require_info.UseSourcePath) {
-            cmSystemTools::Error(
-              cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                       ": source-path is missing"));
+            error = cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
+                             ": source-path is missing");
             return false;
           }
 
           if (require.isMember("lookup-method")) {
             Json::Value const& lookup_method = require["lookup-method"];
             if (!lookup_method.isString()) {
-              cmSystemTools::Error(
-                cmStrCat("-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                         ": lookup-method is not a string"));
+              error = cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                               arg_pp, ": lookup-method is not a string");
               return false;
             }
 
@@ -268,9 +271,9 @@ bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
             } else if (lookup_method_str == "include-quote"_s) {
               require_info.Method = LookupMethod::IncludeQuote;
             } else {
-              cmSystemTools::Error(cmStrCat(
-                "-E cmake_ninja_dyndep failed to parse ", arg_pp,
-                ": lookup-method is not a valid: ", lookup_method_str));
+              error = cmStrCat("-E cmake_ninja_dyndep failed to parse ",
+                               arg_pp, ": lookup-method is not a valid: ",
+                               lookup_method_str);
               return false;
             }
           } else if (require_info.UseSourcePath) {
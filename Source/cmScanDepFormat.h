@@ -38,5 +38,9 @@ struct cmScanDepInfo
 
 bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
                                  cmScanDepInfo* info);
+// Like the above, but stores the error message instead of reporting it,
+// so that it may be called from several threads at once.
+bool cmScanDepFormat_P1689_Parse(std::string const& arg_pp,
+                                 cmScanDepInfo* info, std::string& error);
 bool cmScanDepFormat_P1689_Write(std::string const& path,
                                  cmScanDepInfo const& info);
@@ -235,6 +235,11 @@ std::string const& cmState::GetGlobVerifyStamp() const
   return this->GlobVerificationManager->GetVerifyStamp();
 }
 
+std::string const& cmState::GetGlobVerifyManifest() const
+{
+  return this->GlobVerificationManager->GetVerifyManifest();
+}
+
 bool cmState::SaveVerificationScript(std::string const& path,
                                      cmMessenger* messenger)
 {
@@ -408,13 +413,13 @@ static bool InvokeBuiltinCommand(cmState::BuiltinCommand command,
                                  cmExecutionStatus& status)
 {
   cmMakefile& mf = status.GetMakefile();
-  std::vector<std::string> expandedArguments;
-  if (!mf.ExpandArguments(args, expandedArguments)) {
+  cmMakefile::ExpandedArgumentsScope expandedArguments(mf);
+  if (!expandedArguments.Expand(args)) {
     // There was an error expanding arguments.  It was already
     // reported, so we can skip this command without error.
     return true;
   }
-  return command(expandedArguments, status);
+  return command(expandedArguments.Get(), status);
 }
 
 void cmState::AddBuiltinCommand(std::string const& name,
@@ -677,6 +682,11 @@ bool cmState::GetGlobalPropertyAsBool(std::string const& prop)
   return this->GetGlobalProperty(prop).IsOn();
 }
 
+cmPropertyMap const& cmState::GetGlobalProperties() const
+{
+  return this->GlobalProperties;
+}
+
 void cmState::SetSourceDirectory(std::string const& sourceDirectory)
 {
   this->SourceDirectory = sourceDirectory;
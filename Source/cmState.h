@@ -199,6 +199,7 @@ public:
                             bool asString = false);
   cmValue GetGlobalProperty(std::string const& prop);
   bool GetGlobalPropertyAsBool(std::string const& prop);
+  cmPropertyMap const& GetGlobalProperties() const;
 
   std::string const& GetSourceDirectory() const;
   void SetSourceDirectory(std::string const& sourceDirectory);
@@ -265,6 +266,7 @@ private:
   bool DoWriteGlobVerifyTarget() const;
   std::string const& GetGlobVerifyScript() const;
   std::string const& GetGlobVerifyStamp() const;
+  std::string const& GetGlobVerifyManifest() const;
   bool SaveVerificationScript(std::string const& path, cmMessenger* messenger);
   void AddGlobCacheEntry(cmGlobCacheEntry const& entry,
                          std::string const& variable,
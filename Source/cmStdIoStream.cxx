@@ -137,12 +137,18 @@ Stream::Stream(std::ios& s, FILE* file, Direction direction)
   }
 #else
   static_cast<void>(direction);
-  if (isatty(this->FD_) && TermIsVT100()) {
-    this->Kind_ = TermKind::VT100;
-  }
+  this->DetectKind();
 #endif
 }
 
+#ifndef _WIN32
+void Stream::DetectKind()
+{
+  this->Kind_ = isatty(this->FD_) && TermIsVT100() ? TermKind::VT100
+                                                    : TermKind::None;
+}
+#endif
+
 #ifdef _WIN32
 Stream::~Stream()
 {
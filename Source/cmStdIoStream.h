@@ -45,6 +45,12 @@ public:
   void* Console() const { return this->Console_; }
 #endif
 
+#ifndef _WIN32
+  /** Detect the kind of terminal again after the underlying file
+      descriptor has been replaced, e.g., with dup2.  */
+  void DetectKind();
+#endif
+
 protected:
   enum class Direction
   {
@@ -2991,6 +2991,7 @@ std::string cmSystemToolsCPackCommand;
 std::string cmSystemToolsCMakeCursesCommand;
 std::string cmSystemToolsCMakeGUICommand;
 std::string cmSystemToolsCMClDepsCommand;
+std::string cmSystemToolsCMakeDaemonClientCommand;
 std::string cmSystemToolsCMakeRoot;
 std::string cmSystemToolsHTMLDoc;
 
@@ -3176,6 +3177,11 @@ void cmSystemTools::FindCMakeResources(char const* argv0)
   if (!cmSystemTools::FileExists(cmSystemToolsCMClDepsCommand)) {
     cmSystemToolsCMClDepsCommand.clear();
   }
+  cmSystemToolsCMakeDaemonClientCommand = cmStrCat(
+    exe_dir, "/cmake-daemon-client", cmSystemTools::GetExecutableExtension());
+  if (!cmSystemTools::FileExists(cmSystemToolsCMakeDaemonClientCommand)) {
+    cmSystemToolsCMakeDaemonClientCommand.clear();
+  }
 }
 
 std::string const& cmSystemTools::GetCMakeCommand()
@@ -3208,6 +3214,11 @@ std::string const& cmSystemTools::GetCMClDepsCommand()
   return cmSystemToolsCMClDepsCommand;
 }
 
+std::string const& cmSystemTools::GetCMakeDaemonClientCommand()
+{
+  return cmSystemToolsCMakeDaemonClientCommand;
+}
+
 std::string const& cmSystemTools::GetCMakeRoot()
 {
   return cmSystemToolsCMakeRoot;
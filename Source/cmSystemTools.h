@@ -580,6 +580,7 @@ public:
   static std::string const& GetCMakeGUICommand();
   static std::string const& GetCMakeCursesCommand();
   static std::string const& GetCMClDepsCommand();
+  static std::string const& GetCMakeDaemonClientCommand();
   static std::string const& GetCMakeRoot();
   static std::string const& GetHTMLDoc();
 
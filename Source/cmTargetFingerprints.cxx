@@ -0,0 +1,315 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmTargetFingerprints.h"
+
+#include <vector>
+
+#include <cm/string_view>
+
+#include "cmCryptoHash.h"
+#include "cmGeneratorTarget.h"
+#include "cmGlobalGenerator.h"
+#include "cmLinkItem.h"
+#include "cmList.h"
+#include "cmListFileCache.h"
+#include "cmLocalGenerator.h"
+#include "cmMakefile.h"
+#include "cmPolicies.h"
+#include "cmPropertyMap.h"
+#include "cmSourceFile.h"
+#include "cmState.h"
+#include "cmStateTypes.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmTarget.h"
+#include "cmValue.h"
+#include "cmVersion.h"
+#include "cmake.h"
+
+namespace {
+
+void AppendField(cmCryptoHash& hasher, cm::string_view value)
+{
+  hasher.Append(value);
+  hasher.Append(cm::string_view("\0", 1));
+}
+
+/* Hash a target-level name/value pair.  Fail if the value may reference
+   another target through a generator expression, because the result
+   then depends on properties of a target outside of the link closure.  */
+bool AppendTargetValue(cmCryptoHash& hasher, cm::string_view name,
+                       cm::string_view value)
+{
+  if (value.find("$<TARGET") != cm::string_view::npos) {
+    return false;
+  }
+  AppendField(hasher, name);
+  AppendField(hasher, value);
+  return true;
+}
+
+template <typename T>
+bool AppendTargetValues(cmCryptoHash& hasher, cm::string_view name,
+                        std::vector<BT<T>> const& values)
+{
+  for (BT<T> const& value : values) {
+    if (!AppendTargetValue(hasher, name, value.Value)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Properties cmTarget does not keep in its property map.
+std::string const TargetSpecialProperties[] = {
+  "C_STANDARD",
+  "COMPILE_DEFINITIONS",
+  "COMPILE_FEATURES",
+  "COMPILE_OPTIONS",
+  "CUDA_STANDARD",
+  "CXX_MODULE_SETS",
+  "CXX_STANDARD",
+  "HEADER_SETS",
+  "HIP_STANDARD",
+  "IMPORTED_CXX_MODULES_COMPILE_DEFINITIONS",
+  "IMPORTED_CXX_MODULES_COMPILE_FEATURES",
+  "IMPORTED_CXX_MODULES_COMPILE_OPTIONS",
+  "IMPORTED_CXX_MODULES_INCLUDE_DIRECTORIES",
+  "IMPORTED_CXX_MODULES_LINK_LIBRARIES",
+  "INCLUDE_DIRECTORIES",
+  "INTERFACE_CXX_MODULE_SETS",
+  "INTERFACE_HEADER_SETS",
+  "INTERFACE_LINK_LIBRARIES",
+  "INTERFACE_LINK_LIBRARIES_DIRECT",
+  "INTERFACE_LINK_LIBRARIES_DIRECT_EXCLUDE",
+  "LINK_DIRECTORIES",
+  "LINK_LIBRARIES",
+  "LINK_OPTIONS",
+  "MANUALLY_ADDED_DEPENDENCIES",
+  "OBJC_STANDARD",
+  "OBJCXX_STANDARD",
+  "PRECOMPILE_HEADERS",
+  "SOURCES",
+};
+
+} // anonymous namespace
+
+cmTargetFingerprints::cmTargetFingerprints(cmGlobalGenerator* gg)
+  : GlobalGenerator(gg)
+{
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  AppendField(hasher, cmVersion::GetCMakeVersion());
+  AppendField(hasher, cmSystemTools::GetCMakeCommand());
+  AppendField(hasher, gg->GetName());
+  for (auto const& prop :
+       gg->GetCMakeInstance()->GetState()->GetGlobalProperties().GetList()) {
+    AppendField(hasher, prop.first);
+    AppendField(hasher, prop.second);
+  }
+  this->Global = hasher.FinalizeHex();
+}
+
+std::string const& cmTargetFingerprints::Get(cmGeneratorTarget const* gt,
+                                             std::string const& config)
+{
+  static std::string const none;
+
+  auto key = std::make_pair(gt, config);
+  auto it = this->Targets.find(key);
+  if (it != this->Targets.end()) {
+    return it->second;
+  }
+
+  // A target that depends on itself through its link closure has no
+  // well-defined fingerprint.
+  if (!this->InProgress.insert(gt).second) {
+    return none;
+  }
+  std::string fingerprint = this->Compute(gt, config);
+  this->InProgress.erase(gt);
+  return this->Targets.emplace(key, std::move(fingerprint)).first->second;
+}
+
+std::string const& cmTargetFingerprints::GetDirectory(cmLocalGenerator* lg)
+{
+  auto it = this->Directories.find(lg);
+  if (it != this->Directories.end()) {
+    return it->second;
+  }
+
+  cmMakefile const* mf = lg->GetMakefile();
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  AppendField(hasher, this->Global);
+  for (std::string const& def : mf->GetDefinitions()) {
+    AppendField(hasher, def);
+    AppendField(hasher, mf->GetSafeDefinition(def));
+  }
+  for (std::string const& prop : mf->GetPropertyKeys()) {
+    AppendField(hasher, prop);
+    AppendField(hasher, *mf->GetProperty(prop));
+  }
+  for (int i = 0; i < cmPolicies::CMPCOUNT; ++i) {
+    char const status = static_cast<char>(
+      mf->GetPolicyStatus(static_cast<cmPolicies::PolicyID>(i)));
+    hasher.Append(&status, 1);
+  }
+  return this->Directories.emplace(lg, hasher.FinalizeHex()).first->second;
+}
+
+bool cmTargetFingerprints::AppendLinkItem(cmCryptoHash& hasher,
+                                          cmLinkItem const& item,
+                                          std::string const& config)
+{
+  if (!AppendTargetValue(hasher, item.Feature, item.AsStr())) {
+    return false;
+  }
+  if (item.Target) {
+    std::string const& fingerprint = this->Get(item.Target, config);
+    if (fingerprint.empty()) {
+      return false;
+    }
+    AppendField(hasher, fingerprint);
+  }
+  if (item.ObjectSource) {
+    AppendField(hasher, item.ObjectSource->GetFullPath());
+  }
+  return true;
+}
+
+std::string cmTargetFingerprints::Compute(cmGeneratorTarget const* gt,
+                                          std::string const& config)
+{
+  if (gt->GetType() == cmStateEnums::UTILITY ||
+      gt->GetType() == cmStateEnums::GLOBAL_TARGET) {
+    return std::string();
+  }
+
+  cmTarget const* target = gt->Target;
+  if (!gt->IsImported()) {
+    // Custom commands may have outputs and dependencies that are
+    // shared with other targets.
+    if (!target->GetPreBuildCommands().empty() ||
+        !target->GetPreLinkCommands().empty() ||
+        !target->GetPostBuildCommands().empty()) {
+      return std::string();
+    }
+    // The generators collect global state from these targets.
+    if (gt->GetPropertyAsBool("EXPORT_COMPILE_COMMANDS") ||
+        gt->IsAppBundleOnApple() || gt->IsFrameworkOnApple() ||
+        gt->IsCFBundleOnApple()) {
+      return std::string();
+    }
+  }
+
+  std::string const& directory = this->GetDirectory(gt->GetLocalGenerator());
+
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  AppendField(hasher, directory);
+  AppendField(hasher, config);
+  AppendField(hasher, gt->GetName());
+  AppendField(hasher, cmState::GetTargetTypeName(gt->GetType()));
+  AppendField(hasher, gt->IsImported() ? "IMPORTED" : "");
+
+  for (auto const& prop : target->GetProperties().GetList()) {
+    if (cmHasLiteralSuffix(prop.first, "_CLANG_TIDY_EXPORT_FIXES_DIR") ||
+        !AppendTargetValue(hasher, prop.first, prop.second)) {
+      return std::string();
+    }
+  }
+  for (std::string const& prop : TargetSpecialProperties) {
+    if (cmValue value = target->GetProperty(prop)) {
+      if (!AppendTargetValue(hasher, prop, *value)) {
+        return std::string();
+      }
+    }
+  }
+
+  // C++ modules require collation across targets.
+  if (cmNonempty(target->GetProperty("CXX_MODULE_SETS")) ||
+      cmNonempty(target->GetProperty("INTERFACE_CXX_MODULE_SETS"))) {
+    return std::string();
+  }
+  cmList headerSets{ target->GetProperty("HEADER_SETS") };
+  headerSets.append(target->GetProperty("INTERFACE_HEADER_SETS"));
+  for (std::string const& name : headerSets) {
+    for (std::string const& prop :
+         { cmStrCat("HEADER_SET_", name), cmStrCat("HEADER_DIRS_", name) }) {
+      if (cmValue value = target->GetProperty(prop)) {
+        if (!AppendTargetValue(hasher, prop, *value)) {
+          return std::string();
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < cmPolicies::CMPCOUNT; ++i) {
+    char const status = static_cast<char>(
+      target->GetPolicyStatus(static_cast<cmPolicies::PolicyID>(i)));
+    hasher.Append(&status, 1);
+  }
+
+  if (!gt->IsImported()) {
+    std::vector<cmSourceFile*> sources;
+    gt->GetSourceFiles(sources, config);
+    for (cmSourceFile const* sf : sources) {
+      if (sf->GetCustomCommand()) {
+        return std::string();
+      }
+      AppendField(hasher, sf->GetFullPath());
+      AppendField(hasher, sf->GetLanguage());
+      AppendField(hasher, sf->GetIsGenerated() ? "GENERATED" : "");
+      for (auto const& prop : sf->GetProperties().GetList()) {
+        if (!AppendTargetValue(hasher, prop.first, prop.second)) {
+          return std::string();
+        }
+      }
+      if (!AppendTargetValues(hasher, "COMPILE_OPTIONS",
+                              sf->GetCompileOptions()) ||
+          !AppendTargetValues(hasher, "COMPILE_DEFINITIONS",
+                              sf->GetCompileDefinitions()) ||
+          !AppendTargetValues(hasher, "INCLUDE_DIRECTORIES",
+                              sf->GetIncludeDirectories())) {
+        return std::string();
+      }
+      for (std::string const& dep : sf->GetDepends()) {
+        AppendField(hasher, dep);
+      }
+    }
+
+    if (cmLinkImplementationLibraries const* impl =
+          gt->GetLinkImplementationLibraries(
+            config, cmGeneratorTarget::UseTo::Link)) {
+      for (cmLinkItem const& item : impl->Libraries) {
+        if (!this->AppendLinkItem(hasher, item, config)) {
+          return std::string();
+        }
+      }
+      for (cmLinkItem const& item : impl->Objects) {
+        if (!this->AppendLinkItem(hasher, item, config)) {
+          return std::string();
+        }
+      }
+    }
+  }
+
+  if (cmLinkInterfaceLibraries const* iface = gt->GetLinkInterfaceLibraries(
+        config, gt, cmGeneratorTarget::UseTo::Link)) {
+    // Consumers evaluate the interface with themselves as the head.
+    if (iface->HadHeadSensitiveCondition) {
+      return std::string();
+    }
+    for (auto const* items : { &iface->Libraries, &iface->Objects,
+                               &iface->HeadInclude, &iface->HeadExclude }) {
+      for (cmLinkItem const& item : *items) {
+        if (!this->AppendLinkItem(hasher, item, config)) {
+          return std::string();
+        }
+      }
+    }
+  }
+
+  return hasher.FinalizeHex();
+}
@@ -0,0 +1,54 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <map>
+#include <set>
+#include <string>
+#include <utility>
+
+class cmCryptoHash;
+class cmGeneratorTarget;
+class cmGlobalGenerator;
+class cmLinkItem;
+class cmLocalGenerator;
+
+/** \class cmTargetFingerprints
+ * \brief Compute fingerprints of the inputs from which target rules derive.
+ *
+ * The fingerprint of a target is a hash of everything a generator reads
+ * to write the build rules of the target: its properties and policies,
+ * its sources and their properties, the variables, properties and policies
+ * of its directory, global state, and the fingerprints of the targets in
+ * its link closure.  Generators may keep the rules written by a previous
+ * run if the fingerprint of a target did not change.
+ *
+ * Targets whose rules may depend on state this class does not capture,
+ * such as targets with custom commands or properties that reference other
+ * targets through generator expressions, have an empty fingerprint.
+ */
+class cmTargetFingerprints
+{
+public:
+  cmTargetFingerprints(cmGlobalGenerator* gg);
+
+  /** Get the fingerprint of a target, or an empty string if the target
+      is not eligible.  */
+  std::string const& Get(cmGeneratorTarget const* gt,
+                         std::string const& config);
+
+private:
+  std::string Compute(cmGeneratorTarget const* gt, std::string const& config);
+  std::string const& GetDirectory(cmLocalGenerator* lg);
+  bool AppendLinkItem(cmCryptoHash& hasher, cmLinkItem const& item,
+                      std::string const& config);
+
+  cmGlobalGenerator* GlobalGenerator;
+  std::string Global;
+  std::map<cmLocalGenerator const*, std::string> Directories;
+  std::map<std::pair<cmGeneratorTarget const*, std::string>, std::string>
+    Targets;
+  std::set<cmGeneratorTarget const*> InProgress;
+};
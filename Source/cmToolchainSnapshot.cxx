@@ -0,0 +1,485 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include "cmToolchainSnapshot.h"
+
+#include <algorithm>
+#include <iterator>
+#include <utility>
+
+#include <cm/memory>
+#include <cm/string_view>
+#include <cmext/algorithm>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmCryptoHash.h"
+#include "cmFileTime.h"
+#include "cmGeneratedFileStream.h"
+#include "cmGlobalGenerator.h"
+#include "cmMakefile.h"
+#include "cmState.h"
+#include "cmStateTypes.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmValue.h"
+#include "cmVersion.h"
+#include "cmake.h"
+
+namespace {
+
+// Environment variables read while determining the system and compilers.
+char const* const ToolchainEnvironment[] = {
+  "PATH",
+  "CC",
+  "CFLAGS",
+  "CXX",
+  "CXXFLAGS",
+  "CPPFLAGS",
+  "LDFLAGS",
+  "FC",
+  "FFLAGS",
+  "CUDACXX",
+  "CUDAFLAGS",
+  "CUDAHOSTCXX",
+  "CUDAARCHS",
+  "HIPCXX",
+  "HIPFLAGS",
+  "HIPHOSTCXX",
+  "HIPARCHS",
+  "OBJC",
+  "OBJCFLAGS",
+  "OBJCXX",
+  "OBJCXXFLAGS",
+  "ASM",
+  "ASMFLAGS",
+  "ASM_NASM",
+  "ASM_MASM",
+  "ASM_MARMASM",
+  "RC",
+  "RCFLAGS",
+  "SWIFTC",
+  "ISPC",
+  "ISPCFLAGS",
+  "SDKROOT",
+  "MACOSX_DEPLOYMENT_TARGET",
+  "INCLUDE",
+  "LIB",
+  "LIBPATH",
+};
+
+void AppendField(cmCryptoHash& hasher, cm::string_view value)
+{
+  hasher.Append(value);
+  hasher.Append(cm::string_view("\0", 1));
+}
+
+/* Hash a variable value with the build tree replaced by a placeholder so
+   that build trees in different locations share the same key.  */
+void AppendRelocatable(cmCryptoHash& hasher, std::string value,
+                       std::string const& binaryDir)
+{
+  cmSystemTools::ReplaceString(value, binaryDir, "<CMAKE_BINARY_DIR>");
+  AppendField(hasher, value);
+}
+
+bool ReadWholeFile(std::string const& path, std::string& content)
+{
+  cmsys::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+  if (!fin) {
+    return false;
+  }
+  content.assign(std::istreambuf_iterator<char>(fin),
+                 std::istreambuf_iterator<char>());
+  return !fin.bad();
+}
+
+/* Write a file in the snapshot directory.  Build trees configured
+   concurrently may write the same file, so replace it atomically.  */
+bool WriteSnapshotFile(std::string const& path, std::string const& content)
+{
+  cmGeneratedFileStream fout;
+  fout.Open(path, true, true);
+  fout.SetCopyIfDifferent(true);
+  fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+  if (!fout) {
+    return false;
+  }
+  // Close reports whether the file was replaced, not whether it failed.
+  fout.Close();
+  return true;
+}
+
+/* Identify the compiler tool file so that a snapshot taken before the
+   compiler was replaced is not used.  */
+std::string CompilerStamp(std::string const& compiler)
+{
+  cmFileTime ft;
+  if (!ft.Load(compiler)) {
+    return std::string();
+  }
+  return cmStrCat(compiler, '\n', ft.GetTime(), '\n',
+                  cmSystemTools::FileLength(compiler), '\n');
+}
+
+struct CacheEntry
+{
+  std::string Key;
+  std::string Value;
+  std::string Help;
+  cmStateEnums::CacheEntryType Type;
+};
+
+bool ParseCacheEntries(std::string const& content,
+                       std::vector<CacheEntry>& entries)
+{
+  std::string help;
+  for (std::string const& line :
+       cmTokenize(content, '\n', cmTokenizerMode::New)) {
+    if (cmHasLiteralPrefix(line, "//")) {
+      if (cmHasLiteralPrefix(line, "//\\n")) {
+        help += '\n';
+        help.append(line, 4, std::string::npos);
+      } else {
+        help.append(line, 2, std::string::npos);
+      }
+      continue;
+    }
+    CacheEntry entry;
+    if (!cmState::ParseCacheEntry(line, entry.Key, entry.Value, entry.Type)) {
+      return false;
+    }
+    entry.Help = std::move(help);
+    help.clear();
+    entries.emplace_back(std::move(entry));
+  }
+  return true;
+}
+
+void WriteCacheEntry(std::string& out, std::string const& key,
+                     std::string const& value, std::string const& help,
+                     cmStateEnums::CacheEntryType type)
+{
+  if (!help.empty()) {
+    std::vector<std::string> lines = cmTokenize(help, '\n');
+    for (auto li = lines.begin(); li != lines.end(); ++li) {
+      out += li == lines.begin() ? "//" : "//\\n";
+      out += *li;
+      out += '\n';
+    }
+  }
+  char const* q = key.find(':') != std::string::npos ? "\"" : "";
+  out += cmStrCat(q, key, q, ':', cmState::CacheEntryTypeToString(type), '=');
+  // Enclose trailing whitespace in single quotes as CMakeCache.txt does.
+  if (!value.empty() && (value.back() == ' ' || value.back() == '\t')) {
+    out += cmStrCat('\'', value, '\'');
+  } else {
+    out += value;
+  }
+  out += '\n';
+}
+
+} // anonymous namespace
+
+std::unique_ptr<cmToolchainSnapshot> cmToolchainSnapshot::New(
+  cmMakefile* mf, std::string const& platformInfoDir)
+{
+  std::string root;
+  if (!cmSystemTools::GetEnv("CMAKE_TOOLCHAIN_SNAPSHOT_DIR", root) ||
+      root.empty()) {
+    return nullptr;
+  }
+
+  // The key below is only meaningful before anything has been determined.
+  if (mf->GetDefinition("CMAKE_SYSTEM_LOADED") ||
+      cmSystemTools::FileExists(
+        cmStrCat(platformInfoDir, "/CMakeSystem.cmake"))) {
+    return nullptr;
+  }
+
+  // Project setup files may influence the detection in ways not
+  // reflected by the key.
+  if (cmNonempty(mf->GetDefinition("CMAKE_PROJECT_TOP_LEVEL_INCLUDES"))) {
+    return nullptr;
+  }
+
+  cmState* state = mf->GetState();
+  std::string const& binaryDir = mf->GetHomeOutputDirectory();
+
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  AppendField(hasher, cmVersion::GetCMakeVersion());
+  AppendField(hasher, mf->GetGlobalGenerator()->GetName());
+
+  // Cache entries given by the user, e.g. CMAKE_<LANG>_COMPILER.
+  std::vector<std::string> keys = state->GetCacheEntryKeys();
+  std::sort(keys.begin(), keys.end());
+  for (std::string const& key : keys) {
+    cmStateEnums::CacheEntryType const type = state->GetCacheEntryType(key);
+    if (!cmHasLiteralPrefix(key, "CMAKE_") ||
+        type == cmStateEnums::INTERNAL || type == cmStateEnums::STATIC) {
+      continue;
+    }
+    AppendField(hasher, key);
+    AppendRelocatable(hasher, state->GetSafeCacheEntryValue(key), binaryDir);
+  }
+
+  // Variables set by the project before enabling languages, e.g.
+  // CMAKE_SYSTEM_NAME or CMAKE_OSX_ARCHITECTURES.
+  std::vector<std::string> definitions = mf->GetDefinitions();
+  std::sort(definitions.begin(), definitions.end());
+  for (std::string const& def : definitions) {
+    if (cmHasLiteralPrefix(def, "CMAKE_")) {
+      AppendField(hasher, def);
+      AppendRelocatable(hasher, mf->GetSafeDefinition(def), binaryDir);
+    }
+  }
+
+  if (cmValue toolchain = mf->GetDefinition("CMAKE_TOOLCHAIN_FILE")) {
+    std::string toolchainFile = *toolchain;
+    if (!cmSystemTools::FileIsFullPath(toolchainFile)) {
+      // A relative toolchain file is looked up in the build tree first.
+      // Such a file is specific to one build tree.
+      if (cmSystemTools::FileExists(cmStrCat(binaryDir, '/', toolchainFile))) {
+        return nullptr;
+      }
+      toolchainFile = cmSystemTools::CollapseFullPath(
+        toolchainFile, mf->GetHomeDirectory());
+    }
+    if (cmSystemTools::FileExists(toolchainFile, true)) {
+      cmCryptoHash fileHasher(cmCryptoHash::AlgoSHA256);
+      AppendField(hasher, fileHasher.HashFile(toolchainFile));
+    }
+  }
+
+  for (char const* var : ToolchainEnvironment) {
+    std::string value;
+    if (cmSystemTools::GetEnv(var, value)) {
+      AppendField(hasher, var);
+      AppendField(hasher, value);
+    }
+  }
+
+  std::string snapshotDir =
+    cmStrCat(cmSystemTools::CollapseFullPath(root), '/', hasher.FinalizeHex());
+  return cm::make_unique<cmToolchainSnapshot>(platformInfoDir,
+                                              std::move(snapshotDir));
+}
+
+cmToolchainSnapshot::cmToolchainSnapshot(std::string platformInfoDir,
+                                         std::string snapshotDir)
+  : PlatformInfoDir(std::move(platformInfoDir))
+  , SnapshotDir(std::move(snapshotDir))
+{
+}
+
+std::string cmToolchainSnapshot::GetLanguageDirectory(
+  cmMakefile* mf, std::vector<std::string> const& languages,
+  std::string const& lang) const
+{
+  // Languages enabled together see each other's cache entries.
+  std::vector<std::string> together = languages;
+  std::sort(together.begin(), together.end());
+
+  cmCryptoHash hasher(cmCryptoHash::AlgoSHA256);
+  hasher.Initialize();
+  for (std::string const& l : together) {
+    AppendField(hasher, l);
+  }
+  AppendField(hasher, lang);
+
+  // Variables set by the project since the first language was enabled,
+  // e.g. CMAKE_CXX_COMPILER before enable_language(CXX).
+  std::string const prefix = cmStrCat("CMAKE_", lang, '_');
+  std::vector<std::string> names = mf->GetDefinitions();
+  cm::append(names, mf->GetState()->GetCacheEntryKeys());
+  std::sort(names.begin(), names.end());
+  names.erase(std::unique(names.begin(), names.end()), names.end());
+  for (std::string const& name : names) {
+    if (cmHasPrefix(name, prefix)) {
+      AppendField(hasher, name);
+      AppendRelocatable(hasher, mf->GetSafeDefinition(name),
+                        mf->GetHomeOutputDirectory());
+    }
+  }
+  return cmStrCat(this->SnapshotDir, '/', hasher.FinalizeHex());
+}
+
+void cmToolchainSnapshot::Restore(cmMakefile* mf,
+                                  std::vector<std::string> const& languages)
+{
+  this->LanguageDirectories.clear();
+  this->HadLanguages.clear();
+  this->CacheBefore.clear();
+
+  cmState* state = mf->GetState();
+  for (std::string const& key : state->GetCacheEntryKeys()) {
+    this->CacheBefore.emplace(key, state->GetSafeCacheEntryValue(key));
+  }
+
+  for (std::string const& lang : languages) {
+    if (lang == "NONE" ||
+        mf->GetDefinition(cmStrCat("CMAKE_", lang, "_COMPILER_LOADED")) ||
+        cmSystemTools::FileExists(
+          cmStrCat(this->PlatformInfoDir, "/CMake", lang, "Compiler.cmake"))) {
+      this->HadLanguages.insert(lang);
+      continue;
+    }
+    this->LanguageDirectories.emplace(
+      lang, this->GetLanguageDirectory(mf, languages, lang));
+  }
+
+  if (!this->HadSystem) {
+    std::string const snapshotFile =
+      cmStrCat(this->SnapshotDir, "/CMakeSystem.cmake");
+    if (!cmSystemTools::FileExists(snapshotFile) ||
+        !cmSystemTools::CopyFileAlways(
+          snapshotFile,
+          cmStrCat(this->PlatformInfoDir, "/CMakeSystem.cmake"))) {
+      // The compiler information is only valid for the system it was
+      // determined on.
+      return;
+    }
+    this->HadSystem = true;
+  }
+
+  for (auto const& ld : this->LanguageDirectories) {
+    if (this->RestoreLanguage(mf, ld.first, ld.second)) {
+      this->HadLanguages.insert(ld.first);
+    }
+  }
+}
+
+bool cmToolchainSnapshot::RestoreLanguage(cmMakefile* mf,
+                                          std::string const& lang,
+                                          std::string const& dir)
+{
+  std::string const prefix = cmStrCat(dir, "/CMake", lang);
+
+  // Check that the compiler did not change since the snapshot was taken.
+  std::string stamp;
+  if (!ReadWholeFile(cmStrCat(prefix, "Compiler.stamp"), stamp)) {
+    return false;
+  }
+  std::string const compiler = stamp.substr(0, stamp.find('\n'));
+  if (compiler.empty() || CompilerStamp(compiler) != stamp) {
+    return false;
+  }
+
+  std::string cache;
+  std::vector<CacheEntry> entries;
+  if (!ReadWholeFile(cmStrCat(prefix, "Cache.txt"), cache) ||
+      !ParseCacheEntries(cache, entries)) {
+    return false;
+  }
+
+  if (!cmSystemTools::CopyFileAlways(
+        cmStrCat(prefix, "Compiler.cmake"),
+        cmStrCat(this->PlatformInfoDir, "/CMake", lang, "Compiler.cmake"))) {
+    return false;
+  }
+
+  // Add the cache entries created while determining the compiler, such
+  // as CMAKE_AR and CMAKE_STRIP, unless the user has set them.
+  cmake* cm = mf->GetCMakeInstance();
+  cmState* state = mf->GetState();
+  std::set<std::string> restored;
+  for (CacheEntry const& entry : entries) {
+    if (entry.Type == cmStateEnums::INTERNAL &&
+        cmHasLiteralSuffix(entry.Key, "-ADVANCED")) {
+      std::string const key =
+        entry.Key.substr(0, entry.Key.size() - cmStrLen("-ADVANCED"));
+      if (restored.count(key)) {
+        state->SetCacheEntryBoolProperty(key, "ADVANCED", cmIsOn(entry.Value));
+      }
+      continue;
+    }
+    if (state->GetCacheEntryValue(entry.Key) &&
+        state->GetCacheEntryType(entry.Key) != cmStateEnums::UNINITIALIZED) {
+      continue;
+    }
+    cm->AddCacheEntry(entry.Key, entry.Value, entry.Help, entry.Type);
+    restored.insert(entry.Key);
+  }
+  return true;
+}
+
+void cmToolchainSnapshot::Save(cmMakefile* mf,
+                               std::vector<std::string> const& languages)
+{
+  if (!this->HadSystem) {
+    std::string content;
+    if (!ReadWholeFile(cmStrCat(this->PlatformInfoDir, "/CMakeSystem.cmake"),
+                       content) ||
+        !WriteSnapshotFile(cmStrCat(this->SnapshotDir, "/CMakeSystem.cmake"),
+                           content)) {
+      return;
+    }
+    this->HadSystem = true;
+  }
+
+  std::string const cache = this->GetNewCacheEntries(mf);
+  for (std::string const& lang : languages) {
+    auto ld = this->LanguageDirectories.find(lang);
+    if (ld != this->LanguageDirectories.end() &&
+        !this->HadLanguages.count(lang) &&
+        mf->IsOn(cmStrCat("CMAKE_", lang, "_COMPILER_WORKS"))) {
+      this->SaveLanguage(mf, lang, ld->second, cache);
+    }
+  }
+}
+
+void cmToolchainSnapshot::SaveLanguage(cmMakefile* mf,
+                                       std::string const& lang,
+                                       std::string const& dir,
+                                       std::string const& cache)
+{
+  cmValue compiler = mf->GetDefinition(cmStrCat("CMAKE_", lang, "_COMPILER"));
+  if (!compiler || !cmSystemTools::FileIsFullPath(*compiler)) {
+    return;
+  }
+  std::string const stamp = CompilerStamp(*compiler);
+  std::string content;
+  if (stamp.empty() ||
+      !ReadWholeFile(
+        cmStrCat(this->PlatformInfoDir, "/CMake", lang, "Compiler.cmake"),
+        content)) {
+    return;
+  }
+
+  // Write the compiler information last.  Restore needs all three files.
+  std::string const prefix = cmStrCat(dir, "/CMake", lang);
+  if (WriteSnapshotFile(cmStrCat(prefix, "Compiler.stamp"), stamp) &&
+      WriteSnapshotFile(cmStrCat(prefix, "Cache.txt"), cache)) {
+    WriteSnapshotFile(cmStrCat(prefix, "Compiler.cmake"), content);
+  }
+}
+
+std::string cmToolchainSnapshot::GetNewCacheEntries(cmMakefile* mf) const
+{
+  cmState* state = mf->GetState();
+  std::string const& binaryDir = mf->GetHomeOutputDirectory();
+  std::vector<std::string> keys = state->GetCacheEntryKeys();
+  std::sort(keys.begin(), keys.end());
+
+  std::string out;
+  for (std::string const& key : keys) {
+    std::string const value = state->GetSafeCacheEntryValue(key);
+    auto before = this->CacheBefore.find(key);
+    if (before != this->CacheBefore.end() && before->second == value) {
+      continue;
+    }
+    // Values specific to this build tree cannot be shared.
+    if (value.find(binaryDir) != std::string::npos ||
+        value.find('\n') != std::string::npos) {
+      continue;
+    }
+    cmValue help = state->GetCacheEntryProperty(key, "HELPSTRING");
+    WriteCacheEntry(out, key, value, help ? *help : std::string(),
+                    state->GetCacheEntryType(key));
+    if (state->GetCacheEntryPropertyAsBool(key, "ADVANCED")) {
+      WriteCacheEntry(out, cmStrCat(key, "-ADVANCED"), "1", std::string(),
+                      cmStateEnums::INTERNAL);
+    }
+  }
+  return out;
+}
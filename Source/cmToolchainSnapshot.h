@@ -0,0 +1,71 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+#pragma once
+
+#include "cmConfigure.h" // IWYU pragma: keep
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+class cmMakefile;
+
+/** \class cmToolchainSnapshot
+ * \brief Share platform information among build trees using one toolchain.
+ *
+ * Enabling a language in a fresh build tree determines the system and
+ * compiler and configures the results into the platform information
+ * directory, e.g. CMakeFiles/<version>/CMakeCCompiler.cmake.  Later runs
+ * in the same tree load these files instead of probing again.
+ *
+ * When the CMAKE_TOOLCHAIN_SNAPSHOT_DIR environment variable is set, this
+ * class keeps copies of those files, and of the cache entries created
+ * while determining them, in a directory named by a hash of everything
+ * that may influence the detection: the CMake version, the generator, the
+ * CMAKE_* variables and cache entries, the toolchain file content and the
+ * environment variables read by the compiler detection modules.  The key
+ * is computed when the first language of a fresh build tree is enabled,
+ * before anything has been determined.  Languages enabled later use a
+ * subdirectory keyed by the CMAKE_<LANG>_* variables set at that time.
+ * A fresh build tree with the same keys is seeded from the snapshot, so
+ * it behaves as if it had been configured before.
+ */
+class cmToolchainSnapshot
+{
+public:
+  /** Return a snapshot for the toolchain used by the given makefile, or
+      nullptr if snapshots are not enabled or the build tree already has
+      platform information.  */
+  static std::unique_ptr<cmToolchainSnapshot> New(
+    cmMakefile* mf, std::string const& platformInfoDir);
+
+  cmToolchainSnapshot(std::string platformInfoDir, std::string snapshotDir);
+
+  /** Seed the platform information directory with the system and the
+      given languages if the build tree does not have them yet.  */
+  void Restore(cmMakefile* mf, std::vector<std::string> const& languages);
+
+  /** Store the system and the given languages if they were determined
+      since the matching call to Restore.  */
+  void Save(cmMakefile* mf, std::vector<std::string> const& languages);
+
+private:
+  std::string GetLanguageDirectory(
+    cmMakefile* mf, std::vector<std::string> const& languages,
+    std::string const& lang) const;
+  bool RestoreLanguage(cmMakefile* mf, std::string const& lang,
+                       std::string const& dir);
+  void SaveLanguage(cmMakefile* mf, std::string const& lang,
+                    std::string const& dir, std::string const& cache);
+  std::string GetNewCacheEntries(cmMakefile* mf) const;
+
+  std::string PlatformInfoDir;
+  std::string SnapshotDir;
+  bool HadSystem = false;
+  // State recorded by Restore for the languages being enabled.
+  std::map<std::string, std::string> LanguageDirectories;
+  std::set<std::string> HadLanguages;
+  std::map<std::string, std::string> CacheBefore;
+};
@@ -37,6 +37,7 @@
 #include "cmCMakePresetsGraph.h"
 #include "cmCommandLineArgument.h"
 #include "cmCommands.h"
+#include "cmCustomCommandCache.h"
 #ifdef CMake_ENABLE_DEBUGGER
 #  include "cmDebuggerAdapter.h"
 #  ifdef _WIN32
@@ -45,15 +46,18 @@
 #    include "cmDebuggerPosixPipeConnection.h"
 #  endif //_WIN32
 #endif
+#include "cmDirectoryListingCache.h"
 #include "cmDocumentation.h"
 #include "cmDocumentationEntry.h"
 #include "cmDuration.h"
 #include "cmExternalMakefileProjectGenerator.h"
 #include "cmFileTimeCache.h"
+#include "cmGeneratorExpressionCache.h"
 #include "cmGeneratorTarget.h"
 #include "cmGlobCacheEntry.h"
 #include "cmGlobalGenerator.h"
 #include "cmGlobalGeneratorFactory.h"
+#include "cmInstallHashManifest.h"
 #include "cmLinkLineComputer.h"
 #include "cmLocalGenerator.h"
 #include "cmMakefile.h"
@@ -88,6 +92,7 @@
 #  include "cmGraphVizWriter.h"
 #  include "cmInstrumentation.h"
 #  include "cmInstrumentationQuery.h"
+#  include "cmListFileParseCache.h"
 #  include "cmVariableWatch.h"
 #endif
 
@@ -299,6 +304,8 @@ cmDocumentationEntry cmake::CMAKE_STANDARD_OPTIONS_TABLE[19] = {
 cmake::cmake(Role role, cmState::Mode mode, cmState::ProjectKind projectKind)
   : CMakeWorkingDirectory(cmSystemTools::GetLogicalWorkingDirectory())
   , FileTimeCache(cm::make_unique<cmFileTimeCache>())
+  , DirectoryListingCache(cm::make_unique<cmDirectoryListingCache>())
+  , GeneratorExpressionCache(cm::make_unique<cmGeneratorExpressionCache>())
 #ifndef CMAKE_BOOTSTRAP
   , VariableWatch(cm::make_unique<cmVariableWatch>())
 #endif
@@ -362,7 +369,10 @@ cmake::cmake(Role role, cmState::Mode mode, cmState::ProjectKind projectKind)
   }
 }
 
-cmake::~cmake() = default;
+cmake::~cmake()
+{
+  this->SaveInstallHashManifest();
+}
 
 #if !defined(CMAKE_BOOTSTRAP)
 Json::Value cmake::ReportVersionJson() const
@@ -814,6 +824,7 @@ void cmake::ReadListFile(std::vector<std::string> const& args,
     if (!mf.ReadListFile(path)) {
       cmSystemTools::Error("Error processing file: " + path);
     }
+    this->SaveInstallHashManifest();
   }
 }
 
@@ -2657,6 +2668,24 @@ int cmake::ActualConfigure()
   this->FileAPI = cm::make_unique<cmFileAPI>(this);
   this->FileAPI->ReadQueries();
 
+  this->MarkCliAsUsed("CMAKE_LISTFILE_PARSE_CACHE");
+  if (this->State->GetCacheEntryValue("CMAKE_LISTFILE_PARSE_CACHE").IsOn()) {
+    this->ListFileParseCache = cm::make_unique<cmListFileParseCache>(
+      cmStrCat(this->GetHomeOutputDirectory(),
+               "/CMakeFiles/ListFileParseCache.bin"));
+    this->ListFileParseCache->Load();
+  } else {
+    this->ListFileParseCache.reset();
+  }
+
+  this->MarkCliAsUsed("CMAKE_COMMAND_DAEMON");
+  this->MarkCliAsUsed("CMAKE_FIND_DIRECTORY_CACHE");
+  if (this->State->GetCacheEntryValue("CMAKE_FIND_DIRECTORY_CACHE").IsOn()) {
+    this->DirectoryListingCache->Load(
+      cmStrCat(this->GetHomeOutputDirectory(),
+               "/CMakeFiles/FindDirectoryCache.bin"));
+  }
+
   this->Instrumentation = cm::make_unique<cmInstrumentation>(
     this->State->GetBinaryDirectory(),
     cmInstrumentation::LoadQueriesAfter::No);
@@ -2694,6 +2723,18 @@ int cmake::ActualConfigure()
 #endif
   auto endTime = std::chrono::steady_clock::now();
 
+#if !defined(CMAKE_BOOTSTRAP)
+  if (this->ListFileParseCache) {
+    this->ListFileParseCache->Save();
+    this->ListFileParseCache.reset();
+  }
+  if (this->State->GetCacheEntryValue("CMAKE_FIND_DIRECTORY_CACHE").IsOn()) {
+    this->DirectoryListingCache->Save(
+      cmStrCat(this->GetHomeOutputDirectory(),
+               "/CMakeFiles/FindDirectoryCache.bin"));
+  }
+#endif
+
   // configure result
   if (this->GetWorkingMode() == cmake::NORMAL_MODE) {
     std::ostringstream msg;
@@ -3174,6 +3215,30 @@ void cmake::AddCacheEntry(std::string const& key, cmValue value,
   }
 }
 
+cmInstallHashManifest* cmake::GetInstallHashManifest(std::string const& path)
+{
+  if (!this->InstallHashManifest ||
+      this->InstallHashManifest->GetPath() != path) {
+    // Save the previous manifest before switching.
+    this->SaveInstallHashManifest();
+    this->InstallHashManifest = cm::make_unique<cmInstallHashManifest>(path);
+  }
+  return this->InstallHashManifest.get();
+}
+
+void cmake::SaveInstallHashManifest()
+{
+  if (this->InstallHashManifest && !this->InstallHashManifest->Save()) {
+    this->IssueMessage(
+      MessageType::WARNING,
+      cmStrCat("Cannot write the install hash manifest\n  ",
+               this->InstallHashManifest->GetPath(),
+               "\nUnchanged files may be copied again by the next "
+               "installation."));
+  }
+  this->InstallHashManifest.reset();
+}
+
 bool cmake::DoWriteGlobVerifyTarget() const
 {
   return this->State->DoWriteGlobVerifyTarget();
@@ -3189,6 +3254,11 @@ std::string const& cmake::GetGlobVerifyStamp() const
   return this->State->GetGlobVerifyStamp();
 }
 
+std::string const& cmake::GetGlobVerifyManifest() const
+{
+  return this->State->GetGlobVerifyManifest();
+}
+
 void cmake::AddGlobCacheEntry(cmGlobCacheEntry const& entry,
                               std::string const& variable,
                               cmListFileBacktrace const& backtrace)
@@ -4048,6 +4118,15 @@ int cmake::Build(int jobs, std::string dir, std::vector<std::string> targets,
 #endif
 
   this->GlobalGenerator->PrintBuildCommandAdvice(std::cerr, jobs);
+
+  // Count only the cached custom commands of this build.
+  std::string const customCommandCacheLog =
+    cmCustomCommandCache::GetLogFile(cachePath);
+  unsigned long cacheHits = 0;
+  unsigned long cacheMisses = 0;
+  cmCustomCommandCache::TakeStatistics(customCommandCacheLog, cacheHits,
+                                       cacheMisses);
+
   std::stringstream ostr;
   // `cmGlobalGenerator::Build` logs metadata about what directory and commands
   // are being executed to the `output` parameter. If CMake is verbose, print
@@ -4073,6 +4152,13 @@ int cmake::Build(int jobs, std::string dir, std::vector<std::string> targets,
   int buildresult = doBuild();
 #endif
 
+  if (cmCustomCommandCache::TakeStatistics(customCommandCacheLog, cacheHits,
+                                           cacheMisses)) {
+    std::cout << "Custom command cache: " << cacheHits
+              << (cacheHits == 1 ? " hit, " : " hits, ") << cacheMisses
+              << (cacheMisses == 1 ? " miss" : " misses") << std::endl;
+  }
+
   return buildresult;
 }
 
@@ -40,6 +40,8 @@
 #endif
 
 class cmConfigureLog;
+class cmDirectoryListingCache;
+class cmGeneratorExpressionCache;
 
 #ifdef CMake_ENABLE_DEBUGGER
 namespace cmDebugger {
@@ -51,6 +53,8 @@ class cmExternalMakefileProjectGeneratorFactory;
 class cmFileAPI;
 class cmInstrumentation;
 class cmFileTimeCache;
+class cmInstallHashManifest;
+class cmListFileParseCache;
 class cmGlobalGenerator;
 class cmMakefile;
 class cmMessenger;
@@ -367,6 +371,7 @@ public:
   bool DoWriteGlobVerifyTarget() const;
   std::string const& GetGlobVerifyScript() const;
   std::string const& GetGlobVerifyStamp() const;
+  std::string const& GetGlobVerifyManifest() const;
   void AddGlobCacheEntry(cmGlobCacheEntry const& entry,
                          std::string const& variable,
                          cmListFileBacktrace const& bt);
@@ -478,6 +483,30 @@ public:
    */
   cmFileTimeCache* GetFileTimeCache() { return this->FileTimeCache.get(); }
 
+  /**
+   * Get the cache of directories searched by find commands
+   */
+  cmDirectoryListingCache* GetDirectoryListingCache()
+  {
+    return this->DirectoryListingCache.get();
+  }
+
+  /**
+   * Get the install hash manifest stored at the given path, loading it
+   * on first use.  It is saved by SaveInstallHashManifest, after a script
+   * has been processed, and when this instance is destroyed.
+   */
+  cmInstallHashManifest* GetInstallHashManifest(std::string const& path);
+  void SaveInstallHashManifest();
+
+  /**
+   * Get the cache of parsed generator expressions
+   */
+  cmGeneratorExpressionCache* GetGeneratorExpressionCache()
+  {
+    return this->GeneratorExpressionCache.get();
+  }
+
   bool WasLogLevelSetViaCLI() const { return this->LogLevelWasSetViaCLI; }
 
   //! Get the selected log level for `message()` commands during the cmake run.
@@ -689,6 +718,16 @@ public:
   void UnwatchUnusedCli(std::string const& var);
   void WatchUnusedCli(std::string const& var);
 
+  //! Get the persistent parsed listfile cache, if enabled for this run.
+  cmListFileParseCache* GetListFileParseCache() const
+  {
+#if !defined(CMAKE_BOOTSTRAP)
+    return this->ListFileParseCache.get();
+#else
+    return nullptr;
+#endif
+  }
+
 #if !defined(CMAKE_BOOTSTRAP)
   cmFileAPI* GetFileAPI() const { return this->FileAPI.get(); }
   cmInstrumentation* GetInstrumentation() const
@@ -840,6 +879,9 @@ private:
   bool RegenerateDuringBuild = false;
   std::string CMakeListName;
   std::unique_ptr<cmFileTimeCache> FileTimeCache;
+  std::unique_ptr<cmDirectoryListingCache> DirectoryListingCache;
+  std::unique_ptr<cmGeneratorExpressionCache> GeneratorExpressionCache;
+  std::unique_ptr<cmInstallHashManifest> InstallHashManifest;
   std::string GraphVizFile;
   InstalledFilesMap InstalledFiles;
 #ifndef CMAKE_BOOTSTRAP
@@ -853,6 +895,7 @@ private:
   std::unique_ptr<cmVariableWatch> VariableWatch;
   std::unique_ptr<cmFileAPI> FileAPI;
   std::unique_ptr<cmInstrumentation> Instrumentation;
+  std::unique_ptr<cmListFileParseCache> ListFileParseCache;
 #endif
 
   std::unique_ptr<cmState> State;
@@ -0,0 +1,308 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+/*
+ * cmake-daemon-client is a small stand-in for "cmake -E <command>" in
+ * build rules.  When the CMAKE_COMMAND_DAEMON_SOCKET environment variable
+ * names the socket of a "cmake -E daemon", the command runs there and
+ * no cmake process needs to start.  Otherwise, or if the daemon cannot
+ * serve the request, the client runs the cmake next to it.
+ *
+ * The client deliberately does not link to CMakeLib: its start-up time
+ * is what it saves.
+ */
+
+#include <cerrno>
+#include <csignal>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+
+#include "cmCommandDaemon.h"
+
+extern char** environ;
+
+namespace {
+
+enum class Result
+{
+  Done,    // The daemon ran the command.
+  Refused, // The command did not run.  Run it locally.
+  Lost,    // The daemon went away while running the command.
+};
+
+std::string SiblingCMake(char const* argv0)
+{
+  std::string self;
+  if (std::strchr(argv0, '/')) {
+    self = argv0;
+  } else if (char const* path = std::getenv("PATH")) {
+    std::string const dirs = path;
+    std::string::size_type begin = 0;
+    while (begin <= dirs.size()) {
+      std::string::size_type end = dirs.find(':', begin);
+      if (end == std::string::npos) {
+        end = dirs.size();
+      }
+      std::string const dir = dirs.substr(begin, end - begin);
+      std::string const candidate = (dir.empty() ? "." : dir) + "/" + argv0;
+      if (access(candidate.c_str(), X_OK) == 0) {
+        self = candidate;
+        break;
+      }
+      begin = end + 1;
+    }
+  }
+  if (char* real = realpath(self.c_str(), nullptr)) {
+    self = real;
+    std::free(real);
+  }
+  std::string::size_type const slash = self.rfind('/');
+  return (slash == std::string::npos ? std::string(".")
+                                     : self.substr(0, slash)) +
+    "/cmake";
+}
+
+void AppendString(std::string& out, char const* s, std::size_t size)
+{
+  std::uint32_t const n = static_cast<std::uint32_t>(size);
+  out.append(reinterpret_cast<char const*>(&n), sizeof(n));
+  out.append(s, size);
+}
+
+bool SendAll(int fd, char const* data, std::size_t size)
+{
+  while (size > 0) {
+    ssize_t const n = send(fd, data, size, 0);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    size -= static_cast<std::size_t>(n);
+  }
+  return true;
+}
+
+// Record the process state that a command inherits besides its
+// environment and standard streams.
+void GetProcessState(cmCommandDaemon::Header& header)
+{
+  mode_t const mask = umask(0);
+  umask(mask);
+  header.Umask = static_cast<std::uint32_t>(mask);
+  header.Reserved = 0;
+
+  sigset_t blocked;
+  sigemptyset(&blocked);
+  sigprocmask(SIG_BLOCK, nullptr, &blocked);
+  header.BlockedSignals = 0;
+  header.IgnoredSignals = 0;
+  for (int sig = 1; sig <= 64; ++sig) {
+    std::uint64_t const bit = std::uint64_t(1) << (sig - 1);
+    if (sigismember(&blocked, sig) == 1) {
+      header.BlockedSignals |= bit;
+    }
+    struct sigaction sa;
+    if (sigaction(sig, nullptr, &sa) == 0 && sa.sa_handler == SIG_IGN) {
+      header.IgnoredSignals |= bit;
+    }
+  }
+
+  for (std::size_t i = 0; i < cmCommandDaemon::LimitCount; ++i) {
+    struct rlimit limit;
+    if (getrlimit(cmCommandDaemon::LimitResource(i), &limit) != 0) {
+      limit.rlim_cur = limit.rlim_max = RLIM_INFINITY;
+    }
+    header.Limits[i][0] = limit.rlim_cur == RLIM_INFINITY
+      ? cmCommandDaemon::NoLimit
+      : static_cast<std::uint64_t>(limit.rlim_cur);
+    header.Limits[i][1] = limit.rlim_max == RLIM_INFINITY
+      ? cmCommandDaemon::NoLimit
+      : static_cast<std::uint64_t>(limit.rlim_max);
+  }
+}
+
+Result Forward(char const* socketPath, std::string const& cmake, int argc,
+               char* argv[], cmCommandDaemon::Header& header, int& code)
+{
+  struct sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::size_t const pathLen = std::strlen(socketPath);
+  if (pathLen >= sizeof(addr.sun_path)) {
+    return Result::Refused;
+  }
+  std::memcpy(addr.sun_path, socketPath, pathLen + 1);
+
+  std::vector<char> cwd(4096);
+  while (!getcwd(cwd.data(), cwd.size())) {
+    if (errno != ERANGE) {
+      return Result::Refused;
+    }
+    cwd.resize(cwd.size() * 2);
+  }
+
+  int const fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    return Result::Refused;
+  }
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) !=
+      0) {
+    close(fd);
+    return Result::Refused;
+  }
+
+  header.Tag = cmCommandDaemon::Magic;
+  header.ProtocolVersion = cmCommandDaemon::Version;
+  header.ArgCount = static_cast<std::uint32_t>(argc);
+  header.EnvCount = 0;
+
+  std::string body;
+  AppendString(body, cmake.data(), cmake.size());
+  AppendString(body, cwd.data(), std::strlen(cwd.data()));
+  for (int i = 0; i < argc; ++i) {
+    AppendString(body, argv[i], std::strlen(argv[i]));
+  }
+  for (char** e = environ; *e; ++e) {
+    AppendString(body, *e, std::strlen(*e));
+    ++header.EnvCount;
+  }
+
+  // Send the header together with our standard streams.
+  int const fds[3] = { 0, 1, 2 };
+  union
+  {
+    struct cmsghdr Align;
+    char Buffer[CMSG_SPACE(sizeof(fds))];
+  } control;
+  std::memset(&control, 0, sizeof(control));
+  struct iovec iov;
+  iov.iov_base = &header;
+  iov.iov_len = sizeof(header);
+  struct msghdr msg;
+  std::memset(&msg, 0, sizeof(msg));
+  msg.msg_iov = &iov;
+  msg.msg_iovlen = 1;
+  msg.msg_control = control.Buffer;
+  msg.msg_controllen = sizeof(control.Buffer);
+  struct cmsghdr* c = CMSG_FIRSTHDR(&msg);
+  c->cmsg_level = SOL_SOCKET;
+  c->cmsg_type = SCM_RIGHTS;
+  c->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(c), fds, sizeof(fds));
+
+  ssize_t sent;
+  do {
+    sent = sendmsg(fd, &msg, 0);
+  } while (sent < 0 && errno == EINTR);
+  if (sent < 0 ||
+      !SendAll(fd, reinterpret_cast<char const*>(&header) + sent,
+               sizeof(header) - static_cast<std::size_t>(sent)) ||
+      !SendAll(fd, body.data(), body.size())) {
+    // The daemon does not start a command before the whole request
+    // arrived, so it is safe to run it here.
+    close(fd);
+    return Result::Refused;
+  }
+
+  std::int32_t reply;
+  char* p = reinterpret_cast<char*>(&reply);
+  std::size_t left = sizeof(reply);
+  while (left > 0) {
+    ssize_t const n = read(fd, p, left);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      close(fd);
+      return Result::Lost;
+    }
+    p += n;
+    left -= static_cast<std::size_t>(n);
+  }
+  close(fd);
+  if (reply == cmCommandDaemon::RefuseCode) {
+    return Result::Refused;
+  }
+  code = reply;
+  return Result::Done;
+}
+
+// Terminate the way the command did, so that our parent sees the signal.
+int RaiseSignal(int sig)
+{
+  struct sigaction dfl;
+  std::memset(&dfl, 0, sizeof(dfl));
+  dfl.sa_handler = SIG_DFL;
+  sigemptyset(&dfl.sa_mask);
+  sigaction(sig, &dfl, nullptr);
+  sigset_t set;
+  sigemptyset(&set);
+  sigaddset(&set, sig);
+  sigprocmask(SIG_UNBLOCK, &set, nullptr);
+  raise(sig);
+  // The signal does not terminate a process by default.
+  return 128 + sig;
+}
+
+} // anonymous namespace
+
+int main(int argc, char* argv[])
+{
+  std::string const cmake = SiblingCMake(argc > 0 ? argv[0] : "");
+
+  char const* socketPath = std::getenv("CMAKE_COMMAND_DAEMON_SOCKET");
+  if (socketPath && *socketPath && argc > 2 &&
+      std::strcmp(argv[1], "-E") == 0) {
+    cmCommandDaemon::Header header;
+    GetProcessState(header);
+    // A broken connection must not kill us before we can fall back.
+    struct sigaction ignore;
+    struct sigaction pipeAction;
+    std::memset(&ignore, 0, sizeof(ignore));
+    ignore.sa_handler = SIG_IGN;
+    sigemptyset(&ignore.sa_mask);
+    sigaction(SIGPIPE, &ignore, &pipeAction);
+    int code = 1;
+    switch (Forward(socketPath, cmake, argc - 2, argv + 2, header, code)) {
+      case Result::Done:
+        if (code <= cmCommandDaemon::SignalCode) {
+          return RaiseSignal(cmCommandDaemon::SignalCode - code);
+        }
+        return code;
+      case Result::Lost:
+        std::fprintf(stderr,
+                     "cmake-daemon-client: lost connection to the daemon "
+                     "on:\n  %s\n",
+                     socketPath);
+        return 1;
+      case Result::Refused:
+        break;
+    }
+    sigaction(SIGPIPE, &pipeAction, nullptr);
+  }
+
+  std::vector<char*> args(argv, argv + argc);
+  args.push_back(nullptr);
+  args[0] = const_cast<char*>(cmake.c_str());
+  execv(cmake.c_str(), args.data());
+  std::fprintf(stderr, "cmake-daemon-client: cannot run:\n  %s\n%s\n",
+               cmake.c_str(), std::strerror(errno));
+  return 1;
+}
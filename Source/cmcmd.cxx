@@ -14,7 +14,9 @@
 
 #include "cmCommandLineArgument.h"
 #include "cmCryptoHash.h"
+#include "cmCustomCommandCache.h"
 #include "cmDuration.h"
+#include "cmGlobVerificationManager.h"
 #include "cmGlobalGenerator.h"
 #include "cmList.h"
 #include "cmLocalGenerator.h"
@@ -40,6 +42,7 @@
 #include "cmake.h"
 
 #if !defined(CMAKE_BOOTSTRAP)
+#  include "cmCommandDaemon.h"
 #  include "cmDependsFortran.h" // For -E cmake_copy_f90_mod callback.
 #  include "cmFileTime.h"
 
@@ -100,6 +103,8 @@ char const* const HELP_AVAILABLE_COMMANDS = R"(Available commands:
   copy_directory_if_newer <dir>... destination   - copy newer content of <dir>... directories to 'destination' directory
   copy_if_different <file>... destination  - copy files if it has changed
   copy_if_newer <file>... destination  - copy files if source is newer than destination
+  daemon <socket> [--idle-timeout <seconds>] [--verbose]
+                            - serve commands for cmake-daemon-client on a local socket
   echo [<string>...]        - displays arguments as text
   echo_append [<string>...] - displays arguments as text but no new line
   env [--unset=NAME ...] [NAME=VALUE ...] [--] <command> [<arg>...]
@@ -1155,6 +1160,31 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
       return 0;
     }
 
+#if !defined(CMAKE_BOOTSTRAP)
+    // Serve commands for cmake-daemon-client
+    if (args[1] == "daemon" && args.size() > 2) {
+      cmCommandDaemon::Options options;
+      options.SocketPath = args[2];
+      for (auto ai = args.begin() + 3; ai != args.end(); ++ai) {
+        unsigned long seconds;
+        if (*ai == "--verbose") {
+          options.Verbose = true;
+        } else if (*ai == "--idle-timeout" && ai + 1 != args.end() &&
+                   cmStrToULong(*(ai + 1), &seconds)) {
+          options.IdleTimeout = static_cast<unsigned int>(seconds);
+          ++ai;
+        } else {
+          std::cerr << "-E daemon: invalid argument: " << *ai << '\n';
+          return 1;
+        }
+      }
+      return cmCommandDaemon::Serve(
+        options, [](std::vector<std::string> const& commandArgs) -> int {
+          return cmcmd::ExecuteCMakeCommand(commandArgs, cm::nullopt);
+        });
+    }
+#endif
+
     // Sleep command
     if (args[1] == "sleep" && args.size() > 2) {
       double total = 0;
@@ -1494,6 +1524,16 @@ int cmcmd::ExecuteCMakeCommand(std::vector<std::string> const& args,
     }
 #endif
 
+    // Internal CMake custom command output cache support.
+    if (args[1] == "cmake_cached_command") {
+      return cmCustomCommandCache::Run(args.begin() + 2, args.end());
+    }
+
+    // Internal CMake file(GLOB CONFIGURE_DEPENDS) verification support.
+    if (args[1] == "cmake_verify_globs" && args.size() == 3) {
+      return cmGlobVerificationManager::RunVerification(args[2]);
+    }
+
     // Internal CMake link script support.
     if (args[1] == "cmake_link_script" && args.size() >= 3) {
       return cmcmd::ExecuteLinkScript(args);
@@ -17,6 +17,7 @@
 #include "cmSystemTools.h"
 
 #include "CTest/cmCTestLaunch.h"
+#include "CTest/cmCTestWorker.h"
 
 namespace {
 cmDocumentationEntry const cmDocumentationName = {
@@ -150,6 +151,10 @@ cmDocumentationEntry const cmDocumentationOptions[] = {
   { "--http-header <header>", "Append HTTP header when submitting" },
   { "--schedule-random", "Use a random order for scheduling tests" },
   { "--schedule-random-seed", "Override seed for random order of tests" },
+  { "--schedule-critical-path",
+    "Start tests on the longest chain of dependencies first" },
+  { "--worker <command>",
+    "Run tests through a 'ctest --test-worker' process started by command" },
   { "--submit-index",
     "Submit individual dashboard tests with specific index" },
   { "--timeout <seconds>", "Set the default test timeout." },
@@ -186,6 +191,11 @@ int main(int argc, char const* const* argv)
     return cmCTestLaunch::Main(argc, argv, cmCTestLaunch::Op::Instrument);
   }
 
+  // Dispatch 'ctest --test-worker' mode directly.
+  if (argc >= 2 && strcmp(argv[1], "--test-worker") == 0) {
+    return cmCTestWorker::Main(argc, argv);
+  }
+
   // Dispatch post-build instrumentation daemon for ninja
   if (argc == 3 && strcmp(argv[1], "--start-instrumentation") == 0) {
     return cmInstrumentation(argv[2]).SpawnBuildDaemon();
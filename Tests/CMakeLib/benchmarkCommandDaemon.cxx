@@ -0,0 +1,120 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+// Time "cmake -E true" run cold by cmake, and by cmake-daemon-client
+// without and with a "cmake -E daemon" to serve it.
+//
+// Usage: benchmarkCommandDaemon <cmake> <client> [<runs>]
+//
+// The daemon socket is created in the current working directory.
+
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+namespace {
+
+pid_t Start(std::vector<std::string> const& args)
+{
+  std::vector<char*> argv;
+  for (std::string const& arg : args) {
+    argv.push_back(const_cast<char*>(arg.c_str()));
+  }
+  argv.push_back(nullptr);
+  pid_t const pid = fork();
+  if (pid == 0) {
+    execv(argv[0], argv.data());
+    _exit(127);
+  }
+  return pid;
+}
+
+bool Wait(pid_t pid)
+{
+  int status;
+  while (waitpid(pid, &status, 0) < 0) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// Returns the average time of one run in milliseconds, or a negative
+// value if a run failed.
+double Time(std::vector<std::string> const& args, std::size_t runs)
+{
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < runs; ++r) {
+    pid_t const pid = Start(args);
+    if (pid < 0 || !Wait(pid)) {
+      std::cerr << "Failed to run:\n  " << cmJoin(args, " ") << '\n';
+      return -1;
+    }
+  }
+  double const seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+  return seconds * 1000 / static_cast<double>(runs);
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  if (argc < 3) {
+    std::cerr << "Usage: benchmarkCommandDaemon <cmake> <client> [<runs>]\n";
+    return 1;
+  }
+  std::string const cmake = argv[1];
+  std::string const client = argv[2];
+  std::size_t const runs =
+    argc > 3 ? static_cast<std::size_t>(std::strtoul(argv[3], nullptr, 10))
+             : 200;
+
+  std::string const sock =
+    cmStrCat(cmSystemTools::GetLogicalWorkingDirectory(),
+             "/benchmarkCommandDaemon.sock");
+  cmSystemTools::RemoveFile(sock);
+  cmSystemTools::UnsetEnv("CMAKE_COMMAND_DAEMON_SOCKET");
+
+  double const cold = Time({ cmake, "-E", "true" }, runs);
+  double const fallback = Time({ client, "-E", "true" }, runs);
+
+  pid_t const daemon =
+    Start({ cmake, "-E", "daemon", sock, "--idle-timeout", "60" });
+  for (int i = 0; i < 100 && !cmSystemTools::FileExists(sock); ++i) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+  }
+  if (daemon < 0 || !cmSystemTools::FileExists(sock)) {
+    std::cerr << "The daemon did not start.\n";
+    return 1;
+  }
+  cmSystemTools::PutEnv(cmStrCat("CMAKE_COMMAND_DAEMON_SOCKET=", sock));
+  double const warm = Time({ client, "-E", "true" }, runs);
+  kill(daemon, SIGTERM);
+  Wait(daemon);
+
+  if (cold < 0 || fallback < 0 || warm < 0) {
+    return 1;
+  }
+  std::cout << "Average of " << runs << " runs of -E true:\n"
+            << "  cmake                " << cold << " ms\n"
+            << "  client, no daemon    " << fallback << " ms\n"
+            << "  client, daemon       " << warm << " ms\n";
+  return 0;
+}
@@ -0,0 +1,86 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+// Time reading a depfile that lists many headers, like those written by
+// compilers for sources including large libraries.
+//
+// Usage: benchmarkGccDepfileReader [<headers> [<repetitions>]]
+//
+// The depfile is written to the current working directory.
+
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include <cm/optional>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmGccDepfileReader.h"
+#include "cmGccDepfileReaderTypes.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+int main(int argc, char* argv[])
+{
+  std::size_t const headers =
+    argc > 1 ? static_cast<std::size_t>(std::strtoul(argv[1], nullptr, 10))
+             : 3000;
+  std::size_t const repetitions =
+    argc > 2 ? static_cast<std::size_t>(std::strtoul(argv[2], nullptr, 10))
+             : 100;
+
+  std::string const dir = cmSystemTools::GetLogicalWorkingDirectory();
+  std::string const depfile = cmStrCat(dir, "/benchmarkGccDepfileReader.d");
+  {
+    // Mostly normalized full paths, one per line, as compilers write
+    // them, with some relative paths and escaped spaces mixed in.
+    cmsys::ofstream fout(depfile.c_str());
+    fout << "CMakeFiles/bench.dir/main.cxx.o: " << dir << "/main.cxx";
+    for (std::size_t i = 0; i < headers; ++i) {
+      fout << " \\\n ";
+      switch (i % 10) {
+        case 0:
+          fout << "../include/detail/header" << i << ".h";
+          break;
+        case 1:
+          fout << dir << "/My\\ Headers/header" << i << ".h";
+          break;
+        default:
+          fout << "/usr/include/library/module" << i % 97 << "/header" << i
+               << ".h";
+          break;
+      }
+    }
+    fout << '\n';
+    if (!fout) {
+      std::cerr << "Cannot write the depfile:\n  " << depfile << '\n';
+      return 1;
+    }
+  }
+
+  std::size_t paths = 0;
+  auto const start = std::chrono::steady_clock::now();
+  for (std::size_t r = 0; r < repetitions; ++r) {
+    cm::optional<cmGccDepfileContent> const content =
+      cmReadGccDepfile(depfile.c_str(), dir);
+    if (!content || content->size() != 1 ||
+        content->front().paths.size() != headers + 1) {
+      std::cerr << "The depfile was not read as written.\n";
+      return 1;
+    }
+    paths += content->front().paths.size();
+  }
+  double const seconds = std::chrono::duration<double>(
+                           std::chrono::steady_clock::now() - start)
+                           .count();
+
+  std::cout << "Read " << repetitions << " depfiles listing " << headers
+            << " headers (" << paths << " paths) in " << seconds << " s, "
+            << seconds * 1000 / static_cast<double>(repetitions)
+            << " ms each.\n";
+  cmSystemTools::RemoveFile(depfile);
+  return 0;
+}
@@ -0,0 +1,166 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+// Time the escaping of paths and the formatting of build statements by
+// the Ninja generator.  The escaping is checked against the string
+// replacements it is equivalent to, which are timed as well.
+//
+// Usage: benchmarkNinjaEncoding [<statements>]
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdlib>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+#include "cmGlobalNinjaGenerator.h"
+#include "cmNinjaTypes.h"
+#include "cmState.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+#include "cmake.h"
+
+namespace {
+
+// Count the bytes written to a stream and discard them.
+class CountingBuffer : public std::streambuf
+{
+public:
+  std::size_t Size = 0;
+
+protected:
+  int overflow(int c) override
+  {
+    ++this->Size;
+    return c;
+  }
+  std::streamsize xsputn(char const* /*s*/, std::streamsize n) override
+  {
+    this->Size += static_cast<std::size_t>(n);
+    return n;
+  }
+};
+
+// Escape a path with one string replacement per special character.
+std::string ReferenceEncodePath(cmGlobalNinjaGenerator& gg,
+                                std::string const& path)
+{
+  std::string result = path;
+#ifdef _WIN32
+  if (gg.IsGCCOnWindows()) {
+    std::replace(result.begin(), result.end(), '\\', '/');
+  } else {
+    std::replace(result.begin(), result.end(), '/', '\\');
+  }
+#endif
+  gg.EncodeLiteral(result);
+  cmSystemTools::ReplaceString(result, " ", "$ ");
+  cmSystemTools::ReplaceString(result, ":", "$:");
+  return result;
+}
+
+// Paths like those of object files and sources in a large project.  Some
+// contain characters that must be escaped.
+std::vector<std::string> MakePaths(std::size_t count)
+{
+  static char const* const dirs[] = {
+    "CMakeFiles/core.dir/src/core",
+    "CMakeFiles/net.dir/src/net/protocols",
+    "CMakeFiles/My Library.dir/src/with space",
+    "CMakeFiles/gen.dir/__/generated/c:/out",
+    "CMakeFiles/cost.dir/src/$price",
+  };
+  std::size_t const dirCount = sizeof(dirs) / sizeof(dirs[0]);
+  std::vector<std::string> paths;
+  paths.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    // Most paths need no escaping.
+    std::size_t const d = i % 16 < dirCount ? i % 16 : 0;
+    paths.push_back(cmStrCat(dirs[d], "/file", i, ".cxx.o"));
+  }
+  return paths;
+}
+
+double Seconds(std::chrono::steady_clock::time_point start)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                       start)
+    .count();
+}
+
+}
+
+int main(int argc, char* argv[])
+{
+  std::size_t const count =
+    argc > 1 ? static_cast<std::size_t>(std::strtoul(argv[1], nullptr, 10))
+             : 200000;
+
+  cmake cm(cmake::RoleInternal, cmState::Unknown);
+  cmGlobalNinjaGenerator gg(&cm);
+  std::vector<std::string> const paths = MakePaths(count * 4);
+
+  auto start = std::chrono::steady_clock::now();
+  std::size_t referenceSize = 0;
+  for (std::string const& path : paths) {
+    referenceSize += ReferenceEncodePath(gg, path).size();
+  }
+  double const referenceTime = Seconds(start);
+
+  start = std::chrono::steady_clock::now();
+  std::size_t encodedSize = 0;
+  std::string encoded;
+  for (std::string const& path : paths) {
+    encoded.clear();
+    gg.AppendEncodedPath(encoded, path);
+    encodedSize += encoded.size();
+  }
+  double const encodeTime = Seconds(start);
+
+  for (std::string const& path : paths) {
+    if (gg.EncodePath(path) != ReferenceEncodePath(gg, path)) {
+      std::cerr << "Encoding differs for path:\n  " << path << '\n';
+      return 1;
+    }
+  }
+  if (encodedSize != referenceSize) {
+    std::cerr << "Encoded sizes differ.\n";
+    return 1;
+  }
+
+  // Build statements like those compiling one source each.
+  std::vector<cmNinjaBuild> builds;
+  builds.reserve(count);
+  for (std::size_t i = 0; i < count; ++i) {
+    cmNinjaBuild build("CXX_COMPILER__core_Debug");
+    build.Outputs.push_back(paths[i * 4]);
+    build.ExplicitDeps.push_back(paths[i * 4 + 1]);
+    build.ImplicitDeps.push_back(paths[i * 4 + 2]);
+    build.OrderOnlyDeps.push_back(paths[i * 4 + 3]);
+    build.Variables["DEFINES"] = "-DCORE_EXPORTS -DNDEBUG";
+    build.Variables["DEP_FILE"] = cmStrCat(paths[i * 4], ".d");
+    build.Variables["FLAGS"] = "-O2 -g -fPIC -std=c++17";
+    build.Variables["INCLUDES"] = "-I/src/include -I/build/include";
+    build.Variables["OBJECT_DIR"] = "CMakeFiles/core.dir";
+    builds.push_back(std::move(build));
+  }
+
+  CountingBuffer buffer;
+  std::ostream os(&buffer);
+  start = std::chrono::steady_clock::now();
+  for (cmNinjaBuild const& build : builds) {
+    gg.WriteBuild(os, build);
+  }
+  double const writeTime = Seconds(start);
+
+  std::cout << "Encoded " << paths.size() << " paths in " << encodeTime
+            << " s, with string replacements in " << referenceTime
+            << " s.\n"
+            << "Wrote " << builds.size() << " build statements ("
+            << buffer.Size << " bytes) in " << writeTime << " s.\n";
+  return 0;
+}
@@ -0,0 +1,144 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+#include <cstddef>
+#include <ios>
+#include <sstream>
+#include <string>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmDepends.h"
+#include "cmDependsCompiler.h"
+#include "cmSystemTools.h"
+
+#include "testCommon.h"
+
+namespace {
+
+std::string const databaseFile = "testDependsCompiler.internal";
+
+cmDepends::DependencyMap const dependencies = {
+  { "CMakeFiles/a.dir/a.c.o", { "a.c", "common.h", "/usr/include/stdio.h" } },
+  { "CMakeFiles/a.dir/b.c.o", { "b.c", "common.h", "/usr/include/stdio.h" } },
+  { "CMakeFiles/a.dir/empty.c.o", {} },
+};
+
+std::string EncodeDatabase()
+{
+  std::ostringstream out;
+  cmDependsCompiler::WriteDatabase(dependencies, out);
+  return out.str();
+}
+
+void WriteFile(std::string const& content)
+{
+  cmsys::ofstream fout(databaseFile.c_str(),
+                       std::ios::out | std::ios::binary | std::ios::trunc);
+  fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+bool testRoundTrip()
+{
+  std::cout << "testRoundTrip()\n";
+
+  WriteFile(EncodeDatabase());
+  cmDepends::DependencyMap read;
+  ASSERT_TRUE(cmDependsCompiler::ReadDatabase(databaseFile, read));
+  ASSERT_TRUE(read == dependencies);
+
+  // The database of a target without dependencies is valid too.
+  std::ostringstream out;
+  cmDependsCompiler::WriteDatabase(cmDepends::DependencyMap(), out);
+  WriteFile(out.str());
+  read.clear();
+  ASSERT_TRUE(cmDependsCompiler::ReadDatabase(databaseFile, read));
+  ASSERT_TRUE(read.empty());
+
+  return true;
+}
+
+bool testBadMagic()
+{
+  std::cout << "testBadMagic()\n";
+
+  std::string content = EncodeDatabase();
+  content[7] = '0';
+  WriteFile(content);
+  cmDepends::DependencyMap read;
+  ASSERT_TRUE(!cmDependsCompiler::ReadDatabase(databaseFile, read));
+
+  // The text format of earlier versions.
+  WriteFile("# CMAKE generated file: DO NOT EDIT!\n"
+            "CMakeFiles/a.dir/a.c.o\n"
+            " a.c\n");
+  ASSERT_TRUE(!cmDependsCompiler::ReadDatabase(databaseFile, read));
+
+  return true;
+}
+
+bool testTruncated()
+{
+  std::cout << "testTruncated()\n";
+
+  std::string const content = EncodeDatabase();
+  for (std::size_t size = 0; size < content.size(); ++size) {
+    WriteFile(content.substr(0, size));
+    cmDepends::DependencyMap read;
+    if (cmDependsCompiler::ReadDatabase(databaseFile, read)) {
+      std::cout << "Database truncated to " << size << " of "
+                << content.size() << " bytes was accepted\n";
+      return false;
+    }
+  }
+
+  // Trailing garbage is rejected as well.
+  WriteFile(content + '\0');
+  cmDepends::DependencyMap read;
+  ASSERT_TRUE(!cmDependsCompiler::ReadDatabase(databaseFile, read));
+
+  return true;
+}
+
+bool testBadIndex()
+{
+  std::cout << "testBadIndex()\n";
+
+  // The database ends in the index of the only dependee.  Make it point
+  // past the end of the string table.
+  std::ostringstream out;
+  cmDependsCompiler::WriteDatabase({ { "a.c.o", { "a.c" } } }, out);
+  std::string content = out.str();
+  content.replace(content.size() - 4, 4, 4, '\xff');
+  WriteFile(content);
+  cmDepends::DependencyMap read;
+  ASSERT_TRUE(!cmDependsCompiler::ReadDatabase(databaseFile, read));
+
+  return true;
+}
+
+bool testMissing()
+{
+  std::cout << "testMissing()\n";
+
+  cmSystemTools::RemoveFile(databaseFile);
+  cmDepends::DependencyMap read;
+  ASSERT_TRUE(!cmDependsCompiler::ReadDatabase(databaseFile, read));
+
+  return true;
+}
+
+}
+
+int testDependsCompiler(int /*unused*/, char* /*unused*/[])
+{
+  int const result = runTests({
+    testRoundTrip,
+    testBadMagic,
+    testTruncated,
+    testBadIndex,
+    testMissing,
+  });
+  cmSystemTools::RemoveFile(databaseFile);
+  return result;
+}
@@ -1,8 +1,11 @@
 /* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
    file LICENSE.rst or https://cmake.org/licensing for details.  */
+#include <cstddef>
 #include <iostream>
 #include <string>
 
+#include "cmsys/FStream.hxx"
+
 #include "cmGeneratedFileStream.h"
 #include "cmSystemTools.h"
 
@@ -10,6 +13,81 @@
   std::cout << "FAILED: " << (m1) << (m2) << "\n";                            \
   failed = 1
 
+static int testGeneratedFileStreamBatch()
+{
+  int failed = 0;
+  std::string file1 = "generatedBatchFile1";
+  std::string file2 = "generatedBatchFile2";
+  std::string content;
+
+  for (int pass = 0; pass < 2; ++pass) {
+    cmGeneratedFileStreamBatch batch;
+    {
+      cmGeneratedFileStream gm(file1);
+      gm.SetCopyIfDifferent(true);
+      gm << "This is batch file 1, first version";
+    }
+    {
+      cmGeneratedFileStream gm(file1);
+      gm.SetCopyIfDifferent(true);
+      gm << "This is batch file 1";
+    }
+    {
+      cmGeneratedFileStream gm(file2);
+      gm.SetCopyIfDifferent(true);
+      gm << "This is batch file 2";
+    }
+    if (pass == 0 && cmSystemTools::FileExists(file1)) {
+      cmFailed("cmGeneratedFileStreamBatch replaced a file early: ", file1);
+    }
+    std::size_t replaced = 0;
+    if (!batch.Commit(4, &replaced)) {
+      cmFailed("cmGeneratedFileStreamBatch failed on pass ", pass);
+    }
+    if (replaced != (pass == 0 ? 2u : 0u)) {
+      cmFailed("cmGeneratedFileStreamBatch replaced unexpected number of "
+               "files on pass ",
+               pass);
+    }
+  }
+
+  if (!cmSystemTools::FileExists(file1) ||
+      !cmSystemTools::FileExists(file2)) {
+    cmFailed("cmGeneratedFileStreamBatch did not write files: ",
+             file1 + ", " + file2);
+  } else {
+    cmsys::ifstream fin(file1.c_str());
+    std::getline(fin, content);
+    if (content != "This is batch file 1") {
+      cmFailed("cmGeneratedFileStreamBatch wrote wrong content: ", content);
+    }
+  }
+  cmSystemTools::RemoveFile(file1);
+  cmSystemTools::RemoveFile(file2);
+
+  // A destination that cannot be replaced fails the batch.
+  std::string dir = "generatedBatchDir";
+  cmSystemTools::MakeDirectory(dir + "/sub");
+  {
+    cmGeneratedFileStreamBatch batch;
+    {
+      cmGeneratedFileStream gm(dir);
+      gm.SetCopyIfDifferent(true);
+      gm << "This is not a directory";
+    }
+    if (batch.Commit(4)) {
+      cmFailed("cmGeneratedFileStreamBatch replaced a directory: ", dir);
+    }
+    cmSystemTools::ResetErrorOccurredFlag();
+  }
+  if (!cmSystemTools::FileIsDirectory(dir + "/sub")) {
+    cmFailed("cmGeneratedFileStreamBatch removed a directory: ", dir);
+  }
+  cmSystemTools::RemoveADirectory(dir);
+
+  return failed;
+}
+
 int testGeneratedFileStream(int /*unused*/, char* /*unused*/[])
 {
   int failed = 0;
@@ -84,5 +162,9 @@ int testGeneratedFileStream(int /*unused*/, char* /*unused*/[])
   cmSystemTools::RemoveFile(file3tmp);
   cmSystemTools::RemoveFile(file4tmp);
 
+  if (testGeneratedFileStreamBatch()) {
+    failed = 1;
+  }
+
   return failed;
 }
@@ -0,0 +1,175 @@
+/* Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+   file LICENSE.rst or https://cmake.org/licensing for details.  */
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cmsys/FStream.hxx"
+
+#include "cmListFileCache.h"
+#include "cmListFileParseCache.h"
+#include "cmStringAlgorithms.h"
+#include "cmSystemTools.h"
+
+#include "testCommon.h"
+
+namespace {
+
+std::string const dir = cmSystemTools::GetLogicalWorkingDirectory();
+std::string const listFile = cmStrCat(dir, "/testListFileParseCache.cmake");
+std::string const cacheFile = cmStrCat(dir, "/testListFileParseCache.bin");
+
+std::string ReadFile(std::string const& path)
+{
+  cmsys::ifstream fin(path.c_str(), std::ios::in | std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(fin),
+                     std::istreambuf_iterator<char>());
+}
+
+void WriteFile(std::string const& path, std::string const& content)
+{
+  cmsys::ofstream fout(path.c_str(), std::ios::out | std::ios::binary);
+  fout.write(content.data(), static_cast<std::streamsize>(content.size()));
+}
+
+std::vector<cmListFileFunction> MakeFunctions()
+{
+  std::vector<cmListFileFunction> functions;
+  std::vector<cmListFileArgument> args;
+  args.emplace_back("STATUS", cmListFileArgument::Unquoted, 1);
+  args.emplace_back("hello", cmListFileArgument::Quoted, 1);
+  functions.emplace_back("message", 1, 1, std::move(args));
+  args.clear();
+  args.emplace_back("x", cmListFileArgument::Unquoted, 2);
+  args.emplace_back("y", cmListFileArgument::Bracket, 3);
+  functions.emplace_back("set", 2, 3, std::move(args));
+  return functions;
+}
+
+// Write the listfile and a cache holding its commands.
+bool Store()
+{
+  WriteFile(listFile, "message(STATUS \"hello\")\nset(x\n  [[y]])\n");
+  cmSystemTools::RemoveFile(cacheFile);
+  cmListFileParseCache cache(cacheFile);
+  cache.Load();
+  std::vector<cmListFileFunction> functions;
+  ASSERT_TRUE(!cache.Find(listFile, functions));
+  cache.Insert(listFile, MakeFunctions());
+  ASSERT_TRUE(cache.Save());
+  return true;
+}
+
+bool Lookup(std::vector<cmListFileFunction>& functions)
+{
+  cmListFileParseCache cache(cacheFile);
+  cache.Load();
+  return cache.Find(listFile, functions);
+}
+
+void Put32(std::string& data, std::size_t offset, std::uint32_t value)
+{
+  std::memcpy(&data[offset], &value, sizeof(value));
+}
+
+std::uint32_t Get32(std::string const& data, std::size_t offset)
+{
+  std::uint32_t value;
+  std::memcpy(&value, &data[offset], sizeof(value));
+  return value;
+}
+
+// Offset of the encoded commands of the only entry.
+std::size_t CommandsOffset(std::string const& data)
+{
+  std::size_t offset = 8;            // magic
+  offset += 4 + Get32(data, offset); // cmake version
+  offset += 4 + Get32(data, offset); // listfile path
+  offset += 8 + 8;                   // time and size
+  offset += 4 + Get32(data, offset); // content hash
+  return offset + 8;                 // length of the commands
+}
+
+bool testRoundTrip()
+{
+  ASSERT_TRUE(Store());
+  std::vector<cmListFileFunction> functions;
+  ASSERT_TRUE(Lookup(functions));
+  std::vector<cmListFileFunction> const expected = MakeFunctions();
+  ASSERT_EQUAL(functions.size(), expected.size());
+  for (std::size_t i = 0; i < functions.size(); ++i) {
+    ASSERT_EQUAL(functions[i].OriginalName(), expected[i].OriginalName());
+    ASSERT_EQUAL(functions[i].Line(), expected[i].Line());
+    ASSERT_EQUAL(functions[i].LineEnd(), expected[i].LineEnd());
+    ASSERT_TRUE(functions[i].Arguments() == expected[i].Arguments());
+  }
+  return true;
+}
+
+bool testTruncated()
+{
+  ASSERT_TRUE(Store());
+  std::string const data = ReadFile(cacheFile);
+  for (std::size_t size = 0; size < data.size(); ++size) {
+    WriteFile(cacheFile, data.substr(0, size));
+    std::vector<cmListFileFunction> functions;
+    ASSERT_TRUE(!Lookup(functions));
+    ASSERT_TRUE(functions.empty());
+  }
+  return true;
+}
+
+bool testHugeCounts()
+{
+  ASSERT_TRUE(Store());
+  std::string const data = ReadFile(cacheFile);
+  std::size_t const commands = CommandsOffset(data);
+
+  // A command count far beyond the data must not be reserved.
+  std::string corrupt = data;
+  Put32(corrupt, commands, 0xffffffff);
+  WriteFile(cacheFile, corrupt);
+  std::vector<cmListFileFunction> functions;
+  ASSERT_TRUE(!Lookup(functions));
+
+  // Nor an argument count.
+  std::size_t const name = commands + 4;
+  std::size_t const argCount = name + 4 + Get32(data, name) + 8 + 8;
+  corrupt = data;
+  Put32(corrupt, argCount, 0xffffffff);
+  WriteFile(cacheFile, corrupt);
+  ASSERT_TRUE(!Lookup(functions));
+  return true;
+}
+
+bool testVersionMismatch()
+{
+  ASSERT_TRUE(Store());
+  std::string data = ReadFile(cacheFile);
+  // Change the first character of the recorded cmake version.
+  data[12] = data[12] == '0' ? '1' : '0';
+  WriteFile(cacheFile, data);
+  std::vector<cmListFileFunction> functions;
+  ASSERT_TRUE(!Lookup(functions));
+  return true;
+}
+
+}
+
+int testListFileParseCache(int /*unused*/, char* /*unused*/[])
+{
+  int result = runTests({
+    testRoundTrip,
+    testTruncated,
+    testHugeCounts,
+    testVersionMismatch,
+  });
+  cmSystemTools::RemoveFile(listFile);
+  cmSystemTools::RemoveFile(cacheFile);
+  return result;
+}
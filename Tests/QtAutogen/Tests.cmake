@@ -37,6 +37,7 @@ ADD_AUTOGEN_TEST(RerunRccConfigChange)
 ADD_AUTOGEN_TEST(RerunRccDepends)
 ADD_AUTOGEN_TEST(RerunUicOnFileChange)
 ADD_AUTOGEN_TEST(SameName sameName)
+ADD_AUTOGEN_TEST(SharedParseCache sharedParseCache2)
 ADD_AUTOGEN_TEST(StaticLibraryCycle slc)
 ADD_AUTOGEN_TEST(UicInclude uicInclude)
 ADD_AUTOGEN_TEST(UicInterface QtAutoUicInterface)
@@ -81,7 +81,9 @@ if(check_step EQUAL 3)
     )
 
   if (RunCMake_GENERATOR MATCHES \"Make\")
-    file(STRINGS \"${CMAKE_BINARY_DIR}/CMakeFiles/topcc.dir/compiler_depend.internal\" deps REGEX \"^.*topccdep\\\\.txt$\")
+    # Count the dependencies, not the empty rule of the dependency itself.
+    file(READ \"${CMAKE_BINARY_DIR}/CMakeFiles/topcc.dir/compiler_depend.make\" deps)
+    string(REGEX MATCHALL \"topccdep\\\\.txt[^:]\" deps \"\${deps}\")
     list(LENGTH deps count)
     if (NOT count EQUAL 1)
        string(APPEND RunCMake_TEST_FAILED \"dependencies are duplicated\\n\")
@@ -703,3 +703,61 @@ endforeach()
   run_cmake_command(ScheduleRandomSeed1 ${CMAKE_CTEST_COMMAND} --schedule-random --schedule-random-seed 42)
   run_cmake_command(ScheduleRandomSeed2 ${CMAKE_CTEST_COMMAND} --schedule-random --schedule-random-seed 42)
 endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ScheduleCriticalPath)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+foreach(t IN ITEMS chain1 chain2 chain3 long short)
+  add_test(\${t} \"${CMAKE_COMMAND}\" -E true)
+endforeach()
+set_tests_properties(chain1 chain2 chain3 PROPERTIES COST 1)
+set_tests_properties(chain2 PROPERTIES DEPENDS chain1)
+set_tests_properties(chain3 PROPERTIES DEPENDS chain2)
+set_tests_properties(long PROPERTIES COST 10)
+set_tests_properties(short PROPERTIES COST 0.5)
+")
+  run_cmake_command(ScheduleCriticalPath ${CMAKE_CTEST_COMMAND} -j2 --schedule-critical-path)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Workers)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(echo \"${CMAKE_COMMAND}\" -E echo \"output from a worker\")
+set_tests_properties(echo PROPERTIES PASS_REGULAR_EXPRESSION \"output from a worker\")
+add_test(environment \"${CMAKE_COMMAND}\" -E environment)
+set_tests_properties(environment PROPERTIES
+  ENVIRONMENT WORKERS_TEST_VAR=value
+  PASS_REGULAR_EXPRESSION \"WORKERS_TEST_VAR=value\"
+  DEPENDS echo)
+add_test(processors \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(processors PROPERTIES PROCESSORS 4)
+add_test(fail \"${CMAKE_COMMAND}\" -E false)
+add_test(timeout \"${CMAKE_COMMAND}\" -E sleep 60)
+set_tests_properties(timeout PROPERTIES TIMEOUT 1)
+")
+  set(worker "\"${CMAKE_CTEST_COMMAND}\" --test-worker -j2")
+  run_cmake_command(Workers ${CMAKE_CTEST_COMMAND} -j
+    --worker "${worker}" --worker "${worker}" --output-junit junit.xml)
+endblock()
+
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/WorkersLost)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/CTestTestfile.cmake" "
+add_test(echo \"${CMAKE_COMMAND}\" -E echo \"output from a local test\")
+set_tests_properties(echo PROPERTIES PASS_REGULAR_EXPRESSION \"output from a local test\")
+add_test(processors \"${CMAKE_COMMAND}\" -E true)
+set_tests_properties(processors PROPERTIES PROCESSORS 4)
+")
+  # The worker exits without announcing its slots.
+  run_cmake_command(WorkersLost ${CMAKE_CTEST_COMMAND} -j
+    --worker "\"${CMAKE_COMMAND}\" -E true")
+endblock()
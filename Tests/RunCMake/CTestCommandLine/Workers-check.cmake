@@ -0,0 +1,14 @@
+set(junit "${RunCMake_TEST_BINARY_DIR}/junit.xml")
+if(NOT EXISTS "${junit}")
+  set(RunCMake_TEST_FAILED "JUnit file not written:\n  ${junit}")
+  return()
+endif()
+file(READ "${junit}" junit_content)
+foreach(test IN ITEMS echo environment processors fail timeout)
+  if(NOT junit_content MATCHES "<testcase name=\"${test}\"")
+    string(APPEND RunCMake_TEST_FAILED "Test '${test}' missing from JUnit file.\n")
+  endif()
+endforeach()
+if(NOT junit_content MATCHES "output from a worker")
+  string(APPEND RunCMake_TEST_FAILED "Test output missing from JUnit file.\n")
+endif()
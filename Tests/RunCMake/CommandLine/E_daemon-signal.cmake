@@ -0,0 +1,3 @@
+execute_process(COMMAND ${CLIENT} -E copy big.bin big-copy.bin
+  RESULT_VARIABLE result)
+message(STATUS "copy over file size limit: ${result}")
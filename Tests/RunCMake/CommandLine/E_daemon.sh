@@ -0,0 +1,40 @@
+#!/bin/sh
+cmake="$1"
+client="$2"
+sock="$PWD/daemon.sock"
+rm -f "$sock"
+
+"$cmake" -E daemon "$sock" --verbose --idle-timeout 60 &
+pid=$!
+n=0
+while ! test -S "$sock"; do
+  n=$((n+1))
+  if test $n -gt 100; then
+    echo "daemon did not start" >&2
+    kill $pid
+    exit 1
+  fi
+  sleep 0.1
+done
+
+CMAKE_COMMAND_DAEMON_SOCKET="$sock"
+export CMAKE_COMMAND_DAEMON_SOCKET
+
+"$client" -E echo "daemon echo"
+"$client" -E false
+echo "false: $?"
+mkdir -p sub
+(cd sub && DAEMON_TEST_VAR=forwarded "$client" -E environment) |
+  grep '^DAEMON_TEST_VAR='
+(umask 027 && "$client" -E touch umask.txt)
+ls -l umask.txt | cut -c1-10
+dd if=/dev/zero of=big.bin bs=4096 count=1 2>/dev/null
+(ulimit -f 1 && "$cmake" -DCLIENT="$client" \
+  -P "$(dirname "$0")/E_daemon-signal.cmake")
+"$cmake" -E daemon "$sock"
+echo "second daemon: $?"
+
+kill $pid
+wait $pid
+test -S "$sock" && echo "socket left behind"
+exit 0
@@ -29,3 +29,9 @@ if (NOT numInvocations EQUAL 1)
   set(RunCMake_TEST_FAILED
       "Unexpected number of lowercase command names: ${numInvocations}")
 endif()
+
+file(STRINGS ${ProfilingTestOutput} argumentAllocations
+  REGEX [["argumentAllocations"[ ]*:[ ]*[0-9]+]])
+if ("${argumentAllocations}" STREQUAL "")
+  set(RunCMake_TEST_FAILED "Argument allocations not recorded")
+endif()
@@ -912,6 +912,20 @@ run_cmake_command(E_sleep-bad-arg1 ${CMAKE_COMMAND} -E sleep x)
 run_cmake_command(E_sleep-bad-arg2 ${CMAKE_COMMAND} -E sleep 1 -1)
 run_cmake_command(E_sleep-one-tenth ${CMAKE_COMMAND} -E sleep 0.1)
 
+run_cmake_command(E_daemon-bad-arg ${CMAKE_COMMAND} -E daemon sock --bogus)
+if(UNIX AND NOT CYGWIN)
+  block()
+    cmake_path(GET CMAKE_COMMAND PARENT_PATH bin)
+    set(client "${bin}/cmake-daemon-client${CMAKE_EXECUTABLE_SUFFIX}")
+    run_cmake_command(E_daemon-client-fallback
+      ${CMAKE_COMMAND} -E env
+        CMAKE_COMMAND_DAEMON_SOCKET=${RunCMake_BINARY_DIR}/no-daemon.sock
+        ${client} -E echo client fallback)
+    run_cmake_command(E_daemon
+      sh ${RunCMake_SOURCE_DIR}/E_daemon.sh ${CMAKE_COMMAND} ${client})
+  endblock()
+endif()
+
 run_cmake_command(P_directory ${CMAKE_COMMAND} -P ${RunCMake_SOURCE_DIR})
 
 block()
@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/ListFileParseCache.bin")
+  set(RunCMake_TEST_FAILED "ListFileParseCache.bin not written.")
+endif()
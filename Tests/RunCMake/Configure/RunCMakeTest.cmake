@@ -67,6 +67,49 @@ block()
   run_cmake(RemoveCache)
 endblock()
 
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/ListFileParseCache-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_LISTFILE_PARSE_CACHE=ON)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  set(input "${RunCMake_TEST_BINARY_DIR}/ListFileParseCacheInput.cmake")
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${input}" "message(STATUS \"input=1\")\n")
+  set(RunCMake_TEST_EXPECT_stdout "-- input=1\n")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-parse")
+  run_cmake(ListFileParseCache)
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-cached")
+  run_cmake(ListFileParseCache)
+  file(WRITE "${input}" "message(STATUS \"input=22\")\n")
+  set(RunCMake_TEST_EXPECT_stdout "-- input=22\n")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-changed")
+  run_cmake(ListFileParseCache)
+endblock()
+
+block()
+  set(ENV{CMAKE_TOOLCHAIN_SNAPSHOT_DIR} "${RunCMake_BINARY_DIR}/ToolchainSnapshot")
+  file(REMOVE_RECURSE "$ENV{CMAKE_TOOLCHAIN_SNAPSHOT_DIR}")
+  set(RunCMake_TEST_EXPECT_stdout "-- CMAKE_CXX_COMPILER_WORKS='(TRUE|1)'")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-save")
+  run_cmake(ToolchainSnapshot)
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-restore")
+  run_cmake(ToolchainSnapshot)
+
+  # Make the CXX snapshot stale.  The same compiler is detected again and
+  # its files are replaced even though the compiler stamp is unchanged.
+  file(GLOB cxx_snapshots "$ENV{CMAKE_TOOLCHAIN_SNAPSHOT_DIR}/*/*/CMakeCXXCache.txt")
+  foreach(cache IN LISTS cxx_snapshots)
+    file(APPEND "${cache}" "ToolchainSnapshotStale:STRING=stale\n")
+    string(REPLACE "CMakeCXXCache.txt" "CMakeCXXCompiler.cmake" compiler "${cache}")
+    file(REMOVE "${compiler}")
+  endforeach()
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-resave")
+  run_cmake(ToolchainSnapshot)
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-restore-resaved")
+  run_cmake(ToolchainSnapshot)
+  unset(ENV{CMAKE_TOOLCHAIN_SNAPSHOT_DIR})
+endblock()
+
 if(NOT RunCMake_GENERATOR MATCHES "^Ninja Multi-Config$")
   run_cmake(NoCMAKE_CROSS_CONFIGS)
   run_cmake(NoCMAKE_DEFAULT_BUILD_TYPE)
@@ -0,0 +1,16 @@
+file(GLOB snapshots "$ENV{CMAKE_TOOLCHAIN_SNAPSHOT_DIR}/*/*/CMakeCXXCompiler.cmake")
+if(NOT snapshots)
+  set(RunCMake_TEST_FAILED "CMakeCXXCompiler.cmake not saved in snapshot.\n")
+elseif(RunCMake_TEST_VARIANT_DESCRIPTION MATCHES "^-restore")
+  if(actual_stdout MATCHES "Detecting C(XX)? compiler ABI info")
+    set(RunCMake_TEST_FAILED "Compilers were checked again:\n${actual_stdout}")
+  endif()
+endif()
+
+file(GLOB caches "$ENV{CMAKE_TOOLCHAIN_SNAPSHOT_DIR}/*/*/CMakeCXXCache.txt")
+foreach(cache IN LISTS caches)
+  file(STRINGS "${cache}" stale REGEX "ToolchainSnapshotStale")
+  if(stale)
+    string(APPEND RunCMake_TEST_FAILED "Stale cache entries not replaced:\n  ${cache}\n")
+  endif()
+endforeach()
@@ -0,0 +1,13 @@
+enable_language(C)
+enable_language(CXX)
+
+foreach(lang IN ITEMS C CXX)
+  if(NOT DEFINED CACHE{CMAKE_${lang}_COMPILER})
+    message(SEND_ERROR "CMAKE_${lang}_COMPILER is not in the cache!")
+  endif()
+  message(STATUS "CMAKE_${lang}_COMPILER_WORKS='${CMAKE_${lang}_COMPILER_WORKS}'")
+endforeach()
+
+if(DEFINED CACHE{ToolchainSnapshotStale})
+  message(SEND_ERROR "A stale cache entry was restored from the snapshot!")
+endif()
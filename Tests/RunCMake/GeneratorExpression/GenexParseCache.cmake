@@ -0,0 +1,11 @@
+set(defs
+  SHARED $<$<BOOL:1>:ENABLED> $<$<CONFIG:Debug>:DEBUG_ONLY>
+  NAME_$<TARGET_PROPERTY:NAME>)
+
+foreach(tgt IN ITEMS a b)
+  add_library(${tgt} INTERFACE)
+  set_property(TARGET ${tgt} PROPERTY COMPILE_DEFINITIONS "${defs}")
+  set_property(TARGET ${tgt} PROPERTY COMPILE_OPTIONS "-O$<$<BOOL:1>:2>")
+  file(GENERATE OUTPUT "${tgt}-$<CONFIG>.txt"
+    CONTENT "$<TARGET_PROPERTY:${tgt},COMPILE_DEFINITIONS>;$<TARGET_PROPERTY:${tgt},COMPILE_OPTIONS>\n")
+endforeach()
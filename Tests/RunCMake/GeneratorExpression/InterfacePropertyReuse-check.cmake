@@ -0,0 +1,26 @@
+set(expect_a_Debug "CONFIG_FREE;DEBUG_ONLY;PLAIN;ENABLED")
+set(expect_a_Release "CONFIG_FREE;PLAIN;ENABLED")
+set(expect_b_Debug "PLAIN;ENABLED")
+set(expect_b_Release "PLAIN;ENABLED")
+
+if(RunCMake_GENERATOR_IS_MULTI_CONFIG)
+  set(configs Debug Release)
+else()
+  set(configs Debug)
+endif()
+foreach(config IN LISTS configs)
+  foreach(tgt IN ITEMS a b)
+    set(file "${RunCMake_TEST_BINARY_DIR}/${tgt}-${config}.txt")
+    if(NOT EXISTS "${file}")
+      string(APPEND RunCMake_TEST_FAILED "Missing\n  ${file}\n")
+      continue()
+    endif()
+    file(READ "${file}" actual)
+    string(STRIP "${actual}" actual)
+    if(NOT actual STREQUAL expect_${tgt}_${config})
+      string(APPEND RunCMake_TEST_FAILED
+        "${file} contains\n  ${actual}\nbut expected\n"
+        "  ${expect_${tgt}_${config}}\n")
+    endif()
+  endforeach()
+endforeach()
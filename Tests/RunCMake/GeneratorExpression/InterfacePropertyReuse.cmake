@@ -0,0 +1,17 @@
+add_library(iface_config INTERFACE)
+target_compile_definitions(iface_config INTERFACE
+  CONFIG_FREE $<$<CONFIG:Debug>:DEBUG_ONLY>)
+
+add_library(iface_plain INTERFACE)
+target_compile_definitions(iface_plain INTERFACE
+  PLAIN $<$<BOOL:1>:ENABLED> $<$<STREQUAL:a,b>:DISABLED>)
+
+add_library(a INTERFACE)
+target_link_libraries(a INTERFACE iface_config iface_plain)
+add_library(b INTERFACE)
+target_link_libraries(b INTERFACE iface_plain)
+
+foreach(tgt IN ITEMS a b)
+  file(GENERATE OUTPUT "${tgt}-$<CONFIG>.txt"
+    CONTENT "$<TARGET_PROPERTY:${tgt},INTERFACE_COMPILE_DEFINITIONS>\n")
+endforeach()
@@ -138,3 +138,14 @@ run_cmake(CMP0085-WARN)
 set(RunCMake_TEST_OPTIONS -DCMAKE_POLICY_DEFAULT_CMP0085:STRING=NEW)
 run_cmake(CMP0085-NEW)
 unset(RunCMake_TEST_OPTIONS)
+
+block()
+  if(RunCMake_GENERATOR_IS_MULTI_CONFIG)
+    set(RunCMake_TEST_OPTIONS [==[-DCMAKE_CONFIGURATION_TYPES=Debug;Release]==])
+  else()
+    set(RunCMake_TEST_OPTIONS -DCMAKE_BUILD_TYPE=Debug)
+  endif()
+  list(APPEND RunCMake_TEST_OPTIONS --debug-output)
+  run_cmake(InterfacePropertyReuse)
+  run_cmake(GenexParseCache)
+endblock()
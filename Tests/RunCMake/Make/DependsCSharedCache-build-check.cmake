@@ -0,0 +1,34 @@
+set(cache "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/C.includecache")
+if(NOT EXISTS "${cache}")
+  set(RunCMake_TEST_FAILED "Directory-level include cache not found:\n  ${cache}")
+  return()
+endif()
+
+# Targets scanned concurrently must not drop each other's entries.
+file(STRINGS "${cache}" lines)
+foreach(header IN ITEMS shared only_a only_b)
+  set(found "${lines}")
+  list(FILTER found INCLUDE REGEX "${header}\\.h$")
+  if(NOT found)
+    string(APPEND RunCMake_TEST_FAILED "Include cache does not mention ${header}.h:\n  ${cache}\n")
+  endif()
+endforeach()
+set(found "${lines}")
+list(FILTER found INCLUDE REGEX "only_c\\.h$")
+if(found)
+  string(APPEND RunCMake_TEST_FAILED "Include cache mentions only_c.h of a target with transforms:\n  ${cache}\n")
+endif()
+
+file(GLOB transform_caches "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/C-*.includecache")
+if(NOT transform_caches)
+  string(APPEND RunCMake_TEST_FAILED "Include cache of the target with transforms not found.\n")
+endif()
+
+foreach(tgt IN ITEMS a b c)
+  foreach(header IN ITEMS shared only_${tgt})
+    file(STRINGS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/${tgt}.dir/depend.make" deps REGEX "${header}\\.h")
+    if(NOT deps)
+      string(APPEND RunCMake_TEST_FAILED "depend.make of target ${tgt} does not list ${header}.h\n")
+    endif()
+  endforeach()
+endforeach()
@@ -0,0 +1,15 @@
+set(CMAKE_DEPENDS_USE_COMPILER OFF)
+enable_language(C)
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/shared.h" "#define SHARED 1\n")
+foreach(tgt IN ITEMS a b c)
+  file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/only_${tgt}.h" "\n")
+  file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/${tgt}.c" "#include \"shared.h\"
+#include \"only_${tgt}.h\"
+int main(void) { return SHARED - 1; }
+")
+  add_executable(${tgt} "${CMAKE_CURRENT_BINARY_DIR}/${tgt}.c")
+endforeach()
+
+# A target with include transforms uses a separate cache.
+set_property(TARGET c PROPERTY IMPLICIT_DEPENDS_INCLUDE_TRANSFORM
+  "INC_MACRO(%)=\"%\"")
@@ -0,0 +1,9 @@
+set(leaf_dir "${RunCMake_TEST_BINARY_DIR}/IncrementalGenerate/CMakeFiles/leaf.dir")
+if(NOT EXISTS "${leaf_dir}/fingerprint.txt")
+  set(RunCMake_TEST_FAILED "leaf.dir/fingerprint.txt not written.")
+elseif(RunCMake_TEST_VARIANT_DESCRIPTION STREQUAL "-changed")
+  file(READ "${leaf_dir}/flags.make" flags)
+  if(NOT flags MATCHES "LEAF_CHANGED")
+    set(RunCMake_TEST_FAILED "leaf.dir/flags.make does not have LEAF_CHANGED:\n${flags}")
+  endif()
+endif()
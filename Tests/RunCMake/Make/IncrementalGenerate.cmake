@@ -0,0 +1,5 @@
+enable_language(C)
+add_library(base STATIC IncrementalGenerate/base.c)
+add_subdirectory(IncrementalGenerate)
+add_executable(app hello.c)
+target_link_libraries(app PRIVATE leaf)
@@ -0,0 +1,7 @@
+#ifndef LEAF_CHANGED
+#  error "LEAF_CHANGED not defined"
+#endif
+int leaf(void)
+{
+  return 0;
+}
@@ -16,6 +16,33 @@ run_TargetMessages(OFF)
 run_TargetMessages(VAR-ON -DCMAKE_TARGET_MESSAGES=ON)
 run_TargetMessages(VAR-OFF -DCMAKE_TARGET_MESSAGES=OFF)
 
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/IncrementalGenerate-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_INCREMENTAL_GENERATE=ON)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  set(leaf "${RunCMake_TEST_BINARY_DIR}/IncrementalGenerateLeaf.cmake")
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  file(WRITE "${leaf}" "")
+  set(RunCMake_TEST_EXPECT_stdout "-- Reused build rules of 0 of 4 targets\n")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-initial")
+  run_cmake(IncrementalGenerate)
+  # Variables left over from compiler detection change the first rerun.
+  set(RunCMake_TEST_EXPECT_stdout "-- Reused build rules of [0-9]+ of 4 targets\n")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-rerun")
+  run_cmake(IncrementalGenerate)
+  set(RunCMake_TEST_EXPECT_stdout "-- Reused build rules of 4 of 4 targets\n")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-unchanged")
+  run_cmake(IncrementalGenerate)
+  file(WRITE "${leaf}" "target_compile_definitions(leaf PRIVATE LEAF_CHANGED)\n")
+  set(RunCMake_TEST_EXPECT_stdout "-- Reused build rules of 2 of 4 targets\n")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-changed")
+  run_cmake(IncrementalGenerate)
+  unset(RunCMake_TEST_EXPECT_stdout)
+  unset(RunCMake_TEST_VARIANT_DESCRIPTION)
+  run_cmake_command(IncrementalGenerate-build ${CMAKE_COMMAND} --build .)
+endblock()
+
 function(run_VerboseBuild)
   run_cmake(VerboseBuild)
   set(RunCMake_TEST_NO_CLEAN 1)
@@ -64,6 +91,14 @@ run_VerboseBuildShort()
 
 run_cmake(IncludeRegexSubdir)
 
+function(run_DependsCSharedCache)
+  run_cmake(DependsCSharedCache)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/DependsCSharedCache-build)
+  run_cmake_command(DependsCSharedCache-build ${CMAKE_COMMAND} --build . --parallel 3)
+endfunction()
+run_DependsCSharedCache()
+
 function(run_MakefileConflict)
   run_cmake(MakefileConflict)
   set(RunCMake_TEST_NO_CLEAN 1)
@@ -0,0 +1,10 @@
+foreach(file IN ITEMS out.txt out2.txt byproduct.txt)
+  file(READ "${RunCMake_TEST_BINARY_DIR}/${file}" out)
+  if(NOT out STREQUAL "one\n")
+    string(APPEND RunCMake_TEST_FAILED
+      "${file} not restored from the cache:\n  ${out}\n")
+  endif()
+endforeach()
+if(EXISTS "${RunCMake_TEST_BINARY_DIR}/not-created.txt")
+  string(APPEND RunCMake_TEST_FAILED "not-created.txt was created.\n")
+endif()
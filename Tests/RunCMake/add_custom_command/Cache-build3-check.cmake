@@ -0,0 +1,4 @@
+file(READ "${RunCMake_TEST_BINARY_DIR}/out.txt" out)
+if(NOT out STREQUAL "two\n")
+  set(RunCMake_TEST_FAILED "out.txt not regenerated:\n  ${out}")
+endif()
@@ -0,0 +1,18 @@
+file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/in.txt" "one\n")
+add_custom_command(
+  OUTPUT out.txt
+  BYPRODUCTS byproduct.txt
+  COMMAND ${CMAKE_COMMAND} -E copy in.txt out.txt
+  COMMAND ${CMAKE_COMMAND} -E copy in.txt byproduct.txt
+  DEPENDS "${CMAKE_CURRENT_BINARY_DIR}/in.txt"
+  CACHE
+  )
+# A byproduct the command does not create does not prevent caching.
+add_custom_command(
+  OUTPUT out2.txt
+  BYPRODUCTS not-created.txt
+  COMMAND ${CMAKE_COMMAND} -E copy in.txt out2.txt
+  DEPENDS "${CMAKE_CURRENT_BINARY_DIR}/in.txt"
+  CACHE
+  )
+add_custom_target(drive ALL DEPENDS out.txt out2.txt)
@@ -0,0 +1,2 @@
+add_custom_command(OUTPUT a COMMAND x)
+add_custom_command(OUTPUT a COMMAND y APPEND CACHE)
@@ -0,0 +1,2 @@
+add_custom_target(x)
+add_custom_command(TARGET x POST_BUILD COMMAND x CACHE)
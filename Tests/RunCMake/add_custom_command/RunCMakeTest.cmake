@@ -10,6 +10,8 @@ run_cmake(BadArgument)
 run_cmake(BadByproduct)
 run_cmake(BadOutput)
 run_cmake(BadCommand)
+run_cmake(CacheAppend)
+run_cmake(CacheNoOutput)
 run_cmake(ConfigureFile)
 run_cmake(GeneratedProperty)
 run_cmake(LiteralQuotes)
@@ -72,3 +74,34 @@ if(NOT RunCMake_GENERATOR STREQUAL "Xcode")
     run_cmake_command(CommentGenex-build ${CMAKE_COMMAND} --build .)
   endblock()
 endif()
+
+block()
+  run_cmake(Cache)
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/Cache-build)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  run_cmake_command(Cache-build1 ${CMAKE_COMMAND} --build . --config Debug)
+  # Missing outputs and byproducts are restored from the cache.
+  file(REMOVE
+    "${RunCMake_TEST_BINARY_DIR}/out.txt"
+    "${RunCMake_TEST_BINARY_DIR}/out2.txt"
+    "${RunCMake_TEST_BINARY_DIR}/byproduct.txt"
+    )
+  run_cmake_command(Cache-build2 ${CMAKE_COMMAND} --build . --config Debug)
+  # A change in the content of a dependency is a new key.
+  file(REMOVE "${RunCMake_TEST_BINARY_DIR}/out.txt")
+  file(WRITE "${RunCMake_TEST_BINARY_DIR}/in.txt" "two\n")
+  run_cmake_command(Cache-build3 ${CMAKE_COMMAND} --build . --config Debug)
+  # A damaged entry is replaced by the next run of the commands.
+  file(GLOB stored_outputs
+    "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/CustomCommandCache/*/*/0")
+  file(REMOVE ${stored_outputs}
+    "${RunCMake_TEST_BINARY_DIR}/out.txt"
+    "${RunCMake_TEST_BINARY_DIR}/out2.txt"
+    )
+  run_cmake_command(Cache-build4 ${CMAKE_COMMAND} --build . --config Debug)
+  file(REMOVE
+    "${RunCMake_TEST_BINARY_DIR}/out.txt"
+    "${RunCMake_TEST_BINARY_DIR}/out2.txt"
+    )
+  run_cmake_command(Cache-build5 ${CMAKE_COMMAND} --build . --config Debug)
+endblock()
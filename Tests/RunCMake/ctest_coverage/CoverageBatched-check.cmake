@@ -0,0 +1,2 @@
+include("${CMAKE_CURRENT_LIST_DIR}/CoverageCommon.cmake")
+compare_coverage("${RunCMake_BINARY_DIR}/CoverageSerial-build")
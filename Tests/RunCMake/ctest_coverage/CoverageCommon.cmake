@@ -0,0 +1,27 @@
+# Read the coverage summary and per-line log a build tree submitted,
+# without the parts that depend on the time.
+function(read_coverage var dir)
+  file(READ "${dir}/Testing/TAG" tag)
+  string(REGEX REPLACE "^([^\n]*)\n.*$" "\\1" date "${tag}")
+  set(content "")
+  foreach(xml IN ITEMS Coverage.xml CoverageLog-0.xml)
+    file(STRINGS "${dir}/Testing/${date}/${xml}" lines
+      REGEX "^[ \t]*<(File|Line|LOC|Percent|Coverage)")
+    string(APPEND content "${lines}\n")
+  endforeach()
+  set("${var}" "${content}" PARENT_SCOPE)
+endfunction()
+
+# Compare the coverage of the current test with that of another one.
+function(compare_coverage other)
+  read_coverage(expect "${other}")
+  read_coverage(actual "${RunCMake_TEST_BINARY_DIR}")
+  if(NOT actual STREQUAL expect)
+    string(REPLACE ";" "\n" expect "${expect}")
+    string(REPLACE ";" "\n" actual "${actual}")
+    string(APPEND RunCMake_TEST_FAILED
+      "The coverage differs from that of\n  ${other}\n"
+      "Expected:\n${expect}\nActual:\n${actual}\n")
+    set(RunCMake_TEST_FAILED "${RunCMake_TEST_FAILED}" PARENT_SCOPE)
+  endif()
+endfunction()
@@ -0,0 +1,7 @@
+include("${CMAKE_CURRENT_LIST_DIR}/CoverageCommon.cmake")
+read_coverage(serial "${RunCMake_TEST_BINARY_DIR}")
+if(NOT serial MATCHES [[<File Name="shared\.h"]])
+  string(APPEND RunCMake_TEST_FAILED
+    "Could not find shared.h in the coverage of:\n  "
+    "${RunCMake_TEST_BINARY_DIR}")
+endif()
@@ -0,0 +1,7 @@
+static inline int shared(int x)
+{
+  if (x > 0) {
+    return x * 2;
+  }
+  return -x;
+}
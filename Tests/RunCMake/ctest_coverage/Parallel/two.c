@@ -0,0 +1,11 @@
+#include "shared.h"
+
+int two(void)
+{
+  return shared(-2);
+}
+
+int unused(void)
+{
+  return shared(0);
+}
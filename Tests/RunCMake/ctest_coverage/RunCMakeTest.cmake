@@ -8,3 +8,27 @@ function(run_ctest_coverage CASE_NAME)
 endfunction()
 
 run_ctest_coverage(CoverageQuiet QUIET)
+
+# gcov runs in parallel with -j, and several files are passed to each
+# gcov process with -l.  Both must give the same coverage as one gcov
+# process per file.
+if(CMAKE_C_COMPILER_ID STREQUAL "GNU")
+  set(CASE_CMAKELISTS_SUFFIX_CODE [[
+enable_language(C)
+add_compile_options(--coverage)
+add_link_options(--coverage)
+add_executable(main main.c one.c two.c)
+add_test(NAME main COMMAND main)
+]])
+  function(run_ctest_coverage_parallel CASE_NAME FLAGS)
+    set(CASE_TEST_PREFIX_CODE "set(CTEST_COVERAGE_EXTRA_FLAGS \"${FLAGS}\")")
+    file(REMOVE_RECURSE "${RunCMake_BINARY_DIR}/${CASE_NAME}")
+    file(COPY "${RunCMake_SOURCE_DIR}/Parallel/"
+      DESTINATION "${RunCMake_BINARY_DIR}/${CASE_NAME}")
+    run_ctest(${CASE_NAME} ${ARGN})
+  endfunction()
+  run_ctest_coverage_parallel(CoverageSerial "" -j1)
+  run_ctest_coverage_parallel(CoverageParallel "" -j2)
+  run_ctest_coverage_parallel(CoverageBatched "-l" -j2)
+  unset(CASE_CMAKELISTS_SUFFIX_CODE)
+endif()
@@ -0,0 +1,12 @@
+set(src ${CMAKE_CURRENT_SOURCE_DIR}/dir)
+set(dst ${CMAKE_CURRENT_BINARY_DIR}/dir)
+set(ENV{CMAKE_FILE_COPY_PARALLEL_LEVEL} 1)
+file(COPY ${src}/ DESTINATION ${dst}-1)
+set(ENV{CMAKE_FILE_COPY_PARALLEL_LEVEL} bad)
+file(COPY ${src}/ DESTINATION ${dst}-bad)
+unset(ENV{CMAKE_FILE_COPY_PARALLEL_LEVEL})
+foreach(d IN ITEMS 1 bad)
+  if(NOT EXISTS ${dst}-${d}/empty.txt)
+    message(SEND_ERROR "File not copied to:\n  ${dst}-${d}")
+  endif()
+endforeach()
@@ -0,0 +1,7 @@
+set(src ${CMAKE_CURRENT_SOURCE_DIR}/dir)
+set(dst ${CMAKE_CURRENT_BINARY_DIR}/dir)
+file(REMOVE RECURSE ${dst})
+file(INSTALL FILES ${src}/ DESTINATION ${dst} TYPE DIRECTORY MESSAGE_NEVER)
+file(INSTALL FILES ${src}/ DESTINATION ${dst} TYPE DIRECTORY MESSAGE_NEVER)
+file(COPY ${src}/ DESTINATION ${dst}-copy PATTERN "*.txt" EXCLUDE)
+file(COPY ${src}/ DESTINATION ${dst}-copy FILES_MATCHING PATTERN "empty.txt")
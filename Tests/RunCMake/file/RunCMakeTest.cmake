@@ -15,6 +15,8 @@ run_cmake(UPLOAD-tls-verify-not-set)
 run_cmake(UPLOAD-TLS_VERSION-missing)
 run_cmake(UPLOAD-pass-not-set)
 run_cmake(INSTALL-DIRECTORY)
+run_cmake_with_options(INSTALL-DIRECTORY-summary --log-level=VERBOSE)
+run_cmake(INSTALL-DIRECTORY-jobs)
 run_cmake(INSTALL-FILES_FROM_DIR)
 run_cmake(INSTALL-FILES_FROM_DIR-bad)
 run_cmake(INSTALL-MESSAGE-bad)
@@ -165,6 +167,15 @@ else()
   run_cmake_command(GLOB-CONFIGURE_DEPENDS-RerunCMake-rebuild_second ${CMAKE_COMMAND} --build .)
   run_cmake_command(GLOB-CONFIGURE_DEPENDS-RerunCMake-nowork ${CMAKE_COMMAND} --build .)
 
+  # Directories changed within the last 2 seconds are always globbed again.
+  # Wait longer so that the verification saves and then relies on their times.
+  execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 2.5)
+  message(STATUS "GLOB-CONFIGURE_DEPENDS-RerunCMake: restore first test file after saving directory times...")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-RerunCMake-nowork ${CMAKE_COMMAND} --build .)
+  file(WRITE "${tf_1}" "1")
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-RerunCMake-rebuild_third ${CMAKE_COMMAND} --build .)
+  run_cmake_command(GLOB-CONFIGURE_DEPENDS-RerunCMake-nowork ${CMAKE_COMMAND} --build .)
+
   if(NOT WIN32
       AND NOT MSYS # FIXME: This works on CYGWIN but not on MSYS
       )
@@ -0,0 +1,3 @@
+if(NOT EXISTS "${RunCMake_TEST_BINARY_DIR}/CMakeFiles/FindDirectoryCache.bin")
+  set(RunCMake_TEST_FAILED "FindDirectoryCache.bin not written.")
+endif()
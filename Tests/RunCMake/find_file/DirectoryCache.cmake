@@ -0,0 +1,12 @@
+find_file(Source NAMES DirectoryCache.cmake PATHS "${CMAKE_CURRENT_SOURCE_DIR}"
+  NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "Source='${Source}'")
+
+set(dir "${CMAKE_CURRENT_BINARY_DIR}/dir")
+file(REMOVE_RECURSE "${dir}")
+file(MAKE_DIRECTORY "${dir}")
+find_file(Before NAMES new.h PATHS "${dir}" NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "Before='${Before}'")
+file(WRITE "${dir}/new.h" "")
+find_file(After NAMES new.h PATHS "${dir}" NO_DEFAULT_PATH NO_CACHE)
+message(STATUS "After='${After}'")
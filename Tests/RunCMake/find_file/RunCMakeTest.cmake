@@ -15,6 +15,18 @@ run_cmake(VALIDATOR-undefined-function)
 run_cmake(VALIDATOR-specify-macro)
 run_cmake(VALIDATOR)
 
+block()
+  set(RunCMake_TEST_BINARY_DIR ${RunCMake_BINARY_DIR}/DirectoryCache-build)
+  set(RunCMake_TEST_OPTIONS -DCMAKE_FIND_DIRECTORY_CACHE=ON)
+  set(RunCMake_TEST_NO_CLEAN 1)
+  file(REMOVE_RECURSE "${RunCMake_TEST_BINARY_DIR}")
+  file(MAKE_DIRECTORY "${RunCMake_TEST_BINARY_DIR}")
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-list")
+  run_cmake(DirectoryCache)
+  set(RunCMake_TEST_VARIANT_DESCRIPTION "-cached")
+  run_cmake(DirectoryCache)
+endblock()
+
 if(CMAKE_HOST_WIN32 AND MINGW)
   run_cmake(MSYSTEM_PREFIX)
 endif()
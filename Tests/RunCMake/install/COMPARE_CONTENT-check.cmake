@@ -0,0 +1,77 @@
+set(src ${RunCMake_TEST_BINARY_DIR}/src)
+set(prefix ${RunCMake_TEST_BINARY_DIR}/prefix)
+
+function(install_and_expect step expect)
+  execute_process(
+    COMMAND ${CMAKE_COMMAND} -P ${RunCMake_TEST_BINARY_DIR}/cmake_install.cmake
+    OUTPUT_VARIABLE out ERROR_VARIABLE err)
+  if(NOT out MATCHES "${expect}")
+    string(REGEX REPLACE "\n" "\n  " out "  ${out}")
+    string(APPEND RunCMake_TEST_FAILED
+      "${step} install did not print the expected messages:\n${out}\n")
+    set(RunCMake_TEST_FAILED "${RunCMake_TEST_FAILED}" PARENT_SCOPE)
+  endif()
+endfunction()
+
+function(expect_content file content)
+  file(READ "${file}" actual)
+  if(NOT actual STREQUAL content)
+    string(APPEND RunCMake_TEST_FAILED
+      "File\n  ${file}\nhas content\n  ${actual}\n")
+    set(RunCMake_TEST_FAILED "${RunCMake_TEST_FAILED}" PARENT_SCOPE)
+  endif()
+endfunction()
+
+file(REMOVE_RECURSE ${prefix})
+install_and_expect(First "
+-- Installing: [^\n]*/prefix/(\./)?file.txt\r?
+-- Installing: [^\n]*/prefix/(\./)?dir\r?
+-- Installing: [^\n]*/prefix/(\./)?dir/a.txt\r?
+")
+set(manifest ${RunCMake_TEST_BINARY_DIR}/install_hash_manifest.txt)
+if(EXISTS ${manifest})
+  # The entries are sorted by destination.
+  file(STRINGS ${manifest} entries REGEX "^[0-9]")
+  list(TRANSFORM entries REPLACE "^[^ ]+ [^ ]+ [^ ]+ [^ ]+ [^ ]+ " "")
+  set(expect "${prefix}/./dir/a.txt;${prefix}/./file.txt")
+  if(NOT entries STREQUAL expect)
+    string(APPEND RunCMake_TEST_FAILED
+      "The hash manifest has entries\n  ${entries}\nnot\n  ${expect}\n")
+  endif()
+else()
+  string(APPEND RunCMake_TEST_FAILED "The hash manifest was not written.\n")
+endif()
+
+# Rewrite the sources with the same content and a newer time.
+execute_process(COMMAND ${CMAKE_COMMAND} -E sleep 1.125)
+file(WRITE "${src}/file.txt" "content\n")
+file(WRITE "${src}/dir/a.txt" "a\n")
+install_and_expect(Second "
+-- Up-to-date: [^\n]*/prefix/(\./)?file.txt\r?
+-- Up-to-date: [^\n]*/prefix/(\./)?dir\r?
+-- Up-to-date: [^\n]*/prefix/(\./)?dir/a.txt\r?
+")
+
+# Change the content of a source without changing its size, and the
+# content of a destination.
+file(WRITE "${src}/file.txt" "CONTENT\n")
+file(WRITE "${prefix}/dir/a.txt" "b\n")
+install_and_expect(Third "
+-- Installing: [^\n]*/prefix/(\./)?file.txt\r?
+-- Up-to-date: [^\n]*/prefix/(\./)?dir\r?
+-- Installing: [^\n]*/prefix/(\./)?dir/a.txt\r?
+")
+expect_content("${prefix}/file.txt" "CONTENT\n")
+expect_content("${prefix}/dir/a.txt" "a\n")
+
+# A manifest that cannot be written is reported.
+file(WRITE "${src}/file.txt" "changed\n")
+execute_process(
+  COMMAND ${CMAKE_COMMAND}
+    -DCMAKE_INSTALL_HASH_MANIFEST=${src}/file.txt/manifest.txt
+    -P ${RunCMake_TEST_BINARY_DIR}/cmake_install.cmake
+  OUTPUT_QUIET ERROR_VARIABLE err)
+if(NOT err MATCHES "Cannot write the install hash manifest")
+  string(APPEND RunCMake_TEST_FAILED
+    "A manifest that cannot be written was not reported:\n${err}\n")
+endif()
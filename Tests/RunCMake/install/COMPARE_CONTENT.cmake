@@ -0,0 +1,6 @@
+set(CMAKE_INSTALL_COMPARE_CONTENT ON)
+set(CMAKE_INSTALL_PREFIX "${CMAKE_BINARY_DIR}/prefix")
+file(WRITE "${CMAKE_BINARY_DIR}/src/file.txt" "content\n")
+file(WRITE "${CMAKE_BINARY_DIR}/src/dir/a.txt" "a\n")
+install(FILES "${CMAKE_BINARY_DIR}/src/file.txt" DESTINATION .)
+install(DIRECTORY "${CMAKE_BINARY_DIR}/src/dir" DESTINATION .)
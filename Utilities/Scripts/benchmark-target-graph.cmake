@@ -0,0 +1,71 @@
+# Distributed under the OSI-approved BSD 3-Clause License.  See accompanying
+# file LICENSE.rst or https://cmake.org/licensing for details.
+
+# Time the generation of a project with a large target dependency graph.
+# The project has N custom targets, and target i depends on the targets
+# i-1, i/2, and i-7.  Every target has a custom command, so each one
+# contributes progress marks that the targets depending on it count.
+#
+# Invoke in script mode with the cmake to measure:
+#
+#   path/to/cmake -DN=4000 -P benchmark-target-graph.cmake
+#
+# Optional variables:
+# N         - the number of targets (default 4000)
+# GENERATOR - the generator to use (default "Unix Makefiles")
+# WORK_DIR  - the directory for the project (default ./target-graph-<N>)
+
+cmake_minimum_required(VERSION 3.13)
+
+if(NOT DEFINED N)
+  set(N 4000)
+endif()
+if(NOT DEFINED GENERATOR)
+  set(GENERATOR "Unix Makefiles")
+endif()
+if(NOT DEFINED WORK_DIR)
+  set(WORK_DIR "${CMAKE_CURRENT_BINARY_DIR}/target-graph-${N}")
+endif()
+
+set(source_dir "${WORK_DIR}/src")
+set(binary_dir "${WORK_DIR}/build")
+file(REMOVE_RECURSE "${WORK_DIR}")
+file(MAKE_DIRECTORY "${source_dir}" "${binary_dir}")
+
+set(code "cmake_minimum_required(VERSION 3.13)\nproject(TargetGraph NONE)\n")
+math(EXPR last "${N} - 1")
+foreach(i RANGE ${last})
+  string(APPEND code
+    "add_custom_command(OUTPUT t${i}.txt COMMAND \${CMAKE_COMMAND} -E touch t${i}.txt)\n"
+    "add_custom_target(t${i} ALL DEPENDS t${i}.txt)\n")
+  set(deps "")
+  math(EXPR a "${i} - 1")
+  math(EXPR b "${i} / 2")
+  math(EXPR c "${i} - 7")
+  foreach(d IN ITEMS ${a} ${b} ${c})
+    if(d GREATER_EQUAL 0 AND NOT d EQUAL i)
+      list(APPEND deps t${d})
+    endif()
+  endforeach()
+  if(deps)
+    list(REMOVE_DUPLICATES deps)
+    list(JOIN deps " " deps)
+    string(APPEND code "add_dependencies(t${i} ${deps})\n")
+  endif()
+endforeach()
+file(WRITE "${source_dir}/CMakeLists.txt" "${code}")
+
+string(TIMESTAMP start "%s%f")
+execute_process(
+  COMMAND "${CMAKE_COMMAND}" -G "${GENERATOR}"
+          -S "${source_dir}" -B "${binary_dir}"
+  OUTPUT_QUIET
+  RESULT_VARIABLE result
+  )
+string(TIMESTAMP stop "%s%f")
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "Generating the project failed: ${result}")
+endif()
+
+math(EXPR elapsed "(${stop} - ${start}) / 1000")
+message(STATUS "${N} targets generated with '${GENERATOR}' in ${elapsed} ms")
@@ -16,8 +16,7 @@ for lexer in            \
     CTestResourceGroups \
     DependsJava         \
     Expr                \
-    Fortran             \
-    GccDepfile
+    Fortran
 do
     cxx_file=cm${lexer}Lexer.cxx
     h_file=cm${lexer}Lexer.h